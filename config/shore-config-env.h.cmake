@@ -88,6 +88,9 @@
 /* Defined if you have the <numa.h> header file. */
 #cmakedefine HAVE_NUMA_H
 
+/* Defined if you have the <linux/io_uring.h> header file. */
+#cmakedefine HAVE_LINUX_IO_URING_H
+
 /****************** std functions. *****************************/
 
 /* Defined if you have the `vprintf' function. */
@@ -163,6 +163,12 @@ void Command::setupSMOptions(po::options_description& options)
         "Whether to truncate log archive runs at SM shutdown")
     ("sm_log_partition_size", po::value<int>()->default_value(1024),
         "Size of a log partition in MB")
+    ("sm_log_stream_dirs", po::value<string>()->default_value(""),
+        "Additional log directories, separated by ':', across which log partitions are striped (sm_logdir being the first)")
+    ("sm_log_stripe_size", po::value<int>()->default_value(1024),
+        "Size in KB of the units in which log partitions are striped across log directories")
+    ("sm_log_fake_flush_delay", po::value<int>()->default_value(0),
+        "Artificial delay in microseconds after each log flush, to emulate a slower log device")
     ("sm_log_max_partitions", po::value<int>()->default_value(0),
         "Maximum number of partitions maintained in log directory")
     ("sm_log_delete_old_partitions", po::value<bool>()->default_value(true),
@@ -171,6 +177,8 @@ void Command::setupSMOptions(po::options_description& options)
         "Size in bytes of group commit window (higher -> larger log writes)")
     ("sm_group_commit_timeout", po::value<int>(),
         "Max time to wait (in ms) to fill up group commit window")
+    ("sm_group_commit_adaptive", po::value<bool>()->default_value(false),
+        "Decide when to flush the log from flush latency and commit rate; sm_group_commit_size and timeout become upper bounds")
     ("sm_log_benchmark_start", po::value<bool>()->default_value(false),
         "Whether to generate benchmark_start log record on SM constructor")
     ("sm_page_img_compression", po::value<int>()->default_value(0),
@@ -194,7 +202,8 @@ void Command::setupSMOptions(po::options_description& options)
     ("sm_chkpt_only_root_pages", po::value<bool>(),
         "Checkpoints only record dirty root pages and SPR takes care of rest")
     ("sm_log_fetch_buf_partitions", po::value<uint>()->default_value(0),
-        "Number of partitions to buffer in memory for recovery")
+        "Number of partitions to buffer in memory for recovery (mapped "
+        "rather than copied if built with USE_MMAP)")
     ("sm_log_page_flushers", po::value<uint>()->default_value(1),
         "Number of log page flushers")
     ("sm_preventive_chkpt", po::value<uint>()->default_value(1),
@@ -209,6 +218,8 @@ void Command::setupSMOptions(po::options_description& options)
         "Log Buffer part size")
     ("sm_carray_slots", po::value<int>(),
         "")
+    ("sm_log_private_buffer_size", po::value<int>()->default_value(0),
+        "Max size in bytes of the log chunk each transaction thread reserves for its private log buffer; 0 = no private log buffers")
     ("sm_vol_cluster_stores", po::value<bool>(),
         "Cluster pages of the same store into extents")
     ("sm_vol_log_reads", po::value<bool>(),
@@ -224,6 +235,12 @@ void Command::setupSMOptions(po::options_description& options)
         "Whether to open log archive files with O_DIRECT")
     ("sm_vol_o_direct", po::value<bool>(),
         "Whether to open volume (i.e., db file) with O_DIRECT")
+    ("sm_vol_io_uring", po::value<bool>(),
+        "Use io_uring for page cleaner writes and buffer pool reads, with the \
+         frames registered as fixed buffers (falls back to synchronous I/O if \
+         not supported by the kernel)")
+    ("sm_vol_aio_depth", po::value<int>(),
+        "Number of entries of each per-thread io_uring instance")
     ("sm_no_db", po::value<bool>()->implicit_value(true)->default_value(false),
         "No-database mode, a.k.a. log-structured mode, a.k.a. extreme write elision: \
          DB file is written and all fetched pages are rebuilt \
@@ -259,10 +276,47 @@ void Command::setupSMOptions(po::options_description& options)
         "Lock table size")
     ("sm_rawlock_xctpool_initseg", po::value<int>(),
         "Transaction Pool Initialization Segment")
+    ("sm_bulkload_sort_memory", po::value<int>(),
+        "Memory in MB used to sort unsorted input of B-tree bulk loads before spilling runs to disk (shared by all indexes the kits loaders fill)")
+    ("sm_btree_compress_values", po::value<bool>()->default_value(false),
+        "Store the elements of leaf records of all new B-tree indexes compressed")
+    ("sm_btree_verify_threads", po::value<int>()->default_value(1),
+        "Threads used to verify B-trees and collect their statistics (-1 = one per core)")
+    ("sm_bt_maintenance_interval", po::value<int>(),
+        "Interval in ms of the background B-tree maintenance (adoption, merges, ghost reclamation); -1 = only when woken up")
+    ("sm_bt_maintenance_io_budget", po::value<int>(),
+        "Pages the B-tree maintenance may read from disk or modify per round (0 = unlimited)")
+    ("sm_bt_maintenance_ghost_threshold", po::value<int>(),
+        "Percentage of ghost records that makes the B-tree maintenance defrag a leaf")
+    ("sm_bt_maintenance_usage_threshold", po::value<int>(),
+        "Percentage of a page that two neighboring leaves may use together to be merged by the B-tree maintenance")
     ("sm_bf_warmup_hit_ratio", po::value<int>(),
         "Hit ratio to be achieved until system is considered warmed up (int from 0 to 100)")
     ("sm_bf_warmup_min_fixes", po::value<int>(),
         "Only consider warmup hit ratio once this minimum number of fixes has been performed")
+    ("sm_bf_hashtable_optimistic", po::value<bool>(),
+        "Use open-addressing buffer-pool hash table with optimistic (latch-free) lookups")
+    ("sm_bf_optimistic_inner", po::value<bool>(),
+        "Traverse inner B-tree nodes without latches, validating page versions instead")
+    ("sm_bf_readahead_window", po::value<int>(),
+        "Number of sibling leaves read ahead asynchronously by B-tree cursors (0 = disabled)")
+    ("sm_bf_readahead_max_queued", po::value<int>(),
+        "Maximum number of pages queued for read-ahead; further requests are dropped")
+    ("sm_bf_freelist_caches", po::value<int>(),
+        "Number of per-core caches of free buffer frames (0 = single global freelist, -1 = one per core)")
+    ("sm_bf_freelist_batch", po::value<int>(),
+        "Number of free frames moved at once between the global freelist and a per-core cache")
+    ("sm_bf_snapshot_file", po::value<string>(),
+        "File to which the IDs of cached pages are written on clean shutdown, \
+         and from which the buffer pool is warmed up on the next startup")
+    ("sm_bf_snapshot_wait", po::value<bool>(),
+        "Whether startup waits until the buffer pool snapshot is loaded")
+    ("sm_bf_huge_pages", po::value<string>(),
+        "Back buffer frames and control blocks with huge pages: none, transparent, 2M, or 1G")
+    ("sm_bf_numa_policy", po::value<string>(),
+        "NUMA placement of buffer frames and control blocks: none, interleave, or partition")
+    ("sm_bf_prefault_threads", po::value<int>(),
+        "Threads used to pre-fault buffer pool memory at startup (0 = none, -1 = one per core)")
     ("sm_cleaner_decoupled", po::value<bool>(),
         "Enable/Disable decoupled cleaner")
     ("sm_cleaner_interval", po::value<int>(),
@@ -280,7 +334,15 @@ void Command::setupSMOptions(po::options_description& options)
     ("sm_cleaner_async_candidate_collection", po::value<bool>(),
         "Collect candidate frames to be cleaned in an asynchronous thread")
     ("sm_evict_policy", po::value<string>(),
-        "Policy to use in eviction (a.k.a. page replacement)")
+        "Policy to use in eviction (a.k.a. page replacement): clock, lruk, or 2q")
+    ("sm_evict_lruk_k", po::value<int>(),
+        "Number of past references considered by the LRU-K eviction policy")
+    ("sm_evict_lruk_sample", po::value<int>(),
+        "Number of frames sampled by the LRU-K eviction policy to pick a victim")
+    ("sm_evict_2q_a1in_pct", po::value<int>(),
+        "Size of the 2Q probation queue (A1in) as a percentage of buffer frames")
+    ("sm_evict_2q_a1out_pct", po::value<int>(),
+        "Size of the 2Q ghost queue (A1out) as a percentage of buffer frames")
     ("sm_evict_dirty_pages", po::value<bool>(),
         "Do not skip dirty pages when performing eviction and write them out if necessary")
     ("sm_evict_random", po::value<bool>(),
@@ -291,6 +353,10 @@ void Command::setupSMOptions(po::options_description& options)
         "Perform eviction in a dedicated thread, while fixing threads wait")
     ("sm_eviction_interval", po::value<int>(),
             "Interval for async eviction thread (in msec)")
+    ("sm_evict_threads", po::value<int>(),
+            "Maximum number of async eviction threads, each owning a disjoint range of a power-of-two number of frames")
+    ("sm_evict_batch_size", po::value<int>(),
+            "Number of victims selected and evicted together by the eviction thread")
     ("sm_wakeup_cleaner_attempts", po::value<int>(),
             "How many failed eviction attempts until cleaner is woken up (0 = never)")
     ("sm_clean_only_attempts", po::value<int>(),
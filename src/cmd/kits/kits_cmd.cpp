@@ -144,6 +144,10 @@ void KitsCommand::setupOptions()
         ("asyncCommit", po::value<bool>(&opt_asyncCommit)->default_value(true)
             ->implicit_value(true),
             "Whether to use asynchronous commit (non-durable) for Kits transactions")
+        ("pipelineCommit", po::value<int>(&opt_pipelineCommit)->default_value(0),
+            "Number of committed transactions per worker that may await the log \
+            flush while the worker runs new ones; their clients are notified \
+            once they are durable. Overrides asyncCommit (0 = disabled)")
         ("spread", po::value<bool>(&opt_spread)->default_value(true)
             ->implicit_value(true),
             "Attach each worker thread to a fixed core for improved concurrency")
@@ -464,6 +468,7 @@ void KitsCommand::initShoreEnv()
     shoreEnv->set_qf(opt_queried_sf);
     shoreEnv->set_loaders(opt_num_threads);
     shoreEnv->setAsynchCommit(opt_asyncCommit);
+    shoreEnv->setCommitPipeline(opt_pipelineCommit);
 
     auto res = shoreEnv->init();
     w_assert0(res == 0);
@@ -45,6 +45,7 @@ protected:
     bool opt_skew;
     bool opt_spread;
     bool opt_asyncCommit;
+    int opt_pipelineCommit;
     bool opt_warmup;
     int opt_crashDelay;
     bool opt_crashDelayAfterInit;
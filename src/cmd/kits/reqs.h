@@ -187,6 +187,28 @@ public:
 
 
 
+/********************************************************************
+ *
+ * @struct: commit_pipeline_t
+ *
+ * @brief:  Commits of a worker that still await durability. Only the
+ *          worker counts them; the durability callback of each commit
+ *          signals the condex once, so that the worker can block on it
+ *          instead of forcing log flushes
+ *
+ ********************************************************************/
+
+struct commit_pipeline_t
+{
+    int     _awaiting;
+    condex  _durable;
+
+    commit_pipeline_t() : _awaiting(0) { }
+
+}; // EOF: commit_pipeline_t
+
+
+
 /********************************************************************
  *
  * @struct: base_request_t
@@ -203,13 +225,17 @@ struct base_request_t
     int                 _xct_id;
     trx_result_tuple_t  _result;
 
+    // Set by a worker that pipelines commits. Not the owner
+    commit_pipeline_t*  _commit_pipeline;
+
     base_request_t()
-        : _xct(NULL),_xct_id(-1)
+        : _xct(NULL),_xct_id(-1),_commit_pipeline(NULL)
     { }
 
     base_request_t(xct_t* pxct, const tid_t& atid, const int axctid,
                    const trx_result_tuple_t& aresult)
-        : _xct(pxct),_tid(atid),_xct_id(axctid),_result(aresult)
+        : _xct(pxct),_tid(atid),_xct_id(axctid),_result(aresult),
+          _commit_pipeline(NULL)
     {
         assert (pxct);
     }
@@ -227,6 +253,7 @@ struct base_request_t
         _tid = atid;
         _xct_id = axctid;
         _result = aresult;
+        _commit_pipeline = NULL;
     }
 
     inline xct_t* xct() { return (_xct); }
@@ -116,7 +116,8 @@ ShoreEnv::ShoreEnv(po::variables_map& vm)
       _request_pool(sizeof(trx_request_t)),
       _bUseSLI(false),
       _bUseELR(false),
-      _bUseFlusher(false)
+      _bUseFlusher(false),
+      _commit_pipeline(0)
       // _logger(NULL)
 {
     optionValues = vm;
@@ -1105,6 +1106,59 @@ void ShoreEnv::setAsynchCommit(const bool bAsynch)
 }
 
 
+/******************************************************************
+ *
+ *  @fn:    setCommitPipeline()
+ *
+ *  @brief: Sets how many commits of each worker may await durability
+ *          while the worker runs new transactions (0 = none)
+ *
+ ******************************************************************/
+
+void ShoreEnv::setCommitPipeline(const int depth)
+{
+    _commit_pipeline = std::max(depth, 0);
+}
+
+
+/******************************************************************
+ *
+ *  @fn:    _commit_pipelined()
+ *
+ *  @brief: Commits the attached xct without waiting for the log flush.
+ *          The log flush daemon notifies the client, counts the xct as
+ *          committed and frees the worker's pipeline slot once the
+ *          commit is durable.
+ *
+ *  @note:  The request is recycled as soon as the worker returns, so
+ *          the callback only keeps what it needs
+ *
+ ******************************************************************/
+
+w_rc_t ShoreEnv::_commit_pipelined(Request* prequest)
+{
+    assert (prequest->_commit_pipeline);
+    commit_pipeline_t* pipeline = prequest->_commit_pipeline;
+    condex* pcondex = prequest->_result.get_notify();
+    prequest->_result.set_notify(NULL);
+
+    w_rc_t e = _pssm->commit_xct_async([this, pcondex, pipeline](const lsn_t&) {
+        if (pcondex) pcondex->signal();
+        if ((*&_measure)==MST_MEASURE) _env_stats.inc_trx_com();
+        // last, since the worker may exit once all its commits are durable
+        pipeline->_durable.signal();
+    });
+    if (e.is_error()) {
+        // the callback never runs; the caller aborts and notifies
+        prequest->_result.set_notify(pcondex);
+    }
+    else {
+        pipeline->_awaiting++;
+    }
+    return (e);
+}
+
+
 #if 0
 
 /******************************************************************
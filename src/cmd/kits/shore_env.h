@@ -128,7 +128,11 @@ const int SHORE_NUM_OF_RETRIES       = 3;
         _inc_##trxlid##_att();                                          \
         w_rc_t e = xct_##trximpl(xct_id, in);                           \
         if (!e.is_error()) {                                            \
-            if (isAsynchCommit()) e = _pssm->commit_xct(true);          \
+            if (prequest->_commit_pipeline) {                           \
+                /* client is notified once the commit is durable */     \
+                e = _commit_pipelined(prequest);                        \
+                if (!e.is_error()) return (RCOK); }                     \
+            else if (isAsynchCommit()) e = _pssm->commit_xct(true);     \
             else e = _pssm->commit_xct(); }                             \
         if (e.is_error()) {                                             \
             if (e.err_num() != eDEADLOCK)                    \
@@ -470,6 +474,11 @@ public:
     virtual ~ShoreEnv();
 
     sm_options& get_opts() { return _popts; }
+    // Share of the bulk-load sort memory (sm_bulkload_sort_memory MB in
+    // total) of each of the given number of tables loaded together
+    size_t bulk_sort_memory(size_t tables) const {
+        return (size_t(_popts.get_int_option("sm_bulkload_sort_memory", 64)) << 20) / tables;
+    }
     po::variables_map& get_optionValues(){ return optionValues; };
     // DB INTERFACE
 
@@ -669,6 +678,11 @@ public:
     inline bool isAsynchCommit() const { return (_asynch_commit); }
     void setAsynchCommit(const bool bAsynch);
 
+    // Control how many durable commits each worker may leave in flight
+    // while it runs the next transactions (0 = none)
+    inline int commitPipeline() const { return (_commit_pipeline); }
+    void setCommitPipeline(const int depth);
+
 
     // SLI
 public:
@@ -704,6 +718,11 @@ protected:
     // returns 0 on success
     int _set_sys_params();
     bool _asynch_commit;
+    int _commit_pipeline;
+
+    // Commits the attached xct of a pipelining worker without waiting for
+    // the log flush; the request's client is notified once it is durable
+    w_rc_t _commit_pipelined(Request* prequest);
 
 }; // EOF ShoreEnv
 
@@ -190,7 +190,13 @@ w_rc_t table_man_t<T>::add_tuple(ss_m* db,
     ptuple->store_key(ptuple->_rep_key->_dest, ksz, pindex);
     kstr.construct_regularkey(ptuple->_rep_key->_dest, ksz);
 
-    W_DO(db->create_assoc(pindex->stid(), kstr, vec_t(ptuple->_rep->_dest, tsz)));
+    // while bulk loading, entries are only collected for end_bulk_load()
+    if (is_bulk_loading()) {
+        W_DO(_bulk_add(0, kstr, vec_t(ptuple->_rep->_dest, tsz)));
+    }
+    else {
+        W_DO(db->create_assoc(pindex->stid(), kstr, vec_t(ptuple->_rep->_dest, tsz)));
+    }
 
     // update the indexes
     const std::vector<index_desc_t*>& indexes = _ptable->get_indexes();
@@ -201,6 +207,11 @@ w_rc_t table_man_t<T>::add_tuple(ss_m* db,
         sec_kstr.construct_regularkey(ptuple->_rep->_dest, sec_ksz);
 
         // primary key value (i.e., pointer) is stored in _rep_key
+        if (is_bulk_loading()) {
+            W_DO(_bulk_add(i+1, sec_kstr,
+                        vec_t(ptuple->_rep_key->_dest, ksz)));
+            continue;
+        }
         W_DO(db->create_assoc(indexes[i]->stid(),
                     sec_kstr,
                     vec_t(ptuple->_rep_key->_dest, ksz)
@@ -209,6 +220,75 @@ w_rc_t table_man_t<T>::add_tuple(ss_m* db,
     return (RCOK);
 }
 
+template<class T>
+w_rc_t table_man_t<T>::_bulk_add(size_t i, const w_keystr_t& key,
+                                 const vec_t& el)
+{
+    CRITICAL_SECTION(bulk_cs, _bulk_mutex);
+    return (_bulk_sorters[i]->add(key, el));
+}
+
+
+/*********************************************************************
+ *
+ *  @fn:    begin_bulk_load
+ *
+ *  @brief: Makes add_tuple() collect the index entries in memory
+ *          (spilling sorted runs to temporary files once the entries
+ *          of all indexes exceed sort_memory bytes) instead of
+ *          inserting them
+ *
+ *********************************************************************/
+
+template<class T>
+void table_man_t<T>::begin_bulk_load(size_t sort_memory)
+{
+    assert (_ptable);
+    CRITICAL_SECTION(bulk_cs, _bulk_mutex);
+    assert (!is_bulk_loading());
+
+    // primary index and all secondary indexes
+    size_t count = _ptable->get_indexes().size() + 1;
+    for (size_t i = 0; i < count; i++) {
+        _bulk_sorters.emplace_back(new bulk_load_sorter(sort_memory / count));
+    }
+}
+
+
+/*********************************************************************
+ *
+ *  @fn:    end_bulk_load
+ *
+ *  @brief: Loads the entries collected since begin_bulk_load() in
+ *          key order into the indexes, which must still be empty,
+ *          building their B-tree pages bottom-up
+ *
+ *  @note:  This function should be called in the context of a trx,
+ *          after all threads adding tuples are done.
+ *
+ *********************************************************************/
+
+template<class T>
+w_rc_t table_man_t<T>::end_bulk_load(ss_m* db)
+{
+    assert (_ptable);
+    CRITICAL_SECTION(bulk_cs, _bulk_mutex);
+    if (!is_bulk_loading()) { return (RCOK); }
+
+    const std::vector<index_desc_t*>& indexes = _ptable->get_indexes();
+    assert (_bulk_sorters.size() == indexes.size() + 1);
+    for (size_t i = 0; i < _bulk_sorters.size(); i++) {
+        index_desc_t* pindex = (i == 0) ? _ptable->primary_idx() : indexes[i-1];
+        uint64_t count = 0;
+        W_DO(db->bulk_load(pindex->stid(), *_bulk_sorters[i], true, &count));
+        TRACE( TRACE_ALWAYS, "Bulk loaded (%lu) entries into (%s)\n",
+               count, pindex->name().c_str());
+        _bulk_sorters[i].reset();
+    }
+    _bulk_sorters.clear();
+    return (RCOK);
+}
+
 
 
 
@@ -91,10 +91,14 @@
 #ifndef __TABLE_MAN_H
 #define __TABLE_MAN_H
 
+#include <memory>
+#include <vector>
+
 #include "tls.h"
 #include "sm_vas.h"
 #include "latches.h"
 #include "btcursor.h"
+#include "kits_thread.h"
 
 //#include "shore_msg.h"
 #include "util/guard.h"
@@ -122,11 +126,17 @@ protected:
 
     guard<blob_pool> _pts;   /* trash stack */
 
+    /* sorters collecting the index entries while bulk loading,
+       the primary index first, then the order of get_indexes() */
+    std::vector<std::unique_ptr<bulk_load_sorter> > _bulk_sorters;
+    /* blocking, since an add may spill a sorted run to disk */
+    pthread_mutex_t _bulk_mutex;
+
 public:
 
     table_man_t(T* aTableDesc,
 		bool construct_cache=true)
-        : _ptable(aTableDesc)
+        : _ptable(aTableDesc), _bulk_mutex(thread_mutex_create())
     {
 	// init tuple cache
         if (construct_cache) {
@@ -137,7 +147,7 @@ public:
         }
     }
 
-    virtual ~table_man_t() {}
+    virtual ~table_man_t() { pthread_mutex_destroy(&_bulk_mutex); }
 
     T* table() { return (_ptable); }
 
@@ -254,6 +264,26 @@ public:
                            const lock_mode_t lock_mode = okvl_mode::X);
 
 
+    /* --------------------- */
+    /* --- bulk loading  --- */
+    /* --------------------- */
+
+    // While bulk loading, add_tuple() only collects the entries of
+    // the table's indexes (from any number of threads), which are
+    // then loaded into the still empty indexes by end_bulk_load().
+    // Loaded tuples cannot be read before end_bulk_load().
+    // sort_memory is shared by the sorters of all indexes of the table.
+    void      begin_bulk_load(size_t sort_memory = 64 << 20);
+    w_rc_t    end_bulk_load(ss_m* db);
+    bool      is_bulk_loading() const { return (!_bulk_sorters.empty()); }
+
+protected:
+    // adds an entry of the i-th sorter (0 = primary index)
+    w_rc_t    _bulk_add(size_t i, const w_keystr_t& key, const vec_t& el);
+
+public:
+
+
     // set indexed fields of the row to minimum
     int  min_key(index_desc_t* pindex,
                  table_row_t* ptuple,
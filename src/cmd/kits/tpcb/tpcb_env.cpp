@@ -409,6 +409,12 @@ w_rc_t ShoreTPCBEnv::create_tables()
 
     // time_t tstart = time(NULL);
 
+    // 1. All tuples added until the end of load_data() are bulk loaded
+    size_t sort_memory = bulk_sort_memory(3);
+    branch_man->begin_bulk_load(sort_memory);
+    teller_man->begin_bulk_load(sort_memory);
+    account_man->begin_bulk_load(sort_memory);
+
     // 2. Create and fire up the table creator which will also start the loading
     {
 	guard<table_creator_t> tc;
@@ -457,6 +463,13 @@ w_rc_t ShoreTPCBEnv::load_data()
 	loaders[i]->join();
     }
 
+    // 5. Build the indexes from the tuples collected by the loaders
+    W_DO(db()->begin_xct());
+    W_DO(branch_man->end_bulk_load(db()));
+    W_DO(teller_man->end_bulk_load(db()));
+    W_DO(account_man->end_bulk_load(db()));
+    W_DO(db()->commit_xct());
+
     return RCOK;
 }
 
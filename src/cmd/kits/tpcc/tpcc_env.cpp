@@ -426,6 +426,18 @@ w_rc_t ShoreTPCCEnv::create_tables()
 	int cid_array[ORDERS_PER_DIST];
 	gen_cid_array(cid_array);
 
+	// 0. All tuples added until the end of load_data() are bulk loaded
+	size_t sort_memory = bulk_sort_memory(9);
+	_pwarehouse_man->begin_bulk_load(sort_memory);
+	_pdistrict_man->begin_bulk_load(sort_memory);
+	_pstock_man->begin_bulk_load(sort_memory);
+	_porder_line_man->begin_bulk_load(sort_memory);
+	_pcustomer_man->begin_bulk_load(sort_memory);
+	_phistory_man->begin_bulk_load(sort_memory);
+	_porder_man->begin_bulk_load(sort_memory);
+	_pnew_order_man->begin_bulk_load(sort_memory);
+	_pitem_man->begin_bulk_load(sort_memory);
+
 	// 1. The table creator creates the tables and loads the first records per table
 	{
 		guard<table_creator_t> tc;
@@ -476,6 +488,19 @@ w_rc_t ShoreTPCCEnv::load_data()
 	loaders[i]->join();
     }
 
+    // 4. Build the indexes from the tuples collected by the loaders
+    W_DO(db()->begin_xct());
+    W_DO(_pwarehouse_man->end_bulk_load(db()));
+    W_DO(_pdistrict_man->end_bulk_load(db()));
+    W_DO(_pstock_man->end_bulk_load(db()));
+    W_DO(_porder_line_man->end_bulk_load(db()));
+    W_DO(_pcustomer_man->end_bulk_load(db()));
+    W_DO(_phistory_man->end_bulk_load(db()));
+    W_DO(_porder_man->end_bulk_load(db()));
+    W_DO(_pnew_order_man->end_bulk_load(db()));
+    W_DO(_pitem_man->end_bulk_load(db()));
+    W_DO(db()->commit_xct());
+
     return RCOK;
 }
 
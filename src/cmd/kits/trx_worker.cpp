@@ -33,6 +33,7 @@
 #include "trx_worker.h"
 #include "shore_env.h"
 
+
 /******************************************************************
  *
  * @class: trx_worker_t
@@ -99,6 +100,9 @@ int trx_worker_t::_work_ACTIVE_impl()
 #endif
         }
     }
+
+    // the durability callbacks of pipelined commits refer to this worker
+    _wait_for_durable_commits(0);
     return (0);
 }
 
@@ -121,6 +125,15 @@ int trx_worker_t::_serve_action(Request* prequest)
     //           the xct in order the SLI to work
     assert (prequest);
     //smthread_t::me()->attach_xct(prequest->_xct);
+
+    // With commit pipelining, start the next xct while earlier ones await
+    // durability, as long as there are no more of them than allowed
+    const int pipeline = _env->commitPipeline();
+    if (pipeline > 0) {
+        _wait_for_durable_commits(pipeline - 1);
+        prequest->_commit_pipeline = &_commit_pipeline;
+    }
+
     tid_t atid;
     {
     w_rc_t e = _env->db()->begin_xct(atid);
@@ -160,6 +173,27 @@ int trx_worker_t::_serve_action(Request* prequest)
 
 
 
+/******************************************************************
+ *
+ * @fn:     _wait_for_durable_commits()
+ *
+ * @brief:  Blocks until no more than max_awaiting of the pipelined
+ *          commits of this worker await durability
+ *
+ ******************************************************************/
+
+void trx_worker_t::_wait_for_durable_commits(const int max_awaiting)
+{
+    // The flush daemon makes them durable in its own time, so that
+    // commits of all workers still share flushes; each callback signals
+    // the condex once
+    while (_commit_pipeline._awaiting > max_awaiting) {
+        _commit_pipeline._durable.wait();
+        _commit_pipeline._awaiting--;
+    }
+}
+
+
 /******************************************************************
  *
  * @fn:     _pre_STOP_impl()
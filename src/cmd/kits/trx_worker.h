@@ -566,6 +566,9 @@ private:
     guard<Queue>         _pqueue;
     guard<Pool>          _actionpool;
 
+    // committed xcts still awaiting durability (see ShoreEnv::commitPipeline)
+    commit_pipeline_t    _commit_pipeline;
+
     // states
     int _work_ACTIVE_impl();
 
@@ -574,6 +577,9 @@ private:
     // serves one action
     int _serve_action(Request* prequest);
 
+    // waits until at most max_awaiting commits await durability
+    void _wait_for_durable_commits(const int max_awaiting);
+
 public:
 
     trx_worker_t(ShoreEnv* env, std::string tname,
@@ -262,6 +262,9 @@ rc_t ShoreYCSBEnv::create_tables()
     tc = new table_creator_t(this);
     tc->fork();
     tc->join();
+
+    // All tuples added until the end of load_data() are bulk loaded
+    ycsbtable_man->begin_bulk_load(bulk_sort_memory(1));
     return RCOK;
 }
 
@@ -294,6 +297,11 @@ rc_t ShoreYCSBEnv::load_data()
 	loaders[i]->join();
     }
 
+    // 5. Build the index from the tuples collected by the loaders
+    W_DO(db()->begin_xct());
+    W_DO(ycsbtable_man->end_bulk_load(db()));
+    W_DO(db()->commit_xct());
+
     return RCOK;
 }
 
@@ -10,6 +10,12 @@
 #include "bf_hashtable.h"
 #include "latch.h"
 #include <string.h>
+#include <stdlib.h>
+#include <atomic>
+#include <map>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 const size_t HASHBUCKET_INITIAL_CHUNK_SIZE = 4;
 const uint32_t BF_HASH_SEED = 0x35D0B891;
@@ -237,8 +243,213 @@ bool bf_hashbucket<T>::remove (PageID key) {
     return found;
 }
 
+/** Number of entries in a bucket of bf_hashtable_optimistic. */
+const uint32_t HASHBUCKET_OPTIMISTIC_SLOTS = 4;
+/** bf_hashtable_optimistic has this many buckets per bucket of bf_hashtable. */
+const uint32_t HASHBUCKET_OPTIMISTIC_EXPANSION = 4;
+
+/**
+ * Bucket of bf_hashtable_optimistic, which occupies exactly one cache line
+ * (for T = bf_idx_pair). Keys are stored contiguously so that all of them can
+ * be compared with a single SIMD instruction.
+ *
+ * The version works like a seqlock: it is odd while a writer modifies the
+ * bucket and is incremented again when the writer is done. Readers take a
+ * snapshot of the bucket and retry if the version was odd or changed during
+ * the copy, so the lookup path never writes to shared memory.
+ */
+template<class T>
+struct alignas(CACHELINE_SIZE) bf_hashbucket_optimistic {
+    std::atomic<uint32_t> version;
+    /** bit i is on if slot i holds a valid entry */
+    uint16_t used_mask;
+    /** number of entries with this home bucket that live in the overflow area */
+    uint16_t overflow_count;
+    PageID keys[HASHBUCKET_OPTIMISTIC_SLOTS];
+    T values[HASHBUCKET_OPTIMISTIC_SLOTS];
+
+    /** Returns a bitmask of the used slots whose key equals the given one. */
+    uint32_t match(PageID key) const {
+#ifdef __SSE2__
+        static_assert(HASHBUCKET_OPTIMISTIC_SLOTS * sizeof(PageID) == 16,
+                "SIMD key comparison assumes four 32-bit keys");
+        __m128i k = _mm_set1_epi32(static_cast<int>(key));
+        __m128i ks = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys));
+        uint32_t m = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(k, ks)));
+        return m & used_mask;
+#else
+        uint32_t m = 0;
+        for (uint32_t i = 0; i < HASHBUCKET_OPTIMISTIC_SLOTS; ++i) {
+            if (keys[i] == key) { m |= (1 << i); }
+        }
+        return m & used_mask;
+#endif
+    }
+
+    void lock() {
+        while (true) {
+            uint32_t v = version.load(std::memory_order_relaxed);
+            if ((v & 1) == 0 && version.compare_exchange_weak(v, v + 1,
+                        std::memory_order_acquire)) {
+                return;
+            }
+        }
+    }
+
+    void unlock() {
+        w_assert1(version.load(std::memory_order_relaxed) & 1);
+        version.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    bf_hashbucket_optimistic(); // bulk-initialized by memset, like bf_hashbucket
+};
+
+/**
+ * \brief Open-addressing variant of bf_hashtable with optimistic reads.
+ * \details
+ * Each key has a single home bucket of HASHBUCKET_OPTIMISTIC_SLOTS entries.
+ * If the home bucket is full, the entry goes to a shared overflow area, which
+ * is only consulted when the home bucket's overflow_count is non-zero. With
+ * the default sizing (4 buckets per chained bucket, whose load factor is
+ * already 25%), overflow is very rare.
+ *
+ * Writers serialize on the bucket version (see bf_hashbucket_optimistic) and
+ * never touch other buckets, so there is no lock ordering to worry about.
+ * Entries of a given home bucket in the overflow area are only modified while
+ * holding that bucket; _overflow_lock merely protects the map structure.
+ */
+template<class T>
+class bf_hashtable_optimistic {
+public:
+    bf_hashtable_optimistic(uint32_t size) : _size(size) {
+        void* buf = NULL;
+        if (::posix_memalign(&buf, CACHELINE_SIZE,
+                    sizeof(bf_hashbucket_optimistic<T>) * size) != 0) {
+            W_FATAL(eOUTOFMEMORY);
+        }
+        ::memset (buf, 0, sizeof(bf_hashbucket_optimistic<T>) * size);
+        _table = reinterpret_cast<bf_hashbucket_optimistic<T>*>(buf);
+    }
+
+    ~bf_hashtable_optimistic() {
+        ::free(_table);
+    }
+
+    bool lookup(PageID key, T& value) const {
+        const bf_hashbucket_optimistic<T>& b = _table[bf_hash(key) % _size];
+        while (true) {
+            uint32_t v = b.version.load(std::memory_order_acquire);
+            if (v & 1) { continue; }
+
+            uint32_t m = b.match(key);
+            bool found = m != 0;
+            if (found) { value = b.values[__builtin_ctz(m)]; }
+            bool overflow = b.overflow_count > 0;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (b.version.load(std::memory_order_relaxed) != v) { continue; }
+
+            if (found) { return true; }
+            if (!overflow) { return false; }
+            break;
+        }
+
+        // Rare case: the home bucket spilled into the overflow area
+        spinlock_read_critical_section cs(&_overflow_lock);
+        typename std::map<PageID, T>::const_iterator it = _overflow.find(key);
+        if (it == _overflow.end()) { return false; }
+        value = it->second;
+        return true;
+    }
+
+    bool insert_if_not_exists(PageID key, T value) {
+        bf_hashbucket_optimistic<T>& b = _table[bf_hash(key) % _size];
+        b.lock();
+        bool inserted = false;
+        if (b.match(key) == 0 && !_overflow_find(b, key)) {
+            uint32_t free_mask = ~b.used_mask & ((1 << HASHBUCKET_OPTIMISTIC_SLOTS) - 1);
+            if (free_mask != 0) {
+                uint32_t i = __builtin_ctz(free_mask);
+                b.keys[i] = key;
+                b.values[i] = value;
+                b.used_mask |= (1 << i);
+            }
+            else {
+                spinlock_write_critical_section cs(&_overflow_lock);
+                _overflow[key] = value;
+                ++b.overflow_count;
+            }
+            inserted = true;
+        }
+        b.unlock();
+        return inserted;
+    }
+
+    bool update(PageID key, T value) {
+        bf_hashbucket_optimistic<T>& b = _table[bf_hash(key) % _size];
+        b.lock();
+        bool found = false;
+        uint32_t m = b.match(key);
+        if (m != 0) {
+            b.values[__builtin_ctz(m)] = value;
+            found = true;
+        }
+        else if (b.overflow_count > 0) {
+            spinlock_write_critical_section cs(&_overflow_lock);
+            typename std::map<PageID, T>::iterator it = _overflow.find(key);
+            if (it != _overflow.end()) {
+                it->second = value;
+                found = true;
+            }
+        }
+        b.unlock();
+        return found;
+    }
+
+    bool remove(PageID key) {
+        bf_hashbucket_optimistic<T>& b = _table[bf_hash(key) % _size];
+        b.lock();
+        bool found = false;
+        uint32_t m = b.match(key);
+        if (m != 0) {
+            b.used_mask &= ~m;
+            found = true;
+        }
+        else if (b.overflow_count > 0) {
+            spinlock_write_critical_section cs(&_overflow_lock);
+            if (_overflow.erase(key) > 0) {
+                --b.overflow_count;
+                found = true;
+            }
+        }
+        b.unlock();
+        return found;
+    }
+
+private:
+    /** @pre bucket b is locked */
+    bool _overflow_find(const bf_hashbucket_optimistic<T>& b, PageID key) const {
+        if (b.overflow_count == 0) { return false; }
+        spinlock_read_critical_section cs(&_overflow_lock);
+        return _overflow.count(key) > 0;
+    }
+
+    uint32_t _size;
+    bf_hashbucket_optimistic<T>* _table;
+
+    mutable srwlock_t _overflow_lock;
+    std::map<PageID, T> _overflow;
+};
+
 template<class T>
-bf_hashtable<T>::bf_hashtable(uint32_t size) : _size(size) {
+bf_hashtable<T>::bf_hashtable(uint32_t size, bool optimistic)
+    : _size(size), _table(NULL), _optimistic(NULL)
+{
+    if (optimistic) {
+        _optimistic = new bf_hashtable_optimistic<T>(size * HASHBUCKET_OPTIMISTIC_EXPANSION);
+        return;
+    }
     _table = reinterpret_cast<bf_hashbucket<T>*>
         (new char[sizeof(bf_hashbucket<T>) * size]);
     ::memset (_table, 0, sizeof(bf_hashbucket<T>) * size);
@@ -246,6 +457,9 @@ bf_hashtable<T>::bf_hashtable(uint32_t size) : _size(size) {
 
 template<class T>
 bf_hashtable<T>::~bf_hashtable() {
+    if (_optimistic != NULL) {
+        delete _optimistic;
+    }
     if (_table != NULL) {
         for (uint32_t i = 0; i < _size; ++i) {
             _table[i]._chunk.delete_chain();
@@ -256,24 +470,28 @@ bf_hashtable<T>::~bf_hashtable() {
 
 template<class T>
 bool bf_hashtable<T>::update(PageID key, T value) {
+    if (_optimistic) { return _optimistic->update(key, value); }
     uint32_t hash = bf_hash(key);
     return _table[hash % _size].update(key, value);
 }
 
 template<class T>
 bool bf_hashtable<T>::insert_if_not_exists(PageID key, T value) {
+    if (_optimistic) { return _optimistic->insert_if_not_exists(key, value); }
     uint32_t hash = bf_hash(key);
     return _table[hash % _size].append_if_not_exists(key, value);
 }
 
 template<class T>
 bool bf_hashtable<T>::lookup(PageID key, T& value) const {
+    if (_optimistic) { return _optimistic->lookup(key, value); }
     uint32_t hash = bf_hash(key);
     return _table[hash % _size].find(key, value);
 }
 
 template<class T>
 bool bf_hashtable<T>::remove(PageID key) {
+    if (_optimistic) { return _optimistic->remove(key); }
     uint32_t hash = bf_hash(key);
     return _table[hash % _size].remove(key);
 }
@@ -14,6 +14,9 @@ typedef uint32_t bf_idx;
 template<class T>
 class bf_hashbucket;
 
+template<class T>
+class bf_hashtable_optimistic;
+
 typedef pair<bf_idx, bf_idx> bf_idx_pair;
 
 /**
@@ -44,11 +47,17 @@ typedef pair<bf_idx, bf_idx> bf_idx_pair;
  * this hashtable is evicted and no longer available in bufferpool
  * when the client subsequently tries to pin the page. If that happens, the client
  * must retry from looking up this hashtable.
+ *
+ * \Section{Optimistic mode}
+ * If constructed with optimistic=true, all operations are delegated to
+ * bf_hashtable_optimistic, an open-addressing table of cache-line-sized
+ * buckets whose readers never write to shared memory (see bf_hashtable.cpp).
+ * This is controlled by the option sm_bf_hashtable_optimistic.
  */
 template<class T>
 class bf_hashtable {
 public:
-    bf_hashtable(uint32_t size);
+    bf_hashtable(uint32_t size, bool optimistic = false);
     ~bf_hashtable();
 
     /**
@@ -83,9 +92,14 @@ public:
      */
     bool        remove(PageID key);
 
+    bool      is_optimistic() const { return _optimistic != NULL; }
+
 private:
     uint32_t            _size;
     bf_hashbucket<T>*      _table;
+
+    /** Non-null if the optimistic implementation is used instead of _table. */
+    bf_hashtable_optimistic<T>* _optimistic;
 };
 
 #endif // BF_HASHTABLE_H
@@ -0,0 +1,277 @@
+#include "bf_memory.h"
+
+#include "w_base.h"
+#include "w_debug.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef HAVE_NUMA_H
+#include <numaif.h>
+#endif
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+const size_t BASE_PAGE_SIZE = 4096;
+
+bf_memory_region::bf_memory_region()
+    : _base(NULL), _size(0), _mapped_size(0), _page_size(BASE_PAGE_SIZE),
+    _huge_pages(HUGE_PAGES_NONE), _numa(NUMA_NONE), _partition_size(0)
+{
+}
+
+bf_memory_region::~bf_memory_region()
+{
+    release();
+}
+
+bf_memory_region::huge_page_mode bf_memory_region::parse_huge_pages(const std::string& s)
+{
+    if (s == "none" || s.empty()) { return HUGE_PAGES_NONE; }
+    if (s == "transparent") { return HUGE_PAGES_TRANSPARENT; }
+    if (s == "2M") { return HUGE_PAGES_2M; }
+    if (s == "1G") { return HUGE_PAGES_1G; }
+    W_FATAL_MSG(fcINTERNAL, << "Invalid value for sm_bf_huge_pages: " << s);
+    return HUGE_PAGES_NONE;
+}
+
+bf_memory_region::numa_policy bf_memory_region::parse_numa_policy(const std::string& s)
+{
+    if (s == "none" || s.empty()) { return NUMA_NONE; }
+    if (s == "interleave") { return NUMA_INTERLEAVE; }
+    if (s == "partition") { return NUMA_PARTITION; }
+    W_FATAL_MSG(fcINTERNAL, << "Invalid value for sm_bf_numa_policy: " << s);
+    return NUMA_NONE;
+}
+
+std::vector<int> bf_memory_region::online_numa_nodes()
+{
+    std::vector<int> nodes;
+    std::ifstream in("/sys/devices/system/node/online");
+    std::string list;
+    if (in >> list) {
+        // comma-separated list of ranges, e.g., "0-1,4"
+        std::stringstream ss(list);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            int first = 0, last = 0;
+            int matched = sscanf(range.c_str(), "%d-%d", &first, &last);
+            if (matched < 1) { continue; }
+            if (matched == 1) { last = first; }
+            for (int n = first; n <= last; n++) { nodes.push_back(n); }
+        }
+    }
+    if (nodes.empty()) { nodes.push_back(0); }
+    return nodes;
+}
+
+void* bf_memory_region::allocate(const char* name, size_t size, size_t alignment,
+        huge_page_mode huge_pages, numa_policy numa)
+{
+    w_assert0(!_base);
+    _name = name;
+    _size = size;
+    _huge_pages = huge_pages;
+    _numa = numa;
+
+    if (huge_pages == HUGE_PAGES_NONE && numa == NUMA_NONE) {
+        void* buf = NULL;
+        if (::posix_memalign(&buf, alignment, size) != 0) { return NULL; }
+        _base = buf;
+        _mapped_size = 0;
+        _page_size = BASE_PAGE_SIZE;
+        return _base;
+    }
+
+    if (huge_pages == HUGE_PAGES_2M || huge_pages == HUGE_PAGES_1G) {
+        int shift = huge_pages == HUGE_PAGES_2M ? 21 : 30;
+        size_t page_size = size_t(1) << shift;
+        w_assert0(page_size % alignment == 0);
+        size_t mapped_size = (size + page_size - 1) & ~(page_size - 1);
+        void* buf = ::mmap(NULL, mapped_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (shift << MAP_HUGE_SHIFT),
+                -1, 0);
+        if (buf != MAP_FAILED) {
+            _base = buf;
+            _mapped_size = mapped_size;
+            _page_size = page_size;
+        }
+        else {
+            ERROUT(<< "Could not map " << _name << " with "
+                    << (page_size >> 20) << "MB pages (errno " << errno
+                    << "); using transparent huge pages instead");
+            _huge_pages = HUGE_PAGES_TRANSPARENT;
+        }
+    }
+
+    if (!_base) {
+        // Align mapping to 2MB, so that THP can back the whole region
+        size_t thp_size = size_t(1) << 21;
+        bool use_thp = _huge_pages == HUGE_PAGES_TRANSPARENT;
+        size_t align = std::max(use_thp ? thp_size : BASE_PAGE_SIZE, alignment);
+        w_assert0((align & (align - 1)) == 0);
+        size_t mapped_size = (size + align - 1) & ~(align - 1);
+        size_t reserve = mapped_size + align - BASE_PAGE_SIZE;
+        void* buf = ::mmap(NULL, reserve, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (buf == MAP_FAILED) { return NULL; }
+
+        // Trim unaligned head and tail of the reservation
+        char* start = reinterpret_cast<char*>(buf);
+        char* aligned = reinterpret_cast<char*>(
+                (reinterpret_cast<uintptr_t>(start) + align - 1) & ~(uintptr_t(align) - 1));
+        if (aligned > start) { ::munmap(start, aligned - start); }
+        char* end = aligned + mapped_size;
+        if (start + reserve > end) { ::munmap(end, start + reserve - end); }
+
+        _base = aligned;
+        _mapped_size = mapped_size;
+        _page_size = BASE_PAGE_SIZE;
+        if (use_thp) {
+#ifdef MADV_HUGEPAGE
+            if (::madvise(_base, _mapped_size, MADV_HUGEPAGE) == 0) {
+                _page_size = thp_size;
+            }
+            else
+#endif
+            {
+                ERROUT(<< "Transparent huge pages not available for " << _name);
+                _huge_pages = HUGE_PAGES_NONE;
+            }
+        }
+    }
+
+    apply_numa_policy();
+    return _base;
+}
+
+void bf_memory_region::apply_numa_policy()
+{
+    if (_numa == NUMA_NONE) { return; }
+#ifdef HAVE_NUMA_H
+    std::vector<int> nodes = online_numa_nodes();
+    const int max_node = 1024;
+    unsigned long mask[max_node / (8 * sizeof(unsigned long))];
+
+    auto bind = [&](void* addr, size_t len, int mode, const std::vector<int>& ns)
+    {
+        ::memset(mask, 0, sizeof(mask));
+        for (int n : ns) {
+            if (n >= max_node) { continue; }
+            mask[n / (8 * sizeof(unsigned long))] |= 1UL << (n % (8 * sizeof(unsigned long)));
+        }
+        return syscall(__NR_mbind, addr, len, mode, mask, max_node, 0) == 0;
+    };
+
+    bool ok = true;
+    if (_numa == NUMA_INTERLEAVE) {
+        ok = bind(_base, _mapped_size, MPOL_INTERLEAVE, nodes);
+    }
+    else {
+        // Equal shares, rounded to the backing page size
+        size_t share = (_mapped_size / nodes.size() + _page_size - 1) & ~(_page_size - 1);
+        _partition_size = share;
+        char* p = reinterpret_cast<char*>(_base);
+        for (size_t i = 0; i < nodes.size() && ok; i++) {
+            size_t offset = i * share;
+            if (offset >= _mapped_size) { break; }
+            size_t len = std::min(share, _mapped_size - offset);
+            ok = bind(p + offset, len, MPOL_BIND, {nodes[i]});
+        }
+    }
+
+    if (ok) {
+        _nodes = nodes;
+    }
+    else {
+        ERROUT(<< "Could not apply NUMA policy to " << _name
+                << " (errno " << errno << "); using default placement");
+        _partition_size = 0;
+    }
+#else
+    ERROUT(<< "NUMA support not compiled in; using default placement for " << _name);
+#endif
+}
+
+int bf_memory_region::node_of(size_t offset) const
+{
+    if (_nodes.empty() || _numa != NUMA_PARTITION || _partition_size == 0) {
+        return -1;
+    }
+    size_t i = offset / _partition_size;
+    return i < _nodes.size() ? _nodes[i] : -1;
+}
+
+void bf_memory_region::prefault(unsigned threads)
+{
+    if (!_base || threads == 0) { return; }
+
+    // Touch every base page, since THP may fall back to small pages
+    size_t pages = (_size + BASE_PAGE_SIZE - 1) / BASE_PAGE_SIZE;
+    threads = std::min<size_t>(threads, pages);
+    size_t per_thread = (pages + threads - 1) / threads;
+    volatile char* base = reinterpret_cast<volatile char*>(_base);
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        size_t first = t * per_thread;
+        size_t last = std::min(pages, first + per_thread);
+        workers.emplace_back([base, first, last] {
+            for (size_t p = first; p < last; p++) {
+                // Keep contents, which matters if allocated with posix_memalign
+                volatile char* addr = base + p * BASE_PAGE_SIZE;
+                *addr = *addr;
+            }
+        });
+    }
+    for (auto& w : workers) { w.join(); }
+}
+
+void bf_memory_region::print_layout(std::ostream& o) const
+{
+    static const char* huge_names[] = { "none", "transparent", "2M", "1G" };
+    static const char* numa_names[] = { "none", "interleave", "partition" };
+    o << "  " << _name << ": base=" << _base << ", size=" << _size
+        << ", allocation=" << (_mapped_size ? "mmap" : "posix_memalign")
+        << ", huge_pages=" << huge_names[_huge_pages]
+        << ", page_size=" << _page_size
+        << ", tlb_entries=" << (_size + _page_size - 1) / _page_size
+        << ", numa=" << numa_names[_numa];
+    if (!_nodes.empty()) {
+        o << ", nodes={";
+        for (size_t i = 0; i < _nodes.size(); i++) {
+            o << (i ? "," : "") << _nodes[i];
+        }
+        o << "}";
+        if (_partition_size > 0) {
+            o << ", partition_size=" << _partition_size;
+        }
+    }
+    o << "\n";
+}
+
+void bf_memory_region::release()
+{
+    if (!_base) { return; }
+    if (_mapped_size > 0) {
+        ::munmap(_base, _mapped_size);
+    }
+    else {
+        // note we use free(), not delete[], which corresponds to posix_memalign
+        ::free(_base);
+    }
+    _base = NULL;
+    _size = _mapped_size = 0;
+    _nodes.clear();
+}
@@ -0,0 +1,95 @@
+#ifndef BF_MEMORY_H
+#define BF_MEMORY_H
+
+#include "w_defines.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Large memory region backing the frames or the control blocks of the
+ * buffer pool.
+ * \details
+ * By default, the region is allocated with posix_memalign, exactly like the
+ * buffer pool always did. Optionally (see bf_tree_m constructor), it can be
+ * backed by huge pages and placed on NUMA nodes with an explicit policy:
+ *
+ * - Huge pages: "2M" and "1G" map the region with MAP_HUGETLB, which requires
+ *   pages to be reserved in the hugetlbfs pool (vm.nr_hugepages); if that
+ *   fails, the region falls back to "transparent", i.e., a regular mapping
+ *   advised with MADV_HUGEPAGE. A 200 GB pool then needs 100K (2M) or 200 (1G)
+ *   TLB entries instead of 50M.
+ * - NUMA: "interleave" spreads pages round-robin across all online nodes, so
+ *   that memory bandwidth is not bound to the node that happened to touch the
+ *   memory first; "partition" splits the region into one contiguous range per
+ *   node. Because frames and control blocks are split in the same proportion,
+ *   frame i and its control block end up (approximately) on the same node.
+ *
+ * Policies are applied with mbind() before the memory is touched. Placement
+ * failures (e.g., a container without CAP_SYS_NICE) are reported and ignored.
+ * prefault() touches the whole region with multiple threads, so that the
+ * page-fault cost is paid at startup and not by the first transactions.
+ */
+class bf_memory_region {
+public:
+    enum huge_page_mode { HUGE_PAGES_NONE, HUGE_PAGES_TRANSPARENT,
+        HUGE_PAGES_2M, HUGE_PAGES_1G };
+    enum numa_policy { NUMA_NONE, NUMA_INTERLEAVE, NUMA_PARTITION };
+
+    bf_memory_region();
+    ~bf_memory_region();
+
+    /**
+     * Allocates size bytes aligned to alignment (a power of two). Returns
+     * NULL on failure.
+     */
+    void* allocate(const char* name, size_t size, size_t alignment,
+            huge_page_mode huge_pages, numa_policy numa);
+
+    void release();
+
+    /** Touches every page of the region, using the given number of threads */
+    void prefault(unsigned threads);
+
+    /** NUMA node on which the given offset was placed, or -1 if unknown */
+    int node_of(size_t offset) const;
+
+    /** Prints size, page size, TLB footprint, and NUMA placement */
+    void print_layout(std::ostream& o) const;
+
+    void* base() const { return _base; }
+    size_t size() const { return _size; }
+    /** Whether the region was mapped with mmap rather than posix_memalign */
+    bool is_mapped() const { return _mapped_size > 0; }
+    size_t page_size() const { return _page_size; }
+    /** Huge pages actually used, i.e., after falling back if necessary */
+    huge_page_mode huge_pages() const { return _huge_pages; }
+    /** Nodes the region was placed on; empty if no policy was applied */
+    const std::vector<int>& nodes() const { return _nodes; }
+
+    static huge_page_mode parse_huge_pages(const std::string& s);
+    static numa_policy parse_numa_policy(const std::string& s);
+
+    /** Online NUMA nodes, as listed in /sys/devices/system/node/online */
+    static std::vector<int> online_numa_nodes();
+
+private:
+    std::string _name;
+    void* _base;
+    size_t _size;
+    /** Length of the mapping; zero if allocated with posix_memalign */
+    size_t _mapped_size;
+    /** Size of the pages actually backing the region */
+    size_t _page_size;
+    huge_page_mode _huge_pages;
+    numa_policy _numa;
+    /** Nodes the region was placed on; empty if no policy was applied */
+    std::vector<int> _nodes;
+    /** Length of the range of each node with NUMA_PARTITION */
+    size_t _partition_size;
+
+    void apply_numa_policy();
+};
+
+#endif
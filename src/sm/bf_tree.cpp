@@ -24,6 +24,12 @@
 #include <ostream>
 #include <limits>
 #include <algorithm>
+#include <thread>
+#include <sched.h>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
 
 #include "sm_options.h"
 #include "latch.h"
@@ -39,6 +45,12 @@ thread_local unsigned bf_tree_m::_fix_cnt = 0;
 thread_local unsigned bf_tree_m::_hit_cnt = 0;
 thread_local SprIterator bf_tree_m::_localSprIter;
 
+#ifdef BF_SPLIT_CB
+bf_tree_cb_t* bf_tree_cb_t::_hot_base = NULL;
+bf_tree_cb_cold_t* bf_tree_cb_t::_cold_base = NULL;
+latch_t* bf_tree_cb_t::_latch_base = NULL;
+#endif
+
 // lots of help from Wikipedia here!
 int64_t w_findprime(int64_t min)
 {
@@ -133,21 +145,44 @@ bf_tree_m::bf_tree_m(const sm_options& options)
             << SM_PAGESIZE << "-bytes pages... enable_swizzling=" <<
             _enable_swizzling);
 
-    // use posix_memalign to allow unbuffered disk I/O
-    void *buf = NULL;
-    if (::posix_memalign(&buf, SM_PAGESIZE, SM_PAGESIZE * ((uint64_t)
-                    nbufpages)) != 0)
-    {
+    // Backing memory of frames and control blocks: posix_memalign by default,
+    // optionally huge pages and/or explicit NUMA placement (see bf_memory.h)
+    auto huge_pages = bf_memory_region::parse_huge_pages(
+            options.get_string_option("sm_bf_huge_pages", "none"));
+    auto numa_policy = bf_memory_region::parse_numa_policy(
+            options.get_string_option("sm_bf_numa_policy", "none"));
+
+    // aligned to the page size to allow unbuffered disk I/O
+    void *buf = _buffer_memory.allocate("frames",
+            SM_PAGESIZE * ((uint64_t) nbufpages), SM_PAGESIZE,
+            huge_pages, numa_policy);
+    if (buf == NULL) {
         ERROUT (<< "failed to reserve " << nbufpages
                 << " blocks of " << SM_PAGESIZE << "-bytes pages. ");
         W_FATAL(eOUTOFMEMORY);
     }
     _buffer = reinterpret_cast<generic_page*>(buf);
 
-    // the index 0 is never used. to make sure no one can successfully use it,
-    // fill the block-0 with garbages
-    ::memset (&_buffer[0], 0x27, sizeof(generic_page));
-
+#ifdef BF_SPLIT_CB
+    // split layout: one array each for control blocks, cold fields, and latches
+    BOOST_STATIC_ASSERT(sizeof(bf_tree_cb_t) == 16);
+    BOOST_STATIC_ASSERT(sizeof(bf_tree_cb_cold_t) == CACHELINE_SIZE);
+    BOOST_STATIC_ASSERT(sizeof(latch_t) == CACHELINE_SIZE);
+    buf = _cb_memory.allocate("control blocks",
+            sizeof(bf_tree_cb_t) * (uint64_t) nbufpages, CACHELINE_SIZE,
+            huge_pages, numa_policy);
+    void* cold_buf = _cb_cold_memory.allocate("cold control blocks",
+            sizeof(bf_tree_cb_cold_t) * (uint64_t) nbufpages, CACHELINE_SIZE,
+            huge_pages, numa_policy);
+    void* latch_buf = _latch_memory.allocate("latches",
+            sizeof(latch_t) * (uint64_t) nbufpages, CACHELINE_SIZE,
+            huge_pages, numa_policy);
+    if (buf == NULL || cold_buf == NULL || latch_buf == NULL) {
+        ERROUT (<< "failed to reserve " << nbufpages
+                << " blocks of " << sizeof(bf_tree_cb_t) << "-bytes blocks.");
+        W_FATAL(eOUTOFMEMORY);
+    }
+#else
     // this allocation scheme is sensible only for control block and latch sizes of 64B (cacheline size)
     BOOST_STATIC_ASSERT(sizeof(bf_tree_cb_t) == 64);
     BOOST_STATIC_ASSERT(sizeof(latch_t) == 64);
@@ -155,19 +190,46 @@ bf_tree_m::bf_tree_m(const sm_options& options)
     // multiple of cacheline (64B)
     size_t total_size = (sizeof(bf_tree_cb_t) + sizeof(latch_t))
         * (((uint64_t) nbufpages) + 1LLU);
-    if (::posix_memalign(&buf, sizeof(bf_tree_cb_t) + sizeof(latch_t),
-                total_size) != 0)
-    {
+    buf = _cb_memory.allocate("control blocks", total_size,
+            sizeof(bf_tree_cb_t) + sizeof(latch_t), huge_pages, numa_policy);
+    if (buf == NULL) {
         ERROUT (<< "failed to reserve " << nbufpages
                 << " blocks of " << sizeof(bf_tree_cb_t) << "-bytes blocks.");
         W_FATAL(eOUTOFMEMORY);
     }
+#endif
+
+    // Fault in all memory before the first transaction does (first touch
+    // also determines the NUMA node if no policy is given)
+    int64_t prefault_threads = options.get_int_option("sm_bf_prefault_threads", 0);
+    if (prefault_threads < 0) {
+        prefault_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (prefault_threads > 0) {
+        _buffer_memory.prefault(prefault_threads);
+        _cb_memory.prefault(prefault_threads);
+#ifdef BF_SPLIT_CB
+        _cb_cold_memory.prefault(prefault_threads);
+        _latch_memory.prefault(prefault_threads);
+#endif
+    }
+
+    // the index 0 is never used. to make sure no one can successfully use it,
+    // fill the block-0 with garbages
+    ::memset (&_buffer[0], 0x27, sizeof(generic_page));
     // CS: no need to memset control blocks with zero since we loop over them below to
     // initialize (btw, setting pin count to -1 and used to false is enough)
     // ::memset (buf, 0, (sizeof(bf_tree_cb_t) + sizeof(latch_t)) * (((uint64_t)
     //                 nbufpages) + 1LLU));
+#ifdef BF_SPLIT_CB
+    _control_blocks = reinterpret_cast<bf_tree_cb_t*>(buf);
+    bf_tree_cb_t::_hot_base = _control_blocks;
+    bf_tree_cb_t::_cold_base = reinterpret_cast<bf_tree_cb_cold_t*>(cold_buf);
+    bf_tree_cb_t::_latch_base = reinterpret_cast<latch_t*>(latch_buf);
+#else
     _control_blocks = reinterpret_cast<bf_tree_cb_t*>(reinterpret_cast<char
             *>(buf) + sizeof(bf_tree_cb_t));
+#endif
     w_assert0(_control_blocks != NULL);
 
     /*
@@ -189,11 +251,13 @@ bf_tree_m::bf_tree_m(const sm_options& options)
         cb._pin_cnt = -1;
         cb._used = false;
 
+#ifndef BF_SPLIT_CB
         if (i & 0x1) { /* odd */
             cb._latch_offset = -static_cast<int8_t>(sizeof(bf_tree_cb_t)); // place the latch before the control block
         } else { /* even */
             cb._latch_offset = sizeof(bf_tree_cb_t); // place the latch after the control block
         }
+#endif
 
         cb.clear_latch();
     }
@@ -208,18 +272,71 @@ bf_tree_m::bf_tree_m(const sm_options& options)
     _freelist[nbufpages - 1] = 0;
     _freelist_len = nbufpages - 1; // -1 because [0] isn't a valid block
 
+    // per-core caches of free blocks; initially empty, filled on demand
+    int64_t free_caches = options.get_int_option("sm_bf_freelist_caches", 0);
+    if (free_caches < 0) {
+        // one per core
+        free_caches = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _free_cache_count = free_caches;
+    _free_cache_batch = std::max<int64_t>(1, options.get_int_option("sm_bf_freelist_batch", 32));
+    _free_caches = NULL;
+    if (_free_cache_count > 0) {
+        if (::posix_memalign(&buf, CACHELINE_SIZE,
+                    sizeof(bf_free_cache) * _free_cache_count) != 0)
+        {
+            ERROUT (<< "failed to reserve " << _free_cache_count << " free-frame caches");
+            W_FATAL(eOUTOFMEMORY);
+        }
+        _free_caches = reinterpret_cast<bf_free_cache*>(buf);
+        for (uint32_t i = 0; i < _free_cache_count; i++) {
+            new (&_free_caches[i]) bf_free_cache();
+        }
+    }
+
     //initialize hashtable
     int buckets = w_findprime(1024 + (nbufpages / 4)); // maximum load factor is 25%. this is lower than original shore-mt because we have swizzling
-    _hashtable = new bf_hashtable<bf_idx_pair>(buckets);
+    bool optimistic_hashtable = options.get_bool_option("sm_bf_hashtable_optimistic", false);
+    _hashtable = new bf_hashtable<bf_idx_pair>(buckets, optimistic_hashtable);
     w_assert0(_hashtable != NULL);
+    static_assert(sizeof(bf_hashbucket_optimistic<bf_idx_pair>) == CACHELINE_SIZE,
+            "optimistic hash bucket must fit in one cache line");
 
     _cleaner_decoupled = options.get_bool_option("sm_cleaner_decoupled", false);
 
     _instant_restore = options.get_bool_option("sm_restore_instant", true);
 
-    _evictioner = std::make_shared<page_evictioner_base>(this, options);
     _async_eviction = options.get_bool_option("sm_async_eviction", false);
-    if (_async_eviction) { _evictioner->fork(); }
+    // Multiple evictioner threads only make sense with asynchronous eviction
+    int evict_threads = _async_eviction ?
+        options.get_int_option("sm_evict_threads", 1) : 1;
+    if (evict_threads < 1) { evict_threads = 1; }
+    if (static_cast<bf_idx>(evict_threads) > nbufpages - 1) { evict_threads = nbufpages - 1; }
+    // Shards are a power of two frames, so that fixes can find theirs with a
+    // shift; this may leave fewer shards (threads) than sm_evict_threads
+    bf_idx min_shard_size = (nbufpages - 1 + evict_threads - 1) / evict_threads;
+    _evict_shard_shift = 0;
+    while ((bf_idx(1) << _evict_shard_shift) < min_shard_size) { _evict_shard_shift++; }
+    _evict_shard_size = bf_idx(1) << _evict_shard_shift;
+    for (bf_idx first = 1; first < nbufpages; first += _evict_shard_size) {
+        bf_idx end = std::min<bf_idx>(first + _evict_shard_size, nbufpages);
+        _evictioners.push_back(page_evictioner_base::create(this, options, first, end));
+    }
+    if (_async_eviction) {
+        for (auto& e : _evictioners) { e->fork(); }
+    }
+
+    _snapshot_path = options.get_string_option("sm_bf_snapshot_file", "");
+    _snapshot_wait = options.get_bool_option("sm_bf_snapshot_wait", true);
+
+    _optimistic_inner = options.get_bool_option("sm_bf_optimistic_inner", false);
+
+    _readahead_window = std::max<int64_t>(0,
+            options.get_int_option("sm_bf_readahead_window", 0));
+    if (_readahead_window > 0) {
+        _prefetcher = std::make_shared<page_prefetcher>(this, options);
+        _prefetcher->fork();
+    }
 }
 
 void bf_tree_m::shutdown()
@@ -230,9 +347,27 @@ void bf_tree_m::shutdown()
         _background_restorer = nullptr;
     }
 
+    // Snapshot loader may be waiting for the evictioner as well
+    if (_snapshot_loader) {
+        _snapshot_loader->join();
+        _snapshot_loader = nullptr;
+    }
+
+    // All pages were cleaned on a clean shutdown, so that the snapshot can
+    // be loaded without recovery
+    if (!_snapshot_path.empty() && smlevel_0::shutdown_clean) {
+        save_snapshot();
+    }
+
+    // Prefetcher may be waiting for the evictioner, so it must go first
+    if (_prefetcher) {
+        _prefetcher->stop();
+        _prefetcher = nullptr;
+    }
+
     if(_async_eviction) {
-        _evictioner->stop();
-        _evictioner = nullptr;
+        for (auto& e : _evictioners) { e->stop(); }
+        _evictioners.clear();
     }
 
     if (_cleaner) {
@@ -244,24 +379,28 @@ void bf_tree_m::shutdown()
 bf_tree_m::~bf_tree_m()
 {
     if (_control_blocks != NULL) {
-        char* buf = reinterpret_cast<char*>(_control_blocks) - sizeof(bf_tree_cb_t);
-
-        // note we use free(), not delete[], which corresponds to posix_memalign
-        ::free (buf);
+#ifdef BF_SPLIT_CB
+        _cb_cold_memory.release();
+        _latch_memory.release();
+#endif
+        _cb_memory.release();
         _control_blocks = NULL;
     }
     if (_freelist != NULL) {
         delete[] _freelist;
         _freelist = NULL;
     }
+    if (_free_caches != NULL) {
+        // bf_free_cache is trivially destructible
+        ::free (_free_caches);
+        _free_caches = NULL;
+    }
     if (_hashtable != NULL) {
         delete _hashtable;
         _hashtable = NULL;
     }
     if (_buffer != NULL) {
-        void *buf = reinterpret_cast<void*>(_buffer);
-        // note we use free(), not delete[], which corresponds to posix_memalign
-        ::free (buf);
+        _buffer_memory.release();
         _buffer = NULL;
     }
 }
@@ -301,6 +440,9 @@ w_rc_t bf_tree_m::_grab_free_block(bf_idx& ret)
     auto time1 = steady_clock::now();
 
     while (true) {
+        if (_free_caches) {
+            if (_grab_cached_free_block(ret)) { break; }
+        }
         // once the bufferpool becomes full, getting _freelist_lock everytime will be
         // too costly. so, we check _freelist_len without lock first.
         //   false positive : fine. we do real check with locks in it
@@ -333,16 +475,33 @@ w_rc_t bf_tree_m::_grab_free_block(bf_idx& ret)
 
         // no more free pages -- invoke eviction
         if (_async_eviction) {
+            // Wake up all evictioner shards, but wait only for one of them
+            // (chosen round-robin per thread) to complete an eviction round.
+            static thread_local unsigned wait_shard = 0;
+            wait_shard = (wait_shard + 1) % _evictioners.size();
+            for (unsigned i = 0; i < _evictioners.size(); i++) {
+                if (i != wait_shard) { _evictioners[i]->wakeup(false); }
+            }
             // this will block until we get a notification that a frame was evicted
-            _evictioner->wakeup(true);
+            _evictioners[wait_shard]->wakeup(true);
+
+            // The round may end without a free frame if the victims are
+            // children of a page latched by us, which only we can unswizzle
+            if (_get_free_count() == 0) {
+                bf_idx victim = _evictioners[wait_shard]->pick_victim();
+                if (victim > 0 && _evictioners[wait_shard]->evict_one(victim)) {
+                    ret = victim;
+                    break;
+                }
+            }
         }
         else {
             bool success = false;
             bf_idx victim = 0;
             while (!success) {
-                victim = _evictioner->pick_victim();
+                victim = _evictioners[0]->pick_victim();
                 w_assert0(victim > 0);
-                success = _evictioner->evict_one(victim);
+                success = _evictioners[0]->evict_one(victim);
             }
             ret = victim;
             break;
@@ -382,8 +541,130 @@ void bf_tree_m::check_warmup_done()
     }
 }
 
+bf_free_cache& bf_tree_m::_my_free_cache()
+{
+    w_assert1(_free_cache_count > 0);
+    int cpu = ::sched_getcpu();
+    if (cpu < 0) { cpu = 0; }
+    return _free_caches[cpu % _free_cache_count];
+}
+
+uint32_t bf_tree_m::_refill_free_cache(bf_free_cache& cache, uint32_t count)
+{
+    if (!_freelist_lock.try_lock()) {
+        INC_TSTAT(bf_freelist_contention);
+        _freelist_lock.acquire();
+    }
+
+    uint32_t moved = 0;
+    while (moved < count && _freelist_len > 0) {
+        bf_idx idx = FREELIST_HEAD;
+        w_assert1(_is_valid_idx(idx));
+        FREELIST_HEAD = _freelist[idx];
+        --_freelist_len;
+
+        _freelist[idx] = cache.head;
+        cache.head = idx;
+        moved++;
+    }
+    if (_freelist_len == 0) { FREELIST_HEAD = 0; }
+
+    _freelist_lock.release();
+    cache.len += moved;
+    return moved;
+}
+
+bool bf_tree_m::_grab_cached_free_block(bf_idx& ret)
+{
+    bf_free_cache& cache = _my_free_cache();
+    if (!cache.lock.try_lock()) {
+        INC_TSTAT(bf_freelist_contention);
+        cache.lock.acquire();
+    }
+
+    // Common case: pop from this core's cache. Otherwise, refill it in one
+    // batch from the global list or, if that is empty too, steal about half
+    // of the frames cached by another core.
+    if (cache.len == 0 && _freelist_len > 0) {
+        if (_refill_free_cache(cache, _free_cache_batch) > 0) {
+            INC_TSTAT(bf_freelist_refill);
+        }
+    }
+    if (cache.len == 0) {
+        for (uint32_t i = 1; i < _free_cache_count && cache.len == 0; i++) {
+            bf_free_cache& victim = _free_caches[((&cache - _free_caches) + i)
+                % _free_cache_count];
+            if (victim.len == 0 || !victim.lock.try_lock()) { continue; }
+            uint32_t count = (victim.len + 1) / 2;
+            for (uint32_t j = 0; j < count; j++) {
+                bf_idx idx = victim.head;
+                victim.head = _freelist[idx];
+                _freelist[idx] = cache.head;
+                cache.head = idx;
+            }
+            victim.len -= count;
+            victim.lock.release();
+            cache.len += count;
+            if (count > 0) { INC_TSTAT(bf_freelist_steal); }
+        }
+    }
+
+    bool found = cache.len > 0;
+    if (found) {
+        ret = cache.head;
+        cache.head = _freelist[ret];
+        --cache.len;
+        DBG5(<< "Grabbing idx " << ret << " from free-frame cache");
+        w_assert1(_is_valid_idx(ret));
+        w_assert1 (!get_cb(ret)._used);
+        w_assert1 (get_cb(ret)._pin_cnt < 0);
+    }
+    cache.lock.release();
+    return found;
+}
+
+uint32_t bf_tree_m::_get_free_count() const
+{
+    uint32_t count = _freelist_len;
+    for (uint32_t i = 0; i < _free_cache_count; i++) {
+        count += _free_caches[i].len;
+    }
+    return count;
+}
+
 void bf_tree_m::_add_free_block(bf_idx idx)
 {
+    if (_free_caches) {
+        bf_free_cache& cache = _my_free_cache();
+        if (!cache.lock.try_lock()) {
+            INC_TSTAT(bf_freelist_contention);
+            cache.lock.acquire();
+        }
+        w_assert1(idx != cache.head);
+        w_assert1(!get_cb(idx)._used);
+        w_assert1(get_cb(idx)._pin_cnt < 0);
+        _freelist[idx] = cache.head;
+        cache.head = idx;
+        ++cache.len;
+
+        // Spill a batch back to the global list if the cache grew too large,
+        // so that frames freed on one core are available to the others
+        if (cache.len > 2 * _free_cache_batch) {
+            CRITICAL_SECTION(cs, &_freelist_lock);
+            for (uint32_t i = 0; i < _free_cache_batch; i++) {
+                bf_idx spill = cache.head;
+                cache.head = _freelist[spill];
+                _freelist[spill] = FREELIST_HEAD;
+                FREELIST_HEAD = spill;
+            }
+            cache.len -= _free_cache_batch;
+            _freelist_len += _free_cache_batch;
+            INC_TSTAT(bf_freelist_spill);
+        }
+        cache.lock.release();
+        return;
+    }
+
     CRITICAL_SECTION(cs, &_freelist_lock);
     w_assert1(idx != FREELIST_HEAD);
     w_assert1(!get_cb(idx)._used);
@@ -393,6 +674,20 @@ void bf_tree_m::_add_free_block(bf_idx idx)
     FREELIST_HEAD = idx;
 }
 
+void bf_tree_m::_add_free_blocks(const std::vector<bf_idx>& idxs)
+{
+    if (idxs.empty()) { return; }
+    CRITICAL_SECTION(cs, &_freelist_lock);
+    for (bf_idx idx : idxs) {
+        w_assert1(idx != FREELIST_HEAD);
+        w_assert1(!get_cb(idx)._used);
+        w_assert1(get_cb(idx)._pin_cnt < 0);
+        _freelist[idx] = FREELIST_HEAD;
+        FREELIST_HEAD = idx;
+    }
+    _freelist_len += idxs.size();
+}
+
 void bf_tree_m::post_init()
 {
     if (_no_db_mode && _batch_warmup) {
@@ -540,7 +835,7 @@ w_rc_t bf_tree_m::fix(generic_page* parent, generic_page*& page,
         w_assert1(cb._pid == _buffer[idx].pid);
 
         cb.inc_ref_count();
-        _evictioner->ref(idx);
+        _evictioner_of(idx)->ref(idx);
         if (mode == LATCH_EX) { cb.inc_ref_count_ex(); }
 
         page = &(_buffer[idx]);
@@ -675,6 +970,8 @@ w_rc_t bf_tree_m::fix(generic_page* parent, generic_page*& page,
             // with GenericPageIterator or when prefetching pages).
             cb.set_check_recovery(true);
 
+            _evictioner_of(idx)->miss_ref(idx, pid);
+
             w_assert1(_is_active_idx(idx));
             w_assert1(cb.latch().is_mine());
             DBG(<< "Fixed page " << pid << " (miss) to frame " << idx);
@@ -718,6 +1015,10 @@ w_rc_t bf_tree_m::fix(generic_page* parent, generic_page*& page,
             if (mode == LATCH_EX) {
                 cb.inc_ref_count_ex();
             }
+            if (cb._prefetched) {
+                cb._prefetched = false;
+                INC_TSTAT(bf_prefetch_hit);
+            }
 
             page = &(_buffer[idx]);
 
@@ -727,7 +1028,7 @@ w_rc_t bf_tree_m::fix(generic_page* parent, generic_page*& page,
             DBG(<< "Fixed page " << pid << " (hit) to frame " << idx);
         }
 
-        _evictioner->ref(idx);
+        _evictioner_of(idx)->ref(idx);
         INC_TSTAT(bf_fix_cnt);
         _fix_cnt++;
 
@@ -803,7 +1104,12 @@ rc_t bf_tree_m::_read_page(PageID pid, bf_tree_cb_t& cb, bool from_backup)
 
     rc_t rc = RCOK;
     if (from_backup) { smlevel_0::vol->read_backup(pid, 1, page); }
-    else { rc = smlevel_0::vol->read_page(pid, page); }
+    else {
+        // Through the io_uring of this thread if enabled (see _register_frames)
+        _register_frames();
+        rc = smlevel_0::vol->submit_read(pid, page, 1);
+        smlevel_0::vol->wait_aio();
+    }
     if (rc.is_error()) {
         _hashtable->remove(pid);
         cb.latch().latch_release();
@@ -812,6 +1118,13 @@ rc_t bf_tree_m::_read_page(PageID pid, bf_tree_cb_t& cb, bool from_backup)
     return rc;
 }
 
+void bf_tree_m::_register_frames()
+{
+    // Only registers on the first call of each thread; cheap afterwards
+    smlevel_0::vol->register_aio_buffers(_buffer,
+            sizeof(generic_page) * _block_cnt);
+}
+
 void bf_tree_m::fuzzy_checkpoint(chkpt_t& chkpt) const
 {
     if (_no_db_mode) { return; }
@@ -838,6 +1151,84 @@ void bf_tree_m::fuzzy_checkpoint(chkpt_t& chkpt) const
 }
 
 void bf_tree_m::prefetch_pages(PageID first, unsigned count)
+{
+    // Restore replays the segment itself, so no recovery on fix
+    _prefetch_run(first, count, false, false);
+}
+
+void bf_tree_m::prefetch_pages(std::vector<PageID>& pids, bool readahead)
+{
+    // Read-ahead is only a hint; skip it if pages don't come from the database
+    if (_no_db_mode || is_media_failure()) { return; }
+
+    std::sort(pids.begin(), pids.end());
+    pids.erase(std::unique(pids.begin(), pids.end()), pids.end());
+    // Drop pages that are already cached (e.g., from an overlapping request)
+    pids.erase(std::remove_if(pids.begin(), pids.end(),
+                [this] (PageID pid) { return lookup(pid) != 0; }), pids.end());
+
+    size_t i = 0;
+    while (i < pids.size()) {
+        size_t j = i + 1;
+        while (j < pids.size() && pids[j] == pids[j-1] + 1 && j - i < IOV_MAX) {
+            j++;
+        }
+        _prefetch_run(pids[i], j - i, readahead, true);
+        i = j;
+    }
+}
+
+unsigned bf_tree_m::readahead_siblings(const generic_page* page, bool forward,
+        unsigned count)
+{
+    if (!_prefetcher || count == 0) { return 0; }
+
+    bf_idx idx = page - _buffer;
+    w_assert1(_is_active_idx(idx));
+    bf_idx parent_idx = lookup_parent(page->pid);
+    if (parent_idx == 0) { return 0; }
+
+    // We hold a latch on the child, so the parent may only be latched conditionally
+    bf_tree_cb_t& parent_cb = get_cb(parent_idx);
+    rc_t rc = parent_cb.latch().latch_acquire(LATCH_SH, timeout_t::WAIT_IMMEDIATE);
+    if (rc.is_error()) { return 0; }
+
+    static thread_local std::vector<PageID> pids;
+    pids.clear();
+    unsigned covered = 0;
+
+    // Frame might have been reused since the hash table lookup
+    generic_page* parent = &_buffer[parent_idx];
+    if (parent_cb.is_in_use() && parent->tag == t_btree_p
+            && parent->store == page->store)
+    {
+        fixable_page_h parent_h;
+        parent_h.fix_nonbufferpool_page(parent);
+        PageID child = get_cb(idx)._swizzled ? (idx | SWIZZLED_PID_BIT) : page->pid;
+        general_recordid_t slot = find_page_id_slot(parent, child);
+        int max_slot = parent_h.max_child_slot();
+
+        // Foster children are not in the parent's child range
+        if (slot >= GeneralRecordIds::PID0) {
+            int step = forward ? 1 : -1;
+            for (int s = slot + step; s >= GeneralRecordIds::PID0 && s <= max_slot
+                    && covered < count; s += step)
+            {
+                PageID pid = *parent_h.child_slot_address(s);
+                covered++;
+                // swizzled pointers point to cached pages
+                if ((pid & SWIZZLED_PID_BIT) == 0) { pids.push_back(pid); }
+            }
+        }
+    }
+    parent_cb.latch().latch_release();
+
+    _prefetcher->enqueue(pids);
+    return covered;
+}
+
+void bf_tree_m::_prefetch_run(PageID first, unsigned count, bool readahead,
+        bool check_recovery)
 {
     static thread_local std::vector<generic_page*> frames;
     frames.resize(count);
@@ -858,7 +1249,8 @@ void bf_tree_m::prefetch_pages(PageID first, unsigned count)
 
     bool media_failure = is_media_failure();
 
-    // Then read into them using iovec
+    // Then read into them using iovec (or io_uring)
+    if (!media_failure) { _register_frames(); }
     smlevel_0::vol->read_vector(first, count, frames, media_failure);
 
     // Finally, add the frames to the hash table if not already there and
@@ -874,7 +1266,17 @@ void bf_tree_m::prefetch_pages(PageID first, unsigned count)
 
         if (registered) {
             cb.init(pid, frames[i]->lsn);
-            // cb.set_check_recovery(true);
+            _evictioner_of(idx)->miss_ref(idx, pid);
+
+            // Same as a miss in fix(): the page may be older than its last
+            // update in the log, e.g., when a snapshot is loaded during
+            // instant restart (fix() registers the parent on the first hit)
+            cb.set_check_recovery(check_recovery);
+
+            if (readahead) {
+                cb._prefetched = true;
+                INC_TSTAT(bf_prefetch_read);
+            }
 
             if (media_failure) { cb.pin_for_restore(); }
         }
@@ -1104,6 +1506,19 @@ void bf_tree_m::debug_dump(std::ostream &o) const
 {
     o << "dumping the bufferpool contents. _block_cnt=" << _block_cnt << "\n";
     o << "  _freelist_len=" << _freelist_len << ", HEAD=" << FREELIST_HEAD << "\n";
+    for (uint32_t i = 0; i < _free_cache_count; i++) {
+        o << "  free-frame cache[" << i << "]: len=" << _free_caches[i].len
+            << ", head=" << _free_caches[i].head << "\n";
+    }
+    o << "  optimistic hashtable=" << _hashtable->is_optimistic() << "\n";
+    o << "  evictioner shards=" << _evictioners.size()
+        << " (" << _evict_shard_size << " frames each)\n";
+    _buffer_memory.print_layout(o);
+    _cb_memory.print_layout(o);
+#ifdef BF_SPLIT_CB
+    _cb_cold_memory.print_layout(o);
+    _latch_memory.print_layout(o);
+#endif
 
     for (uint32_t store = 1; store < stnode_page::max; ++store) {
         if (_root_pages[store] != 0) {
@@ -1201,9 +1616,13 @@ void bf_tree_m::_delete_block(bf_idx idx) {
 }
 
 bf_tree_cb_t* bf_tree_m::get_cbp(bf_idx idx) const {
+#ifdef BF_SPLIT_CB
+    return &_control_blocks[idx];
+#else
     bf_idx real_idx;
     real_idx = (idx << 1) + (idx & 0x1); // more efficient version of: real_idx = (idx % 2) ? idx*2+1 : idx*2
     return &_control_blocks[real_idx];
+#endif
 }
 
 bf_tree_cb_t& bf_tree_m::get_cb(bf_idx idx) const {
@@ -1212,7 +1631,11 @@ bf_tree_cb_t& bf_tree_m::get_cb(bf_idx idx) const {
 
 bf_idx bf_tree_m::get_idx(const bf_tree_cb_t* cb) const {
     bf_idx real_idx = cb - _control_blocks;
+#ifdef BF_SPLIT_CB
+    return real_idx;
+#else
     return real_idx / 2;
+#endif
 }
 
 bf_tree_cb_t* bf_tree_m::get_cb(const generic_page *page) {
@@ -1261,12 +1684,80 @@ w_rc_t bf_tree_m::refix_direct (generic_page*& page, bf_idx
     // cb.pin();
     DBG(<< "Refix direct of " << idx << " set pin cnt to " << cb._pin_cnt);
     cb.inc_ref_count();
-    _evictioner->ref(idx);
+    _evictioner_of(idx)->ref(idx);
     if (mode == LATCH_EX) { cb.inc_ref_count_ex(); }
     page = &(_buffer[idx]);
     return RCOK;
 }
 
+bool bf_tree_m::optimistic_root(StoreID store, bf_idx& idx, uint32_t& version)
+{
+    idx = _root_pages[store];
+    if (!_is_valid_idx(idx)) { return false; }
+    bf_tree_cb_t &cb = get_cb(idx);
+    return cb.latch().optimistic_begin(version) && !cb._check_recovery;
+}
+
+bool bf_tree_m::optimistic_child(PageID pid, bf_idx& idx, uint32_t& version)
+{
+    if (is_swizzled_pointer(pid)) {
+        idx = pid ^ SWIZZLED_PID_BIT;
+        // pointer may be garbage if the parent is being modified
+        if (!_is_valid_idx(idx)) { return false; }
+    }
+    else {
+        bf_idx_pair p;
+        if (!_hashtable->lookup(pid, p)) { return false; }
+        idx = p.first;
+        if (!_is_valid_idx(idx)) { return false; }
+    }
+
+    // Control-block fields below only change under an EX latch, so they are
+    // stable if the version is validated later
+    bf_tree_cb_t &cb = get_cb(idx);
+    if (!cb.latch().optimistic_begin(version)) { return false; }
+    if (!cb._used || cb._check_recovery || cb.is_pinned_for_restore()) {
+        return false;
+    }
+    if (is_swizzled_pointer(pid)) { return cb._swizzled; }
+    return cb._pid == pid;
+}
+
+bool bf_tree_m::optimistic_validate(bf_idx idx, uint32_t version) const
+{
+    return get_cb(idx).latch().optimistic_validate(version);
+}
+
+w_rc_t bf_tree_m::fix_optimistic(generic_page*& page, bf_idx idx, latch_mode_t mode)
+{
+    w_assert1(_is_valid_idx(idx));
+    bf_tree_cb_t &cb = get_cb(idx);
+    W_DO(cb.latch().latch_acquire(mode, timeout_t::WAIT_FOREVER));
+
+    // Without latch coupling, nothing prevented eviction before the latch
+    // was acquired
+    if (!cb.is_in_use() || cb._check_recovery || cb.is_pinned_for_restore()) {
+        cb.latch().latch_release();
+        return RC(stINUSE);
+    }
+
+    cb.inc_ref_count();
+    _evictioner_of(idx)->ref(idx);
+    if (mode == LATCH_EX) { cb.inc_ref_count_ex(); }
+    if (cb._prefetched) {
+        cb._prefetched = false;
+        INC_TSTAT(bf_prefetch_hit);
+    }
+
+    page = &(_buffer[idx]);
+
+    INC_TSTAT(bf_fix_cnt);
+    INC_TSTAT(bf_hit_cnt);
+    _fix_cnt++;
+    _hit_cnt++;
+    return RCOK;
+}
+
 w_rc_t bf_tree_m::fix_nonroot(generic_page*& page, generic_page *parent,
                                      PageID pid, latch_mode_t mode, bool conditional,
                                      bool virgin_page, bool only_if_hit, bool do_recovery,
@@ -1578,3 +2069,146 @@ void WarmupThread::run()
     ERROUT(<< "Finished warmup! Pages fixed: " << fixed << " of " << npages <<
             " with DB size " << vol->get_alloc_cache()->get_last_allocated_pid());
 }
+
+void bf_tree_m::save_snapshot()
+{
+    std::vector<bf_snapshot_entry> entries;
+    for (bf_idx idx = 1; idx < _block_cnt; ++idx) {
+        auto& cb = get_cb(idx);
+        if (!cb.is_in_use()) { continue; }
+        generic_page* page = &_buffer[idx];
+        if (page->tag != t_btree_p || page->pid != cb._pid) { continue; }
+
+        bf_snapshot_entry e;
+        e.pid = cb._pid;
+        bf_idx parent_idx = lookup_parent(cb._pid);
+        e.parent = parent_idx ? _buffer[parent_idx].pid : 0;
+        e.store = page->store;
+        btree_page_h p;
+        p.fix_nonbufferpool_page(page);
+        e.level = p.level();
+        e.ref_count = cb._ref_count;
+        entries.push_back(e);
+    }
+
+    std::stable_sort(entries.begin(), entries.end(),
+        [] (const bf_snapshot_entry& a, const bf_snapshot_entry& b) {
+            if (a.level != b.level && (a.level > 1 || b.level > 1)) {
+                return a.level > b.level;
+            }
+            return a.ref_count > b.ref_count;
+        });
+
+    // Write to a temporary file first, so that a crash during shutdown does
+    // not leave a truncated snapshot behind
+    std::string tmp_path = _snapshot_path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    uint64_t magic = SnapshotWarmupThread::MAGIC;
+    uint64_t count = entries.size();
+    out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+            sizeof(bf_snapshot_entry) * count);
+    out.close();
+    if (out.fail() || ::rename(tmp_path.c_str(), _snapshot_path.c_str()) != 0) {
+        ERROUT(<< "Could not write buffer pool snapshot " << _snapshot_path);
+        ::unlink(tmp_path.c_str());
+        return;
+    }
+
+    ADD_TSTAT(bf_snapshot_pages_saved, count);
+    ERROUT(<< "Saved buffer pool snapshot with " << count << " pages");
+}
+
+void bf_tree_m::load_snapshot()
+{
+    if (_snapshot_path.empty() || _no_db_mode) { return; }
+
+    _snapshot_loader = std::make_shared<SnapshotWarmupThread>(_snapshot_path);
+    _snapshot_loader->fork();
+    if (_snapshot_wait) {
+        _snapshot_loader->join();
+        _snapshot_loader = nullptr;
+    }
+}
+
+void SnapshotWarmupThread::fix_inner_nodes(btree_page_h& parent,
+        const std::unordered_set<PageID>& inner, size_t& fixed)
+{
+    if (parent.level() <= 2) { return; }
+
+    auto visit = [&] (PageID ptr) {
+        if (inner.count(smlevel_0::bf->normalize_pid(ptr)) == 0) { return; }
+        btree_page_h page;
+        // swizzles the pointer in the parent (if enabled) on the way
+        if (page.fix_nonroot(parent, ptr, LATCH_SH).is_error()) { return; }
+        fixed++;
+        fix_inner_nodes(page, inner, fixed);
+    };
+
+    if (parent.get_foster() > 0) { visit(parent.get_foster_opaqueptr()); }
+    visit(parent.pid0_opaqueptr());
+    for (int j = 0; j < parent.nrecs(); j++) {
+        visit(parent.child_opaqueptr(j));
+    }
+}
+
+void SnapshotWarmupThread::run()
+{
+    std::ifstream in(_path, std::ios::binary);
+    if (!in) { return; }
+
+    uint64_t magic = 0, count = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || magic != MAGIC) {
+        ERROUT(<< "Ignoring invalid buffer pool snapshot " << _path);
+        return;
+    }
+
+    // Only as many entries as there are free frames, leaving some slack for
+    // the evictioner; the hottest pages come first
+    bf_tree_m* bf = smlevel_0::bf;
+    vol_t* vol = smlevel_0::vol;
+    size_t budget = bf->_get_free_count();
+    budget -= std::min<size_t>(budget, bf->get_block_cnt() / 16);
+    std::vector<bf_snapshot_entry> entries(std::min<uint64_t>(count, budget));
+    in.read(reinterpret_cast<char*>(entries.data()),
+            sizeof(bf_snapshot_entry) * entries.size());
+    entries.resize(in.gcount() / sizeof(bf_snapshot_entry));
+    in.close();
+    // Never used twice, e.g., after a crash
+    ::unlink(_path.c_str());
+
+    std::vector<PageID> pids;
+    std::unordered_set<PageID> inner;
+    std::vector<StoreID> stores;
+    pids.reserve(entries.size());
+    for (auto& e : entries) {
+        // Pages may have been deallocated since the snapshot was taken
+        if (!vol->is_allocated_page(e.pid)) { continue; }
+        pids.push_back(e.pid);
+        if (e.level > 1) {
+            inner.insert(e.pid);
+            stores.push_back(e.store);
+        }
+    }
+
+    // Sorted into runs of consecutive pages by prefetch_pages
+    bf->prefetch_pages(pids, false);
+    ADD_TSTAT(bf_snapshot_pages_loaded, pids.size());
+
+    // Fix inner nodes top-down, so that they are swizzled in their parents
+    std::sort(stores.begin(), stores.end());
+    stores.erase(std::unique(stores.begin(), stores.end()), stores.end());
+    size_t fixed = 0;
+    for (StoreID store : stores) {
+        btree_page_h root;
+        if (root.fix_root(store, LATCH_SH).is_error()) { continue; }
+        fix_inner_nodes(root, inner, fixed);
+    }
+    ADD_TSTAT(bf_snapshot_inner_fixed, fixed);
+
+    ERROUT(<< "Loaded buffer pool snapshot: " << pids.size() << " of "
+            << count << " pages, " << fixed << " inner nodes re-fixed");
+}
@@ -12,13 +12,17 @@
 #include "generic_page.h"
 #include "bf_hashtable.h"
 #include "bf_tree_cb.h"
+#include "bf_memory.h"
 #include <iosfwd>
 #include "page_cleaner.h"
 #include "page_evictioner.h"
+#include "page_prefetcher.h"
 #include "restart.h"
 #include "restore.h"
 
 #include <array>
+#include <string>
+#include <unordered_set>
 
 class sm_options;
 class lsn_t;
@@ -27,8 +31,24 @@ struct bf_tree_cb_t; // include bf_tree_cb.h in implementation codes
 class test_bf_tree;
 class test_bf_fixed;
 class page_evictioner_base;
+
+/**
+ * \brief Cache of free buffer frames used by the threads running on one core.
+ * \details
+ * A singly-linked list (through bf_tree_m::_freelist) with its own lock,
+ * aligned to a cache line so that caches of different cores do not share one.
+ * See bf_tree_m::_grab_cached_free_block().
+ */
+struct alignas(CACHELINE_SIZE) bf_free_cache {
+    tatas_lock lock;
+    bf_idx     head;
+    uint32_t   len;
+
+    bf_free_cache() : head(0), len(0) {}
+};
 class bf_tree_cleaner;
 class btree_page_h;
+class SnapshotWarmupThread;
 struct EvictionContext;
 
 /** Specifies how urgent we are to evict pages. \NOTE Order does matter.  */
@@ -69,6 +89,7 @@ class bf_tree_m {
     friend class bf_tree_cleaner; // for page cleaning
     friend class page_evictioner_base;  // for page evictioning
     friend class WarmupThread;
+    friend class SnapshotWarmupThread;
     friend class page_cleaner_decoupled;
     friend class page_evictioner_gclock;
     friend class GenericPageIterator;
@@ -161,6 +182,43 @@ public:
      */
     w_rc_t refix_direct (generic_page*& page, bf_idx idx, latch_mode_t mode, bool conditional);
 
+    /**
+     * \brief Optimistic (latch-free) access to the frame of the root page of
+     * the given store, for traversals of inner B-tree nodes.
+     * \details
+     * Returns the frame index and the version of its latch (see
+     * latch_t::optimistic_begin()), without latching, pinning, or otherwise
+     * writing to the frame. Returns false if the root is not loaded yet or is
+     * currently EX-latched. Contents read from the frame are meaningful only if
+     * optimistic_validate() succeeds afterwards.
+     */
+    bool optimistic_root(StoreID store, bf_idx& idx, uint32_t& version);
+
+    /**
+     * \brief Same as optimistic_root(), for the page pointed to by the given
+     * (swizzled or not) child pointer.
+     * \details
+     * Returns false if the page is not cached, is EX-latched, or still has to be
+     * recovered. With the non-optimistic hash table, lookups of non-swizzled
+     * pointers take a bucket spinlock.
+     */
+    bool optimistic_child(PageID pid, bf_idx& idx, uint32_t& version);
+
+    /** True iff the frame was not EX-latched since optimistic_root/child() */
+    bool optimistic_validate(bf_idx idx, uint32_t version) const;
+
+    /**
+     * Latches a frame reached with optimistic_child() without latching its
+     * parent. Because the frame may have been evicted or reused in the
+     * meantime, the caller must check that the fixed page is the one it was
+     * looking for (e.g., with fence keys). Fails with stINUSE if the frame is
+     * no longer in use or needs recovery.
+     */
+    w_rc_t fix_optimistic(generic_page*& page, bf_idx idx, latch_mode_t mode);
+
+    /** Whether B-tree traversals read inner nodes optimistically (sm_bf_optimistic_inner) */
+    bool is_optimistic_inner() const { return _optimistic_inner; }
+
     /**
      * Fixes an existing (not virgin) root page for the given store.
      * This method doesn't receive page ID because it's already known by bufferpool.
@@ -176,6 +234,31 @@ public:
     /** Prefetches pages into free frames using iovec */
     void prefetch_pages(PageID first, unsigned count);
 
+    /**
+     * Reads the given pages into free frames, unless they are already cached
+     * (read-ahead). Runs of consecutive page IDs are read with a single vector
+     * I/O. The frames are marked as prefetched, so that fixes on them count as
+     * read-ahead hits and evictions before any fix as read-ahead waste
+     * (unless !readahead, e.g., when loading a snapshot). Either way, the
+     * pages are checked for recovery on their first fix.
+     */
+    void prefetch_pages(std::vector<PageID>& pids, bool readahead = true);
+
+    /**
+     * \brief Asynchronous read-ahead for the siblings of a B-tree page.
+     * \details
+     * Looks up the parent of the given page, which must be fixed by the
+     * caller, and if the parent can be latched without waiting, queues the
+     * (unswizzled) child pointers of up to count siblings that follow (or
+     * precede, if !forward) the page for the read-ahead thread.
+     * @return the number of siblings considered, i.e., how many pages ahead
+     * of the given one are covered by this read-ahead.
+     */
+    unsigned readahead_siblings(const generic_page* page, bool forward, unsigned count);
+
+    /** Read-ahead window of B-tree cursors (sm_bf_readahead_window; 0 = disabled) */
+    unsigned get_readahead_window() const { return _readahead_window; }
+
     /**
      * upgrade SH-latch on the given page to EX-latch.
      * This method is always conditional, immediately returning if there is a conflicting latch.
@@ -310,6 +393,16 @@ public:
 
     bool is_warmup_done() const { return _warmup_done; }
 
+    /**
+     * \brief Warms up the buffer pool from the snapshot taken on the last
+     * clean shutdown (option sm_bf_snapshot_file).
+     * \details
+     * Must be called after restart, once the volume caches are built. Forks a
+     * SnapshotWarmupThread and, unless sm_bf_snapshot_wait is false, waits
+     * until it has loaded the snapshot.
+     */
+    void load_snapshot();
+
     bool has_dirty_frames() const;
 
     void fuzzy_checkpoint(chkpt_t& chkpt) const;
@@ -389,12 +482,57 @@ private:
     /** Adds a free block to the freelist. */
     void   _add_free_block(bf_idx idx);
 
+    /** Adds a batch of free blocks to the freelist with a single lock acquisition. */
+    void   _add_free_blocks(const std::vector<bf_idx>& idxs);
+
+    /**
+     * Pops a free block from the free-frame cache of the current core, refilling
+     * it from the global freelist or stealing from other cores if it is empty.
+     * @return whether a free block was found
+     */
+    bool   _grab_cached_free_block(bf_idx& ret);
+
+    /**
+     * Reads a run of consecutive pages into free frames (see prefetch_pages).
+     * Unless check_recovery is false, the frames are recovered on their first
+     * fix, like pages read by a miss in fix().
+     */
+    void   _prefetch_run(PageID first, unsigned count, bool readahead,
+                         bool check_recovery);
+
+    /**
+     * Moves up to count blocks from the global freelist into the given cache,
+     * whose lock must be held by the caller. Returns the number of blocks moved.
+     */
+    uint32_t _refill_free_cache(bf_free_cache& cache, uint32_t count);
+
+    /** Returns the free-frame cache of the core on which the caller is running */
+    bf_free_cache& _my_free_cache();
+
+    /**
+     * Number of free blocks, i.e., in the global freelist and in the per-core
+     * caches. Not a consistent snapshot, but good enough to trigger eviction.
+     */
+    uint32_t _get_free_count() const;
+
+    /** Returns the evictioner responsible for the shard that contains the given frame. */
+    page_evictioner_base* _evictioner_of(bf_idx idx) const {
+        return _evictioners[(idx - 1) >> _evict_shard_shift].get();
+    }
+
     /// returns true iff idx is in the valid range.  for assertion.
     bool   _is_valid_idx (bf_idx idx) const;
 
     /// Called by fix to read a page from the database (or the backup)
     rc_t _read_page(PageID pid, bf_tree_cb_t& cb, bool from_backup = false);
 
+    /**
+     * Registers the frame array with the io_uring of the calling thread
+     * (option sm_vol_io_uring), so that page reads into the frames are
+     * fixed-buffer requests. No-op if io_uring is disabled.
+     */
+    void _register_frames();
+
     /**
      * returns true if idx is in the valid range and also the block is used.  for assertion.
      *
@@ -433,6 +571,12 @@ private:
      */
     void check_warmup_done();
 
+    /**
+     * Writes the IDs of all cached B-tree pages, ordered by hotness, to
+     * _snapshot_path (see SnapshotWarmupThread). Called on clean shutdown.
+     */
+    void save_snapshot();
+
     void set_warmup_done();
 
     /// Buffer is considered warm when hit ratio goes above this
@@ -455,6 +599,14 @@ private:
     /** Array of page contents. array size is _block_cnt. index 0 is never used (means NULL). */
     generic_page*              _buffer;
 
+    /** Memory backing _buffer and _control_blocks (huge pages, NUMA placement) */
+    bf_memory_region     _buffer_memory;
+    bf_memory_region     _cb_memory;
+#ifdef BF_SPLIT_CB
+    bf_memory_region     _cb_cold_memory;
+    bf_memory_region     _latch_memory;
+#endif
+
     /** hashtable to locate a page in this bufferpool. swizzled pages are removed from bufferpool. */
     bf_hashtable<bf_idx_pair>*        _hashtable;
 
@@ -473,16 +625,40 @@ private:
     /** spin lock to protect all freelist related stuff. */
     tatas_lock           _freelist_lock;
 
+    /**
+     * Per-core caches of free blocks (sm_bf_freelist_caches; none if 0).
+     * Blocks in a cache are not in the global freelist, but they are linked
+     * through the same _freelist array. Caches are refilled from (and spill
+     * into) the global freelist in batches of _free_cache_batch blocks, so
+     * that _freelist_lock is only taken once per batch.
+     */
+    bf_free_cache*       _free_caches;
+    uint32_t             _free_cache_count;
+    uint32_t             _free_cache_batch;
+
     /** the dirty page cleaner. */
     std::shared_ptr<page_cleaner_base>   _cleaner;
 
-    /** worker thread responsible for evicting pages. */
-    std::shared_ptr<page_evictioner_base> _evictioner;
+    /**
+     * worker threads responsible for evicting pages. Each one owns a disjoint
+     * range of _evict_shard_size frames (only one unless sm_evict_threads > 1).
+     */
+    std::vector<std::shared_ptr<page_evictioner_base>> _evictioners;
+    bf_idx _evict_shard_size;
+    /** log2 of _evict_shard_size, which is a power of two */
+    unsigned _evict_shard_shift;
 
     /** Perform eviction on dedicated thread; fixing threads just wait until a free
      * frame is available */
     bool _async_eviction;
 
+    /** read-ahead thread; only exists if _readahead_window > 0 */
+    std::shared_ptr<page_prefetcher> _prefetcher;
+    unsigned _readahead_window;
+
+    /** whether B-tree traversals read inner nodes without latches */
+    bool _optimistic_inner;
+
     /** whether to swizzle non-root pages. */
     bool                 _enable_swizzling;
 
@@ -505,6 +681,11 @@ private:
 
     bool _log_fetches;
 
+    /** Buffer pool snapshot file; empty if snapshots are disabled */
+    std::string _snapshot_path;
+    bool _snapshot_wait;
+    std::shared_ptr<SnapshotWarmupThread> _snapshot_loader;
+
     static thread_local unsigned _fix_cnt;
     static thread_local unsigned _hit_cnt;
 
@@ -574,6 +755,48 @@ public:
     void fixChildren(btree_page_h& parent, size_t& fixed, size_t max);
 };
 
+/**
+ * \brief Entry of the buffer pool snapshot file.
+ * \details
+ * Entries are sorted by hotness: inner nodes first, from the highest level
+ * down, then leaves by decreasing reference count. The parent is the page
+ * through which the frame was last fixed (0 if unknown).
+ */
+struct bf_snapshot_entry {
+    PageID pid;
+    PageID parent;
+    StoreID store;
+    int16_t level;
+    uint16_t ref_count;
+};
+
+/**
+ * \brief Thread that reloads the buffer pool snapshot on startup.
+ * \details
+ * Takes as many entries from the head of the snapshot as there are free
+ * frames, reads them in page-ID order with large vector reads (see
+ * bf_tree_m::prefetch_pages()), and then fixes the cached inner nodes
+ * top-down from each root, so that the upper levels of the B-trees are
+ * swizzled again before the first transaction arrives. The snapshot is
+ * deleted once loaded, so that it is never used after a crash.
+ */
+class SnapshotWarmupThread : public thread_wrapper_t {
+public:
+    SnapshotWarmupThread(const std::string& path) : _path(path) {};
+    virtual ~SnapshotWarmupThread() {}
+
+    virtual void run();
+
+    /** Magic number at the beginning of the snapshot file */
+    static const uint64_t MAGIC = 0x3130504e53464230ULL; // "0BFSNP01"
+
+private:
+    std::string _path;
+
+    void fix_inner_nodes(btree_page_h& parent,
+            const std::unordered_set<PageID>& inner, size_t& fixed);
+};
+
 class GenericPageIterator
 {
 public:
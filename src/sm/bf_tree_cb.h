@@ -50,7 +50,32 @@
  * atomic-inc when for some reason you are sure there are at least one more pins on the
  * block, such as when you are incrementing for the case of 3) above.
  *
+ * \Section Layout (BF_SPLIT_CB)
+ *
+ * By default, each control block holds all fields of a frame in one cache line, and
+ * control blocks alternate with their latches (see comment on _latch_offset below).
+ * Fields touched by every fix (pin count, _used, _swizzled, reference counts) thus
+ * share their cache line with fields only touched by updates, the cleaner, and
+ * recovery (page LSNs, log volume, restore pin). If compiled with BF_SPLIT_CB (CMake
+ * option of the same name), the latter are moved to a separate array of
+ * bf_tree_cb_cold_t, latches to an array of their own, and the control block
+ * shrinks to 16 bytes, i.e., four blocks per cache line. All three
+ * arrays are indexed by bf_idx (see bf_tree_m::get_cbp()). Cold fields must be
+ * accessed with cold(), which works with both layouts.
  */
+#ifdef BF_SPLIT_CB
+struct alignas(CACHELINE_SIZE) bf_tree_cb_cold_t {
+    std::atomic<bool> _pinned_for_restore;
+    uint16_t _swizzled_ptr_cnt_hint;
+    uint32_t _log_volume;
+    lsn_t _page_lsn;
+    lsn_t _persisted_lsn;
+    lsn_t _rec_lsn;
+    lsn_t _next_persisted_lsn;
+    lsn_t _next_rec_lsn;
+};
+#endif
+
 struct bf_tree_cb_t {
     /**
      * Maximum value of the per-frame refcount (reference counter).  We cap the
@@ -78,15 +103,17 @@ struct bf_tree_cb_t {
         _pin_cnt = 0;
         _pid = pid;
         _swizzled = false;
-        _pinned_for_restore = false;
         _check_recovery = false;
+        _prefetched = false;
         _ref_count = 0;
         _ref_count_ex = 0;
-        _page_lsn = page_lsn;
-        _rec_lsn = lsn_t::null;
-        _persisted_lsn = page_lsn;
-        _next_rec_lsn = lsn_t::null;
-        _next_persisted_lsn = lsn_t::null;
+        cold_t& c = cold();
+        c._pinned_for_restore = false;
+        c._page_lsn = page_lsn;
+        c._rec_lsn = lsn_t::null;
+        c._persisted_lsn = page_lsn;
+        c._next_rec_lsn = lsn_t::null;
+        c._next_persisted_lsn = lsn_t::null;
 
         // Update _used last. Since it's an std::atomic, a thread seeing it set
         // to true (e.g., cleaner or fuzzy checkpoints) can rely on the fact that
@@ -94,6 +121,23 @@ struct bf_tree_cb_t {
         _used = true;
     }
 
+#ifdef BF_SPLIT_CB
+    typedef bf_tree_cb_cold_t cold_t;
+
+    /** Bases of the arrays of the split layout; set by bf_tree_m */
+    static bf_tree_cb_t* _hot_base;
+    static bf_tree_cb_cold_t* _cold_base;
+    static latch_t* _latch_base;
+
+    size_t index() const { return this - _hot_base; }
+    cold_t& cold() const { return _cold_base[index()]; }
+#else
+    // cold fields are members of this struct
+    typedef bf_tree_cb_t cold_t;
+    cold_t& cold() { return *this; }
+    const cold_t& cold() const { return *this; }
+#endif
+
     /** clears latch */
     inline void clear_latch() {
         ::memset(latchp(), 0, sizeof(latch_t));
@@ -123,34 +167,45 @@ struct bf_tree_cb_t {
     /// Reference count incremented only by X-latching
     uint16_t _ref_count_ex; // +2 -> 12
 
-    uint8_t _fill13; // +1 -> 13
+    /// Whether the page was read ahead and has not been fixed since (for statistics)
+    bool _prefetched; // +1 -> 13
 
+#ifdef BF_SPLIT_CB
+    /// Whether the page must be checked for recovery when fixed (see below)
+    bool _check_recovery; // +1 -> 14
+#else
     std::atomic<bool> _pinned_for_restore; // +1 -> 14
-    void pin_for_restore() { _pinned_for_restore = true; }
-    void unpin_for_restore() { _pinned_for_restore = false; }
-    bool is_pinned_for_restore() { return _pinned_for_restore; }
+#endif
+    void pin_for_restore() { cold()._pinned_for_restore = true; }
+    void unpin_for_restore() { cold()._pinned_for_restore = false; }
+    bool is_pinned_for_restore() { return cold()._pinned_for_restore; }
 
     /// true if this block is actually used
     std::atomic<bool> _used;          // +1  -> 15
     /// Whether this page is swizzled from the parent
     std::atomic<bool> _swizzled;      // +1 -> 16
 
+#ifndef BF_SPLIT_CB
     lsn_t _page_lsn; // +8 -> 24
-    lsn_t get_page_lsn() const { return _page_lsn; }
+#endif
+    lsn_t get_page_lsn() const { return cold()._page_lsn; }
     void set_page_lsn(lsn_t lsn)
     {
         // caller must hold EX latch, since it has just performed an update on
         // the page
-        _page_lsn = lsn;
-        if (_rec_lsn <= _persisted_lsn) { _rec_lsn = lsn; }
-        if (_next_rec_lsn <= _next_persisted_lsn) { _next_rec_lsn = lsn; }
+        cold_t& c = cold();
+        c._page_lsn = lsn;
+        if (c._rec_lsn <= c._persisted_lsn) { c._rec_lsn = lsn; }
+        if (c._next_rec_lsn <= c._next_persisted_lsn) { c._next_rec_lsn = lsn; }
     }
 
     // CS: page_lsn value when it was last picked for cleaning
     // Replaces the old dirty flag, because dirty is defined as
     // page_lsn > clean_lsn
+#ifndef BF_SPLIT_CB
     lsn_t _persisted_lsn; // +8 -> 32
-    lsn_t get_persisted_lsn() const { return _persisted_lsn; }
+#endif
+    lsn_t get_persisted_lsn() const { return cold()._persisted_lsn; }
 
     bool is_dirty()
     {
@@ -161,7 +216,7 @@ struct bf_tree_cb_t {
             // fine, whereas false negative cause lost updates on recovery
             return true;
         }
-        bool res = _page_lsn > _persisted_lsn;
+        bool res = cold()._page_lsn > cold()._persisted_lsn;
         latch().latch_release();
         return res;
     }
@@ -173,21 +228,28 @@ struct bf_tree_cb_t {
     // and it is set in set_page_lsn() above. During log analysis, the minimum
     // of all recovery LSNs determines the starting point for the log-based redo
     // recovery of traditional ARIES. This is not used in instant restart.
+#ifndef BF_SPLIT_CB
     lsn_t _rec_lsn; // +8 -> 40
-    lsn_t get_rec_lsn() const  { return _rec_lsn; }
+#endif
+    lsn_t get_rec_lsn() const  { return cold()._rec_lsn; }
 
+#ifndef BF_SPLIT_CB
     lsn_t _next_persisted_lsn; // +8 -> 48
-    lsn_t get_next_persisted_lsn() const { return _next_persisted_lsn; }
+#endif
+    lsn_t get_next_persisted_lsn() const { return cold()._next_persisted_lsn; }
 
     void mark_persisted_lsn()
     {
         // called by cleaner while it holds SH latch
-        _next_rec_lsn = lsn_t::null;
-        _next_persisted_lsn = _page_lsn;
+        cold_t& c = cold();
+        c._next_rec_lsn = lsn_t::null;
+        c._next_persisted_lsn = c._page_lsn;
     }
 
+#ifndef BF_SPLIT_CB
     lsn_t _next_rec_lsn; // +8 -> 56
-    lsn_t get_next_rec_lsn() const  { return _next_rec_lsn; }
+#endif
+    lsn_t get_next_rec_lsn() const  { return cold()._next_rec_lsn; }
 
     // Called when cleaner writes and fsync's the page to disk. This updates
     // rec_lsn and persisted_lsn to their "next" counterparts that were recorded
@@ -207,8 +269,9 @@ struct bf_tree_cb_t {
             // (which I don't think so).
             return;
         }
-        _persisted_lsn = _next_persisted_lsn;
-        _rec_lsn = _next_rec_lsn;
+        cold_t& c = cold();
+        c._persisted_lsn = c._next_persisted_lsn;
+        c._rec_lsn = c._next_rec_lsn;
         latch().latch_release();
     }
 
@@ -219,17 +282,20 @@ struct bf_tree_cb_t {
         auto rc = latch().latch_acquire(LATCH_SH, timeout_t::WAIT_IMMEDIATE);
         if (rc.is_error()) { return; }
 
-        _rec_lsn = archived_lsn;
-        _persisted_lsn = archived_lsn;
+        cold()._rec_lsn = archived_lsn;
+        cold()._persisted_lsn = archived_lsn;
         latch().latch_release();
     }
 
     /// Log volume generated on this page (for page_img logrec compression, see xct_logger.h)
+#ifndef BF_SPLIT_CB
     uint32_t _log_volume;        // +4 -> 60
-    uint16_t get_log_volume() const { return _log_volume; }
-    void increment_log_volume(uint16_t c) { _log_volume += c; }
-    void set_log_volume(uint16_t c) { _log_volume = c; }
+#endif
+    uint16_t get_log_volume() const { return cold()._log_volume; }
+    void increment_log_volume(uint16_t c) { cold()._log_volume += c; }
+    void set_log_volume(uint16_t c) { cold()._log_volume = c; }
 
+#ifndef BF_SPLIT_CB
     /**
      * number of swizzled pointers to children; protected by ??
      */
@@ -238,6 +304,7 @@ struct bf_tree_cb_t {
     /// This is used for frames that are prefetched during buffer pool warmup.
     /// They might need recovery next time they are fixed.
     bool _check_recovery;   // +1 -> 63
+#endif
     void set_check_recovery(bool chk) { _check_recovery = chk; }
 
     // Add padding to align control block at cacheline boundary (64 bytes)
@@ -257,8 +324,10 @@ struct bf_tree_cb_t {
      * avoid having a control block and latch in the same 128B sector.
      */
 
+#ifndef BF_SPLIT_CB
     /** offset to the latch to protect this page. */
     int8_t                      _latch_offset;  // +1 -> 64
+#endif
 
     // increment pin count atomically
     bool pin()
@@ -322,8 +391,12 @@ struct bf_tree_cb_t {
     bf_tree_cb_t& operator=(const bf_tree_cb_t&);
 
     latch_t* latchp() const {
+#ifdef BF_SPLIT_CB
+        return &_latch_base[index()];
+#else
         uintptr_t p = reinterpret_cast<uintptr_t>(this) + _latch_offset;
         return reinterpret_cast<latch_t*>(p);
+#endif
     }
 
     latch_t &latch() {
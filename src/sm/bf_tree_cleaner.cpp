@@ -101,6 +101,7 @@ void bf_tree_cleaner::flush_workspace_no_clusters(size_t count)
         write_pages(i, i+1);
     }
 
+    smlevel_0::vol->wait_aio();
     smlevel_0::vol->sync();
 
     for (size_t i = 0; i < count; i++) {
@@ -196,6 +197,7 @@ void bf_tree_cleaner::flush_clusters(const vector<size_t>& clusters)
         i = k;
     }
 
+    smlevel_0::vol->wait_aio();
     smlevel_0::vol->sync();
 
     i = 0;
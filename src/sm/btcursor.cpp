@@ -71,6 +71,7 @@ void bt_cursor_t::_init(
     _pid = 0;
     _slot = -1;
     _lsn = lsn_t::null;
+    _readahead_left = 0;
     _elen = 0;
 
     _needs_lock = g_xct_does_need_lock();
@@ -253,6 +254,117 @@ w_rc_t bt_cursor_t::_refix_current_key(btree_page_h &p) {
 }
 
 rc_t bt_cursor_t::next()
+{
+    btree_page_h p;
+    W_DO(_next(p));
+    return RCOK;
+}
+
+rc_t bt_cursor_t::next_batch(size_t max_count, char* buffer, size_t buffer_size,
+                             bt_cursor_rec_t* recs, size_t& count)
+{
+    count = 0;
+    if (max_count == 0) {
+        return RCOK;
+    }
+
+    btree_page_h p;
+    W_DO(_next(p));
+    if (_eof) {
+        return RCOK;
+    }
+
+    // the first record was already copied to _elbuf
+    size_t klen = _key.get_length_as_keystr();
+    if (klen + _elen > buffer_size) {
+        return RC(eRECWONTFIT);
+    }
+    ::memcpy(buffer, _key.buffer_as_keystr(), klen);
+    ::memcpy(buffer + klen, _elbuf, _elen);
+    recs[0].key  = buffer;
+    recs[0].klen = klen;
+    recs[0].elem = buffer + klen;
+    recs[0].elen = _elen;
+    count = 1;
+    size_t used = klen + _elen;
+
+    // the rest comes from the same page, still latched
+    W_DO(_next_batch_in_page(p, max_count, buffer, buffer_size, used, recs, count));
+    INC_TSTAT(bt_cursor_batch_cnt);
+    return RCOK;
+}
+
+rc_t bt_cursor_t::_next_batch_in_page(btree_page_h &p, size_t max_count,
+                                      char* buffer, size_t buffer_size, size_t &used,
+                                      bt_cursor_rec_t* recs, size_t &count)
+{
+    w_assert1(p.is_fixed());
+    slotid_t slot = _slot;
+    while (count < max_count) {
+        slot += _forward ? 1 : -1;
+        if (slot < 0 || slot >= p.nrecs()) {
+            break; // the next call moves to the neighboring page
+        }
+        if (p.is_ghost(slot)) {
+            continue;
+        }
+
+        // same conditions and locks as _advance_one_slot(), except that
+        // the end of the range is left to the next call
+        p.get_key(slot, _tmp_next_key_buf);
+        const okvl_mode *mode = NULL;
+        if (_forward) {
+            int d = _tmp_next_key_buf.compare(_upper);
+            if (d < 0) {
+                mode = _ex_lock ? &ALL_X_GAP_X : &ALL_S_GAP_S;
+            } else if (d == 0 && _upper_inclusive) {
+                mode = _ex_lock ? &ALL_X_GAP_N : &ALL_S_GAP_N;
+            } else {
+                break;
+            }
+        } else {
+            int d = _tmp_next_key_buf.compare(_lower);
+            if (d > 0 || (d == 0 && _lower_inclusive)) {
+                mode = _ex_lock ? &ALL_X_GAP_X : &ALL_S_GAP_S;
+            } else {
+                break;
+            }
+        }
+        if (_needs_lock) {
+            rc_t rc = btree_impl::_ux_lock_key (_store, p, _tmp_next_key_buf,
+                    LATCH_SH, *mode, false);
+            if (rc.is_error()) {
+                if (rc.err_num() == eLOCKRETRY) {
+                    break; // the page changed while we waited; the next call re-locates
+                }
+                return rc;
+            }
+        }
+
+        size_t klen = _tmp_next_key_buf.get_length_as_keystr();
+        if (used + klen > buffer_size) {
+            break;
+        }
+        smsize_t elen = buffer_size - used - klen;
+        bool ghost;
+        if (!p.copy_element(slot, buffer + used + klen, elen, ghost)) {
+            break;
+        }
+        ::memcpy(buffer + used, _tmp_next_key_buf.buffer_as_keystr(), klen);
+        recs[count].key  = buffer + used;
+        recs[count].klen = klen;
+        recs[count].elem = buffer + used + klen;
+        recs[count].elen = elen;
+        used += klen + elen;
+        ++count;
+
+        _slot = slot;
+        _key = _tmp_next_key_buf;
+    }
+    return RCOK;
+}
+
+rc_t bt_cursor_t::_next(btree_page_h &p)
 {
     if (!is_valid()) {
         return RCOK; // EOF
@@ -267,7 +379,6 @@ rc_t bt_cursor_t::next()
     }
 
     w_assert3(_pid);
-    btree_page_h p;
     W_DO(_refix_current_key(p));
     w_assert3(p.is_fixed());
     w_assert3(p.pid() == _pid);
@@ -315,6 +426,19 @@ rc_t bt_cursor_t::_find_next(btree_page_h &p, bool &eof)
     return RCOK;
 }
 
+void bt_cursor_t::_read_ahead(btree_page_h &p)
+{
+    unsigned window = smlevel_0::bf->get_readahead_window();
+    if (window == 0) { return; }
+
+    if (_readahead_left > window / 2) {
+        _readahead_left--;
+        return;
+    }
+    _readahead_left = smlevel_0::bf->readahead_siblings(p.get_generic_page(),
+            _forward, window);
+}
+
 rc_t bt_cursor_t::_advance_one_slot(btree_page_h &p, bool &eof)
 {
     w_assert1(p.is_fixed());
@@ -386,12 +510,17 @@ rc_t bt_cursor_t::_advance_one_slot(btree_page_h &p, bool &eof)
                 W_DO(ss_m::lm->lock(lid.hash(), lock_mode, true, true, true));
             }
 
-            // TODO this part should check if we find an exact match of fence keys.
-            // because we unlatch above, it's possible to not find exact match.
-            // in that case, we should change the traverse_mode to fence_contains and continue
-            W_DO(btree_impl::_ux_traverse(_store, neighboring_fence, traverse_mode, LATCH_SH, p));
+            bool moved;
+            W_DO(_move_via_foster(p, neighboring_fence, moved));
+            if (!moved) {
+                // TODO this part should check if we find an exact match of fence keys.
+                // because we unlatch above, it's possible to not find exact match.
+                // in that case, we should change the traverse_mode to fence_contains and continue
+                W_DO(btree_impl::_ux_traverse(_store, neighboring_fence, traverse_mode, LATCH_SH, p));
+            }
             _slot = _forward ? 0 : p.nrecs() - 1;
             _set_current_page(p);
+            _read_ahead(p);
             continue;
         }
 
@@ -442,6 +571,54 @@ rc_t bt_cursor_t::_advance_one_slot(btree_page_h &p, bool &eof)
     return RCOK;
 }
 
+rc_t bt_cursor_t::_move_via_foster(btree_page_h &p, const w_keystr_t &neighboring_fence,
+                                   bool &moved)
+{
+    moved = false;
+    w_assert1(!p.is_fixed());
+    if (_forward) {
+        // the previous page is still pinned for refix
+        rc_t rc = p.refix_direct(_pid_bfidx.idx(), LATCH_SH);
+        if (rc.is_error()) {
+            return RCOK; // let the traversal deal with it
+        }
+        if (p.get_foster() == 0 || p.compare_with_fence_high(neighboring_fence) != 0) {
+            p.unfix();
+            return RCOK;
+        }
+        btree_page_h next;
+        W_DO(next.fix_nonroot(p, p.get_foster_opaqueptr(), LATCH_SH));
+        p = next;
+        if (p.compare_with_fence_low(neighboring_fence) != 0) {
+            p.unfix();
+            return RCOK;
+        }
+    } else {
+        // a foster child is registered with its foster parent as parent
+        bf_idx parent_idx = smlevel_0::bf->lookup_parent(_pid);
+        if (parent_idx == 0) {
+            return RCOK;
+        }
+        // might be stale, hence the checks below
+        PageID prev_pid = smlevel_0::bf->get_page(parent_idx)->pid;
+        rc_t rc = p.fix_direct(prev_pid, LATCH_SH, false, false, true /*only_if_hit*/);
+        if (rc.is_error()) {
+            if (rc.err_num() == stINUSE) {
+                return RCOK; // not cached (any more)
+            }
+            return rc;
+        }
+        if (p.get_generic_page()->tag != t_btree_p || !p.is_leaf() || p.store() != _store
+            || p.compare_with_fence_high(neighboring_fence) != 0) {
+            p.unfix();
+            return RCOK;
+        }
+    }
+    INC_TSTAT(bt_cursor_foster_moves);
+    moved = true;
+    return RCOK;
+}
+
 rc_t bt_cursor_t::_make_rec(const btree_page_h& page)
 {
     // Copy the record to buffer
@@ -11,6 +11,18 @@
 
 class btree_page_h;
 
+/**
+ * \brief A record returned by bt_cursor_t::next_batch().
+ * \details
+ * Points into the buffer given to next_batch().  The key is in the key
+ * string format (see w_keystr_t::construct_from_keystr()).
+ */
+struct bt_cursor_rec_t {
+    const char* key;
+    smsize_t    klen;
+    const char* elem;
+    smsize_t    elen;
+};
 
 /**
  * \brief A cursor object to sequentially read BTree.
@@ -57,6 +69,13 @@ class btree_page_h;
  * the key range locks are on half-open interval (a key
  * and open interval on its _right_).
  *
+ * \section Batches
+ * next_batch() returns many records with one call.  The first one is
+ * found like next() does, and the following ones are copied from the same
+ * leaf page while it stays latched, so the latch, the page-update check,
+ * and the copy to the internal record buffer are paid once per batch
+ * instead of once per record.
+ *
  * Also, there's a trade-off between concurrency and overhead.
  * In this class, we try to minimize overhead rather than
  * concurrency. See jira ticket:89 "Cursor case: overhead-concurrency trade-off" (originally trac ticket:91) for more details.
@@ -111,6 +130,26 @@ public:
      */
     rc_t next();
 
+    /**
+     * \brief Moves the cursor over up to max_count records at once.
+     * \details
+     * The first record is found like next() does, possibly on another page.
+     * The following ones are taken from the same leaf page without releasing
+     * its latch, so fewer than max_count records may be returned before the
+     * end of the scan; count is 0 only if eof().  Keys and elements are
+     * copied into buffer until it is full.  If not even the first record
+     * fits, eRECWONTFIT is returned, and the record is available from key()
+     * and elem() as after next().  Otherwise, key() is the key of the last
+     * returned record afterwards, but elem() is not meaningful.
+     * @param[in] max_count maximum number of records to return
+     * @param[out] buffer keys and elements of the returned records
+     * @param[in] buffer_size size of buffer
+     * @param[out] recs the returned records; must have max_count entries
+     * @param[out] count number of returned records
+     */
+    rc_t next_batch(size_t max_count, char* buffer, size_t buffer_size,
+                    bt_cursor_rec_t* recs, size_t& count);
+
     bool          is_valid() const { return _first_time || !_eof; }
     bool          is_forward() const { return _forward; }
     void          close();
@@ -131,6 +170,8 @@ private:
         const w_keystr_t& lower,  bool lower_inclusive,
         const w_keystr_t& upper,  bool upper_inclusive,
         bool              forward);
+    /** next(), but leaves the current page fixed in p unless eof. */
+    rc_t        _next(btree_page_h &p);
     rc_t        _locate_first();
     rc_t        _check_page_update(btree_page_h &p);
     rc_t        _find_next(btree_page_h &p, bool &eof);
@@ -162,6 +203,40 @@ private:
     */
     rc_t        _advance_one_slot(btree_page_h &p, bool &eof);
 
+    /**
+     * \brief Moves to the neighboring leaf through a foster relationship
+     * instead of a traversal from the root.
+     * \details
+     * Forward, the next leaf is the foster child of the current page, if
+     * any; it is reached by latch coupling.  Backward, the previous leaf is
+     * the foster parent if the current page is a foster child, which the
+     * buffer pool knows as its registered parent.  Either way, the page is
+     * used only if its fence key matches neighboring_fence.  Called with
+     * p unfixed; if moved is false, p is left unfixed.
+     */
+    rc_t        _move_via_foster(btree_page_h &p, const w_keystr_t &neighboring_fence,
+                                 bool &moved);
+
+    /**
+     * \brief Appends the records following _slot on p to a batch.
+     * \details
+     * Stops at the end of the page, at the end of the search range, when the
+     * batch or buffer is full, or when a lock wait lets the page change.
+     */
+    rc_t        _next_batch_in_page(btree_page_h &p, size_t max_count,
+                                    char* buffer, size_t buffer_size, size_t &used,
+                                    bt_cursor_rec_t* recs, size_t &count);
+
+    /**
+     * \brief Issues asynchronous read-ahead of the leaves that follow p.
+     * \details
+     * Called whenever the cursor moves to a new leaf. Requests the next
+     * siblings from the parent's child pointers (see bf_tree_m::readahead_siblings)
+     * once less than half of the read-ahead window is left ahead of the cursor,
+     * e.g., when it crosses into the child range of another parent.
+     */
+    void        _read_ahead(btree_page_h &p);
+
     /**
     *  Make the cursor point to record at "slot" on "page".
     */
@@ -198,6 +273,9 @@ private:
     /** lsn of the current page AS OF last access. */
     lsn_t       _lsn;
 
+    /** number of leaves ahead of the current page covered by the last read-ahead. */
+    unsigned    _readahead_left;
+
     /** current key. */
     w_keystr_t  _key;
     /** only internally used as temporary variable. */
@@ -42,11 +42,11 @@ btree_m::max_entry_size() {
 }
 
 rc_t
-btree_m::create(StoreID stid, PageID root)
+btree_m::create(StoreID stid, PageID root, int poor_key_width, bool compress_values)
 {
     DBGTHRD(<<"btree create: stid " << stid);
 
-    W_DO(btree_impl::_ux_create_tree_core(stid, root));
+    W_DO(btree_impl::_ux_create_tree_core(stid, root, poor_key_width, compress_values));
 
     bool empty=false;
     W_DO(is_empty(stid, empty));
@@ -69,6 +69,11 @@ btree_m::is_empty(
     return RCOK;
 }
 
+rc_t btree_m::bulk_load(StoreID store, bulk_load_iterator& iter, uint64_t& count) {
+    W_DO(btree_impl::_ux_bulk_load(store, iter, count));
+    return RCOK;
+}
+
 rc_t btree_m::insert(StoreID store, const w_keystr_t &key, const cvec_t &el) {
     if (key.get_length_as_nonkeystr() + el.size() > btree_page_h::max_entry_size) {
         return RC(eRECWONTFIT);
@@ -77,6 +82,12 @@ rc_t btree_m::insert(StoreID store, const w_keystr_t &key, const cvec_t &el) {
     return RCOK;
 }
 
+rc_t btree_m::insert_batch(StoreID store, size_t count, const w_keystr_t* keys,
+                          const cvec_t* elems, rc_t* results) {
+    W_DO(btree_impl::_ux_insert_batch(store, count, keys, elems, results));
+    return RCOK;
+}
+
 rc_t btree_m::update(
     StoreID store,
     const w_keystr_t&                 key,
@@ -132,15 +143,42 @@ rc_t btree_m::lookup(
     W_DO( btree_impl::_ux_lookup(store, key, found, el, elen ));
     return RCOK;
 }
+rc_t btree_m::lookup_batch(
+    StoreID store, size_t count, const w_keystr_t* keys,
+    void** els, smsize_t* elens, bool* found, rc_t* results)
+{
+    W_DO( btree_impl::_ux_lookup_batch(store, count, keys, found, els, elens, results));
+    return RCOK;
+}
+rc_t btree_m::get_du_statistics(
+        StoreID store, btree_stats_t &btree_stats, bool audit, int threads)
+{
+    // the verification is almost free once the pages are read
+    const int hash_bits = 20;
+    btree_stats_t stats;
+    bool consistent;
+    W_DO(btree_impl::_ux_verify_tree_parallel(store, hash_bits, threads, consistent, &stats));
+    if (audit) {
+        if (!consistent) {
+            return RC(se_INCONSISTENT_INDEX);
+        }
+        W_DO(stats.audit());
+    }
+    btree_stats.add(stats);
+    return RCOK;
+}
 rc_t btree_m::verify_tree(
-        StoreID store, int hash_bits, bool &consistent)
+        StoreID store, int hash_bits, bool &consistent, int threads)
 {
+    if (threads > 1) {
+        return btree_impl::_ux_verify_tree_parallel(store, hash_bits, threads, consistent, NULL);
+    }
     return btree_impl::_ux_verify_tree(store, hash_bits, consistent);
 }
 rc_t btree_m::verify_volume(
-        int hash_bits, verify_volume_result &result)
+        int hash_bits, verify_volume_result &result, int threads)
 {
-    return btree_impl::_ux_verify_volume(hash_bits, result);
+    return btree_impl::_ux_verify_volume(hash_bits, result, threads);
 }
 
 void
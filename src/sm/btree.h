@@ -20,6 +20,7 @@ struct btree_int_stats_t;
 class w_keystr_t;
 class verify_volume_result;
 struct okvl_mode;
+class bulk_load_iterator;
 /**
  * Data access API for B+Tree.
  * \ingroup SSMBTREE
@@ -44,12 +45,27 @@ public:
 
     static smsize_t                max_entry_size();
 
-    /** Create a btree. Return the root page id in root. */
+    /**
+     * Create a btree in the given root page, whose pages keep
+     * poor_key_width bytes of each key as poor man's normalized key
+     * and, if compress_values, store the elements of leaf records compressed.
+     */
     static rc_t                        create(
         StoreID              stid,
-        PageID               root
+        PageID               root,
+        int                  poor_key_width,
+        bool                 compress_values = false
         );
 
+    /**
+     * Fill the empty btree with the entries of iter, which come in
+     * ascending key order, building its pages bottom-up.
+     */
+    static rc_t                        bulk_load(
+        StoreID                          store,
+        bulk_load_iterator&              iter,
+        uint64_t&                        count);
+
     /**
     * Insert <key, el> into the btree.
     */
@@ -58,6 +74,18 @@ public:
         const w_keystr_t&                 key,
         const cvec_t&                     elem);
 
+    /**
+    * Insert many <key, el> pairs into the btree, traversing only once for
+    * keys that fall into the same leaf.  Each pair succeeds or fails on its
+    * own; results[i] tells the outcome of keys[i].
+    */
+    static rc_t                        insert_batch(
+        StoreID store,
+        size_t                            count,
+        const w_keystr_t*                 keys,
+        const cvec_t*                     elems,
+        rc_t*                             results);
+
     /**
     * Update el of key with the new data.
     */
@@ -115,24 +143,45 @@ public:
         smsize_t&                      elen,
         bool&                          found);
 
+    /**
+    * Find many keys in btree, traversing only once for keys that fall into
+    * the same leaf.  Same as lookup() for each keys[i], with the outcome
+    * in results[i].
+    */
+    static rc_t                        lookup_batch(
+        StoreID store,
+        size_t                         count,
+        const w_keystr_t*              keys,
+        void**                         els,
+        smsize_t*                      elens,
+        bool*                          found,
+        rc_t*                          results);
+
+    /**
+     * Adds the space statistics of all pages of the tree to btree_stats,
+     * collected by the given number of threads while verifying the tree.
+     * If audit is true, also checks that the statistics account for every byte.
+     */
     static rc_t                 get_du_statistics(
-        const PageID &root_pid,
+        StoreID                         store,
         btree_stats_t&                btree_stats,
-        bool                            audit);
+        bool                            audit,
+        int                             threads = 1);
 
     /**
     *  Verifies the integrity of whole tree using the fence-key bitmap technique.
      * @copydetails btree_impl::_ux_verify_tree(const PageID&,int,bool&)
+     * If threads > 1, uses btree_impl::_ux_verify_tree_parallel().
     */
     static rc_t                        verify_tree(
-        StoreID store, int hash_bits, bool &consistent);
+        StoreID store, int hash_bits, bool &consistent, int threads = 1);
 
     /**
      * \brief Verifies consistency of all BTree indexes in the volume.
      * @copydetails btree_impl::_ux_verify_volume()
      */
     static rc_t            verify_volume(
-        int hash_bits, verify_volume_result &result);
+        int hash_bits, verify_volume_result &result, int threads = 1);
 protected:
     /*
      * for use by logrecs for undo
@@ -145,16 +194,6 @@ protected:
 private:
     /** Return true in ret if btree at root is empty. false otherwise. */
     static rc_t                        is_empty(StoreID store, bool& ret);
-
-    /** Used by get_du_statistics internally to collect all nodes' statistics. */
-    static rc_t _get_du_statistics_recurse(
-        const PageID&        currentpid,
-        btree_stats_t&        _stats,
-        base_stat_t        &lf_cnt,
-        base_stat_t        &int_cnt,
-        btree_lf_stats_t        &lf_stats,
-        btree_int_stats_t       &int_stats,
-        bool                 audit);
 };
 
 /*<std-footer incl-file-exclusion='BTREE_H'>  -- do not edit anything below this line -- */
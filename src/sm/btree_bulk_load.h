@@ -0,0 +1,99 @@
+/*
+ * (c) Copyright 2011-2014, Hewlett-Packard Development Company, LP
+ */
+
+#ifndef BTREE_BULK_LOAD_H
+#define BTREE_BULK_LOAD_H
+
+#include "w_defines.h"
+#include "w_key.h"
+#include "vec_t.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Source of the entries given to ss_m::bulk_load().
+ * \ingroup SSMBTREE
+ * \details
+ * next() is called until it sets eof.  Unless the bulk load is told to sort
+ * the input, entries must come in strictly ascending key order.
+ */
+class bulk_load_iterator {
+public:
+    virtual ~bulk_load_iterator() {}
+
+    /**
+     * Returns the next entry in key and elem, or sets eof to true if there
+     * are no more entries (key and elem are then left untouched).
+     */
+    virtual rc_t next(w_keystr_t& key, std::string& elem, bool& eof) = 0;
+};
+
+/**
+ * \brief External merge sort for the input of ss_m::bulk_load().
+ * \ingroup SSMBTREE
+ * \details
+ * Entries are added in any order with add().  Whenever the buffered entries
+ * exceed the memory limit, they are sorted and spilled as a run to a
+ * temporary file.  Once all entries were added, the sorter is used as a
+ * bulk_load_iterator which merges the runs and returns the entries in key
+ * order.  Adding after the first next() call is not allowed.
+ *
+ * The sorter is not thread-safe; concurrent producers must serialize add().
+ */
+class bulk_load_sorter : public bulk_load_iterator {
+public:
+    /** @param[in] memory_limit bytes of entries buffered before a run is spilled. */
+    bulk_load_sorter(size_t memory_limit = 64 << 20);
+    virtual ~bulk_load_sorter();
+
+    /** Adds one entry. */
+    rc_t add(const w_keystr_t& key, const cvec_t& elem);
+
+    /** Adds all entries of the given iterator. */
+    rc_t add_all(bulk_load_iterator& iter);
+
+    virtual rc_t next(w_keystr_t& key, std::string& elem, bool& eof);
+
+    /** Number of entries added so far. */
+    size_t size() const { return _count; }
+
+    /** Number of runs spilled to temporary files so far. */
+    size_t run_count() const { return _runs.size(); }
+
+private:
+    /** An entry; the key is kept as key string (with sign byte). */
+    struct entry_t {
+        std::string key;
+        std::string elem;
+    };
+
+    /** A spilled run and its current (smallest unread) entry. */
+    struct run_t {
+        FILE*   file;
+        entry_t head;
+        bool    eof;
+    };
+
+    rc_t _spill();
+    rc_t _start_merge();
+    static rc_t _write_entry(FILE* file, const entry_t& e);
+    static rc_t _read_entry(FILE* file, entry_t& e, bool& eof);
+
+    size_t               _memory_limit;
+    size_t               _buffered_bytes;
+    size_t               _count;
+    std::vector<entry_t> _buffer;
+    std::vector<run_t>   _runs;
+
+    /** True once next() was called. */
+    bool                 _merging;
+    /** Position in _buffer when nothing was spilled. */
+    size_t               _buffer_pos;
+    /** Min-heap of run indexes, ordered by their head key. */
+    std::vector<size_t>  _heap;
+};
+
+#endif // BTREE_BULK_LOAD_H
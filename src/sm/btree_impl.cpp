@@ -49,6 +49,16 @@ btree_impl::_ux_insert_core(
     // find the leaf (potentially) containing the key
     btree_page_h       leaf;
     W_DO( _ux_traverse(store, key, t_fence_contain, LATCH_EX, leaf));
+    return _ux_insert_in_leaf(store, key, el, leaf);
+}
+
+rc_t
+btree_impl::_ux_insert_in_leaf(
+    StoreID store,
+    const w_keystr_t&    key,
+    const cvec_t&        el,
+    btree_page_h&        leaf)
+{
     w_assert1( leaf.is_fixed());
     w_assert1( leaf.is_leaf());
     w_assert1( leaf.latch_mode() == LATCH_EX);
@@ -138,6 +148,66 @@ btree_impl::_ux_insert_core(
     return RCOK;
 }
 
+rc_t
+btree_impl::_ux_insert_batch(
+    StoreID store,
+    size_t               count,
+    const w_keystr_t*    keys,
+    const cvec_t*        elems,
+    rc_t*                results)
+{
+    std::vector<size_t> order;
+    _ux_batch_order(count, keys, order);
+
+    for (size_t i = 0; i < count && i < BATCH_PREFETCH_DISTANCE; ++i) {
+        _ux_prefetch_leaf(store, keys[order[i]]);
+    }
+
+    btree_page_h leaf;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t k = order[i];
+        const w_keystr_t& key = keys[k];
+        INC_TSTAT(bt_insert_cnt);
+        INC_TSTAT(bt_batch_key_cnt);
+
+        rc_t rc;
+        if (key.get_length_as_nonkeystr() + elems[k].size() > btree_page_h::max_entry_size) {
+            rc = RC(eRECWONTFIT);
+        } else {
+            while (true) {
+                // after a split, leaf is the page that got the previous key
+                if (leaf.is_fixed() && leaf.fence_contains(key)) {
+                    INC_TSTAT(bt_batch_leaf_reuse_cnt);
+                } else {
+                    leaf.unfix();
+                    rc = _ux_traverse(store, key, t_fence_contain, LATCH_EX, leaf);
+                    if (rc.is_error()) {
+                        break;
+                    }
+                }
+                rc = _ux_insert_in_leaf(store, key, elems[k], leaf);
+                if (rc.is_error() && rc.err_num() == eLOCKRETRY) {
+                    leaf.unfix(); // the leaf might have changed while we waited
+                    continue;
+                }
+                break;
+            }
+            if (rc.is_error() && rc.err_num() != eDUPLICATE) {
+                leaf.unfix(); // don't trust the latch after other errors
+            }
+        }
+        results[k] = rc;
+
+        if (i + BATCH_PREFETCH_DISTANCE < count) {
+            const w_keystr_t& ahead = keys[order[i + BATCH_PREFETCH_DISTANCE]];
+            if (!leaf.is_fixed() || !leaf.fence_contains(ahead)) {
+                _ux_prefetch_leaf(store, ahead);
+            }
+        }
+    }
+    return RCOK;
+}
+
 rc_t
 btree_impl::_ux_put(
     StoreID store,
@@ -340,14 +410,17 @@ btree_impl::_ux_update_core(StoreID store, const w_keystr_t &key, const cvec_t &
     // get the old data and log
     bool ghost;
     smsize_t old_element_len;
-    const char *old_element = leaf.element(slot, old_element_len, ghost);
+    std::string old_element_buffer;
+    const char *old_element = leaf.element(slot, old_element_len, ghost,
+                                           old_element_buffer);
     // it might be ghost..
     if (ghost) {
         return RC(eNOTFOUND);
     }
 
-    // are we expanding?
-    if (old_element_len < el.size()) {
+    // are we expanding? compressed elements might also grow
+    // if the new one compresses worse
+    if (!leaf.check_space_for_replace_el(slot, el)) {
         if (!leaf.check_space_for_insert_leaf(key, el)) {
             // this page needs split. As this is a rare case,
             // we just call remove and then insert to simplify the code
@@ -382,10 +455,13 @@ btree_impl::_ux_update_core_tail(StoreID store,
         return RC(eNOTFOUND);
     }
     smsize_t old_element_len;
-    const char *old_element = leaf.element(slot, old_element_len, is_ghost);
+    std::string old_element_buffer;
+    const char *old_element = leaf.element(slot, old_element_len, is_ghost,
+                                           old_element_buffer);
 
-    // are we expanding?
-    if (old_element_len < el.size()) {
+    // are we expanding? compressed elements might also grow
+    // if the new one compresses worse
+    if (!leaf.check_space_for_replace_el(slot, el)) {
         if (!leaf.check_space_for_insert_leaf(key, el)) {
             // this page needs split. As this is a rare case,
             // we just call remove and then insert to simplify the code
@@ -449,13 +525,30 @@ rc_t btree_impl::_ux_overwrite_core(
     // get the old data and log
     bool ghost;
     smsize_t old_element_len;
-    const char *old_element = leaf.element(slot, old_element_len, ghost);
+    std::string old_element_buffer;
+    const char *old_element = leaf.element(slot, old_element_len, ghost,
+                                           old_element_buffer);
     if (ghost) {
         return RC(eNOTFOUND);
     }
     if (old_element_len < offset + elen) {
         return RC(eRECWONTFIT);
     }
+    if (leaf.is_value_compressed()) {
+        // the overwritten element might compress worse and not fit anymore,
+        // so, as for updates, remove and insert it
+        std::string new_element(old_element, old_element_len);
+        new_element.replace(offset, elen, el, elen);
+        cvec_t new_el(new_element.data(), new_element.size());
+        if (!leaf.check_space_for_replace_el(slot, new_el)
+            && !leaf.check_space_for_insert_leaf(key.get_length_as_keystr()
+                                                 - leaf.get_prefix_length(),
+                                                 old_element_len)) {
+            W_DO(_ux_remove(store, key));
+            W_DO(_ux_insert(store, key, new_el));
+            return RCOK;
+        }
+    }
 
     Logger::log_p<btree_overwrite_log> (&leaf, key, old_element, el, offset, elen);
     leaf.overwrite_el_nolog(slot, offset, el, elen);
@@ -579,7 +672,9 @@ btree_impl::_ux_undo_ghost_mark(StoreID store, const w_keystr_t &key)
     // should be held and the original record should still be intact
     bool ghost;
     smsize_t existing_element_len;
-    const char *existing_element = leaf.element(slot, existing_element_len, ghost);
+    std::string existing_element_buffer;
+    const char *existing_element = leaf.element(slot, existing_element_len, ghost,
+                                                existing_element_buffer);
     cvec_t el (existing_element, existing_element_len);
 
 // TODO(Restart)...
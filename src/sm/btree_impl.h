@@ -11,6 +11,7 @@
 #include "btree_verify.h"
 #include "w_okvl.h"
 #include "xct.h"
+#include <vector>
 
 /**
  * \brief The internal implementation class which actually implements the
@@ -109,6 +110,38 @@ public:
         StoreID store,
         const w_keystr_t&                 key,
         const cvec_t&                     elem);
+    /**
+     * Second half of _ux_insert_core(), after traversing to the leaf.
+     * If the leaf is split, leaf is set to the page which got the tuple.
+     */
+    static rc_t                        _ux_insert_in_leaf(
+        StoreID store,
+        const w_keystr_t&                 key,
+        const cvec_t&                     elem,
+        btree_page_h&                     leaf);
+
+    /**
+    *  \brief Inserts many tuples, sharing traversals among keys in the same leaf.
+    * \details
+    *  The keys are processed in ascending order.  The leaf of the previous key
+    *  stays EX-latched and is reused as long as its fence keys contain the
+    *  next key; otherwise the tree is traversed again.  Meanwhile, the leaves
+    *  of keys a few positions ahead are prefetched (see _ux_prefetch_leaf()).
+    *  Each key succeeds or fails on its own, as if inserted by _ux_insert().
+    *  Context: User transaction.
+    * @param[in] store Store ID
+    * @param[in] count number of tuples
+    * @param[in] keys keys of the inserted tuples
+    * @param[in] elems data of the inserted tuples
+    * @param[out] results outcome for each tuple, in the order of keys
+    */
+    static rc_t                        _ux_insert_batch(
+        StoreID store,
+        size_t                            count,
+        const w_keystr_t*                 keys,
+        const cvec_t*                     elems,
+        rc_t*                             results);
+
     /** Last half of _ux_insert, after traversing, finding (or not) and ghost determination.*/
     static rc_t _ux_insert_core_tail
     (StoreID store,
@@ -320,6 +353,32 @@ public:
         PageID&                   leaf_pid_causing_failed_upgrade
         );
 
+    /**
+    * \brief Optimistic variant of _ux_traverse_recurse for t_fence_contain.
+    * \details
+    * Reads inner nodes without latching them: the version of the latch of each
+    * node (see latch_t::optimistic_begin()) is validated after searching it and
+    * after looking up the child's frame, and the traversal restarts from the
+    * root if it changed. Thus, no shared memory is written until the leaf,
+    * which is fixed in leaf_latch_mode and accepted only if its fence keys
+    * contain the key. Sets found to false if the optimistic traversal gave up,
+    * e.g., because the root is a leaf, a page is not cached or needs recovery,
+    * or writers kept conflicting; the caller then falls back to latch coupling.
+    *  Context: Both user and system transaction.
+    * @param[in] store Store ID
+    * @param[in] key  target key
+    * @param[in] leaf_latch_mode EX for insert/remove, SH for lookup
+    * @param[out] leaf leaf containing the key, if found
+    * @param[out] found whether leaf was fixed
+    */
+    static rc_t                 _ux_traverse_optimistic(
+        StoreID                    store,
+        const w_keystr_t&          key,
+        latch_mode_t               leaf_latch_mode,
+        btree_page_h&              leaf,
+        bool&                      found
+        );
+
     /**
      * \brief Internal helper function to actually search for the correct slot and test fence
      * assumptions.
@@ -382,6 +441,64 @@ public:
         void*                      el,
         smsize_t&                  elen
         );
+    /** Second half of _ux_lookup_core(), after traversing to the (latched) leaf. */
+    static rc_t                 _ux_lookup_in_leaf(
+        StoreID store,
+        const w_keystr_t&          key,
+        bool&                      found,
+        void*                      el,
+        smsize_t&                  elen,
+        btree_page_h&              leaf
+        );
+
+    /**
+    *  Finds many keys in btree, sharing traversals among keys in the same leaf.
+    *  The keys are processed in ascending order.  The leaf of the previous key
+    *  stays SH-latched and is reused as long as its fence keys contain the
+    *  next key.  Meanwhile, the leaves of keys a few positions ahead are
+    *  prefetched (see _ux_prefetch_leaf()).  Each key succeeds or fails
+    *  on its own, as if looked up by _ux_lookup().
+    *  Context: user transaction.
+    * @param[in] store Store ID
+    * @param[in] count number of keys
+    * @param[in] keys keys we want to find
+    * @param[out] found for each key, true if it is found
+    * @param[out] els for each key, buffer to put el
+    * @param[in,out] elens for each key, size of the buffer (in) and of el (out)
+    * @param[out] results outcome for each key
+    */
+    static rc_t                 _ux_lookup_batch(
+        StoreID store,
+        size_t                     count,
+        const w_keystr_t*          keys,
+        bool*                      found,
+        void**                     els,
+        smsize_t*                  elens,
+        rc_t*                      results
+        );
+
+    /** Returns the positions of the given keys in ascending key order. */
+    static void                 _ux_batch_order(
+        size_t                     count,
+        const w_keystr_t*          keys,
+        std::vector<size_t>&       order
+        );
+
+    /**
+    * \brief Prefetches the leaf page which (probably) contains the key into CPU caches.
+    * \details
+    * Descends the tree like _ux_traverse_optimistic(), without latching or
+    * pinning anything, and issues prefetch instructions for the header and the
+    * slot array of the leaf page and for its control block.  Does nothing if
+    * any page on the way is not cached or is being modified.  The result
+    * is only a hint, so it is not validated at the leaf.
+    */
+    static void                 _ux_prefetch_leaf(StoreID store, const w_keystr_t& key);
+
+    enum {
+        /** How many keys ahead of the current one batched operations prefetch the leaf for. */
+        BATCH_PREFETCH_DISTANCE = 4
+    };
 
 #ifdef DOXYGEN_HIDE
 ///==========================================
@@ -632,7 +749,9 @@ public:
      * this version assumes system transaction as the active transaction on current thread.
      * @see _sx_shrink_tree()
      */
-    static rc_t                        _ux_create_tree_core(const StoreID &stid, const PageID &root_pid);
+    static rc_t                        _ux_create_tree_core(const StoreID &stid, const PageID &root_pid,
+                                                            int poor_key_width,
+                                                            bool compress_values = false);
 
     /**
     *  \brief Shrink the tree. Copy the child page over the root page so the
@@ -657,6 +776,30 @@ public:
     */
     static rc_t                        _sx_grow_tree(btree_page_h& root);
 
+#ifdef DOXYGEN_HIDE
+///==========================================
+///   BEGIN: Bulk Loading. implemented in btree_impl_bulkload.cpp
+///==========================================
+#endif // DOXYGEN_HIDE
+    /**
+     * \brief Builds the B-tree bottom-up from the given entries.
+     * \details
+     * The tree must be empty.  Pages of each level are filled completely,
+     * one after another, in memory and then installed with a single
+     * page_img_format log record, each in its own system transaction.
+     * The root is formatted last, so a crash in the middle leaves the tree
+     * empty (the pages written so far remain allocated to the store).  If
+     * the load fails with an error instead, those pages are deallocated.
+     * The root stays EX-latched throughout, which keeps out other threads.
+     * Context: user transaction, which is needed for logging.
+     * @param[in] store the B-tree to load.
+     * @param[in] iter entries in strictly ascending key order; eDUPLICATE or
+     * eBADARGUMENT are returned on equal or descending keys.
+     * @param[out] count number of entries loaded.
+     */
+    static rc_t                        _ux_bulk_load(StoreID store, bulk_load_iterator& iter,
+                                                     uint64_t& count);
+
 #ifdef DOXYGEN_HIDE
 ///==========================================
 ///   BEGIN: BTree Verification. implemented in btree_impl_verify.cpp
@@ -698,6 +841,37 @@ public:
     static rc_t                        _ux_verify_feed_page(
         btree_page_h &page, verification_context &context);
 
+    /**
+    * \brief Parallel version of _ux_verify_tree() that can also collect space statistics.
+    * \details
+    * The calling thread checks the pages at the top of the tree, descending
+    * until there are at least 4 subtrees per thread or it reaches the leaves.
+    * The subtrees below are then checked by \e threads workers (the calling
+    * thread only if threads <= 1), each feeding its own verification_context.
+    * Facts and expectations only cancel out once all bitmaps are merged, so a
+    * separator key checked by one worker may be the fence of a page checked
+    * by another.
+    * Workers latch pages that are already in the bufferpool, but read all other
+    * pages straight from the volume without caching them. Verifying or
+    * measuring a large tree thus does not evict the working set.
+    * Like _ux_verify_tree(), this method expects no concurrent structural changes
+    * in the tree; otherwise it may report false inconsistencies.
+    * @param[in] store Store ID
+    * @param[in] hash_bits the number of bits we use for hashing, at most 31.
+    * @param[in] threads number of worker threads
+    * @param[out] consistent whether the BTree is consistent
+    * @param[out] stats if not NULL, the space statistics of the tree are added to it
+    */
+    static rc_t                        _ux_verify_tree_parallel(
+        StoreID store, int hash_bits, int threads, bool &consistent,
+        btree_stats_t *stats);
+
+    /**
+    * Adds the space statistics of the given page to the given object.
+    */
+    static void                        _ux_collect_page_stats(
+        btree_page_h &page, btree_stats_t &stats);
+
     /**
      * \brief Verifies consistency of all BTree indexes in the volume.
      * \details Unlike verify_index() this method sequentially scans
@@ -708,10 +882,12 @@ public:
      * @param[in] vid The volume of interest.
      * @param[in] hash_bits the number of bits we use for hashing per BTree, at most 31.
      * @param[out] result Results of the verification.
+     * @param[in] threads number of threads that scan disjoint ranges of the volume,
+     * each with its own result, which are merged at the end.
      * @see _ux_verify_tree()
      */
     static rc_t                       _ux_verify_volume(
-        int hash_bits, verify_volume_result &result);
+        int hash_bits, verify_volume_result &result, int threads = 1);
 
     /** initialize context for in-query verification.*/
     static void inquery_verify_init(StoreID store);
@@ -726,36 +902,93 @@ public:
 ///==========================================
 #endif // DOXYGEN_HIDE
     /**
-    *  \brief Checks the whole tree to opportunistically adopt, in-page defrag and rebalance.
+    *  \brief Checks the whole tree to opportunistically adopt, in-page defrag and merge.
     *  \details
     * This method recursively checks the entire tree and to find
     * something that needs maintenance, such as B-link chain, ghost records and unbalanced nodes.
     * If it finds such pages, it does adopt/defrag/merge etc.
     * This method is completely opportunistic, meaning it doesn't require a global latch or lock.
     * If there is some page this method can't get EX latch immediately, it skips the page.
-    * Context: in system transaction.
+    * The walk keeps SH latches on the path from the root and upgrades them only
+    * to modify a page.
+    * Ghost records are only reclaimed from pages that no active transaction
+    * has updated, so that their deletions can still be rolled back.
+    * Context: not in a transaction. Each adopt, merge and in-page defrag
+    * runs in its own system transaction, which commits right away.
     * @param[in] store Store ID
     * @param[in] inpage_defrag_ghost_threshold 0 to 100 (percent). if page has this many ghosts, and:
     * @param[in] inpage_defrag_usage_threshold 0 to 100 (percent). and it has this many used space, it does defrag.
+    * Also, two neighboring leaves that together use at most this much of a page are merged.
     * @param[in] does_adopt whether we do adopts
-    * @param[in] does_merge whether we do merge/rebalance (which might trigger de-adopt as well)
+    * @param[in] does_merge whether we do merge (which might trigger de-adopt as well)
+    * @param[in,out] io_budget if not NULL, number of pages the walk may still read from
+    * disk or modify. Decremented as the walk goes; the walk stops when it reaches 0.
+    * @param[in,out] resume_key if not NULL and constructed, the walk skips the part of
+    * the tree below this key. When the budget runs out, it is set to where the walk
+    * stopped; when the walk completes, it is cleared.
     */
-    static rc_t                        _sx_defrag_tree(
+    static rc_t                        _ux_defrag_tree(
         StoreID store,
         uint16_t inpage_defrag_ghost_threshold = 10,
         uint16_t inpage_defrag_usage_threshold = 50,
         bool does_adopt = true,
-        bool does_merge = true);
+        bool does_merge = true,
+        size_t* io_budget = NULL,
+        w_keystr_t* resume_key = NULL);
+
+    /**
+     * \brief Turns a real child into the foster child of its left sibling.
+     * \details
+     * The inverse of _sx_adopt_foster(): the separator key of right_child is
+     * removed from real_parent, and left_child gets right_child as its foster
+     * child. This is the first step to merge two adjacent siblings, see
+     * _sx_merge_foster().
+     * Context: System transaction.
+     * @param[in] real_parent node page that has both children, EX-latched
+     * @param[in] left_child left sibling without foster child, EX-latched
+     * @param[in] right_child child right after left_child in real_parent,
+     * without foster child, EX-latched
+     */
+    static rc_t _sx_deadopt_foster(btree_page_h &real_parent, btree_page_h &left_child,
+                                   btree_page_h &right_child);
 
     /**
-     * @see _sx_defrag_tree()
+     * @see _sx_deadopt_foster()
      */
-    static rc_t                        _ux_defrag_tree_core(
-        StoreID store,
-        uint16_t inpage_defrag_ghost_threshold,
-        uint16_t inpage_defrag_usage_threshold,
-        bool does_adopt,
-        bool does_merge);
+    static rc_t _ux_deadopt_foster_core(btree_page_h &real_parent, btree_page_h &left_child,
+                                        btree_page_h &right_child);
+
+    /** Applies the changes of one de-adopt on the real parent. Used by REDO too. */
+    static void _ux_deadopt_foster_apply_real_parent(btree_page_h &real_parent,
+                                                     const w_keystr_t &low_key);
+    /** Applies the changes of one de-adopt on the new foster parent. Used by REDO too. */
+    static void _ux_deadopt_foster_apply_foster_parent(btree_page_h &foster_parent,
+        PageID deadopted_pid, lsn_t deadopted_emlsn,
+        const w_keystr_t &low_key, const w_keystr_t &high_key);
+
+    /**
+     * \brief Merges a foster child into its foster parent.
+     * \details
+     * All records of the foster child are moved to the foster parent, which
+     * takes over the high fence and the foster child (if any) of the merged
+     * page. The new image of the foster parent is logged as one
+     * page_img_format log record, so there is no write-order dependency.
+     * The foster child is then deallocated; as nothing points to it any more,
+     * it is left with an empty key range so that a cursor which still has
+     * it pinned re-traverses.
+     * Context: System transaction.
+     * @param[in] foster_parent leaf page, EX-latched
+     * @param[in] foster_child leaf page, the foster child of foster_parent, EX-latched.
+     * Unfixed on success.
+     * @pre both pages fit together in one page
+     * @pre the pointer to foster_child is not swizzled, see bf_tree_m::unswizzle()
+     */
+    static rc_t _sx_merge_foster(btree_page_h &foster_parent, btree_page_h &foster_child);
+
+    /**
+     * @see _sx_merge_foster()
+     */
+    static rc_t _ux_merge_foster_core(btree_page_h &foster_parent, btree_page_h &foster_child);
 
     /**
      * \brief Defrags the given page to remove holes and ghost records in the page.
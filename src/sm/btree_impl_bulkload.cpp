@@ -0,0 +1,532 @@
+/*
+ * (c) Copyright 2011-2014, Hewlett-Packard Development Company, LP
+ */
+
+#include "w_defines.h"
+
+/**
+ * Implementation of bulk loading functions in btree_impl.h and of
+ * bulk_load_sorter in btree_bulk_load.h.
+ * Separated from btree_impl.cpp.
+ */
+
+#define SM_SOURCE
+#define BTREE_C
+
+#include "sm_base.h"
+#include "btree_page_h.h"
+#include "btree_impl.h"
+#include "btree_bulk_load.h"
+#include "w_key.h"
+#include "xct.h"
+#include "bf_tree.h"
+#include "vol.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+/** The page being filled at one level of the tree during a bulk load. */
+struct bulk_level_t {
+    /** In-memory image of the page; installed in the buffer pool once full. */
+    generic_page buffer;
+    btree_page_h page;
+    w_keystr_t   fence_low;
+};
+
+/** A record moved from a full page to the next one of its level. */
+struct bulk_moved_rec_t {
+    w_keystr_t  key;
+    std::string elem;        // leaf only
+    PageID      child;       // node only
+    lsn_t       child_emlsn; // node only
+};
+
+/**
+ * Builds a B-tree from sorted entries, keeping the right-most page of each
+ * level in memory.  Whenever a page is full, it is written to a newly
+ * allocated page with the next key as high fence, its low fence is added
+ * as separator to the level above, and the level starts over with a new page.
+ * Like splits, leaves use the shortest separator between their last and the
+ * next key instead of the whole next key (suffix truncation).
+ */
+class bulk_builder_t {
+public:
+    bulk_builder_t(btree_page_h& root) : _root(root) {}
+
+    rc_t add(const w_keystr_t& key, const cvec_t& elem);
+    rc_t finish();
+    /**
+     * Deallocates the pages written out so far, which nothing points to
+     * until finish() installs the top level in the root.  Called if the
+     * load fails before that.
+     */
+    rc_t abort();
+
+private:
+    /** Starts a new in-memory page at the given level (0 = leaf). */
+    rc_t _start_page(size_t level, const w_keystr_t& fence_low,
+                     PageID pid0, const lsn_t& pid0_emlsn);
+    /**
+     * Writes out the page of the given level with the given high fence
+     * and adds it to its parent.  If the page is too full for the high
+     * fence, its last records are removed and returned in moved instead,
+     * and the first of them becomes the high fence.  Returns the high fence
+     * actually used, which is shortened for leaves, in fence_high.
+     */
+    rc_t _close_page(size_t level, w_keystr_t& fence_high,
+                     std::vector<bulk_moved_rec_t>& moved);
+    /**
+     * Closes the page of the given level with key as high fence and
+     * starts the next one.  For nodes, child becomes pid0 of the next page
+     * (consumed) unless records had to be moved there.
+     */
+    rc_t _next_page(size_t level, const w_keystr_t& key,
+                    PageID child, const lsn_t& child_emlsn, bool& consumed);
+    /** Adds a child, whose low fence is key, to the page of the given level. */
+    rc_t _add_child(size_t level, const w_keystr_t& key,
+                    PageID child, const lsn_t& child_emlsn);
+
+    btree_page_h&                              _root;
+    std::vector<std::unique_ptr<bulk_level_t>> _levels;
+    /** Last key added, to check the input is sorted. */
+    w_keystr_t                                 _last_key;
+    /** Pages allocated by _close_page(), each in its own system transaction. */
+    std::vector<PageID>                        _allocated;
+};
+
+rc_t bulk_builder_t::add(const w_keystr_t& key, const cvec_t& elem)
+{
+    if (_levels.empty()) {
+        w_keystr_t infimum;
+        infimum.construct_neginfkey();
+        W_DO(_start_page(0, infimum, 0, lsn_t::null));
+    }
+
+    if (_last_key.is_constructed()) {
+        int d = key.compare(_last_key);
+        if (d == 0) {
+            return RC(eDUPLICATE);
+        } else if (d < 0) {
+            return RC(eBADARGUMENT);
+        }
+    }
+    _last_key = key;
+
+    // the in-memory page has no prefix, so the key fits at least as well
+    // once the page gets its actual fence keys
+    btree_page_h& leaf = _levels[0]->page;
+    while (!leaf.check_space_for_insert_leaf(key.get_length_as_keystr(), elem.size())) {
+        if (leaf.nrecs() == 0) {
+            return RC(eRECWONTFIT);
+        }
+        bool consumed;
+        W_DO(_next_page(0, key, 0, lsn_t::null, consumed));
+    }
+    leaf.insert_nonghost(key, elem);
+    return RCOK;
+}
+
+rc_t bulk_builder_t::finish()
+{
+    if (_levels.empty()) {
+        return RCOK; // no entries, the tree stays empty
+    }
+
+    w_keystr_t infimum, supremum, dummy_chain_high;
+    infimum.construct_neginfkey();
+    supremum.construct_posinfkey();
+
+    // closing a level might add another one above, so re-check the size
+    for (size_t level = 0; level + 1 < _levels.size(); ++level) {
+        std::vector<bulk_moved_rec_t> moved;
+        W_DO(_close_page(level, supremum, moved));
+        w_assert0(moved.empty()); // the pages already have supremum as high fence
+    }
+
+    // the top level has a single page, which becomes the root
+    btree_page_h& top = _levels.back()->page;
+    // page_img_format is not a single-log SSX record
+    sys_xct_section_t sxs;
+    W_DO(sxs.check_error_on_start());
+    rc_t ret = _root.format_steal(_root.get_page_lsn(), _root.pid(), _root.store(),
+                                  _root.pid(), // root page id is not changed.
+                                  top.level(),
+                                  top.pid0(), top.get_pid0_emlsn(),
+                                  0, lsn_t::null, // no foster
+                                  infimum, supremum, dummy_chain_high,
+                                  true, // log it
+                                  &top, 0, top.nrecs());
+    W_DO(sxs.end_sys_xct(ret));
+    INC_TSTAT(bt_bulkload_pages);
+    _allocated.clear(); // reachable from the root now
+    return RCOK;
+}
+
+rc_t bulk_builder_t::abort()
+{
+    for (size_t i = 0; i < _allocated.size(); ++i) {
+        W_DO(smlevel_0::vol->deallocate_page(_allocated[i]));
+    }
+    _allocated.clear();
+    return RCOK;
+}
+
+rc_t bulk_builder_t::_start_page(size_t level, const w_keystr_t& fence_low,
+                                 PageID pid0, const lsn_t& pid0_emlsn)
+{
+    if (_levels.size() <= level) {
+        w_assert1(_levels.size() == level);
+        _levels.emplace_back(new bulk_level_t);
+        _levels.back()->page.fix_nonbufferpool_page(&_levels.back()->buffer);
+    }
+    bulk_level_t& l = *_levels[level];
+    l.fence_low = fence_low;
+
+    w_keystr_t supremum, dummy_chain_high;
+    supremum.construct_posinfkey();
+    // "stealing" no records from the root gives it the poor man's key width of the tree
+    W_DO(l.page.format_steal(lsn_t::null, 0, _root.store(), _root.pid(),
+                             level + 1, pid0, pid0_emlsn,
+                             0, lsn_t::null, // no foster
+                             fence_low, supremum, dummy_chain_high,
+                             false, // not a real page; logged when written out
+                             &_root, 0, 0));
+    return RCOK;
+}
+
+rc_t bulk_builder_t::_close_page(size_t level, w_keystr_t& fence_high,
+                                 std::vector<bulk_moved_rec_t>& moved)
+{
+    bulk_level_t& l = *_levels[level];
+
+    // the high fence makes the fence record longer by at most its length
+    w_keystr_t& high = fence_high;
+    while (true) {
+        if (l.page.is_leaf() && l.page.nrecs() > 0 && !high.is_posinf()) {
+            // take common leading bytes +1 from the next key, as in
+            // btree_page_h::suggest_fence_for_split().  Nodes can't do this,
+            // their fences must be the same as those of their children.
+            w_keystr_t last, separator;
+            l.page.get_key(l.page.nrecs() - 1, last);
+            size_t common_bytes = last.common_leading_bytes(high);
+            w_assert1(common_bytes < high.get_length_as_keystr());
+            separator.construct_from_keystr(high.buffer_as_keystr(), common_bytes + 1);
+            high = separator;
+        }
+        if (l.page.is_leaf() ? l.page.check_space_for_insert_leaf(high.get_length_as_keystr(), 0)
+                             : l.page.check_space_for_insert_node(high)) {
+            break;
+        }
+        int last = l.page.nrecs() - 1;
+        if (last <= 0) {
+            return RC(eRECWONTFIT);
+        }
+        btrec_t rec(l.page, last);
+        bulk_moved_rec_t m;
+        m.key = rec.key();
+        if (l.page.is_leaf()) {
+            m.elem.resize(rec.elen());
+            rec.elem().copy_to(&m.elem[0], rec.elen());
+            m.child = 0;
+        } else {
+            m.child = rec.child();
+            m.child_emlsn = rec.child_emlsn();
+        }
+        moved.insert(moved.begin(), m);
+        l.page.delete_range(last, last + 1);
+        high = m.key;
+    }
+
+    PageID new_pid;
+    W_DO(smlevel_0::vol->alloc_a_page(new_pid, _root.store()));
+    _allocated.push_back(new_pid);
+    btree_page_h new_page;
+    W_DO(new_page.fix_direct(new_pid, LATCH_EX, false, true));
+
+    // copy the in-memory page with its final high fence, which may make
+    // the prefix longer and the records shorter
+    w_keystr_t dummy_chain_high;
+    {
+        sys_xct_section_t sxs;
+        W_DO(sxs.check_error_on_start());
+        rc_t ret = new_page.format_steal(new_page.get_page_lsn(), new_pid, _root.store(),
+                                         _root.pid(), l.page.level(),
+                                         l.page.pid0(), l.page.get_pid0_emlsn(),
+                                         0, lsn_t::null, // no foster
+                                         l.fence_low, high, dummy_chain_high,
+                                         true, // log it
+                                         &l.page, 0, l.page.nrecs());
+        W_DO(sxs.end_sys_xct(ret));
+    }
+    w_assert3(new_page.is_consistent(true, true));
+    lsn_t new_emlsn = new_page.get_page_lsn();
+    new_page.unfix();
+    INC_TSTAT(bt_bulkload_pages);
+
+    return _add_child(level + 1, l.fence_low, new_pid, new_emlsn);
+}
+
+rc_t bulk_builder_t::_next_page(size_t level, const w_keystr_t& key,
+                                PageID child, const lsn_t& child_emlsn, bool& consumed)
+{
+    std::vector<bulk_moved_rec_t> moved;
+    w_keystr_t fence = key;
+    W_DO(_close_page(level, fence, moved));
+
+    bool leaf = (level == 0);
+    consumed = !leaf && moved.empty();
+    if (moved.empty()) {
+        return _start_page(level, fence, child, child_emlsn);
+    }
+
+    // a moved child of a node becomes pid0, moved leaf records stay records
+    W_DO(_start_page(level, fence, moved[0].child, moved[0].child_emlsn));
+    btree_page_h& page = _levels[level]->page;
+    for (size_t i = (leaf ? 0 : 1); i < moved.size(); ++i) {
+        if (leaf) {
+            page.insert_nonghost(moved[i].key,
+                                 cvec_t(moved[i].elem.data(), moved[i].elem.size()));
+        } else {
+            W_DO(page.insert_node(moved[i].key, page.nrecs(),
+                                  moved[i].child, moved[i].child_emlsn));
+        }
+    }
+    return RCOK;
+}
+
+rc_t bulk_builder_t::_add_child(size_t level, const w_keystr_t& key,
+                                PageID child, const lsn_t& child_emlsn)
+{
+    if (_levels.size() == level) {
+        // first (left-most) page of its level, which becomes pid0 of a new level
+        w_assert1(key.is_neginf());
+        return _start_page(level, key, child, child_emlsn);
+    }
+
+    btree_page_h& node = _levels[level]->page;
+    while (!node.check_space_for_insert_node(key)) {
+        if (node.nrecs() == 0) {
+            return RC(eRECWONTFIT);
+        }
+        bool consumed;
+        W_DO(_next_page(level, key, child, child_emlsn, consumed));
+        if (consumed) {
+            return RCOK;
+        }
+    }
+    return node.insert_node(key, node.nrecs(), child, child_emlsn);
+}
+
+/** Feeds all entries of iter to the builder and finishes the tree. */
+rc_t bulk_build(bulk_builder_t& builder, bulk_load_iterator& iter, uint64_t& count)
+{
+    w_keystr_t key;
+    std::string elem;
+    while (true) {
+        bool eof;
+        W_DO(iter.next(key, elem, eof));
+        if (eof) {
+            break;
+        }
+        if (key.get_length_as_nonkeystr() + elem.size() > btree_page_h::max_entry_size) {
+            return RC(eRECWONTFIT);
+        }
+        W_DO(builder.add(key, cvec_t(elem.data(), elem.size())));
+        ++count;
+    }
+    return builder.finish();
+}
+
+} // anonymous namespace
+
+rc_t btree_impl::_ux_bulk_load(StoreID store, bulk_load_iterator& iter, uint64_t& count)
+{
+    count = 0;
+
+    btree_page_h root;
+    W_DO(root.fix_root(store, LATCH_EX));
+    if (root.nrecs() > 0 || !root.is_leaf() || root.get_foster() != 0) {
+        return RC(eNDXNOTEMPTY);
+    }
+
+    bulk_builder_t builder(root);
+    rc_t rc = bulk_build(builder, iter, count);
+    if (rc.is_error()) {
+        // leave the index empty rather than leaking the pages written so far
+        W_DO(builder.abort());
+        count = 0;
+        return rc;
+    }
+
+    w_assert3(root.is_consistent(true, true));
+    DBG1(<< "Bulk loaded " << count << " entries into store " << store);
+    return RCOK;
+}
+
+bulk_load_sorter::bulk_load_sorter(size_t memory_limit)
+    : _memory_limit(memory_limit), _buffered_bytes(0), _count(0),
+      _merging(false), _buffer_pos(0)
+{
+}
+
+bulk_load_sorter::~bulk_load_sorter()
+{
+    for (size_t i = 0; i < _runs.size(); ++i) {
+        ::fclose(_runs[i].file);
+    }
+}
+
+rc_t bulk_load_sorter::add(const w_keystr_t& key, const cvec_t& elem)
+{
+    w_assert1(!_merging);
+    entry_t e;
+    e.key.assign(reinterpret_cast<const char*>(key.buffer_as_keystr()),
+                 key.get_length_as_keystr());
+    e.elem.resize(elem.size());
+    if (elem.size() > 0) {
+        elem.copy_to(&e.elem[0], elem.size());
+    }
+    _buffered_bytes += sizeof(entry_t) + e.key.size() + e.elem.size();
+    _buffer.push_back(std::move(e));
+    ++_count;
+
+    if (_buffered_bytes >= _memory_limit) {
+        W_DO(_spill());
+    }
+    return RCOK;
+}
+
+rc_t bulk_load_sorter::add_all(bulk_load_iterator& iter)
+{
+    w_keystr_t key;
+    std::string elem;
+    while (true) {
+        bool eof;
+        W_DO(iter.next(key, elem, eof));
+        if (eof) {
+            return RCOK;
+        }
+        W_DO(add(key, cvec_t(elem.data(), elem.size())));
+    }
+}
+
+rc_t bulk_load_sorter::next(w_keystr_t& key, std::string& elem, bool& eof)
+{
+    if (!_merging) {
+        W_DO(_start_merge());
+    }
+
+    if (_runs.empty()) {
+        // everything fit in memory
+        eof = (_buffer_pos == _buffer.size());
+        if (!eof) {
+            entry_t& e = _buffer[_buffer_pos++];
+            key.construct_from_keystr(e.key.data(), e.key.size());
+            elem.swap(e.elem);
+        }
+        return RCOK;
+    }
+
+    eof = _heap.empty();
+    if (eof) {
+        return RCOK;
+    }
+    auto run_greater = [this](size_t a, size_t b) {
+        return _runs[a].head.key > _runs[b].head.key;
+    };
+    std::pop_heap(_heap.begin(), _heap.end(), run_greater);
+    run_t& run = _runs[_heap.back()];
+    key.construct_from_keystr(run.head.key.data(), run.head.key.size());
+    elem.swap(run.head.elem);
+    W_DO(_read_entry(run.file, run.head, run.eof));
+    if (run.eof) {
+        _heap.pop_back();
+    } else {
+        std::push_heap(_heap.begin(), _heap.end(), run_greater);
+    }
+    return RCOK;
+}
+
+rc_t bulk_load_sorter::_spill()
+{
+    std::sort(_buffer.begin(), _buffer.end(),
+              [](const entry_t& a, const entry_t& b) { return a.key < b.key; });
+
+    FILE* file = std::tmpfile();
+    if (file == NULL) {
+        return RC(eOS);
+    }
+    run_t run;
+    run.file = file;
+    run.eof = false;
+    _runs.push_back(run);
+
+    for (size_t i = 0; i < _buffer.size(); ++i) {
+        W_DO(_write_entry(file, _buffer[i]));
+    }
+    if (::fflush(file) != 0 || ::fseek(file, 0, SEEK_SET) != 0) {
+        return RC(eOS);
+    }
+
+    _buffer.clear();
+    _buffered_bytes = 0;
+    return RCOK;
+}
+
+rc_t bulk_load_sorter::_start_merge()
+{
+    _merging = true;
+    if (_runs.empty()) {
+        std::sort(_buffer.begin(), _buffer.end(),
+                  [](const entry_t& a, const entry_t& b) { return a.key < b.key; });
+        _buffer_pos = 0;
+        return RCOK;
+    }
+
+    // spill the remainder so that all entries are merged the same way
+    if (!_buffer.empty()) {
+        W_DO(_spill());
+    }
+    std::vector<entry_t>().swap(_buffer);
+
+    for (size_t i = 0; i < _runs.size(); ++i) {
+        W_DO(_read_entry(_runs[i].file, _runs[i].head, _runs[i].eof));
+        if (!_runs[i].eof) {
+            _heap.push_back(i);
+        }
+    }
+    std::make_heap(_heap.begin(), _heap.end(), [this](size_t a, size_t b) {
+        return _runs[a].head.key > _runs[b].head.key;
+    });
+    return RCOK;
+}
+
+rc_t bulk_load_sorter::_write_entry(FILE* file, const entry_t& e)
+{
+    uint32_t lengths[2] = { (uint32_t) e.key.size(), (uint32_t) e.elem.size() };
+    if (::fwrite(lengths, sizeof(lengths), 1, file) != 1
+        || ::fwrite(e.key.data(), 1, e.key.size(), file) != e.key.size()
+        || ::fwrite(e.elem.data(), 1, e.elem.size(), file) != e.elem.size()) {
+        return RC(eOS);
+    }
+    return RCOK;
+}
+
+rc_t bulk_load_sorter::_read_entry(FILE* file, entry_t& e, bool& eof)
+{
+    uint32_t lengths[2];
+    if (::fread(lengths, sizeof(lengths), 1, file) != 1) {
+        eof = true;
+        return ::ferror(file) ? RC(eOS) : RCOK;
+    }
+    eof = false;
+    e.key.resize(lengths[0]);
+    e.elem.resize(lengths[1]);
+    if ((lengths[0] > 0 && ::fread(&e.key[0], 1, lengths[0], file) != lengths[0])
+        || (lengths[1] > 0 && ::fread(&e.elem[0], 1, lengths[1], file) != lengths[1])) {
+        return RC(eOS);
+    }
+    return RCOK;
+}
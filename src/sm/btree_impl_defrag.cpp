@@ -18,37 +18,541 @@
 #include "btree_impl.h"
 #include "w_key.h"
 #include "xct.h"
+#include "bf_tree.h"
+#include "vol.h"
+#include "log_core.h"
+#include "xct_logger.h"
 
-rc_t btree_impl::_sx_defrag_tree(
+namespace {
+
+/**
+ * Space the merge of two neighboring pages would use, including the longer
+ * keys of records that lose part of their prefix because the merged page
+ * has a wider key range.
+ */
+size_t merged_used_space(const btree_page_h& left, const btree_page_h& right)
+{
+    w_keystr_t fence_low, fence_high;
+    left.copy_fence_low_key(fence_low);
+    right.copy_fence_high_key(fence_high);
+    size_t prefix_len = fence_low.common_leading_bytes(fence_high);
+    size_t left_prefix_len = left.get_prefix_length();
+    size_t right_prefix_len = right.get_prefix_length();
+    size_t used = left.used_space() + right.used_space();
+    if (left_prefix_len > prefix_len) {
+        // each record may also need one more alignment unit
+        used += (left_prefix_len - prefix_len + 8) * left.nrecs();
+    }
+    if (right_prefix_len > prefix_len) {
+        used += (right_prefix_len - prefix_len + 8) * right.nrecs();
+    }
+    return used;
+}
+
+/**
+ * One opportunistic walk over a B-tree for btree_impl::_ux_defrag_tree().
+ *
+ * The walk goes from left to right over the nodes right above the leaves.
+ * Each of them is reached by a traversal from the root with latch coupling,
+ * so that at most three pages are latched at any time, and the walk key is
+ * then moved to its high fence.  An upper node is restructured when the
+ * walk key reaches its low fence, i.e., the first time a traversal passes
+ * through it.  Latches are upgraded (conditionally) only to modify a page,
+ * and pages that cannot be latched immediately are skipped.
+ */
+class defrag_walk_t {
+public:
+    defrag_walk_t(uint16_t ghost_threshold, uint16_t usage_threshold,
+                  bool does_adopt, bool does_merge, size_t* io_budget)
+        : _ghost_threshold(ghost_threshold), _usage_threshold(usage_threshold),
+          _does_adopt(does_adopt), _does_merge(does_merge),
+          _io_budget(io_budget), _stopped(false)
+    {
+        _oldest_active_lsn = _compute_oldest_active_lsn();
+    }
+
+    /**
+     * Walks the tree from the given key on.  When the budget runs out, key
+     * is where the walk stopped; otherwise it is cleared.
+     */
+    rc_t run(StoreID store, w_keystr_t& key);
+
+private:
+    /**
+     * Traverses from the root to the lowest node above the leaves (or the
+     * root leaf) that contains key.  Sets restart if a page on the way was
+     * split by an adoption and the traversal has to start over.
+     */
+    rc_t _traverse(StoreID store, const w_keystr_t& key, btree_page_h& page,
+                   bool& restart);
+    /** Merges, adopts and defrags the children of the given node. */
+    rc_t _restructure(btree_page_h& node);
+    /** Merges the given leaf child with its foster children and right sibling. */
+    rc_t _merge_leaves(btree_page_h& node, slotid_t slot, btree_page_h& child);
+    /** Adopts the foster child of the given child into node. */
+    rc_t _adopt(btree_page_h& node, btree_page_h& child);
+    /** Reclaims ghost records of the given leaf if it crosses the thresholds. */
+    rc_t _defrag_leaf(btree_page_h& leaf);
+
+    /**
+     * Fixes the given child in SH mode, reading it from disk only if the
+     * budget allows.  fixed is false if the page was skipped.
+     */
+    rc_t _fix_child(btree_page_h& parent, PageID pid_opaqueptr, bool conditional,
+                    btree_page_h& child, bool& fixed);
+    /** Consumes one page of the I/O budget; false if none is left. */
+    bool _charge();
+    /** Whether two neighboring leaves are underfull enough to be merged. */
+    bool _should_merge(const btree_page_h& left, const btree_page_h& right) const;
+
+    /** LSN before which no active transaction has logged anything. */
+    static lsn_t _compute_oldest_active_lsn();
+
+    uint16_t    _ghost_threshold;
+    uint16_t    _usage_threshold;
+    bool        _does_adopt;
+    bool        _does_merge;
+    size_t*     _io_budget;
+    bool        _stopped;
+    /** Ghosts of pages that were not updated since then can be reclaimed. */
+    lsn_t       _oldest_active_lsn;
+};
+
+rc_t defrag_walk_t::run(StoreID store, w_keystr_t& key)
+{
+    if (!key.is_constructed()) {
+        key.construct_neginfkey();
+    }
+    while (!_stopped) {
+        btree_page_h page;
+        bool restart;
+        W_DO(_traverse(store, key, page, restart));
+        if (restart || _stopped) {
+            continue;
+        }
+
+        INC_TSTAT(bt_maint_pages_visited);
+        if (page.is_leaf()) {
+            W_DO(_defrag_leaf(page));
+        } else {
+            W_DO(_restructure(page));
+        }
+        if (_stopped) {
+            break;
+        }
+        if (page.is_fence_high_supremum()) {
+            key.clear();
+            return RCOK;
+        }
+        // next node (possibly the foster child of this one)
+        page.copy_fence_high_key(key);
+    }
+    INC_TSTAT(bt_maint_budget_exhausted);
+    return RCOK;
+}
+
+rc_t defrag_walk_t::_traverse(StoreID store, const w_keystr_t& key,
+                              btree_page_h& page, bool& restart)
+{
+    restart = false;
+    W_DO(page.fix_root(store, LATCH_SH));
+    if (_does_adopt && page.get_foster() != 0 && _charge()
+        && page.upgrade_latch_conditional()) {
+        // the root cannot be adopted; give it a new level instead
+        W_DO(btree_impl::_sx_grow_tree(page));
+        INC_TSTAT(bt_maint_adopts);
+    }
+
+    while (true) {
+        if (!page.fence_contains(key) && page.get_foster() != 0) {
+            btree_page_h foster;
+            bool fixed;
+            W_DO(_fix_child(page, page.get_foster_opaqueptr(), false, foster, fixed));
+            if (!fixed) {
+                return RCOK; // out of budget
+            }
+            page = foster;
+            continue;
+        }
+        if (page.level() <= 2) {
+            return RCOK;
+        }
+
+        if (page.compare_with_fence_low(key) == 0) {
+            PageID pid = page.pid();
+            INC_TSTAT(bt_maint_pages_visited);
+            W_DO(_restructure(page));
+            if (_stopped) {
+                return RCOK;
+            }
+            if (page.pid() != pid) {
+                // split by an adoption; the key may be elsewhere now
+                restart = true;
+                return RCOK;
+            }
+        }
+
+        slotid_t slot;
+        page.search_node(key, slot);
+        btree_page_h child;
+        bool fixed;
+        W_DO(_fix_child(page, slot == -1 ? page.pid0_opaqueptr() : page.child_opaqueptr(slot),
+                        false, child, fixed));
+        if (!fixed) {
+            return RCOK; // out of budget
+        }
+        page = child;
+    }
+}
+
+rc_t defrag_walk_t::_restructure(btree_page_h& node)
+{
+    w_assert1(node.is_node());
+    for (slotid_t i = -1; i < node.nrecs() && !_stopped; ++i) {
+        PageID pid_opaqueptr = i == -1 ? node.pid0_opaqueptr() : node.child_opaqueptr(i);
+        btree_page_h child;
+        bool fixed;
+        W_DO(_fix_child(node, pid_opaqueptr, true, child, fixed));
+        if (!fixed) {
+            continue;
+        }
+        if (child.is_leaf()) {
+            INC_TSTAT(bt_maint_pages_visited);
+            W_DO(_defrag_leaf(child));
+            if (_does_merge) {
+                W_DO(_merge_leaves(node, i, child));
+            }
+        }
+        if (_does_adopt && !_stopped && child.get_foster() != 0) {
+            PageID pid = node.pid();
+            W_DO(_adopt(node, child));
+            if (node.pid() != pid) {
+                // node was split and now is its new foster child, which
+                // will be restructured when the walk gets there
+                return RCOK;
+            }
+        }
+    }
+    return RCOK;
+}
+
+rc_t defrag_walk_t::_merge_leaves(btree_page_h& node, slotid_t slot, btree_page_h& child)
+{
+    // merge foster children, which need no change in the parent
+    while (!_stopped && child.get_foster() != 0) {
+        btree_page_h foster;
+        bool fixed;
+        W_DO(_fix_child(child, child.get_foster_opaqueptr(), true, foster, fixed));
+        if (!fixed || !foster.is_leaf()) {
+            break;
+        }
+        W_DO(_defrag_leaf(foster));
+        if (!_should_merge(child, foster) || !_charge()) {
+            break;
+        }
+        if (!child.upgrade_latch_conditional() || !foster.upgrade_latch_conditional()) {
+            break;
+        }
+        // the merged-away page must not be referenced by its frame anymore
+        smlevel_0::bf->unswizzle(child.get_generic_page(), GeneralRecordIds::FOSTER_CHILD);
+        W_DO(btree_impl::_sx_merge_foster(child, foster));
+        INC_TSTAT(bt_maint_merges);
+    }
+
+    // merge the right sibling, which first becomes the foster child
+    while (!_stopped && child.get_foster() == 0 && slot + 1 < node.nrecs()) {
+        btree_page_h right;
+        bool fixed;
+        W_DO(_fix_child(node, node.child_opaqueptr(slot + 1), true, right, fixed));
+        if (!fixed || right.get_foster() != 0 || !right.is_leaf()) {
+            break;
+        }
+        // its ghosts would otherwise count as used space
+        W_DO(_defrag_leaf(right));
+        if (!_should_merge(child, right) || !_charge()) {
+            break;
+        }
+        if (!node.upgrade_latch_conditional() || !child.upgrade_latch_conditional()
+            || !right.upgrade_latch_conditional()) {
+            break;
+        }
+        smlevel_0::bf->unswizzle(node.get_generic_page(), slot + 2); // general recordid of slot+1
+        W_DO(btree_impl::_sx_deadopt_foster(node, child, right));
+        W_DO(btree_impl::_sx_merge_foster(child, right));
+        INC_TSTAT(bt_maint_merges);
+    }
+    return RCOK;
+}
+
+rc_t defrag_walk_t::_adopt(btree_page_h& node, btree_page_h& child)
+{
+    if (!_charge()) {
+        return RCOK;
+    }
+    if (!node.upgrade_latch_conditional() || !child.upgrade_latch_conditional()) {
+        return RCOK; // no hurry
+    }
+    W_DO(btree_impl::_sx_adopt_foster(node, child));
+    INC_TSTAT(bt_maint_adopts);
+    return RCOK;
+}
+
+rc_t defrag_walk_t::_defrag_leaf(btree_page_h& leaf)
+{
+    w_assert1(leaf.is_leaf());
+    int ghosts = leaf.nghosts();
+    if (ghosts == 0 || ghosts * 100 < leaf.nrecs() * _ghost_threshold) {
+        return RCOK;
+    }
+    size_t capacity = leaf.used_space() + leaf.usable_space();
+    if (leaf.used_space() * 100 < capacity * _usage_threshold) {
+        return RCOK;
+    }
+    // ghosts of deletes that are not committed yet must stay for rollback
+    if (leaf.get_page_lsn() >= _oldest_active_lsn || !_charge()) {
+        return RCOK;
+    }
+    if (!leaf.upgrade_latch_conditional()) {
+        return RCOK;
+    }
+    W_DO(btree_impl::_sx_defrag_page(leaf));
+    INC_TSTAT(bt_maint_defrags);
+    ADD_TSTAT(bt_maint_ghosts_reclaimed, ghosts);
+    return RCOK;
+}
+
+rc_t defrag_walk_t::_fix_child(btree_page_h& parent, PageID pid_opaqueptr,
+                               bool conditional, btree_page_h& child, bool& fixed)
+{
+    fixed = false;
+    rc_t rc = child.fix_nonroot(parent, pid_opaqueptr, LATCH_SH, conditional,
+                                false /*virgin_page*/, true /*only_if_hit*/);
+    if (rc.is_error() && rc.err_num() == stINUSE) {
+        // not in the buffer pool; reading it counts against the budget
+        if (!_charge()) {
+            return RCOK;
+        }
+        rc = child.fix_nonroot(parent, pid_opaqueptr, LATCH_SH, conditional);
+    }
+    if (rc.is_error()) {
+        if (conditional) {
+            return RCOK; // skip it
+        }
+        return rc;
+    }
+    fixed = true;
+    return RCOK;
+}
+
+bool defrag_walk_t::_charge()
+{
+    if (_io_budget == NULL) {
+        return true;
+    }
+    if (*_io_budget == 0) {
+        _stopped = true;
+        return false;
+    }
+    --(*_io_budget);
+    return true;
+}
+
+bool defrag_walk_t::_should_merge(const btree_page_h& left, const btree_page_h& right) const
+{
+    w_assert1(left.is_leaf());
+    if (!right.is_leaf() || right.store() != left.store()) {
+        return false;
+    }
+    // with pointer swizzling, right's foster pointer would be taken over by
+    // left as it is, so left would reference a frame it did not swizzle
+    if (smlevel_0::bf->is_swizzled_pointer(right.get_foster_opaqueptr())) {
+        return false;
+    }
+    size_t capacity = left.used_space() + left.usable_space();
+    return merged_used_space(left, right) * 100 <= capacity * _usage_threshold;
+}
+
+lsn_t defrag_walk_t::_compute_oldest_active_lsn()
+{
+    lsn_t oldest = smlevel_0::log->curr_lsn();
+    xct_i iter(true); // lock the list
+    for (xct_t* xd = iter.next(); xd; xd = iter.next()) {
+        if (xd != xct() && xd->first_lsn().valid() && xd->first_lsn() < oldest) {
+            oldest = xd->first_lsn();
+        }
+    }
+    return oldest;
+}
+
+} // anonymous namespace
+
+rc_t btree_impl::_ux_defrag_tree(
     StoreID store,
     uint16_t inpage_defrag_ghost_threshold,
     uint16_t inpage_defrag_usage_threshold,
     bool does_adopt,
-    bool does_merge)
+    bool does_merge,
+    size_t* io_budget,
+    w_keystr_t* resume_key)
+{
+    w_keystr_t key;
+    if (resume_key) {
+        key = *resume_key;
+    }
+    defrag_walk_t walk(inpage_defrag_ghost_threshold, inpage_defrag_usage_threshold,
+                       does_adopt, does_merge, io_budget);
+    W_DO(walk.run(store, key));
+    if (resume_key) {
+        *resume_key = key;
+    }
+    return RCOK;
+}
+
+rc_t btree_impl::_sx_deadopt_foster(btree_page_h &real_parent, btree_page_h &left_child,
+                                    btree_page_h &right_child)
+{
+    sys_xct_section_t sxs(true);
+    W_DO(sxs.check_error_on_start());
+    rc_t ret = _ux_deadopt_foster_core(real_parent, left_child, right_child);
+    W_DO (sxs.end_sys_xct (ret));
+    return ret;
+}
+
+rc_t btree_impl::_ux_deadopt_foster_core(btree_page_h &real_parent,
+                                         btree_page_h &left_child,
+                                         btree_page_h &right_child)
+{
+    w_assert1 (xct()->is_single_log_sys_xct());
+    w_assert1 (real_parent.latch_mode() == LATCH_EX);
+    w_assert1 (real_parent.is_node());
+    w_assert1 (left_child.latch_mode() == LATCH_EX);
+    w_assert1 (right_child.latch_mode() == LATCH_EX);
+    w_assert1 (left_child.level() == right_child.level());
+
+    if (left_child.get_foster() != 0 || right_child.get_foster() != 0) {
+        return RC(eINTERNAL); // only leaves without foster chain
+    }
+
+    w_keystr_t low_key, high_key;
+    right_child.copy_fence_low_key(low_key);
+    right_child.copy_fence_high_key(high_key);
+    w_assert1(left_child.compare_with_fence_high(low_key) == 0);
+
+    bool found;
+    slotid_t slot;
+    real_parent.search(low_key, found, slot);
+    if (!found || real_parent.child(slot) != right_child.pid()) {
+        return RC(eINTERNAL);
+    }
+    // left child gets the chain-high fence
+    if (left_child.usable_space() < high_key.get_length_as_keystr()) {
+        return RC(eRECWONTFIT);
+    }
+
+    lsn_t child_emlsn = real_parent.get_emlsn_general(slot + 1);
+    Logger::log_p<btree_foster_deadopt_log> (&real_parent, &left_child,
+            right_child.pid(), child_emlsn, low_key, high_key);
+    _ux_deadopt_foster_apply_real_parent(real_parent, low_key);
+    _ux_deadopt_foster_apply_foster_parent(left_child, right_child.pid(), child_emlsn,
+                                           low_key, high_key);
+
+    // Switch parent of de-adopted child
+    smlevel_0::bf->switch_parent(right_child.pid(), left_child.get_generic_page());
+
+    w_assert3(real_parent.is_consistent(true, true));
+    w_assert3(left_child.is_consistent(true, true));
+    return RCOK;
+}
+
+void btree_impl::_ux_deadopt_foster_apply_real_parent(btree_page_h &real_parent,
+                                                      const w_keystr_t &low_key)
+{
+    w_assert1 (real_parent.is_fixed());
+    w_assert1 (real_parent.latch_mode() == LATCH_EX);
+    w_assert1 (real_parent.is_node());
+
+    bool found;
+    slotid_t slot;
+    real_parent.search(low_key, found, slot);
+    w_assert0(found);
+    W_COERCE(real_parent.remove_shift_nolog(slot));
+}
+
+void btree_impl::_ux_deadopt_foster_apply_foster_parent(btree_page_h &foster_parent,
+    PageID deadopted_pid, lsn_t deadopted_emlsn,
+    const w_keystr_t &low_key, const w_keystr_t &high_key)
+{
+    w_assert1 (foster_parent.is_fixed());
+    w_assert1 (foster_parent.latch_mode() == LATCH_EX);
+    w_assert1 (foster_parent.get_foster() == 0);
+
+    // fence-high (=low_key) and thus the prefix stay the same
+    w_keystr_t fence_low;
+    foster_parent.copy_fence_low_key(fence_low);
+    W_COERCE(foster_parent.replace_fence_rec_nolog_no_defrag(fence_low, low_key, high_key,
+                                                          foster_parent.get_prefix_length()));
+    foster_parent.page()->btree_foster = deadopted_pid;
+    foster_parent.set_emlsn_general(GeneralRecordIds::FOSTER_CHILD, deadopted_emlsn);
+}
+
+rc_t btree_impl::_sx_merge_foster(btree_page_h &foster_parent, btree_page_h &foster_child)
 {
     sys_xct_section_t sxs;
     W_DO(sxs.check_error_on_start());
-    rc_t ret = _ux_defrag_tree_core (store,
-        inpage_defrag_ghost_threshold,
-        inpage_defrag_usage_threshold,
-        does_adopt, does_merge
-    );
+    rc_t ret = _ux_merge_foster_core(foster_parent, foster_child);
     W_DO (sxs.end_sys_xct (ret));
     return ret;
 }
 
-rc_t btree_impl::_ux_defrag_tree_core(
-    StoreID store,
-    uint16_t /*inpage_defrag_ghost_threshold*/,
-    uint16_t /*inpage_defrag_usage_threshold*/,
-    bool /*does_adopt*/,
-    bool /*does_merge*/)
+rc_t btree_impl::_ux_merge_foster_core(btree_page_h &page, btree_page_h &foster_p)
 {
-    // TODO implement
-    // this should use the improved tree-walk-through jira ticket:60 "Tree walk-through without more than 2 pages latched" (originally trac ticket:62)
-    btree_page_h page;
-    W_DO (page.fix_root(store, LATCH_SH));
+    w_assert1 (xct()->is_sys_xct());
+    w_assert1 (page.latch_mode() == LATCH_EX);
+    w_assert1 (foster_p.latch_mode() == LATCH_EX);
+    w_assert1 (page.is_leaf());
+    w_assert1 (foster_p.is_leaf());
+    w_assert1 (page.get_foster() == foster_p.pid());
+    w_assert1 (!smlevel_0::bf->is_swizzled(foster_p.get_generic_page()));
+
+    if (merged_used_space(page, foster_p) > page.used_space() + page.usable_space()) {
+        return RC(eRECWONTFIT);
+    }
+
+    // page is formatted in place, so steal its own records from a copy
+    generic_page copy;
+    ::memcpy(&copy, page.get_generic_page(), sizeof(generic_page));
+    btree_page_h src;
+    src.fix_nonbufferpool_page(&copy);
+
+    w_keystr_t fence_low, fence_high, chain_high;
+    page.copy_fence_low_key(fence_low);
+    foster_p.copy_fence_high_key(fence_high);
+    PageID foster_pid = foster_p.pid();
+    PageID next_foster = foster_p.get_foster();
+    if (next_foster != 0) {
+        page.copy_chain_fence_high_key(chain_high);
+    }
+    W_DO(page.format_steal(page.get_page_lsn(), page.pid(), page.store(), page.root(),
+                           page.level(), 0, lsn_t::null, // leaf has no pid0
+                           foster_p.get_foster_opaqueptr(), foster_p.get_foster_emlsn(),
+                           fence_low, fence_high, chain_high,
+                           true, // log it to avoid write-order dependency
+                           &src, 0, src.nrecs(),
+                           &foster_p, 0, foster_p.nrecs()));
+    if (next_foster != 0) {
+        smlevel_0::bf->switch_parent(next_foster, page.get_generic_page());
+    }
+    w_assert3(page.is_consistent(true, true));
 
+    // Nothing points to the merged page any more. Give it an empty key range
+    // and a new LSN so that anyone who still has it pinned re-traverses.
+    w_keystr_t dummy_chain_high;
+    W_DO(foster_p.format_steal(page.get_page_lsn(), foster_pid, page.store(), page.root(),
+                               page.level(), 0, lsn_t::null, 0, lsn_t::null,
+                               fence_high, fence_high, dummy_chain_high,
+                               false)); // deallocated below, nothing to recover
+    foster_p.unfix(true /*evict*/);
+    W_DO(smlevel_0::vol->deallocate_page(foster_pid));
     return RCOK;
 }
 
@@ -17,7 +17,8 @@
 #include "xct.h"
 #include "vol.h"
 
-rc_t btree_impl::_ux_create_tree_core(const StoreID& stid, const PageID& root_pid)
+rc_t btree_impl::_ux_create_tree_core(const StoreID& stid, const PageID& root_pid,
+                                      int poor_key_width, bool compress_values)
 {
     w_assert1(root_pid != 0);
     w_assert1(stid != 0);
@@ -29,6 +30,9 @@ rc_t btree_impl::_ux_create_tree_core(const StoreID& stid, const PageID& root_pi
     supremum.construct_posinfkey();
     w_assert1(supremum.is_constructed());
     W_DO(page.fix_root(stid, LATCH_EX, false, true));
+    // all other pages of the tree inherit it (see btree_page_h::format_steal())
+    page.page()->set_poor_key_width(poor_key_width);
+    page.page()->set_compressed_values(compress_values);
     W_DO(page.format_steal(page.get_page_lsn(), root_pid, stid, root_pid,
                            1, // level=1. initial tree has only one level
                            0, lsn_t::null,// no pid0
@@ -22,6 +22,9 @@
 #include "xct.h"
 #include "w_okvl.h"
 #include "w_okvl_inl.h"
+#include "bf_tree.h"
+
+#include <algorithm>
 
 rc_t
 btree_impl::_ux_lookup(StoreID store, const w_keystr_t& key, bool& found,
@@ -39,13 +42,18 @@ btree_impl::_ux_lookup(StoreID store, const w_keystr_t& key, bool& found,
 rc_t
 btree_impl::_ux_lookup_core(StoreID store, const w_keystr_t& key,
                             bool& found, void* el, smsize_t& elen) {
-    bool need_lock     = g_xct_does_need_lock();
-    bool ex_for_select = g_xct_does_ex_lock_for_select();
-
     btree_page_h leaf; // first-leaf
 
     // find the leaf (potentially) containing the key
     W_DO(_ux_traverse(store, key, t_fence_contain, LATCH_SH, leaf));
+    return _ux_lookup_in_leaf(store, key, found, el, elen, leaf);
+}
+
+rc_t
+btree_impl::_ux_lookup_in_leaf(StoreID store, const w_keystr_t& key, bool& found,
+                               void* el, smsize_t& elen, btree_page_h& leaf) {
+    bool need_lock     = g_xct_does_need_lock();
+    bool ex_for_select = g_xct_does_ex_lock_for_select();
 
     w_assert1(leaf.is_fixed());
     w_assert1(leaf.is_leaf());
@@ -86,6 +94,115 @@ btree_impl::_ux_lookup_core(StoreID store, const w_keystr_t& key,
     return RCOK;
 }
 
+rc_t
+btree_impl::_ux_lookup_batch(StoreID store, size_t count, const w_keystr_t* keys,
+                             bool* found, void** els, smsize_t* elens, rc_t* results)
+{
+    std::vector<size_t> order;
+    _ux_batch_order(count, keys, order);
+
+    // prime the pipeline; afterwards each key prefetches for the key
+    // BATCH_PREFETCH_DISTANCE positions ahead
+    for (size_t i = 0; i < count && i < BATCH_PREFETCH_DISTANCE; ++i) {
+        _ux_prefetch_leaf(store, keys[order[i]]);
+    }
+
+    btree_page_h leaf;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t k = order[i];
+        const w_keystr_t& key = keys[k];
+        INC_TSTAT(bt_find_cnt);
+        INC_TSTAT(bt_batch_key_cnt);
+
+        rc_t rc;
+        while (true) {
+            if (leaf.is_fixed() && leaf.fence_contains(key)) {
+                INC_TSTAT(bt_batch_leaf_reuse_cnt);
+            } else {
+                leaf.unfix();
+                rc = _ux_traverse(store, key, t_fence_contain, LATCH_SH, leaf);
+                if (rc.is_error()) {
+                    break;
+                }
+            }
+            rc = _ux_lookup_in_leaf(store, key, found[k], els[k], elens[k], leaf);
+            if (rc.is_error() && rc.err_num() == eLOCKRETRY) {
+                leaf.unfix(); // the leaf might have changed while we waited
+                continue;
+            }
+            break;
+        }
+        if (rc.is_error() && rc.err_num() != eRECWONTFIT) {
+            leaf.unfix(); // don't trust the latch after other errors
+        }
+        results[k] = rc;
+
+        if (i + BATCH_PREFETCH_DISTANCE < count) {
+            const w_keystr_t& ahead = keys[order[i + BATCH_PREFETCH_DISTANCE]];
+            if (!leaf.is_fixed() || !leaf.fence_contains(ahead)) {
+                _ux_prefetch_leaf(store, ahead);
+            }
+        }
+    }
+    return RCOK;
+}
+
+void
+btree_impl::_ux_batch_order(size_t count, const w_keystr_t* keys, std::vector<size_t>& order)
+{
+    order.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    // stable, so that duplicate keys are processed in the given order
+    std::stable_sort(order.begin(), order.end(), [keys](size_t a, size_t b) {
+        return keys[a].compare(keys[b]) < 0;
+    });
+}
+
+void
+btree_impl::_ux_prefetch_leaf(StoreID store, const w_keystr_t& key)
+{
+    bf_tree_m& bf = *smlevel_0::bf;
+    bf_idx   idx;
+    uint32_t version;
+    if (!bf.optimistic_root(store, idx, version)) {
+        return;
+    }
+    // bounded, because without validation we might go in circles through reused frames
+    for (int depth = 0; depth < 32; ++depth) {
+        btree_page_h current;
+        current.fix_nonbufferpool_page(bf.get_page(idx));
+        PageID pid_to_follow_opaqueptr = current.search_node_optimistic(key);
+        if (pid_to_follow_opaqueptr == 0 || !bf.optimistic_validate(idx, version)) {
+            return; // current is a leaf (root) or was modified
+        }
+
+        bf_idx   next_idx;
+        uint32_t next_version;
+        if (!bf.optimistic_child(pid_to_follow_opaqueptr, next_idx, next_version)) {
+            return; // not cached: nothing to prefetch
+        }
+        btree_page_h next;
+        next.fix_nonbufferpool_page(bf.get_page(next_idx));
+        if (next.level() > 1) {
+            idx     = next_idx;
+            version = next_version;
+            continue;
+        }
+
+        // header and slot array of the page; a search then only misses
+        // on the few record bodies it compares with
+        const char* frame = reinterpret_cast<const char*>(bf.get_page(next_idx));
+        for (size_t offset = 0; offset < 4 * CACHELINE_SIZE; offset += CACHELINE_SIZE) {
+            __builtin_prefetch(frame + offset);
+        }
+        __builtin_prefetch(bf.get_cbp(next_idx));
+        INC_TSTAT(bt_batch_prefetch_cnt);
+        return;
+    }
+}
+
 rc_t
 btree_impl::_ux_traverse(StoreID store, const w_keystr_t &key,
                          traverse_mode_t traverse_mode, latch_mode_t leaf_latch_mode,
@@ -101,6 +218,17 @@ btree_impl::_ux_traverse(StoreID store, const w_keystr_t &key,
         w_assert1(traverse_mode != t_fence_low_match); // surely misuse
     }
 
+    if (traverse_mode == t_fence_contain && smlevel_0::bf->is_optimistic_inner()
+        && !(xct() != NULL && xct()->is_inquery_verify())) {
+        bool found;
+        W_DO(_ux_traverse_optimistic(store, key, leaf_latch_mode, leaf, found));
+        if (found) {
+            INC_TSTAT(bt_optimistic_traverse_cnt);
+            return RCOK;
+        }
+        INC_TSTAT(bt_optimistic_fallback_cnt);
+    }
+
     PageID leaf_pid_causing_failed_upgrade = 0;
     for (int times = 0; times < 20; ++times) { // arbitrary number
         inquery_verify_init(store); // initialize in-query verification
@@ -264,6 +392,74 @@ btree_impl::_ux_traverse_recurse(btree_page_h&                start,
     return RCOK;
 }
 
+rc_t
+btree_impl::_ux_traverse_optimistic(StoreID store, const w_keystr_t& key,
+                                    latch_mode_t leaf_latch_mode,
+                                    btree_page_h& leaf, bool& found)
+{
+    found = false;
+    leaf.unfix();
+    bf_tree_m& bf = *smlevel_0::bf;
+    for (int times = 0; times < 5; ++times) { // arbitrary number
+        bf_idx   idx;
+        uint32_t version;
+        if (!bf.optimistic_root(store, idx, version)) {
+            return RCOK;
+        }
+        while (true) {
+            btree_page_h current;
+            current.fix_nonbufferpool_page(bf.get_page(idx));
+            PageID pid_to_follow_opaqueptr = current.search_node_optimistic(key);
+            if (!bf.optimistic_validate(idx, version)) {
+                break; // restart
+            }
+            if (pid_to_follow_opaqueptr == 0) {
+                return RCOK; // current is a leaf (root) or not a foster-B-tree node
+            }
+
+            bf_idx   next_idx;
+            uint32_t next_version;
+            if (!bf.optimistic_child(pid_to_follow_opaqueptr, next_idx, next_version)) {
+                return RCOK; // not cached or being modified: let latches sort it out
+            }
+            // the child must be the one current still points to
+            if (!bf.optimistic_validate(idx, version)) {
+                break;
+            }
+
+            btree_page_h next;
+            next.fix_nonbufferpool_page(bf.get_page(next_idx));
+            if (next.level() > 1) {
+                idx     = next_idx;
+                version = next_version;
+                continue;
+            }
+
+            // Presumably the leaf: latch it and check that the frame still
+            // holds the page we followed (it may have been evicted and reused
+            // for a page of another store, even one with infinite fences) and
+            // that its fence keys contain the key
+            rc_t rc = leaf.fix_optimistic(next_idx, leaf_latch_mode);
+            if (rc.is_error()) {
+                if (rc.err_num() != stINUSE) {
+                    return rc;
+                }
+                break;
+            }
+            if (leaf.is_leaf() && leaf.store() == store
+                    && leaf.pid() == bf.normalize_pid(pid_to_follow_opaqueptr)
+                    && leaf.fence_contains(key)) {
+                found = true;
+                return RCOK;
+            }
+            leaf.unfix();
+            break;
+        }
+        INC_TSTAT(bt_optimistic_restart_cnt);
+    }
+    return RCOK;
+}
+
 void btree_impl::_ux_traverse_search(btree_impl::traverse_mode_t traverse_mode,
                                      btree_page_h *current,
                                      const w_keystr_t& key,
@@ -68,6 +68,8 @@ rc_t btree_impl::_ux_norec_alloc_core(btree_page_h &page, PageID &new_page_id) {
         << old_lsn << ", new-LSN=" << page.get_page_lsn() << ", PID=" << new_page_id);
 
     // initialize as an empty child:
+    new_page.page()->set_poor_key_width(page.get_poor_key_width());
+    new_page.page()->set_compressed_values(page.is_value_compressed());
     new_page.format_steal(page.get_page_lsn(), new_page_id, page.store(),
                           page.root(), page.level(), 0, lsn_t::null,
                           page.get_foster_opaqueptr(), page.get_foster_emlsn(),
@@ -122,13 +124,14 @@ rc_t btree_impl::_sx_split_foster(btree_page_h& page, PageID& new_page_id,
     w_keystr_t split_key;
     W_DO(new_page.format_foster_child(page, new_page_id, triggering_key, split_key,
             move_count));
-    w_assert0(move_count > 0);
+    // no record moves in a no-copy split at the right edge of a leaf
+    w_assert0(move_count > 0 || (page.is_leaf() && move_count == 0));
     // DBG5(<< "NEW FOSTER CHILD " << new_page);
 
     /*
      * Step 3: Delete moved records and update foster child pointer and high
-     * fence on overflowing page. Foster parent is not recompressed after
-     * moving records (CS TODO)
+     * fence on overflowing page. Foster parent is recompressed in step 6,
+     * after the split is committed.
      */
     page.delete_range(page.nrecs() - move_count, page.nrecs());
     // DBG5(<< "AFTER RANGE DELETE " << page);
@@ -172,8 +175,24 @@ rc_t btree_impl::_sx_split_foster(btree_page_h& page, PageID& new_page_id,
     // hint for subsequent accesses
     increase_forster_child(page.pid());
 
+    INC_TSTAT(bt_splits);
+
     W_DO (sxs.end_sys_xct (RCOK));
 
+    /*
+     * Step 6: The new high fence narrows the key range of the foster parent,
+     * so its remaining records may share a longer prefix now (the foster
+     * child got its prefix when it was formatted). Truncate it from all of
+     * them. Compression logs its own record in its own system transaction,
+     * so it must not run inside the single-log one of the split above.
+     */
+    w_keystr_t low;
+    page.copy_fence_low_key(low);
+    rc = page.compress(low, split_key, new_chain);
+    if (rc.is_error() && rc.err_num() != eCANTCOMPRESS) {
+        return rc;
+    }
+
     DBG1(<< "Split page " << page.pid() << " into " << new_page_id);
 
     return RCOK;
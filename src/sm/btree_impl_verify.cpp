@@ -21,6 +21,12 @@
 #include "xct.h"
 #include "sm_base.h"
 #include "bf_tree.h"
+#include "restart.h"
+#include "thread_wrapper.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
 
 // NOTE we don't know the level of root until we start, so just give "-1" as magic value for root level
 const int16_t NOCHECK_ROOT_LEVEL = -1;
@@ -175,6 +181,192 @@ rc_t btree_impl::_ux_verify_feed_page(
 }
 
 
+void btree_impl::_ux_collect_page_stats(btree_page_h &page, btree_stats_t &stats)
+{
+    if (page.is_leaf()) {
+        ++stats.leaf_pg_cnt;
+        W_COERCE(page.leaf_stats(stats.leaf_pg));
+    } else {
+        ++stats.int_pg_cnt;
+        W_COERCE(page.int_stats(stats.int_pg));
+    }
+}
+
+namespace {
+/**
+ * Runs one share of a parallel verification on its own thread.
+ */
+class verify_worker_t : public thread_wrapper_t {
+public:
+    verify_worker_t(const std::function<rc_t()> &work) : _work(work) {}
+    virtual void run() { _rc = _work(); }
+    const rc_t& get_rc() const { return _rc; }
+private:
+    std::function<rc_t()> _work;
+    rc_t _rc;
+};
+
+/**
+ * Runs the given function on the given number of threads (on the calling
+ * thread if threads <= 1) and returns the first error any of them returned.
+ */
+rc_t run_verify_workers(int threads, const std::function<rc_t(int)> &work)
+{
+    if (threads <= 1) {
+        return work(0);
+    }
+    std::vector<std::unique_ptr<verify_worker_t> > workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(new verify_worker_t([&work, i] { return work(i); }));
+        workers.back()->fork();
+    }
+    rc_t ret;
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->join();
+        if (workers[i]->get_rc().is_error() && !ret.is_error()) {
+            ret = workers[i]->get_rc();
+        }
+    }
+    return ret;
+}
+
+/** Whether the image of the given page on the volume misses updates restart has yet to redo. */
+bool needs_redo(PageID pid, const generic_page &image)
+{
+    if (smlevel_0::recovery) {
+        lsn_t expected_lsn = smlevel_0::recovery->get_dirty_page_emlsn(pid);
+        return !expected_lsn.is_null() && image.lsn < expected_lsn;
+    }
+    return false;
+}
+
+/**
+ * Latches pages that are in the bufferpool, and reads all other pages
+ * from the volume into a private frame so that they are not cached.
+ * Only pages that restart has yet to redo are fixed in the bufferpool,
+ * which recovers them.
+ */
+class uncached_page_reader {
+public:
+    rc_t fix(PageID pid, btree_page_h &page) {
+        rc_t rc = page.fix_direct(pid, LATCH_SH, false, false, true /*only_if_hit*/);
+        if (!rc.is_error()) {
+            return RCOK;
+        }
+        if (rc.err_num() != stINUSE) {
+            return rc;
+        }
+        W_DO(smlevel_0::vol->read_page(pid, &_frame));
+        if (needs_redo(pid, _frame)) {
+            return page.fix_direct(pid, LATCH_SH);
+        }
+        page.fix_nonbufferpool_page(&_frame);
+        return RCOK;
+    }
+private:
+    generic_page _frame;
+};
+
+/** Appends the children of the given page, if any, to the given list. */
+void add_children(const btree_page_h &page, std::vector<PageID> &pids)
+{
+    if (page.is_node()) {
+        pids.push_back(page.pid0());
+        for (slotid_t slot = 0; slot < page.nrecs(); ++slot) {
+            pids.push_back(page.child(slot));
+        }
+    }
+}
+} // anonymous namespace
+
+rc_t btree_impl::_ux_verify_tree_parallel(
+    StoreID store, int hash_bits, int threads, bool &consistent, btree_stats_t *stats)
+{
+    if (threads < 1) {
+        threads = 1;
+    }
+    verification_context context (hash_bits);
+    btree_stats_t top_stats;
+
+    // check the top of the tree on this thread, one level at a time
+    // (including foster chains), until there are enough subtrees to share
+    std::vector<PageID> chains, partitions;
+    int16_t level;
+    {
+        w_keystr_t infimum, supremum;
+        infimum.construct_neginfkey();
+        supremum.construct_posinfkey();
+        btree_page_h rp;
+        W_DO( rp.fix_root(store, LATCH_SH));
+        context.add_expectation(rp.pid(), NOCHECK_ROOT_LEVEL, false, infimum);
+        context.add_expectation(rp.pid(), NOCHECK_ROOT_LEVEL, true, supremum);
+        level = rp.level();
+        top_stats.level_cnt = level;
+        W_DO(_ux_verify_feed_page(rp, context));
+        _ux_collect_page_stats(rp, top_stats);
+        add_children(rp, partitions);
+        chains.push_back(rp.get_foster());
+    }
+    uncached_page_reader reader;
+    const size_t min_partitions = 4 * threads;
+    while (true) {
+        for (size_t i = 0; i < chains.size(); ++i) {
+            for (PageID pid = chains[i]; pid != 0;) {
+                btree_page_h page;
+                W_DO(reader.fix(pid, page));
+                W_DO(_ux_verify_feed_page(page, context));
+                _ux_collect_page_stats(page, top_stats);
+                add_children(page, partitions);
+                pid = page.get_foster();
+            }
+        }
+        if (--level <= 1 || partitions.size() >= min_partitions) {
+            break;
+        }
+        chains.swap(partitions);
+        partitions.clear();
+    }
+
+    // then check the subtrees in parallel. each worker walks the subtrees it
+    // takes without keeping any page fixed, so one private frame is enough.
+    std::vector<std::unique_ptr<verification_context> > contexts;
+    std::vector<btree_stats_t> worker_stats(threads);
+    for (int i = 0; i < threads; ++i) {
+        contexts.emplace_back(new verification_context(hash_bits));
+    }
+    std::atomic<size_t> next_partition(0);
+    W_DO(run_verify_workers(threads, [&](int worker) -> rc_t {
+        uncached_page_reader worker_reader;
+        std::vector<PageID> pids;
+        for (size_t i = next_partition++; i < partitions.size(); i = next_partition++) {
+            pids.push_back(partitions[i]);
+            while (!pids.empty()) {
+                PageID pid = pids.back();
+                pids.pop_back();
+                btree_page_h page;
+                W_DO(worker_reader.fix(pid, page));
+                W_DO(_ux_verify_feed_page(page, *contexts[worker]));
+                _ux_collect_page_stats(page, worker_stats[worker]);
+                if (page.get_foster() != 0) {
+                    pids.push_back(page.get_foster());
+                }
+                add_children(page, pids);
+            }
+        }
+        return RCOK;
+    }));
+
+    for (int i = 0; i < threads; ++i) {
+        context.merge(*contexts[i]);
+        top_stats.add(worker_stats[i]);
+    }
+    consistent = context.is_bitmap_clean() && context._pages_inconsistent == 0;
+    if (stats != NULL) {
+        stats->add(top_stats);
+    }
+    return RCOK;
+}
+
 void btree_impl::inquery_verify_init(StoreID store)
 {
     xct_t *x = xct();
@@ -356,39 +548,81 @@ bool verification_context::is_bitmap_clean () const
     return true;
 }
 
+void verification_context::merge (const verification_context &other)
+{
+    w_assert1 (_hash_bits == other._hash_bits);
+    w_assert1 (_bitmap_size == other._bitmap_size);
+    // facts and expectations flip bits, so merging is XOR-ing the bitmaps
+    int64_t* const begin = reinterpret_cast<int64_t*>(_bitmap);
+    int64_t const* const end = reinterpret_cast<const int64_t*>(_bitmap + _bitmap_size);
+    int64_t const* it_other = reinterpret_cast<const int64_t*>(other._bitmap);
+    for (int64_t *it = begin; it != end; ++it, ++it_other) {
+        *it ^= *it_other;
+    }
+    _pages_checked += other._pages_checked;
+    _pages_inconsistent += other._pages_inconsistent;
+}
+
 rc_t btree_impl::_ux_verify_volume(
-    int hash_bits, verify_volume_result &result)
+    int hash_bits, verify_volume_result &result, int threads)
 {
+    if (threads < 1) {
+        threads = 1;
+    }
     smlevel_0::bf->wakeup_cleaner(true, 1);
     vol_t *vol = ss_m::vol;
     w_assert1(vol);
-    generic_page buf;
     PageID endpid = (PageID) (vol->num_used_pages());
-    // CS TODO should skip non-btree PIDs
-    for (PageID pid = 0; pid < endpid; ++pid) {
-        // TODO we should skip large chunks of unused areas to speedup.
-        // TODO we should scan more than one page at a time to speedup.
-        if (!vol->is_allocated_page(pid)) {
-            continue;
-        }
-        W_DO (vol->read_page(pid, &buf));
-        btree_page_h page;
-        page.fix_nonbufferpool_page(&buf);
-        if (page.tag() == t_btree_p && !page.is_to_be_deleted()) {
-            verification_context *context = result.get_or_create_context(page.root(), hash_bits);
-            w_assert0(context);
-            w_assert0(result.get_context(page.root()));
-            W_DO (_ux_verify_feed_page (page, *context));
-
-            if (page.pid() == page.root()) {
-                // root needs corresponding expectations from outside.
-                w_keystr_t infimum, supremum;
-                infimum.construct_neginfkey();
-                supremum.construct_posinfkey();
-                context->add_expectation(page.root(), NOCHECK_ROOT_LEVEL, false, infimum);
-                context->add_expectation(page.root(), NOCHECK_ROOT_LEVEL, true, supremum);
+
+    // each thread takes the next range of pages and reads it at once.
+    // the pages are not cached in the bufferpool.
+    const PageID range_size = 64;
+    std::atomic<PageID> next_range(0);
+    std::vector<std::unique_ptr<verify_volume_result> > results;
+    for (int i = 0; i < threads; ++i) {
+        results.emplace_back(new verify_volume_result());
+    }
+    W_DO(run_verify_workers(threads, [&](int worker) -> rc_t {
+        verify_volume_result &my_result = *results[worker];
+        std::vector<generic_page> buf(range_size);
+        // CS TODO should skip non-btree PIDs
+        for (PageID first = next_range.fetch_add(range_size); first < endpid;
+                first = next_range.fetch_add(range_size)) {
+            PageID count = std::min(range_size, endpid - first);
+            W_DO (vol->read_many_pages(first, &buf[0], count));
+            for (PageID i = 0; i < count; ++i) {
+                // TODO we should skip large chunks of unused areas to speedup.
+                if (!vol->is_allocated_page(first + i)) {
+                    continue;
+                }
+                btree_page_h page;
+                if (buf[i].tag == t_btree_p && needs_redo(first + i, buf[i])) {
+                    W_DO(page.fix_direct(first + i, LATCH_SH));
+                } else {
+                    page.fix_nonbufferpool_page(&buf[i]);
+                }
+                if (page.tag() == t_btree_p && !page.is_to_be_deleted()) {
+                    verification_context *context
+                        = my_result.get_or_create_context(page.root(), hash_bits);
+                    w_assert0(context);
+                    W_DO (_ux_verify_feed_page (page, *context));
+
+                    if (page.pid() == page.root()) {
+                        // root needs corresponding expectations from outside.
+                        w_keystr_t infimum, supremum;
+                        infimum.construct_neginfkey();
+                        supremum.construct_posinfkey();
+                        context->add_expectation(page.root(), NOCHECK_ROOT_LEVEL, false, infimum);
+                        context->add_expectation(page.root(), NOCHECK_ROOT_LEVEL, true, supremum);
+                    }
+                }
             }
         }
+        return RCOK;
+    }));
+
+    for (int i = 0; i < threads; ++i) {
+        result.merge(*results[i], hash_bits);
     }
     return RCOK;
 }
@@ -428,3 +662,10 @@ verification_context* verify_volume_result::get_context (PageID root_pid)
         return NULL;
     }
 }
+void verify_volume_result::merge (const verify_volume_result &other, int hash_bits)
+{
+    for (std::map<PageID, verification_context*>::const_iterator iter = other._results.begin();
+         iter != other._results.end(); ++iter) {
+        get_or_create_context(iter->first, hash_bits)->merge(*iter->second);
+    }
+}
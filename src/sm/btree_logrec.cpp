@@ -209,7 +209,8 @@ void btree_overwrite_log::redo(PagePtr page)
     const char* old_el = dp->_data + dp->_klen;
     smsize_t cur_elen;
     bool ghost;
-    const char* cur_el = bp.element(slot, cur_elen, ghost);
+    std::string cur_el_buffer;
+    const char* cur_el = bp.element(slot, cur_elen, ghost, cur_el_buffer);
     w_assert1(!ghost);
     w_assert1(cur_elen >= offset + elen);
     w_assert1(::memcmp(old_el, cur_el + offset, elen) == 0);
@@ -308,12 +309,12 @@ void btree_ghost_reclaim_log::construct(const PagePtr p,
 template <class PagePtr>
 void btree_ghost_reclaim_log::redo(PagePtr page)
 {
-    // REDO is to defrag it again
+    // REDO is to defrag it again, without logging it again
     borrowed_btree_page_h bp(page);
     // TODO actually should reclaim only logged entries because
     // locked entries might have been avoided.
     // (but in that case shouldn't defragging the page itself be avoided?)
-    rc_t rc = btree_impl::_sx_defrag_page(bp);
+    rc_t rc = bp.defrag(true);
     if (rc.is_error()) {
         W_FATAL(rc.err_num());
     }
@@ -410,6 +411,38 @@ void btree_foster_adopt_log::redo(PagePtr p) {
     }
 }
 
+template <class PagePtr>
+void btree_foster_deadopt_log::construct(const PagePtr /*p*/, const PagePtr p2,
+    PageID deadopted_pid, lsn_t deadopted_emlsn, const w_keystr_t& low_key,
+    const w_keystr_t& high_key) {
+    set_size((new (data_ssx()) btree_foster_deadopt_t(
+        p2->pid(), deadopted_pid, deadopted_emlsn, low_key, high_key))->size());
+}
+
+template <class PagePtr>
+void btree_foster_deadopt_log::redo(PagePtr p) {
+    w_assert1(is_single_sys_xct());
+    borrowed_btree_page_h bp(p);
+    btree_foster_deadopt_t *dp = reinterpret_cast<btree_foster_deadopt_t*>(data_ssx());
+
+    w_keystr_t low_key, high_key;
+    low_key.construct_from_keystr(dp->_data, dp->_low_len);
+    high_key.construct_from_keystr(dp->_data + dp->_low_len, dp->_high_len);
+
+    PageID target_pid = p->pid();
+    DBGOUT3 (<< *this << " target_pid=" << target_pid << ", deadopted_pid="
+        << dp->_deadopted_pid << ", low_key=" << low_key << ", high_key=" << high_key);
+    if (target_pid == dp->_page2_pid) {
+        // we are recovering "page2", which is the new foster-parent.
+        btree_impl::_ux_deadopt_foster_apply_foster_parent(bp, dp->_deadopted_pid,
+                                                           dp->_deadopted_emlsn,
+                                                           low_key, high_key);
+    } else {
+        // we are recovering "page", which is real-parent.
+        btree_impl::_ux_deadopt_foster_apply_real_parent(bp, low_key);
+    }
+}
+
 template <class PagePtr>
 void btree_split_log::construct(
         const PagePtr child_p,
@@ -448,7 +481,7 @@ void btree_split_log::redo(PagePtr p)
     else {
         // redoing the foster parent
         borrowed_btree_page_h bp(p);
-        w_assert1(bp.nrecs() > bulk->move_count);
+        w_assert1(bp.nrecs() >= bulk->move_count);
         bp.delete_range(bp.nrecs() - bulk->move_count, bp.nrecs());
 
         w_keystr_t new_high_fence, new_chain;
@@ -525,6 +558,11 @@ template void btree_foster_adopt_log::template construct<btree_page_h*>(
         btree_page_h* p, btree_page_h* p2,
     PageID new_child_pid, lsn_t new_child_emlsn, const w_keystr_t& new_child_key);
 
+template void btree_foster_deadopt_log::template construct<btree_page_h*>(
+        btree_page_h* p, btree_page_h* p2,
+    PageID deadopted_pid, lsn_t deadopted_emlsn, const w_keystr_t& low_key,
+    const w_keystr_t& high_key);
+
 template void btree_insert_nonghost_log::template construct<btree_page_h*>(
     btree_page_h* page, const w_keystr_t &key, const cvec_t &el, const bool is_sys_txn);
 
@@ -575,6 +613,7 @@ template void btree_ghost_mark_log::template redo<btree_page_h*>(btree_page_h*);
 template void btree_ghost_reclaim_log::template redo<btree_page_h*>(btree_page_h*);
 template void btree_ghost_reserve_log::template redo<btree_page_h*>(btree_page_h*);
 template void btree_foster_adopt_log::template redo<btree_page_h*>(btree_page_h*);
+template void btree_foster_deadopt_log::template redo<btree_page_h*>(btree_page_h*);
 template void btree_split_log::template redo<btree_page_h*>(btree_page_h*);
 template void btree_compress_page_log::template redo<btree_page_h*>(btree_page_h*);
 
@@ -587,5 +626,6 @@ template void btree_ghost_mark_log::template redo<fixable_page_h*>(fixable_page_
 template void btree_ghost_reclaim_log::template redo<fixable_page_h*>(fixable_page_h*);
 template void btree_ghost_reserve_log::template redo<fixable_page_h*>(fixable_page_h*);
 template void btree_foster_adopt_log::template redo<fixable_page_h*>(fixable_page_h*);
+template void btree_foster_deadopt_log::template redo<fixable_page_h*>(fixable_page_h*);
 template void btree_split_log::template redo<fixable_page_h*>(fixable_page_h*);
 template void btree_compress_page_log::template redo<fixable_page_h*>(fixable_page_h*);
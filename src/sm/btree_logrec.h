@@ -258,6 +258,35 @@ struct btree_foster_adopt_t : multi_page_log_t {
     int size() const { return sizeof(multi_page_log_t) + 14 + _new_child_key_len; }
 };
 
+/**
+ * A \b multi-page \b SSX log record for \b btree_foster_deadopt.
+ * The real parent (page) loses the separator of a child, which becomes the
+ * foster child of its left sibling (page2).
+ * This log is totally \b self-contained, so no WOD assumed.
+ */
+struct btree_foster_deadopt_t : multi_page_log_t {
+    lsn_t   _deadopted_emlsn;   // +8
+    PageID  _deadopted_pid;     // +4
+    int16_t _low_len;           // +2
+    int16_t _high_len;          // +2
+    /** low fence (separator) and high fence of the de-adopted child. */
+    char    _data[logrec_t::max_data_sz - sizeof(multi_page_log_t) - 16];
+
+    btree_foster_deadopt_t(PageID page2_id, PageID deadopted_pid,
+                           lsn_t deadopted_emlsn, const w_keystr_t& low_key,
+                           const w_keystr_t& high_key)
+    : multi_page_log_t(page2_id), _deadopted_emlsn(deadopted_emlsn),
+    _deadopted_pid (deadopted_pid)
+    {
+        _low_len = low_key.get_length_as_keystr();
+        _high_len = high_key.get_length_as_keystr();
+        low_key.serialize_as_keystr(_data);
+        high_key.serialize_as_keystr(_data + _low_len);
+    }
+
+    int size() const { return sizeof(multi_page_log_t) + 16 + _low_len + _high_len; }
+};
+
 /**
  * Delete of a range of keys from a page which was split (i.e., a new
  * foster parent). Deletes the last move_count slots on the page, updating
@@ -0,0 +1,65 @@
+#include "btree_maintainer.h"
+
+#include "sm_base.h"
+#include "btree_impl.h"
+#include "vol.h"
+#include "smthread.h"
+
+#include <algorithm>
+#include <vector>
+
+btree_maintainer::btree_maintainer(const sm_options& options)
+    : worker_thread_t(options.get_int_option("sm_bt_maintenance_interval", -1))
+{
+    _io_budget = options.get_int_option("sm_bt_maintenance_io_budget", 0);
+    _ghost_threshold = options.get_int_option("sm_bt_maintenance_ghost_threshold", 10);
+    _usage_threshold = options.get_int_option("sm_bt_maintenance_usage_threshold", 50);
+    _next_store = 0;
+
+    fork();
+}
+
+btree_maintainer::~btree_maintainer()
+{
+}
+
+void btree_maintainer::do_work()
+{
+    INC_TSTAT(bt_maint_rounds);
+
+    std::vector<StoreID> stores;
+    smlevel_0::vol->get_stnode_cache()->get_used_stores(stores);
+    if (stores.empty()) { return; }
+    std::sort(stores.begin(), stores.end());
+
+    // A limited budget is shared by all stores of this round. The round
+    // starts where the previous one stopped, i.e., with an interrupted walk
+    // or the store after the last completed one, so that a large store does
+    // not starve the ones after it.
+    size_t budget = _io_budget;
+    size_t* budget_ptr = _io_budget > 0 ? &budget : NULL;
+    size_t start = std::lower_bound(stores.begin(), stores.end(), _next_store)
+        - stores.begin();
+    for (size_t i = 0; i < stores.size() && !should_exit(); ++i) {
+        StoreID store = stores[(start + i) % stores.size()];
+        _next_store = store;
+        if (budget_ptr && budget == 0) { break; }
+        if (smlevel_0::vol->get_store_root(store) == 0) { continue; }
+
+        w_keystr_t& resume_key = _resume_keys[store];
+        rc_t rc = btree_impl::_ux_defrag_tree(store, _ghost_threshold,
+                _usage_threshold, true, true, budget_ptr, &resume_key);
+        if (rc.is_error()) {
+            // Maintenance is only an optimization; try again next round
+            DBGOUT1(<< "B-tree maintenance of store " << store << " failed: " << rc);
+            _resume_keys.erase(store);
+            continue;
+        }
+        if (resume_key.is_constructed()) {
+            // walk incomplete, so the budget is exhausted
+            break;
+        }
+        _resume_keys.erase(store);
+        _next_store = store + 1;
+    }
+}
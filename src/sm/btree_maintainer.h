@@ -0,0 +1,49 @@
+#ifndef BTREE_MAINTAINER_H
+#define BTREE_MAINTAINER_H
+
+#include "basics.h"
+#include "sm_options.h"
+#include "w_key.h"
+#include "worker_thread.h"
+
+#include <map>
+
+/**
+ * \brief Background maintenance of the B-trees.
+ * \details
+ * Each round walks the B-trees of all stores with
+ * btree_impl::_ux_defrag_tree(), which adopts foster children, merges
+ * underfull neighboring leaves and reclaims ghost records from leaves no
+ * active transaction has updated. This way foster chains and underfull pages
+ * left behind by user transactions are cleaned up off the critical path.
+ *
+ * A round may only read or modify sm_bt_maintenance_io_budget pages; when the
+ * budget runs out, the walk of the current store stops and the next round
+ * resumes it at the same key, then continues with the stores after it.
+ *
+ * Options: sm_bt_maintenance_interval (ms between rounds; -1, the default,
+ * only runs a round when woken up), sm_bt_maintenance_io_budget,
+ * sm_bt_maintenance_ghost_threshold, sm_bt_maintenance_usage_threshold.
+ */
+class btree_maintainer : public worker_thread_t {
+public:
+    btree_maintainer(const sm_options& options);
+    virtual ~btree_maintainer();
+
+protected:
+    virtual void do_work();
+
+private:
+    /** Maximum number of pages read or modified per round; 0 = unlimited */
+    size_t _io_budget;
+    uint16_t _ghost_threshold;
+    uint16_t _usage_threshold;
+
+    /** Where the walk of each store stopped when its budget ran out */
+    std::map<StoreID, w_keystr_t> _resume_keys;
+
+    /** Store the next round starts with */
+    StoreID _next_store;
+};
+
+#endif
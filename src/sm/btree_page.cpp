@@ -9,6 +9,11 @@
 #include "w_debug.h"
 #include "w_key.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define POOR_SEARCH_X86
+#include <immintrin.h>
+#endif
+
 
 void btree_page_data::init_items() {
     w_assert1(btree_level >= 1);
@@ -87,10 +92,10 @@ void btree_page_data::remove_items(
 void btree_page_data::set_ghost(int item) {
     w_assert1(item>=0 && item<nitems);
 
-    body_offset_t offset = head[item].offset;
+    body_offset_t offset = _head_offset(item);
     w_assert1(offset != 0);
     if (offset >= 0) {
-        head[item].offset = -offset;
+        _head_offset(item) = -offset;
         nghosts++;
     }
 }
@@ -98,10 +103,10 @@ void btree_page_data::set_ghost(int item) {
 void btree_page_data::unset_ghost(int item) {
     w_assert1(item>=0 && item<nitems);
 
-    body_offset_t offset = head[item].offset;
+    body_offset_t offset = _head_offset(item);
     w_assert1(offset != 0);
     if (offset < 0) {
-        head[item].offset = -offset;
+        _head_offset(item) = -offset;
         nghosts--;
     }
 }
@@ -114,20 +119,20 @@ bool btree_page_data::insert_item(int item, bool ghost, poor_man_key poor,
     w_assert3(_items_are_consistent());
 
     size_t body_length = data_length + _item_body_overhead();
-    if ((size_t)usable_space() < sizeof(item_head) + _item_align(body_length)) {
+    if ((size_t)usable_space() < _head_size() + _item_align(body_length)) {
         return false;
     }
 
     // shift item array up to insert a item so it is head[item]:
-    ::memmove(&head[item+1], &head[item], (nitems-item)*sizeof(item_head));
+    ::memmove(_head(item+1), _head(item), (nitems-item)*_head_size());
     nitems++;
     if (ghost) {
         nghosts++;
     }
 
     first_used_body -= _item_align(body_length)/sizeof(item_body);
-    head[item].offset = ghost ? -first_used_body : first_used_body;
-    head[item].poor = poor;
+    _head_offset(item) = ghost ? -first_used_body : first_used_body;
+    set_item_poor(item, poor);
 
     if (!is_leaf()) {
         body[first_used_body].interior.child = child;
@@ -155,7 +160,7 @@ bool btree_page_data::resize_item(int item, size_t new_length, size_t keep_old)
     w_assert1(keep_old <= new_length);
     w_assert3(_items_are_consistent());
 
-    body_offset_t offset = head[item].offset;
+    body_offset_t offset = _head_offset(item);
     bool ghost = false;
     if (offset < 0) {
         offset = -offset;
@@ -176,7 +181,7 @@ bool btree_page_data::resize_item(int item, size_t new_length, size_t keep_old)
 
     char* old_p = item_data(item);
     first_used_body -= _item_align(body_length)/sizeof(item_body);
-    head[item].offset = ghost ? -first_used_body : first_used_body;
+    _head_offset(item) = ghost ? -first_used_body : first_used_body;
     _item_body_length(first_used_body) = body_length;
     if (!is_leaf()) {
         body[first_used_body].interior.child = body[offset].interior.child;
@@ -205,7 +210,7 @@ void btree_page_data::delete_item(int item) {
     w_assert1(item>=0 && item<nitems);
     w_assert3(_items_are_consistent());
 
-    body_offset_t offset = head[item].offset;
+    body_offset_t offset = _head_offset(item);
     if (offset < 0) {
         offset = -offset;
         nghosts--;
@@ -217,7 +222,7 @@ void btree_page_data::delete_item(int item) {
     }
 
     // shift item array down to remove head[item]:
-    ::memmove(&head[item], &head[item+1], (nitems-(item+1))*sizeof(item_head));
+    ::memmove(_head(item), _head(item+1), (nitems-(item+1))*_head_size());
     nitems--;
 
     w_assert3(_items_are_consistent());
@@ -236,14 +241,14 @@ void btree_page_data::delete_range(int from, int to)
     size_t to_delete = to - from;
     while (to_delete > 0) {
         int i = from + to_delete - 1;
-        body_offset_t offset = head[i].offset;
+        body_offset_t offset = _head_offset(i);
         if (offset < 0) {
             nghosts--;
             offset = -offset;
         }
 
         // delete item head
-        ::memmove(&head[i], &head[i+1], (nitems - (i+1)) * sizeof(item_head));
+        ::memmove(_head(i), _head(i+1), (nitems - (i+1)) * _head_size());
         nitems--;
 
         body_offset_t body_count = _item_bodies(offset);
@@ -257,17 +262,17 @@ void btree_page_data::delete_range(int from, int to)
             // and adjust the offset of any item with a lower offset
             int j = 0;
             while (j < nitems) {
-                body_offset_t j_off = head[j].offset;
+                body_offset_t j_off = _head_offset(j);
                 if (abs(j_off) < offset) {
                     if (j_off > 0) {
-                        head[j].offset += body_count;
+                        _head_offset(j) += body_count;
                     }
                     else {
                         // CS TODO: delete ghosts instead of shifting
-                        head[j].offset -= body_count;
+                        _head_offset(j) -= body_count;
                     }
                     // DBG(<< "Offset of item" << j << " shifted to "
-                    //         << head[j].offset);
+                    //         << _head_offset(j));
                 }
                 j++;
             }
@@ -283,46 +288,41 @@ void btree_page_data::delete_range(int from, int to)
 
 void btree_page_data::truncate_all(size_t amount, size_t pos)
 {
-    // fence keys must already be truncated, so we skip item 0
-    for (int i = 1; i < nitems; i++) {
-        body_offset_t offset = head[i].offset;
-        if (offset < 0) continue;
-        item_length_t new_len = item_length(i) - amount;
-
-        // move item data to the left by amount
-        char* data_begin = item_data(i) + pos;
-        ::memmove(data_begin, data_begin + amount, new_len - pos);
-
-        // set new item length
-        body_offset_t old_body_count = _item_bodies(offset);
-        if (is_leaf()) {
-            body[offset].leaf.item_len = new_len;
-        }
-        else {
-            body[offset].interior.item_len = new_len;
-        }
-        body_offset_t new_body_count = _item_bodies(offset);
-
-        // see if we can save any space by freeing item bodies
-        w_assert1(new_body_count <= old_body_count);
-        if (new_body_count < old_body_count) {
-            body_offset_t diff = old_body_count - new_body_count;
-            // shift all bodies behind us to the right
-            body_offset_t move_count = offset + new_body_count - first_used_body;
-            ::memmove(&body[first_used_body + diff], &body[first_used_body],
-                    move_count * sizeof(item_body));
-
-            // update offset of all affected items
-            for (int j = 1; j < nitems; j++) {
-                if (head[j].offset <= offset) {
-                    head[j].offset += diff;
-                }
-            }
+    // like compact(), rewrite all bodies from the end of the page, but keep
+    // ghosts and cut amount bytes at pos out of every item except the fence
+    // record (item 0), whose fence keys must already be truncated
+    item_body scratch_body[max_bodies];
+    int       scratch_head = max_bodies;
+#ifdef ZERO_INIT
+    ::memset(&scratch_body, 0, sizeof(scratch_body));
+#endif // ZERO_INIT
 
-            first_used_body += diff;
+    for (int i = 0; i < nitems; i++) {
+        body_offset_t offset = _head_offset(i);
+        bool ghost = (offset < 0);
+        if (ghost) {
+            offset = -offset;
         }
-
+        item_length_t old_len = _item_body_length(offset);
+        size_t cut = (i == 0) ? 0 : amount;
+        w_assert1(old_len >= _item_body_overhead() + pos + cut);
+        item_length_t new_len = old_len - cut;
+
+        scratch_head -= _item_align(new_len) / sizeof(item_body);
+        char* src = (char*) &body[offset];
+        char* dest = (char*) &scratch_body[scratch_head];
+        size_t head_len = _item_body_overhead() + pos;
+        ::memcpy(dest, src, head_len);
+        ::memcpy(dest + head_len, src + head_len + cut, old_len - head_len - cut);
+        if (is_leaf()) {
+            scratch_body[scratch_head].leaf.item_len = new_len;
+        } else {
+            scratch_body[scratch_head].interior.item_len = new_len;
+        }
+        _head_offset(i) = ghost ? -scratch_head : scratch_head;
     }
+    first_used_body = scratch_head;
+    ::memcpy(&body[first_used_body], &scratch_body[scratch_head], (max_bodies-scratch_head)*sizeof(item_body));
 
     w_assert3(_items_are_consistent());
 }
@@ -360,7 +360,9 @@ std::ostream& operator<<(std::ostream& os, btree_page_data& b)
     os << "  LENGHTS: fence_low=" << b.btree_fence_low_length <<
         " fence_high=" << b.btree_fence_high_length <<
         " fence_chain=" << b.btree_chain_fence_high_length <<
-        " prefix= " << b.btree_prefix_length << '\n';
+        " prefix= " << b.btree_prefix_length <<
+        " poor_key=" << b.poor_key_width() <<
+        " compressed_values=" << b.compressed_values() << '\n';
     os << "  ITEMS: " << b.nitems-1 << " GHOSTS: " << b.nghosts << '\n';
     os << "  FREE SPACE: " << b.usable_space() << '\n';
     os << "  FIRST USED BODY: " << b.first_used_body << '\n';
@@ -373,7 +375,7 @@ std::ostream& operator<<(std::ostream& os, btree_page_data& b)
 
 bool btree_page_data::_items_are_consistent() const {
     // This is not a part of check; should be always true:
-    w_assert1(first_used_body*sizeof(item_body) >= nitems*sizeof(item_head));
+    w_assert1(first_used_body*sizeof(item_body) >= nitems*_head_size());
 
 
     // check overlapping records.
@@ -386,7 +388,7 @@ bool btree_page_data::_items_are_consistent() const {
     boost::scoped_array<uint32_t> sorted_items(new uint32_t[nitems]); // <<<>>>
     int ghosts_seen = 0;
     for (int item = 0; item<nitems; ++item) {
-        int offset = head[item].offset;
+        int offset = _head_offset(item);
         if (offset < 0) {
             offset = -offset;
             ghosts_seen++;
@@ -437,7 +439,7 @@ bool btree_page_data::_items_are_consistent() const {
     if (error) {
         DBGOUT1(<<"nitems=" << nitems << ", nghosts="<<nghosts);
         for (int i=0; i<nitems; i++) {
-            int offset = head[i].offset;
+            int offset = _head_offset(i);
             if (offset < 0) offset = -offset;
             size_t len = _item_bodies(offset);
             DBGOUT1(<<"  item[" << i << "] body @ offsets " << offset << " to " << offset+len-1
@@ -462,14 +464,14 @@ void btree_page_data::compact() {
 
     int j = 0;
     for (int i=0; i<nitems; i++) {
-        body_offset_t offset = head[i].offset;
+        body_offset_t offset = _head_offset(i);
         if (offset < 0) {
             nghosts--;
         } else {
             int length = _item_bodies(offset);
             scratch_head -= length;
-            head[j].poor   = head[i].poor;
-            head[j].offset = scratch_head;
+            set_item_poor(j, item_poor(i));
+            _head_offset(j) = scratch_head;
             ::memcpy(&scratch_body[scratch_head], &body[offset], length*sizeof(item_body));
             j++;
         }
@@ -484,11 +486,125 @@ void btree_page_data::compact() {
 
 
 char* btree_page_data::unused_part(size_t& length) {
-    char* start_gap = (char*)&head[nitems];
+    char* start_gap = _head(nitems);
     char* after_gap = (char*)&body[first_used_body];
     length = after_gap - start_gap;
     return start_gap;
 }
 
 
-const size_t btree_page_data::max_item_overhead = sizeof(item_head) + sizeof(item_length_t) + sizeof(PageID) + _item_align(1)-1;
+const size_t btree_page_data::max_item_overhead = max_head_size + sizeof(item_length_t) + sizeof(PageID) + _item_align(1)-1;
+
+
+/*
+ * Vectorized poor_man_key search.
+ *
+ * With the default poor_key_width(), each item head is 4 bytes with the
+ * poor_man_key in its upper half (on little-endian x86), so shifting a vector of heads right by 16 bits gives
+ * the poor_man_keys as non-negative 32-bit integers, which can be compared
+ * with a broadcast search key using signed comparisons.
+ */
+namespace {
+/// counts items of heads[0..count-1] with poor_man_key below and above key
+typedef void (*poor_count_func)(const uint32_t* heads, int count, uint32_t key,
+                                int& less, int& greater);
+
+void poor_count_scalar(const uint32_t* heads, int count, uint32_t key,
+                       int& less, int& greater) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t poor = heads[i] >> 16;
+        less    += poor < key;
+        greater += poor > key;
+    }
+}
+
+#ifdef POOR_SEARCH_X86
+__attribute__((target("sse2")))
+void poor_count_sse2(const uint32_t* heads, int count, uint32_t key,
+                     int& less, int& greater) {
+    const __m128i k = _mm_set1_epi32(key);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i poor = _mm_srli_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(heads + i)), 16);
+        less    += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, poor))));
+        greater += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(poor, k))));
+    }
+    poor_count_scalar(heads + i, count - i, key, less, greater);
+}
+
+__attribute__((target("avx2")))
+void poor_count_avx2(const uint32_t* heads, int count, uint32_t key,
+                     int& less, int& greater) {
+    const __m256i k = _mm256_set1_epi32(key);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i poor = _mm256_srli_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(heads + i)), 16);
+        less    += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, poor))));
+        greater += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(poor, k))));
+    }
+    poor_count_sse2(heads + i, count - i, key, less, greater);
+}
+#endif // POOR_SEARCH_X86
+
+btree_page_data::poor_search_isa_t best_poor_search_isa() {
+#ifdef POOR_SEARCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return btree_page_data::POOR_SEARCH_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return btree_page_data::POOR_SEARCH_SSE2;
+    }
+#endif // POOR_SEARCH_X86
+    return btree_page_data::POOR_SEARCH_SCALAR;
+}
+
+poor_count_func poor_count_of(btree_page_data::poor_search_isa_t isa) {
+    switch (isa) {
+#ifdef POOR_SEARCH_X86
+        case btree_page_data::POOR_SEARCH_AVX2: return poor_count_avx2;
+        case btree_page_data::POOR_SEARCH_SSE2: return poor_count_sse2;
+#endif // POOR_SEARCH_X86
+        default: return poor_count_scalar;
+    }
+}
+
+btree_page_data::poor_search_isa_t poor_search_isa = best_poor_search_isa();
+poor_count_func poor_count = poor_count_of(poor_search_isa);
+} // anonymous namespace
+
+btree_page_data::poor_search_isa_t btree_page_data::get_poor_search_isa() {
+    return poor_search_isa;
+}
+
+btree_page_data::poor_search_isa_t btree_page_data::set_poor_search_isa(poor_search_isa_t isa) {
+    poor_search_isa = std::min(isa, best_poor_search_isa());
+    poor_count      = poor_count_of(poor_search_isa);
+    return poor_search_isa;
+}
+
+void btree_page_data::poor_range(int first, int last, poor_man_key poor,
+                                 int& lower, int& upper) const {
+    BOOST_STATIC_ASSERT(min_head_size == sizeof(uint32_t));
+    w_assert1(first >= 0 && first <= last && last <= nitems);
+
+    int less = 0, greater = 0;
+    if (poor_key_width() == default_poor_key_width) {
+        poor_count(reinterpret_cast<const uint32_t*>(_head(first)), last - first,
+                   poor, less, greater);
+    } else {
+        // wider heads are not vectorized
+        for (int i = first; i < last; ++i) {
+            poor_man_key item = item_poor(i);
+            less    += item < poor;
+            greater += item > poor;
+        }
+    }
+    lower = first + less;
+    upper = last - greater;
+    w_assert1(lower == first || item_poor(lower - 1) < poor);
+    w_assert1(lower == last || item_poor(lower) >= poor);
+    w_assert1(upper == last || item_poor(upper) > poor);
+}
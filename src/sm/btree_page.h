@@ -16,8 +16,8 @@
  * \details
  * Each item contains the following fixed-size fields:
  * \li ghost? (1 bit):   am I a ghost item?
- * \li poor   (2 bytes): leading bytes of an associated key for speeding up search
- *    (type poor_man_key)
+ * \li poor   (2, 4, or 8 bytes, see poor_key_width()): leading bytes of an
+ *    associated key for speeding up search (type poor_man_key)
  *
  * \li child  (4 bytes): child page ID; this field is present only in interior nodes
  *
@@ -158,14 +158,61 @@ protected:
     void          unset_ghost(int item);
 
 
-    /// The type of poor_man_key data
-    typedef uint16_t poor_man_key;
+    /**
+     * The type of poor_man_key data, of which only the lowest
+     * poor_key_width() bytes are stored in each item.
+     */
+    typedef uint64_t poor_man_key;
+
+    /// Valid values of poor_key_width()
+    enum {
+        default_poor_key_width = 2,
+        max_poor_key_width     = sizeof(poor_man_key)
+    };
+
+    /**
+     * Number of leading key bytes kept as poor_man_key in each item.
+     * Chosen per store when creating the index; wider ones take more space
+     * but tell more keys apart without comparing them fully.
+     */
+    int           poor_key_width() const {
+        // 0 in pages formatted before it was configurable (and in virgin pages)
+        return is_valid_poor_key_width(poor_width) ? poor_width : int(default_poor_key_width);
+    }
+
+    /// set poor_key_width() of a page about to be (re)formatted
+    void          set_poor_key_width(int width) {
+        w_assert1(is_valid_poor_key_width(width));
+        poor_width = width;
+    }
+
+    /**
+     * Whether leaf elements are stored compressed, which is chosen per
+     * store when creating the index (see btree_page_h::_encode_element()).
+     */
+    bool          compressed_values() const { return value_compression != 0; }
+
+    /// set compressed_values() of a page about to be (re)formatted
+    void          set_compressed_values(bool compressed) {
+        value_compression = compressed ? 1 : 0;
+    }
 
     /// return the poor_man_key data for the given item
     poor_man_key  item_poor(int item) const;
 
-    /// return a reference to the poor_man_key data for the given item
-    poor_man_key& item_poor(int item);
+    /// set the poor_man_key data for the given item
+    void          set_item_poor(int item, poor_man_key poor);
+
+    /**
+     * Given that the poor_man_key data of items first..last-1 are sorted
+     * (as they are for the records of a B-tree page), returns in lower the
+     * first of these items whose poor_man_key is not less than poor, and
+     * in upper the first one whose poor_man_key is greater than poor (last
+     * if none). With the default poor_key_width(), compares many items at
+     * once with the instruction set chosen by set_poor_search_isa().
+     */
+    void          poor_range(int first, int last, poor_man_key poor,
+                             int& lower, int& upper) const;
 
     /**
      * Return a reference to the child pointer data for the given
@@ -189,6 +236,17 @@ protected:
      */
     size_t        item_length(int item) const;
 
+    /**
+     * Latch-free variants of item_poor() and of item_child(), item_data(),
+     * and item_length() for optimistic reads of interior pages, which may be
+     * modified concurrently (see btree_page_h::search_node_optimistic()).
+     * Every field is read once and bounds-checked instead of asserted; they
+     * return false if the item does not lie within the page.
+     */
+    bool          optimistic_item_poor(int item, poor_man_key& poor) const;
+    bool          optimistic_item(int item, PageID& child, const char*& data,
+                                  size_t& length) const;
+
 
     /**
      * Attempt to insert a new item at given item position, pushing
@@ -269,7 +327,8 @@ protected:
 
     /**
      * remove 'amount' leading bytes from each item data, starting at offset
-     * 'pos"
+     * 'pos", except from the fence record (item 0).  Ghost items are
+     * truncated too, and the item bodies get compacted as in compact().
      *
      * Example:
      * current data = AABBCC
@@ -350,8 +409,14 @@ private:
     /// offset to beginning of used item bodies (# of used item body that is located left-most).
     body_offset_t first_used_body;                 // +2 -> 30
 
-    /// padding to ensure header size is a multiple of 8
-    uint16_t      padding;                         // +2 -> 32
+    /**
+     * poor_key_width() if set; used to be padding to ensure header size
+     * is a multiple of 8, which is why 0 means the default.
+     */
+    uint8_t       poor_width;                      // +1 -> 31
+
+    /// compressed_values(); also used to be padding, so 0 means no.
+    uint8_t       value_compression;               // +1 -> 32
 
     // ======================================================================
     //   END: item-specific headers
@@ -385,27 +450,47 @@ private:
      *
      *   head_0 head_1 ... head_I  <possible gap> body_J body_J+1 ... body_N
      *
-     * where head_i is a fixed sized value of type item_head that
+     * where head_i is a fixed sized value (_head_size() bytes) that
      * contains the poor_man_key, the ghost bit, and a offset to a
      * starting item_body for item # i.  As items are added, space is
      * consumed on both sides of the gap: at the beginning for another
-     * item_head and at the end for one or more item bodies to store
+     * item head and at the end for one or more item bodies to store
      * the remaining data, namely the variable-size data field and
      * (for interior nodes only) the child pointer.
      *
      * Here, I is nitems+1, J is first_used_body, and N is max_bodies-1.
      */
 
-    typedef struct {
-        /**
-         * sign bit: is this a ghost item?  (<0 => yes)
-         * first item_body belonging to this item is body[abs(offset)]
-         */
-        body_offset_t offset;
-        poor_man_key  poor;
-    } item_head;
-    //static_assert(sizeof(item_head) == 4, "item_head has wrong length");
-    BOOST_STATIC_ASSERT(sizeof(item_head) == 4);
+    /*
+     * An item head consists of:
+     *  - body_offset_t offset: sign bit: is this a ghost item?  (<0 => yes)
+     *    first item_body belonging to this item is body[abs(offset)]
+     *  - the lowest poor_key_width() bytes of its poor_man_key, unaligned
+     * With the default width, that is 4 bytes, as it always used to be.
+     */
+    enum {
+        min_head_size = sizeof(body_offset_t) + default_poor_key_width,
+        max_head_size = sizeof(body_offset_t) + max_poor_key_width
+    };
+
+    /// size of each item head of this page
+    size_t        _head_size() const { return sizeof(body_offset_t) + poor_key_width(); }
+
+    /// return the item head of the given item (which may be nitems, i.e., the gap)
+    char*         _head(int item) { return heads + item * _head_size(); }
+    const char*   _head(int item) const { return heads + item * _head_size(); }
+
+    /// return a reference to the body offset in the head of the given item
+    body_offset_t&       _head_offset(int item) {
+        return *reinterpret_cast<body_offset_t*>(_head(item));
+    }
+    const body_offset_t& _head_offset(int item) const {
+        return *reinterpret_cast<const body_offset_t*>(_head(item));
+    }
+
+    /// (unaligned) load and store of the poor_man_key in an item head
+    static poor_man_key _load_poor(const char* src, int width);
+    static void         _store_poor(char* dest, int width, poor_man_key poor);
 
     typedef struct {
         // item format depends on whether we are a leaf or not:
@@ -432,7 +517,7 @@ private:
 
     BOOST_STATIC_ASSERT(data_sz%sizeof(item_body) == 0);
     enum {
-        max_heads  = data_sz/sizeof(item_head),
+        max_heads  = data_sz/min_head_size,
         max_bodies = data_sz/sizeof(item_body),
         /** Bytes that should be subtracted from item_len for actual data in leaf. */
         leaf_overhead = sizeof(item_length_t),
@@ -441,7 +526,7 @@ private:
     };
 
     union {
-        item_head head[max_heads];
+        char      heads[data_sz];  // item heads, _head_size() bytes each
         item_body body[max_bodies];
     };
     // check field sizes are large enough:
@@ -486,6 +571,28 @@ private:
 public:
     friend std::ostream& operator<<(std::ostream&, btree_page_data&);
 
+    /// Is width a valid number of poor_man_key bytes (2, 4, or 8)?
+    static bool is_valid_poor_key_width(int width) {
+        return width == 2 || width == 4 || width == 8;
+    }
+
+    /// Instruction sets poor_range() can use
+    enum poor_search_isa_t {
+        POOR_SEARCH_SCALAR, ///< one item at a time, plain binary search
+        POOR_SEARCH_SSE2,   ///< 4 items per comparison
+        POOR_SEARCH_AVX2    ///< 8 items per comparison
+    };
+
+    /// Instruction set currently used by poor_range(), by default the best one the CPU supports
+    static poor_search_isa_t get_poor_search_isa();
+
+    /**
+     * Overrides the instruction set used by poor_range() (e.g., for
+     * benchmarks). Falls back to the best one supported by the CPU, which
+     * is returned.
+     */
+    static poor_search_isa_t set_poor_search_isa(poor_search_isa_t isa);
+
     bool eq(const btree_page_data&) const;
 };
 
@@ -574,23 +681,40 @@ inline btree_page_data::body_offset_t btree_page_data::_item_bodies(body_offset_
 
 inline bool btree_page_data::is_ghost(int item) const {
     w_assert1(item>=0 && item<nitems);
-    return head[item].offset < 0;
+    return _head_offset(item) < 0;
 }
 
-inline btree_page_data::poor_man_key& btree_page_data::item_poor(int item) {
-    w_assert1(item>=0 && item<nitems);
-    return head[item].poor;
-}
 inline btree_page_data::poor_man_key btree_page_data::item_poor(int item) const {
     w_assert1(item>=0 && item<nitems);
-    return head[item].poor;
+    return _load_poor(_head(item) + sizeof(body_offset_t), poor_key_width());
+}
+inline void btree_page_data::set_item_poor(int item, poor_man_key poor) {
+    w_assert1(item>=0 && item<=nitems);  // <= as insert_item() sets it before nitems++
+    w_assert1(poor_key_width() == max_poor_key_width
+              || poor < (poor_man_key(1) << (poor_key_width() * 8)));
+    _store_poor(_head(item) + sizeof(body_offset_t), poor_key_width(), poor);
+}
+
+inline btree_page_data::poor_man_key btree_page_data::_load_poor(const char* src, int width) {
+    switch (width) {
+        case 2: { uint16_t v; ::memcpy(&v, src, sizeof(v)); return v; }
+        case 4: { uint32_t v; ::memcpy(&v, src, sizeof(v)); return v; }
+        default: { uint64_t v; ::memcpy(&v, src, sizeof(v)); return v; }
+    }
+}
+inline void btree_page_data::_store_poor(char* dest, int width, poor_man_key poor) {
+    switch (width) {
+        case 2: { uint16_t v = poor; ::memcpy(dest, &v, sizeof(v)); break; }
+        case 4: { uint32_t v = poor; ::memcpy(dest, &v, sizeof(v)); break; }
+        default: { uint64_t v = poor; ::memcpy(dest, &v, sizeof(v)); break; }
+    }
 }
 
 inline PageID& btree_page_data::item_child(int item) {
     w_assert1(item>=0 && item<nitems);
     w_assert1(!is_leaf());
 
-    body_offset_t offset = head[item].offset;
+    body_offset_t offset = _head_offset(item);
     if (offset < 0) {
         offset = -offset;
     }
@@ -600,7 +724,7 @@ inline PageID& btree_page_data::item_child(int item) {
 
 inline char* btree_page_data::item_data(int item) {
     w_assert1(item>=0 && item<nitems);
-    body_offset_t offset = head[item].offset;
+    body_offset_t offset = _head_offset(item);
     if (offset < 0) {
         offset = -offset;
     }
@@ -613,7 +737,7 @@ inline char* btree_page_data::item_data(int item) {
 
 inline size_t btree_page_data::item_length(int item) const {
     w_assert1(item>=0 && item<nitems);
-    body_offset_t offset = head[item].offset;
+    body_offset_t offset = _head_offset(item);
     if (offset < 0) {
         offset = -offset;
     }
@@ -631,23 +755,23 @@ inline size_t btree_page_data::item_length(int item) const {
 
 inline size_t btree_page_data::predict_item_space(size_t data_length) const {
     size_t body_length = data_length + _item_body_overhead();
-    return _item_align(body_length) + sizeof(item_head);
+    return _item_align(body_length) + _head_size();
 }
 
 inline size_t btree_page_data::item_space(int item) const {
     w_assert1(item>=0 && item<nitems);
-    body_offset_t offset = head[item].offset;
+    body_offset_t offset = _head_offset(item);
     if (offset < 0) {
         offset = -offset;
     }
 
-    return _item_align(_item_body_length(offset)) + sizeof(item_head);
+    return _item_align(_item_body_length(offset)) + _head_size();
 }
 
 
 inline size_t btree_page_data::usable_space() const {
-    w_assert1(first_used_body*sizeof(item_body) >= nitems*sizeof(item_head));
-    return    first_used_body*sizeof(item_body) -  nitems*sizeof(item_head);
+    w_assert1(first_used_body*sizeof(item_body) >= nitems*_head_size());
+    return    first_used_body*sizeof(item_body) -  nitems*_head_size();
 }
 
 
@@ -669,5 +793,39 @@ inline T volatile &ACCESS_ONCE(T &t) {
     return static_cast<T volatile &>(t);
 }
 
+inline bool btree_page_data::optimistic_item_poor(int item, poor_man_key& poor) const {
+    // the width may change as well if the frame gets reused
+    int width = poor_key_width();
+    size_t head_size = sizeof(body_offset_t) + width;
+    if (item < 0 || (item + 1) * head_size > data_sz) {
+        return false;
+    }
+    poor = _load_poor(heads + item * head_size + sizeof(body_offset_t), width);
+    return true;
+}
+
+inline bool btree_page_data::optimistic_item(int item, PageID& child,
+                                             const char*& data, size_t& length) const {
+    size_t head_size = _head_size();
+    if (item < 0 || (item + 1) * head_size > data_sz) {
+        return false;
+    }
+    int offset = ACCESS_ONCE(*reinterpret_cast<const body_offset_t*>(heads + item * head_size));
+    if (offset < 0) {
+        offset = -offset;
+    }
+    if (offset >= max_bodies) {
+        return false;
+    }
+    size_t len = ACCESS_ONCE(body[offset].interior.item_len);
+    if (len < interior_overhead || offset * sizeof(item_body) + len > data_sz) {
+        return false;
+    }
+    child  = ACCESS_ONCE(body[offset].interior.child);
+    data   = body[offset].interior.item_data;
+    length = len - interior_overhead;
+    return true;
+}
+
 #endif // BTREE_PAGE_H
 
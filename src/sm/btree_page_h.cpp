@@ -51,7 +51,8 @@ btrec_t::set(const btree_page_h& page, slotid_t slot) {
     if (page.is_leaf())  {
         page.get_key(slot, _key);
         smsize_t element_len;
-        const char* element_data = page.element(slot, element_len, _ghost_record);
+        const char* element_data = page.element(slot, element_len, _ghost_record,
+                                                _elem_buffer);
         _elem.put(element_data, element_len);
         _child = 0;
         _child_emlsn = lsn_t::null;
@@ -166,8 +167,14 @@ rc_t btree_page_h::format_steal(lsn_t            new_lsn,         // LSN of the
     // The _init inserts into slot 0 which contains the low, high (confusing nameing,
     // this is actually the foster key) and chain_high_fence (actually the high fence) keys,
     // but do not log it, since the actual record movement will move all the records
+    // The poor man's key width and the compression of values are the same in
+    // the whole B-tree, so take them from the page we steal from or keep
+    // those of this page.
+    int poor_key_width = steal_src1 ? steal_src1->get_poor_key_width() : get_poor_key_width();
+    bool compressed_values = steal_src1 ? steal_src1->is_value_compressed() : is_value_compressed();
     _init(new_lsn, pid, store, root, pid0, pid0_emlsn, foster, foster_emlsn,
-          l, fence_low, fence_high, chain_fence_high, ghost);
+          l, fence_low, fence_high, chain_fence_high, ghost, poor_key_width,
+          compressed_values);
 
     // steal records from old page
     if (steal_src1) {
@@ -284,6 +291,8 @@ rc_t btree_page_h::format_foster_child(btree_page_h& parent,
     page()->btree_level = parent.level();
     page()->btree_foster = parent.get_foster_opaqueptr();
     page()->btree_foster_emlsn = parent.get_foster_emlsn();
+    page()->set_poor_key_width(parent.get_poor_key_width());
+    page()->set_compressed_values(parent.is_value_compressed());
     page()->init_items();
 
     // Initialize fence keys: high = split key, low = same as in parent
@@ -332,8 +341,7 @@ rc_t btree_page_h::format_foster_child(btree_page_h& parent,
         if (is_leaf())
         {
             smsize_t data_length;
-            bool is_ghost;
-            const char* data = parent.element(i, data_length, is_ghost);
+            const char* data = parent._stored_element(i, data_length);
             _pack_leaf_record(v, v_scratch, new_trunc_key, data, data_length);
             child = 0;
         }
@@ -360,6 +368,9 @@ rc_t btree_page_h::format_foster_child(btree_page_h& parent,
 
 void btree_page_h::delete_range(int from, int to)
 {
+    if (from == to) {
+        return; // e.g., no-copy split
+    }
     // 1st item is always fence keys
     page()->delete_range(from+1, to+1);
     w_assert3(is_consistent(true, true));
@@ -447,14 +458,16 @@ void btree_page_h::_steal_records(btree_page_h* steal_src,
         if (is_leaf())
         {
             smsize_t data_length;
-            bool is_ghost;
-            const char* data = steal_src->element(i, data_length, is_ghost);
+            const char* data = steal_src->_stored_element(i, data_length);
             _pack_leaf_record(v, v_scratch, new_trunc_key, data, data_length);
             child = 0;
 
             if (true == full_logging)
             {
                 // Log the insertion into new page (leaf)
+                bool is_ghost;
+                std::string element_buffer;
+                data = steal_src->element(i, data_length, is_ghost, element_buffer);
                 vec_t el;
                 el.put(data, data_length);
                 // key: original key including prefix
@@ -616,8 +629,10 @@ rc_t btree_page_h::copy_records(const int  rec_count,     // In: number of recor
         if (is_leaf())
         {
             // Leaf page data pointer and length, throw away the data pointer
-            // since we will re-acquire it later
-            const char* data = element(current_slot, data_length, is_ghost);
+            // since we will re-acquire it later.  The records stay in the
+            // same B-tree, so compressed elements are copied as they are.
+            const char* data = _stored_element(current_slot, data_length);
+            is_ghost = this->is_ghost(current_slot);
             w_assert1(NULL != data);
             child = 0;
         }
@@ -704,7 +719,7 @@ rc_t btree_page_h::copy_records(const int  rec_count,     // In: number of recor
         if (is_leaf())
         {
             smsize_t dummy;
-            const char* data = element(current_slot, dummy, is_ghost);
+            const char* data = _stored_element(current_slot, dummy);
             w_assert1(NULL != data);
             w_assert1(data_length == dummy);
             memcpy(data_buffer+current_len, data, data_length);
@@ -1001,16 +1016,24 @@ rc_t btree_page_h::norecord_split (PageID foster, lsn_t foster_emlsn,
 
 inline int btree_page_h::_compare_slot_with_key(int slot, const void* key_noprefix, size_t key_len, poor_man_key key_poor) const {
     // fast path using poor_man_key's:
-    int result = _poor(slot) - (int)key_poor;
-    if (result != 0) {
+    poor_man_key slot_poor = _poor(slot);
+    if (slot_poor != key_poor) {
+        int result = slot_poor < key_poor ? -1 : 1;
         w_assert1((result<0) == (_compare_key_noprefix(slot, key_noprefix, key_len)<0));
         return result;
     }
 
     // slow path:
+    INC_TSTAT(bt_full_key_compares);
     return _compare_key_noprefix(slot, key_noprefix, key_len);
 }
 
+/**
+ * Number of slots below which search() compares poor man's keys with SIMD
+ * instructions instead of continuing its binary search.
+ */
+const int POOR_SEARCH_WINDOW = 32;
+
 void
 btree_page_h::search(const char *key_raw, size_t key_raw_len,
                      bool& found_key, slotid_t& return_slot) const {
@@ -1065,7 +1088,21 @@ btree_page_h::search(const char *key_raw, size_t key_raw_len,
     }
 #endif
 
+    // with SIMD, binary search only until few enough slots are left, see below
+    bool narrowed = btree_page_data::get_poor_search_isa() == btree_page_data::POOR_SEARCH_SCALAR
+        || page()->poor_key_width() != btree_page::default_poor_key_width;
     while (low+1 < high) {
+        if (!narrowed && high - low <= POOR_SEARCH_WINDOW) {
+            // Poor man's keys are sorted, so one vectorized pass over the
+            // remaining slots finds those whose poor man's key equals the
+            // search key's, which are the only ones needing full comparison.
+            narrowed = true;
+            int lower, upper; // items, i.e., slots+1
+            page()->poor_range(low + 2, high + 1, poormkey, lower, upper);
+            low  = lower - 2;
+            high = upper - 1;
+            continue;
+        }
         int mid = (low + high) / 2;
         w_assert1(low<mid && mid<high);
         int d = _compare_slot_with_key(mid, key_noprefix, key_len, poormkey);
@@ -1096,6 +1133,95 @@ void btree_page_h::search_node(const w_keystr_t& key,
     }
 }
 
+PageID btree_page_h::search_node_optimistic(const w_keystr_t& key) const {
+    const btree_page* p = page();
+    const char* key_raw     = (const char*) key.buffer_as_keystr();
+    size_t      key_raw_len = key.get_length_as_keystr();
+
+    // read every header field once; they may change under our feet
+    int level          = ACCESS_ONCE(p->btree_level);
+    int items          = p->number_of_items();
+    int prefix_len     = ACCESS_ONCE(p->btree_prefix_length);
+    int fence_low_len  = ACCESS_ONCE(p->btree_fence_low_length);
+    int fence_high_len = ACCESS_ONCE(p->btree_fence_high_length);
+    if (level < 2 || items < 1 || prefix_len < 0 || prefix_len > fence_low_len
+        || prefix_len > fence_high_len) {
+        return 0;
+    }
+
+    PageID      child;
+    const char* fence;
+    size_t      fence_len;
+    if (!p->optimistic_item(0, child, fence, fence_len)
+        || (size_t) (fence_low_len + fence_high_len - prefix_len) > fence_len) {
+        return 0;
+    }
+
+    // same as compare_with_fence_high()
+    const char* fence_high_noprefix = fence + fence_low_len;
+    int d;
+    if ((size_t) prefix_len > key_raw_len) {
+        d = w_keystr_t::compare_bin_str(key_raw, key_raw_len, fence, key_raw_len);
+    } else {
+        d = w_keystr_t::compare_bin_str(key_raw, prefix_len, fence, prefix_len);
+        if (d == 0) {
+            d = w_keystr_t::compare_bin_str(key_raw + prefix_len, key_raw_len - prefix_len,
+                                            fence_high_noprefix, fence_high_len - prefix_len);
+        }
+    }
+    if (d >= 0) {
+        // key belongs to a foster child (or we are on the wrong page)
+        return ACCESS_ONCE(p->btree_foster);
+    }
+    if ((size_t) prefix_len > key_raw_len
+        || ::memcmp(key_raw, fence, prefix_len) != 0) {
+        return 0; // key below fence-low: we are on the wrong page
+    }
+
+    // same binary search as search(), over items 1..items-1
+    const void*  key_noprefix = key_raw + prefix_len;
+    size_t       key_len      = key_raw_len - prefix_len;
+    poor_man_key poormkey     = _extract_poor_man_key(key_noprefix, key_len);
+    int low = -1, high = items - 1;
+    while (low + 1 < high) {
+        int mid = (low + high) / 2;
+        poor_man_key poor;
+        if (!p->optimistic_item_poor(mid + 1, poor)) {
+            return 0;
+        }
+        int cmp = poor < poormkey ? -1 : (poor > poormkey ? 1 : 0);
+        if (cmp == 0) {
+            const char* data;
+            size_t      length;
+            if (!p->optimistic_item(mid + 1, child, data, length)
+                || length < sizeof(lsn_t)) {
+                return 0;
+            }
+            INC_TSTAT(bt_full_key_compares);
+            cmp = w_keystr_t::compare_bin_str(data, length - sizeof(lsn_t),
+                                              key_noprefix, key_len);
+        }
+        if (cmp < 0) {        // search key after slot
+            low = mid;
+        } else if (cmp > 0) { // search key before slot
+            high = mid;
+        } else {              // separator keys are inclusive for the right child
+            low = mid;
+            break;
+        }
+    }
+
+    if (low < 0) {
+        return ACCESS_ONCE(p->btree_pid0);
+    }
+    const char* data;
+    size_t      length;
+    if (!p->optimistic_item(low + 1, child, data, length)) {
+        return 0;
+    }
+    return child;
+}
+
 
 void btree_page_h::_update_btree_consecutive_skewed_insertions(slotid_t slot) {
     if (nrecs() == 0) {
@@ -1253,7 +1379,10 @@ rc_t btree_page_h::replace_ghost(const w_keystr_t &key,
     w_assert3 (rec.key().compare(key) == 0);
 #endif // W_DEBUG_LEVEL > 2
 
-    if (!page()->replace_item_data(slot+1, _element_offset(slot), elem)) {
+    cvec_t      stored;
+    std::string buffer;
+    _pack_element(stored, elem, buffer);
+    if (!page()->replace_item_data(slot+1, _element_offset(slot), stored)) {
         w_assert1(false); // should not happen because ghost should have had enough space
     }
 
@@ -1266,7 +1395,10 @@ rc_t btree_page_h::replace_el_nolog(slotid_t slot, const cvec_t &elem) {
     w_assert2( is_leaf());
     w_assert1(!is_ghost(slot));
 
-    if (!page()->replace_item_data(slot+1, _element_offset(slot), elem)) {
+    cvec_t      stored;
+    std::string buffer;
+    _pack_element(stored, elem, buffer);
+    if (!page()->replace_item_data(slot+1, _element_offset(slot), stored)) {
         return RC(eRECWONTFIT);
     }
     return RCOK;
@@ -1278,6 +1410,19 @@ void btree_page_h::overwrite_el_nolog(slotid_t slot, smsize_t offset,
     w_assert2( is_leaf());
     w_assert1 (!is_ghost(slot));
 
+    if (is_value_compressed()) {
+        // decompress, overwrite and compress again; the caller made sure
+        // that there is enough space in case it compresses worse now
+        smsize_t len;
+        bool ghost;
+        std::string value;
+        element(slot, len, ghost, value);
+        w_assert1(offset + elen <= len);
+        value.replace(offset, elen, new_el, elen);
+        W_COERCE(replace_el_nolog(slot, cvec_t(value.data(), len)));
+        return;
+    }
+
     size_t data_offset = _element_offset(slot);
     w_assert1(data_offset+offset+elen <= page()->item_length(slot+1));
 
@@ -1366,7 +1511,10 @@ void btree_page_h::insert_nonghost(const w_keystr_t &key, const cvec_t &elem) {
         // == 0, which mins replace_item_data will be invoked on slot 1. This
         // means that all methods that iterate over slots (e.g.,
         // _convrt_to_disk_page) must skip slot 0 (what a great design ...)
-        if (!page()->replace_item_data(slot+1, _element_offset(slot), elem)) {
+        cvec_t      stored;
+        std::string buffer;
+        _pack_element(stored, elem, buffer);
+        if (!page()->replace_item_data(slot+1, _element_offset(slot), stored)) {
             w_assert1(false); // should not happen because ghost should have had enough space
         }
 
@@ -1384,8 +1532,11 @@ void btree_page_h::insert_nonghost(const w_keystr_t &key, const cvec_t &elem) {
 
     cvec_t leaf_record;
     pack_scratch_t leaf_scratch;
+    std::string buffer;
+    cvec_t      stored;
+    _pack_element(stored, elem, buffer);
     _pack_leaf_record_prefix(leaf_record, leaf_scratch, trunc_key);
-    leaf_record.put(elem);
+    leaf_record.put(stored);
     if (!page()->insert_item(slot+1, false, poormkey, 0, leaf_record)) {
         w_assert0(false);
     }
@@ -1413,6 +1564,18 @@ bool btree_page_h::check_space_for_insert_leaf(size_t trunc_key_length, size_t e
     size_t data_length = _predict_leaf_data_length(trunc_key_length, element_length);
     return btree_page_h::_check_space_for_insert(data_length);
 }
+bool btree_page_h::check_space_for_replace_el(slotid_t slot, const cvec_t& el) const {
+    w_assert1 (is_leaf());
+    smsize_t stored_length;
+    _stored_element(slot, stored_length);
+    if (!is_value_compressed()) {
+        return el.size() <= stored_length;
+    }
+    cvec_t      stored;
+    std::string buffer;
+    _pack_element(stored, el, buffer);
+    return stored.size() <= stored_length;
+}
 bool btree_page_h::check_space_for_insert_node(const w_keystr_t& key) {
     w_assert1 (is_node());
     size_t data_length = key.get_length_as_keystr() + sizeof(lsn_t);
@@ -1423,14 +1586,9 @@ bool btree_page_h::check_chance_for_norecord_split(const w_keystr_t& key_to_inse
     if (!is_insertion_extremely_skewed_right()) {
         return false; // not a good candidate for norecord-split
     }
-    if (nrecs() == 0) {
+    if (nrecs() == 0 || !is_leaf()) {
         return false;
     }
-    if (usable_space() > used_space() * 3 / nrecs()
-        && usable_space() > SM_PAGESIZE / 10
-    ) {
-        return false; // too early to split
-    }
 
     const char* key_to_insert_raw = (const char*) key_to_insert.buffer_as_keystr();
     int key_to_insert_len = key_to_insert.get_length_as_keystr();
@@ -1438,44 +1596,84 @@ bool btree_page_h::check_chance_for_norecord_split(const w_keystr_t& key_to_inse
     w_assert1(key_to_insert_len >= prefix_len && ::memcmp(get_prefix_key(), key_to_insert_raw, prefix_len) == 0); // otherwise why to insert to this page?
 
     int d = _compare_key_noprefix(nrecs() - 1, key_to_insert_raw + prefix_len, key_to_insert_len - prefix_len);
-    if (d <= 0) {
+    if (d >= 0) {
         return false; // not hitting highest. norecord-split will be useless
     }
 
-    // we need some space for updated fence-high and chain-high
-    smsize_t space_for_split = get_fence_low_length() + key_to_insert.get_length_as_keystr();
-    if (get_chain_fence_high_length() == 0) {
-        space_for_split += get_fence_high_length(); // newly set chain-high
-    } else {
-        space_for_split += get_chain_fence_high_length(); // otherwise chain-fence-high is unchanged
+    // we need some space for the new fence record with updated fence-high
+    // (at most as long as the new key) and chain-high, see _pack_fence_rec()
+    smsize_t chain_length = get_chain_fence_high_length();
+    if (chain_length == 0) {
+        chain_length = get_fence_high_length(); // newly set chain-high
+    }
+    smsize_t new_high_length = key_to_insert_len;
+    smsize_t space_for_split = page()->predict_item_space(get_fence_low_length()
+        + new_high_length - prefix_len + std::max(chain_length, new_high_length));
+    if (usable_space() < space_for_split) {
+        return false; // too late
     }
-    return (usable_space() >= ALIGN_BYTE(space_for_split)); // otherwise it's too late
+    // too early if one more record of the usual size still fits besides the new fences
+    return usable_space() < space_for_split + used_space() / nrecs();
 }
 
 void btree_page_h::suggest_fence_for_split(w_keystr_t &mid,
                                            slotid_t& right_begins_from,
-                                           const w_keystr_t &
-#ifdef NORECORD_SPLIT_ENABLE
-                                               triggering_key
-#endif // NORECORD_SPLIT_ENABLE
-    ) const {
-// TODO for fair comparison with shore-mt, let's disable no-record-split for now
-#ifdef NORECORD_SPLIT_ENABLE
-    // if this is bulk-load case, simply make the new key as mid key (100% split)
-    if (check_chance_for_norecord_split(triggering_key)) {
-        right_begins_from = nrecs();
-        if (is_leaf()) {
+                                           const w_keystr_t &triggering_key) const {
+    // Sequential insertions (e.g., ever-increasing order IDs) would leave
+    // half-full pages behind if we split in the middle. Instead, we split at
+    // the edge of the page the insertions go to, with the shortest separator
+    // between the new key and the records.
+    if (is_leaf() && nrecs() > 0) {
+        // right edge: the new key starts an empty foster child while this
+        // page stays full and moves no record ("no-copy" split)
+        if (check_chance_for_norecord_split(triggering_key)) {
+            right_begins_from = nrecs();
             w_keystr_t lastkey;
             get_key(nrecs() - 1, lastkey);
             size_t common_bytes = lastkey.common_leading_bytes(triggering_key);
             w_assert1(common_bytes < triggering_key.get_length_as_keystr());
             mid.construct_from_keystr(triggering_key.buffer_as_keystr(), common_bytes + 1);
-        } else {
-            mid = triggering_key;
+            INC_TSTAT(bt_edge_splits);
+            return;
+        }
+        // left edge: a foster child can only be on the right, so the
+        // records move to it and this page keeps the key range below them
+        // for the new key and the ones that follow.  Only the few lowest
+        // records stay, to make room for the longer fence keys of the
+        // foster child.
+        if (is_insertion_extremely_skewed_left() && nrecs() >= 2) {
+            w_keystr_t firstkey;
+            get_key(0, firstkey);
+            if (triggering_key.compare(firstkey) < 0) {
+                size_t freed = 0;
+                slotid_t boundary = 0;
+                size_t len1, len2;
+                const char* k2 = NULL;
+                while (boundary < nrecs() - 1) {
+                    freed += get_rec_space(boundary);
+                    ++boundary;
+                    // low fence is at most as long as the key at the boundary
+                    k2 = _leaf_key_noprefix(boundary, len2);
+                    if (freed >= ALIGN_BYTE(get_fence_high_length() * 2
+                                            + get_prefix_length() + len2)) {
+                        break;
+                    }
+                    k2 = NULL;
+                }
+                if (k2 != NULL) {
+                    const char* k1 = _leaf_key_noprefix(boundary - 1, len1);
+                    size_t common_bytes = w_keystr_t::common_leading_bytes(
+                        (const unsigned char *) k1, len1, (const unsigned char *) k2, len2);
+                    w_assert1(common_bytes < len2);
+                    right_begins_from = boundary;
+                    mid.construct_from_keystr(get_prefix_key(), get_prefix_length(),
+                                              k2, common_bytes + 1);
+                    INC_TSTAT(bt_edge_splits);
+                    return;
+                }
+            }
         }
-        return;
     }
-#endif // NORECORD_SPLIT_ENABLE
 
     w_assert1 (nrecs() >= 2);
     // pick the best separator key as follows.
@@ -1576,7 +1774,102 @@ void btree_page_h::get_key(slotid_t slot,  w_keystr_t &key) const {
 }
 
 
-const char* btree_page_h::element(int slot, smsize_t &len, bool &ghost) const {
+void btree_page_h::_pack_element(cvec_t& stored, const cvec_t& elem,
+                                 std::string& buffer) const {
+    if (!is_value_compressed()) {
+        stored.put(elem);
+        return;
+    }
+    // the flat element, followed by its encoding (at most one byte longer)
+    size_t elen = elem.size();
+    buffer.resize(2 * elen + 1);
+    char* element = &buffer[0];
+    elem.copy_to(element, elen);
+    size_t len = _encode_element(element, elen, element + elen);
+    stored.put(element + elen, len);
+    ADD_TSTAT(bt_value_bytes, elem.size());
+    ADD_TSTAT(bt_value_bytes_stored, len);
+}
+
+size_t btree_page_h::_encode_element(const char* element, size_t len, char* out) {
+    // leave out the format byte for the plain element
+    const size_t max_encoded = len + 1;
+    size_t o = 1;
+    size_t i = 0;
+    while (i < len && o < max_encoded) {
+        size_t run = 1;
+        while (i + run < len && run < 130 && element[i + run] == element[i]) {
+            ++run;
+        }
+        if (run >= 3) {
+            if (o + 2 > max_encoded) {
+                break;
+            }
+            out[o++] = (char) (run + 125);
+            out[o++] = element[i];
+            i += run;
+            continue;
+        }
+        // literals until the next run of at least 3 bytes
+        size_t lit = 0;
+        while (i + lit < len && lit < 128) {
+            if (i + lit + 2 < len && element[i + lit] == element[i + lit + 1]
+                && element[i + lit] == element[i + lit + 2]) {
+                break;
+            }
+            ++lit;
+        }
+        if (o + 1 + lit > max_encoded) {
+            break;
+        }
+        out[o++] = (char) (lit - 1);
+        ::memcpy(out + o, element + i, lit);
+        o += lit;
+        i += lit;
+    }
+    if (i < len || o >= max_encoded) {
+        out[0] = 0; // plain
+        ::memcpy(out + 1, element, len);
+        return len + 1;
+    }
+    out[0] = 1; // runs
+    return o;
+}
+
+size_t btree_page_h::_decode_element(const char* encoded, size_t encoded_len,
+                                     char* out, size_t max_len) {
+    if (encoded_len == 0) {
+        return 0; // e.g., reserved ghost
+    }
+    if (encoded[0] != 1) {
+        if (out != NULL) {
+            ::memcpy(out, encoded + 1, std::min(encoded_len - 1, max_len));
+        }
+        return encoded_len - 1;
+    }
+    size_t len = 0;
+    for (size_t i = 1; i < encoded_len;) {
+        unsigned char c = (unsigned char) encoded[i++];
+        if (c < 128) {
+            size_t lit = std::min<size_t>(c + 1, encoded_len - i);
+            if (out != NULL && len + lit <= max_len) {
+                ::memcpy(out + len, encoded + i, lit);
+            }
+            len += lit;
+            i += lit;
+        } else if (i < encoded_len) {
+            size_t run = c - 125;
+            if (out != NULL && len + run <= max_len) {
+                ::memset(out + len, encoded[i], run);
+            }
+            len += run;
+            ++i;
+        }
+    }
+    return len;
+}
+
+const char* btree_page_h::_stored_element(int slot, smsize_t &len) const {
     w_assert1(is_leaf());
 
     size_t offset = _element_offset(slot);
@@ -1584,12 +1877,39 @@ const char* btree_page_h::element(int slot, smsize_t &len, bool &ghost) const {
     w_assert1(length >= 0);
 
     len   = length;
-    ghost = is_ghost(slot);
     return page()->item_data(slot+1) + offset;
 }
+const char* btree_page_h::element(int slot, smsize_t &len, bool &ghost,
+                                  std::string &buffer) const {
+    const char* stored = _stored_element(slot, len);
+    ghost = is_ghost(slot);
+    if (!is_value_compressed()) {
+        return stored;
+    }
+    smsize_t stored_len = len;
+    len = _decode_element(stored, stored_len, NULL, 0);
+    buffer.resize(len);
+    _decode_element(stored, stored_len, &buffer[0], len);
+    return buffer.data();
+}
 bool btree_page_h::copy_element(int slot, char *out_buffer, smsize_t &len, bool &ghost) const {
+    if (is_value_compressed()) {
+        // decompress straight into the given buffer, if it is large enough
+        smsize_t stored_len;
+        const char* stored = _stored_element(slot, stored_len);
+        ghost = is_ghost(slot);
+        smsize_t actual_length = _decode_element(stored, stored_len, NULL, 0);
+        bool fits = (len >= actual_length);
+        if (fits) {
+            _decode_element(stored, stored_len, out_buffer, len);
+        }
+        len = actual_length;
+        return fits;
+    }
+
     smsize_t actual_length;
-    const char* element_data = element(slot, actual_length, ghost);
+    const char* element_data = _stored_element(slot, actual_length);
+    ghost = is_ghost(slot);
 
     if (len >= actual_length) {
         ::memcpy(out_buffer, element_data, actual_length);
@@ -1605,19 +1925,28 @@ bool btree_page_h::copy_element(int slot, char *out_buffer, smsize_t &len, bool
 
 rc_t
 btree_page_h::leaf_stats(btree_lf_stats_t& _stats) {
-    _stats.hdr_bs    += hdr_sz + page()->item_space(0);
+    // the fence record and the space between items (holes) count as header
+    _stats.hdr_bs    += hdr_sz + data_sz - usable_space();
     _stats.unused_bs += usable_space();
 
     int n = nrecs();
-    _stats.entry_cnt += n;
-    int16_t prefix_length = get_prefix_length();
     for (int i = 0; i < n; i++)  {
-        btrec_t rec;
-        rec.set(*this, i);
+        size_t space = page()->item_space(i + 1);
+        _stats.hdr_bs -= space;
+        if (is_ghost(i)) {
+            // can be reclaimed by defrag
+            _stats.unused_bs += space;
+            continue;
+        }
+        ++_stats.entry_cnt;
         ++_stats.unique_cnt; // always unique (otherwise a bug)
-        _stats.key_bs            += rec.key().get_length_as_keystr() - prefix_length;
-        _stats.data_bs           += rec.elen();
-        _stats.entry_overhead_bs += page()->item_space(n+1) - (rec.key().get_length_as_keystr()-prefix_length) - rec.elen();
+        size_t key_len;
+        smsize_t elem_len;
+        _leaf_key_noprefix(i, key_len);
+        _stored_element(i, elem_len);
+        _stats.key_bs            += key_len;
+        _stats.data_bs           += elem_len;
+        _stats.entry_overhead_bs += space - key_len - elem_len;
     }
     return RCOK;
 }
@@ -1625,19 +1954,151 @@ btree_page_h::leaf_stats(btree_lf_stats_t& _stats) {
 rc_t
 btree_page_h::int_stats(btree_int_stats_t& _stats) {
     _stats.unused_bs += usable_space();
-    _stats.used_bs   += used_space();
+    _stats.used_bs   += hdr_sz + used_space();
+    return RCOK;
+}
+
+void btree_lf_stats_t::add(const btree_lf_stats_t& stats) {
+    hdr_bs += stats.hdr_bs;
+    key_bs += stats.key_bs;
+    data_bs += stats.data_bs;
+    entry_overhead_bs += stats.entry_overhead_bs;
+    unused_bs += stats.unused_bs;
+    entry_cnt += stats.entry_cnt;
+    unique_cnt += stats.unique_cnt;
+}
+
+void btree_lf_stats_t::clear() {
+    hdr_bs = 0;
+    key_bs = 0;
+    data_bs = 0;
+    entry_overhead_bs = 0;
+    unused_bs = 0;
+    entry_cnt = 0;
+    unique_cnt = 0;
+}
+
+w_rc_t btree_lf_stats_t::audit() const {
+    if (total_bytes() % sizeof(generic_page) != 0 || unique_cnt > entry_cnt) {
+        return RC(eINTERNAL);
+    }
+    return RCOK;
+}
+
+base_stat_t btree_lf_stats_t::total_bytes() const {
+    return hdr_bs + key_bs + data_bs + entry_overhead_bs + unused_bs;
+}
+
+void btree_lf_stats_t::print(ostream& o, const char *pref) const {
+    o << pref << "hdr_bs " << hdr_bs << endl
+      << pref << "key_bs " << key_bs << endl
+      << pref << "data_bs " << data_bs << endl
+      << pref << "entry_overhead_bs " << entry_overhead_bs << endl
+      << pref << "unused_bs " << unused_bs << endl
+      << pref << "entry_cnt " << entry_cnt << endl
+      << pref << "unique_cnt " << unique_cnt << endl;
+}
+
+ostream& operator<<(ostream& o, const btree_lf_stats_t& s) {
+    s.print(o, "btree_lf ");
+    return o;
+}
+
+void btree_int_stats_t::add(const btree_int_stats_t& stats) {
+    used_bs += stats.used_bs;
+    unused_bs += stats.unused_bs;
+}
+
+void btree_int_stats_t::clear() {
+    used_bs = 0;
+    unused_bs = 0;
+}
+
+w_rc_t btree_int_stats_t::audit() const {
+    if (total_bytes() % sizeof(generic_page) != 0) {
+        return RC(eINTERNAL);
+    }
     return RCOK;
 }
 
+base_stat_t btree_int_stats_t::total_bytes() const {
+    return used_bs + unused_bs;
+}
+
+void btree_int_stats_t::print(ostream& o, const char *pref) const {
+    o << pref << "used_bs " << used_bs << endl
+      << pref << "unused_bs " << unused_bs << endl;
+}
+
+ostream& operator<<(ostream& o, const btree_int_stats_t& s) {
+    s.print(o, "btree_int ");
+    return o;
+}
+
+void btree_stats_t::add(const btree_stats_t& stats) {
+    leaf_pg.add(stats.leaf_pg);
+    int_pg.add(stats.int_pg);
+    leaf_pg_cnt += stats.leaf_pg_cnt;
+    int_pg_cnt += stats.int_pg_cnt;
+    unlink_pg_cnt += stats.unlink_pg_cnt;
+    unalloc_pg_cnt += stats.unalloc_pg_cnt;
+    level_cnt = std::max(level_cnt, stats.level_cnt);
+}
+
+void btree_stats_t::clear() {
+    leaf_pg.clear();
+    int_pg.clear();
+    leaf_pg_cnt = 0;
+    int_pg_cnt = 0;
+    unlink_pg_cnt = 0;
+    unalloc_pg_cnt = 0;
+    level_cnt = 0;
+}
+
+w_rc_t btree_stats_t::audit() const {
+    W_DO(leaf_pg.audit());
+    W_DO(int_pg.audit());
+    // every page found by the traversal must be fully accounted for
+    if (leaf_pg.total_bytes() != leaf_pg_cnt * (base_stat_t) sizeof(generic_page)
+        || int_pg.total_bytes() != int_pg_cnt * (base_stat_t) sizeof(generic_page)) {
+        return RC(eINTERNAL);
+    }
+    return RCOK;
+}
+
+base_stat_t btree_stats_t::total_bytes() const {
+    return leaf_pg.total_bytes() + int_pg.total_bytes();
+}
+
+base_stat_t btree_stats_t::alloc_pg_cnt() const {
+    return leaf_pg_cnt + int_pg_cnt + unlink_pg_cnt;
+}
+
+void btree_stats_t::print(ostream& o, const char *pref) const {
+    leaf_pg.print(o, pref);
+    int_pg.print(o, pref);
+    o << pref << "leaf_pg_cnt " << leaf_pg_cnt << endl
+      << pref << "int_pg_cnt " << int_pg_cnt << endl
+      << pref << "unlink_pg_cnt " << unlink_pg_cnt << endl
+      << pref << "unalloc_pg_cnt " << unalloc_pg_cnt << endl
+      << pref << "level_cnt " << level_cnt << endl;
+}
+
+ostream& operator<<(ostream& o, const btree_stats_t& s) {
+    s.print(o, "btree ");
+    return o;
+}
+
 
 smsize_t
 btree_page_h::max_entry_size =
     // must be able to fit 2 entries to a page; data_sz must hold:
     //    fence record:                   max_item_overhead + (max_entry_size+1)*3   (low, high, chain keys)
     //    each of 2 regular leaf entries: max_item_overhead + max_entry_size+1 + sizeof(key_length_t) [key len]
+    //                                    + 1 [format byte of compressed elements]
     //
     // +1's are for signed byte of keys
-    (btree_page::data_sz - 3*btree_page::max_item_overhead - 2*sizeof(key_length_t)) / 5 - 1;
+    (btree_page::data_sz - 3*btree_page::max_item_overhead - 2*sizeof(key_length_t) - 2) / 5 - 1;
 
 
 void
@@ -1846,23 +2307,27 @@ rc_t btree_page_h::compress(const w_keystr_t& low, const w_keystr_t& high,
 
     size_t diff = prefix_len - old_prefix_len;
     // remove diff bytes from position pos of each key on the page
-    // First bytes of data are the key length -- we don't want to
-    // truncate that
-    page()->truncate_all(diff, sizeof(key_length_t));
+    // In leaves, first bytes of data are the key length -- we don't want to
+    // truncate that. Keys in interior nodes start right away.
+    page()->truncate_all(diff, is_leaf() ? sizeof(key_length_t) : 0);
 
     page()->btree_prefix_length = (int16_t) prefix_len;
 
     // Update all key lengths and poorman's keys
     for (int i = 1; i <= nrecs(); i++) {
-        char* data = page()->item_data(i);
-        key_length_t key_len =
-            *((key_length_t*) page()->item_data(i)) - diff;
-        ::memcpy(data, &key_len, sizeof(key_length_t));
-
+        const char* key_noprefix;
+        size_t key_len;
+        if (is_leaf()) {
+            char* data = page()->item_data(i);
+            key_length_t new_key_len = *((key_length_t*) data) - diff;
+            ::memcpy(data, &new_key_len, sizeof(key_length_t));
+            key_noprefix = _leaf_key_noprefix(i - 1, key_len);
+        } else {
+            key_noprefix = _node_key_noprefix(i - 1, key_len);
+        }
 
-        poor_man_key poormkey = _extract_poor_man_key(
-                page()->item_data(i) + sizeof(key_length_t), key_len);
-        page()->item_poor(i) = poormkey;
+        poor_man_key poormkey = _extract_poor_man_key(key_noprefix, key_len);
+        page()->set_item_poor(i, poormkey);
     }
 
     // replace fence keys
@@ -1896,7 +2361,9 @@ void btree_page_h::_init(lsn_t lsn, PageID page_id, StoreID store,
     const w_keystr_t &high,                  // High key, confusing naming, it is actually the foster key
     const w_keystr_t &chain_fence_high,      // Chain high fence key (if foster chain),
                                              // it is the high fence key for all foster child nodes
-    const bool ghost )                       // Should the fence key record be a ghost?
+    const bool ghost,                        // Should the fence key record be a ghost?
+    int poor_key_width,                      // Bytes of poor man's normalized keys
+    bool compressed_values)                  // Are elements of leaf records compressed?
 {
 
     // Initialize the current page with fence keys and other information
@@ -1925,6 +2392,8 @@ void btree_page_h::_init(lsn_t lsn, PageID page_id, StoreID store,
     page()->store        = store;
     page()->tag          = t_btree_p;
     page()->page_flags   = 0;
+    page()->set_poor_key_width(poor_key_width);
+    page()->set_compressed_values(compressed_values);
     page()->init_items();
     page()->btree_consecutive_skewed_insertions = 0;
     page()->btree_root                    = root_pid;
@@ -5,6 +5,8 @@
 #ifndef BTREE_PAGE_H_H
 #define BTREE_PAGE_H_H
 
+#include <string>
+
 #include "btree_page.h"
 
 #include "w_defines.h"
@@ -64,6 +66,8 @@ private:
      */
     lsn_t           _child_emlsn;
     cvec_t          _elem;
+    /// copy of the decompressed element if the page has compressed values
+    std::string     _elem_buffer;
 
     // disabled
     NORET            btrec_t(const btrec_t&);
@@ -129,11 +133,12 @@ class btree_ghost_reclaim_log;
  * avoiding L1 cache misses.  The whole point of poor_man_key is
  * avoiding cache misses!
  *
- * NOTE So far, poor-man's normalied key is 2 byte integer (uint16_t)
- * and the corresponding bytes are NOT eliminated from the key string
- * in the record.  This is to speed up the retrieval of the
- * (truncated) complete key at the cost of an additional 2 bytes to
- * store it.  I admit this is arguable, but deserilizing the first
+ * NOTE Poor-man's normalized keys are 2 bytes by default, or 4 or 8
+ * bytes if chosen so when creating the index (see
+ * btree_page_data::poor_key_width()), and the corresponding bytes are
+ * NOT eliminated from the key string in the record.  This is to speed
+ * up the retrieval of the (truncated) complete key at the cost of an
+ * additional 2 (or more) bytes to store it.  I admit this is arguable, but deserilizing the first
  * part everytime (it's likely little-endian, so we need to flip it)
  * will slow down retrieval.
  *
@@ -251,6 +256,10 @@ public:
     const char* get_prefix_key() const;
     /// Returns the length of prefix key (0 means no prefix compression).
     int16_t           get_prefix_length() const;
+    /// Returns the number of key bytes kept as poor man's normalized key (same in the whole B-tree).
+    int               get_poor_key_width() const;
+    /// Returns if elements of leaf records are stored compressed (same in the whole B-tree).
+    bool              is_value_compressed() const;
     /// Returns the low fence key, which is same OR smaller than all entries in this page and its descendants.
     const char*  get_fence_low_key() const;
     /// Returns the length of low fence key.
@@ -437,7 +446,13 @@ public:
                          const w_keystr_t& fence_high,
                          const w_keystr_t& chain_fence_high);
 
-    /// Returns if whether we can do norecord insert now.
+    /**
+     * Returns whether this leaf should now split off an empty foster child
+     * for the given key, which is beyond all its records, without moving any
+     * record (see suggest_fence_for_split()).  This is the case if insertions
+     * have been sequential and the page is just about full, but still has
+     * space for the new fence keys.
+     */
     bool                 check_chance_for_norecord_split(const w_keystr_t& key_to_insert) const;
 
 
@@ -461,9 +476,14 @@ public:
      * Return pointer to, length of element of given record.  Also
      * returns ghost status of given record.
      *
+     * If is_value_compressed(), the element is decompressed into buffer,
+     * and the returned pointer is valid as long as buffer is not modified.
+     * Otherwise, it points into the page and buffer is left alone.
+     *
      * @pre we are a leaf page
      */
-    const char*     element(int slot, smsize_t &len, bool &ghost) const;
+    const char*     element(int slot, smsize_t &len, bool &ghost,
+                            std::string &buffer) const;
 
     /**
      * Attempt to copy element of given record to provided buffer
@@ -582,6 +602,19 @@ public:
     void            search_node(const w_keystr_t& key,
                                 slotid_t&         return_slot) const;
 
+    /**
+     * Latch-free variant of search_node() for optimistic traversals, which
+     * read interior nodes while they may be modified concurrently.
+     *
+     * Returns the opaque pointer of the child to follow for the given
+     * key, or of the foster child if the key is not below the high fence
+     * key. Returns 0 if the page content does not look like a consistent
+     * interior node. Every access is bounded to the page and no assertion
+     * is checked, but the result is meaningful only if the latch version
+     * of the frame is validated afterwards.
+     */
+    PageID          search_node_optimistic(const w_keystr_t& key) const;
+
 
     // ======================================================================
     //   BEGIN: Insert/Update/Delete functions
@@ -700,6 +733,12 @@ public:
      */
     bool           check_space_for_insert_leaf(const w_keystr_t &trunc_key, const cvec_t &el);
     bool           check_space_for_insert_leaf(size_t trunc_key_length, size_t element_length);
+    /**
+     * Returns if the element of the given record can be replaced with el
+     * without taking more space, i.e., if el is stored (encoded, if
+     * is_value_compressed()) in at most as many bytes as the current element.
+     */
+    bool           check_space_for_replace_el(slotid_t slot, const cvec_t &el) const;
     /// for intermediate node (no element).
     bool           check_space_for_insert_node(const w_keystr_t &key);
 
@@ -721,6 +760,7 @@ public:
     w_keystr_t           recalculate_fence_for_split(slotid_t right_begins_from) const;
 
     bool                 is_insertion_extremely_skewed_right() const;
+    bool                 is_insertion_extremely_skewed_left() const;
     bool                 is_insertion_skewed_right() const;
     bool                 is_insertion_skewed_left()  const;
 
@@ -886,17 +926,60 @@ private:
     /**
      * Compute needed length of variable-size data to store a leaf
      * record with the given truncated key and element lengths.
+     * If is_value_compressed(), this is an upper bound.
      */
     size_t _predict_leaf_data_length(int trunc_key_length, int element_length) const;
 
+    /**
+     * Returns the element of given record as it is stored in this page,
+     * i.e., still compressed if is_value_compressed().  Records moved to
+     * another page of the same B-tree can keep it as is.
+     *
+     * @pre we are a leaf page
+     */
+    const char*     _stored_element(int slot, smsize_t &len) const;
+
+    /**
+     * Sets stored to elem as it is stored in this page: elem itself, or,
+     * if is_value_compressed(), its encoding in buffer, which must remain
+     * unmodified while stored is used.  See _encode_element().
+     */
+    void            _pack_element(cvec_t& stored, const cvec_t& elem,
+                                  std::string& buffer) const;
+
+    /**
+     * Encodes an element of length len for pages with compressed values
+     * into out (of at least len + 1 bytes) and returns the encoded length.
+     *
+     * Row values tend to contain runs of the same byte, such as padding
+     * of fixed-length strings or the high-order bytes of small integers.
+     * After a leading format byte, the encoding consists of runs, each
+     * starting with a control byte c: if c < 128, c+1 literal bytes
+     * follow; otherwise, the one following byte repeats c-125 times.  If
+     * that does not save space, the format byte is 0 and the element
+     * follows as is.  Records are encoded individually, so that they can
+     * be moved between pages without re-encoding them.
+     */
+    static size_t   _encode_element(const char* element, size_t len, char* out);
+
+    /**
+     * Decodes an element encoded by _encode_element() into out (of at
+     * least max_len bytes) and returns its length.  If out is NULL, only
+     * returns the length.
+     */
+    static size_t   _decode_element(const char* encoded, size_t encoded_len,
+                                    char* out, size_t max_len);
+
 
     /**
      * \brief Poor man's normalized key type.
      *
      * \details
      * To speed up comparison this should be an integer type, not char[].
+     * Only the first btree_page_data::poor_key_width() bytes of the key
+     * are used.
      */
-    typedef uint16_t poor_man_key;
+    typedef btree_page::poor_man_key poor_man_key;
 
     /// Returns the value of poor-man's normalized key for the given key string WITHOUT prefix.
     poor_man_key _extract_poor_man_key(const void* trunc_key, size_t trunc_key_len) const;
@@ -972,7 +1055,8 @@ private:
         PageID root_pid, PageID pid0, lsn_t pid0_emlsn,
         PageID foster_pid, lsn_t foster_emlsn, int16_t btree_level,
         const w_keystr_t &low, const w_keystr_t &high,
-        const w_keystr_t &chain_fence_high, const bool ghost);
+        const w_keystr_t &chain_fence_high, const bool ghost,
+        int poor_key_width, bool compressed_values);
 
 public:
     friend std::ostream& operator<<(std::ostream& os, btree_page_h& b);
@@ -1119,6 +1203,12 @@ inline PageID btree_page_h::get_foster_opaqueptr() const {
 inline int16_t btree_page_h::get_prefix_length() const {
     return page()->btree_prefix_length;
 }
+inline int btree_page_h::get_poor_key_width() const {
+    return page()->poor_key_width();
+}
+inline bool btree_page_h::is_value_compressed() const {
+    return page()->compressed_values();
+}
 inline int16_t btree_page_h::get_fence_low_length() const {
     return page()->btree_fence_low_length;
 }
@@ -1208,6 +1298,14 @@ inline bool btree_page_h::is_insertion_extremely_skewed_right() const {
         || (ins > 1 && ins >= nrecs() - 1)
         ;
 }
+inline bool btree_page_h::is_insertion_extremely_skewed_left() const {
+    // completely reverse-sorted insertion
+    int ins = -page()->btree_consecutive_skewed_insertions;
+    return ins > 50
+        || ins > nrecs() * 9 / 10
+        || (ins > 1 && ins >= nrecs() - 1)
+        ;
+}
 inline bool btree_page_h::is_insertion_skewed_right() const {
     return page()->btree_consecutive_skewed_insertions > 5;
 }
@@ -1324,23 +1422,29 @@ inline int btree_page_h::_pack_fence_rec(cvec_t& out, const w_keystr_t& low,
 
 inline size_t btree_page_h::_predict_leaf_data_length(int trunc_key_length,
                                                       int element_length) const {
-    return sizeof(key_length_t) + trunc_key_length + element_length;
+    // encoded elements are at most one format byte longer
+    return sizeof(key_length_t) + trunc_key_length + element_length
+        + (is_value_compressed() ? 1 : 0);
 }
 
 inline btree_page_h::poor_man_key btree_page_h::_extract_poor_man_key(const void* trunc_key,
                                                                       size_t trunc_key_len) const {
-    if (trunc_key_len == 0) {
-        return 0;
-    } else if (trunc_key_len == 1) {
-        return (*reinterpret_cast<const unsigned char*>(trunc_key)) << 8;
-    } else {
+    int width = page()->poor_key_width();
+    if (width == 2 && trunc_key_len >= 2) {
         // convert big-endian array (usable with memcmp) into 16-bit integer (little-endian)
         return deserialize16_ho(trunc_key);
     }
+    // same for wider or shorter keys, padding with zeros
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(trunc_key);
+    poor_man_key poor = 0;
+    for (int i = 0; i < width; ++i) {
+        poor = (poor << 8) | ((size_t) i < trunc_key_len ? bytes[i] : 0);
+    }
+    return poor;
 }
 inline btree_page_h::poor_man_key btree_page_h::_extract_poor_man_key(const cvec_t& trunc_key) const {
-    char start[2];
-    trunc_key.copy_to(start, 2);
+    char start[btree_page::max_poor_key_width];
+    trunc_key.copy_to(start, btree_page::max_poor_key_width);
     return _extract_poor_man_key(start, trunc_key.size());
 }
 inline btree_page_h::poor_man_key
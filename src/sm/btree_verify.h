@@ -53,6 +53,12 @@ public:
     }
     /** Returns if all bitmap entries are zero, implying that the BTree is consistent. */
     bool is_bitmap_clean () const;
+    /**
+     * Adds the facts, expectations and counts collected by another context
+     * with the same hash_bits, e.g., by another thread verifying another part
+     * of the same BTree.
+     */
+    void merge (const verification_context &other);
 private:
     static uint32_t _modify_hash (const char* data, size_t len, uint32_t hash_value);
     static uint32_t _modify_hash (uint32_t data, uint32_t hash_value);
@@ -71,6 +77,8 @@ public:
     ~verify_volume_result();
     verification_context* get_or_create_context (PageID root_pid, int hash_bits);
     verification_context* get_context (PageID root_pid);
+    /** Merges the contexts of another result into the contexts of this one. */
+    void merge (const verify_volume_result &other, int hash_bits);
 
     std::map<PageID, verification_context*> _results;
 };
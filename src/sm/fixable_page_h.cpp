@@ -98,6 +98,17 @@ w_rc_t fixable_page_h::refix_direct (bf_idx idx, latch_mode_t mode, bool conditi
     return RCOK;
 }
 
+w_rc_t fixable_page_h::fix_optimistic(bf_idx idx, latch_mode_t mode) {
+    w_assert1(idx != 0);
+    w_assert1(mode != LATCH_NL);
+
+    unfix();
+    W_DO(smlevel_0::bf->fix_optimistic(_pp, idx, mode));
+    _bufferpool_managed = true;
+    _mode               = mode;
+    return RCOK;
+}
+
 w_rc_t fixable_page_h::fix_root (StoreID store, latch_mode_t mode,
         bool conditional, bool virgin)
 {
@@ -115,6 +115,13 @@ public:
      */
     w_rc_t refix_direct(bf_idx idx, latch_mode_t mode, bool conditional=false);
 
+    /**
+     * Fixes the page in the given frame, which was reached by an optimistic
+     * traversal without latching its parent (see bf_tree_m::fix_optimistic()).
+     * The caller must check that this is the page it was looking for.
+     */
+    w_rc_t fix_optimistic(bf_idx idx, latch_mode_t mode);
+
     /**
      * Fixes an existing (not virgin) root page for the given store.  This method doesn't
      * receive page ID because it's already known by bufferpool.
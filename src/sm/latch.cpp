@@ -72,7 +72,7 @@ const char* const  latch_t::latch_mode_str[4] = { "NL", "Q", "SH", "EX" };
 
 
 latch_t::latch_t() :
-    _total_count(0)
+    _total_count(0), _version(0)
 {
 }
 
@@ -512,8 +512,11 @@ latch_t::_release(latch_holder_t* me)
     }
     else {
         w_assert2(_lock.has_writer());
-        if (_lock.has_writer())
+        if (_lock.has_writer()) {
+            // invalidate optimistic readers before letting them in
+            _version.fetch_add(1, std::memory_order_release);
             _lock.release_write();
+        }
     }
     me->_mode = LATCH_NL;
     return 0;
@@ -535,6 +538,7 @@ latch_t::_downgrade(latch_holder_t* me)
     w_assert3(me->_mode == LATCH_EX);
     w_assert3(me->_count > 0);
 
+    _version.fetch_add(1, std::memory_order_release);
     _lock.downgrade();
     me->_mode = LATCH_SH;
 
@@ -64,6 +64,7 @@ Rome Research Laboratory Contract No. F30602-97-2-0247.
 
 #include "smthread.h"
 #include "latches.h"
+#include <atomic>
 #include <list>
 #include <thread>
 
@@ -188,6 +189,27 @@ public:
 	 * Returns the resulting latch count.
      */
     int                     latch_release();
+
+    /**\brief Begin an optimistic (latch-free) read of the protected data.
+     * \details
+     * Returns false if the latch is currently held in EX mode. Otherwise,
+     * version receives the current version of the latch, which is
+     * incremented every time an EX holder releases or downgrades it. Data
+     * read afterwards is consistent only if optimistic_validate() succeeds
+     * with the same version. Neither call writes to the latch.
+     */
+    bool                    optimistic_begin(uint32_t& version) const {
+        version = _version.load(std::memory_order_acquire);
+        return !_lock.has_writer();
+    }
+
+    /**\brief True iff no EX holder came by since optimistic_begin(). */
+    bool                    optimistic_validate(uint32_t version) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return !_lock.has_writer()
+            && _version.load(std::memory_order_relaxed) == version;
+    }
+
     /**\brief Unreliable, but helpful for some debugging.
      */
     bool                    is_latched() const;
@@ -239,6 +261,9 @@ private:
     latch_t&                     operator=(const latch_t&);
 
     uint32_t            _total_count;
+
+    /// Incremented whenever an EX hold ends. \sa optimistic_begin()
+    std::atomic<uint32_t> _version;
 };
 
 inline bool
@@ -37,13 +37,16 @@ void ConsolidationArray::wait_for_leader(CArraySlot* info) {
 
 bool ConsolidationArray::wait_for_expose(CArraySlot* info) {
     w_assert1(SLOT_FINISHED == info->vthis()->count);
-    w_assert1(CARRAY_RELEASE_DELEGATION);
+    w_assert1(_release_delegation);
     lintel::atomic_thread_fence(lintel::memory_order_seq_cst);
     // If there is a predecessor which is still running,
     // let's try to delegate the work of releasing the buffer
     // to the slow predecessor. 1/32 to stop too long chains.
+    // When delegation was turned on for private log buffers, the predecessor
+    // may be a chunk that stays open for a while, so we never spin on it.
     const int TERMINATE_CHAIN_POSSIBILITY = 32;
-    if(info->pred2 && (_indexof(info) % TERMINATE_CHAIN_POSSIBILITY) != 0) {
+    if(info->pred2 && (!CARRAY_RELEASE_DELEGATION
+                || (_indexof(info) % TERMINATE_CHAIN_POSSIBILITY) != 0)) {
         lintel::atomic_thread_fence(lintel::memory_order_release);
         // Atomically change my status to DELEGATED.
         int64_t waiting_cas_tmp = QNODE_WAITING._combined;
@@ -57,8 +60,9 @@ bool ConsolidationArray::wait_for_expose(CArraySlot* info) {
     return false;
 }
 
-ConsolidationArray::ConsolidationArray(int active_slot_count)
-    : _slot_mark(0), _active_slot_count(active_slot_count) {
+ConsolidationArray::ConsolidationArray(int active_slot_count, bool release_delegation)
+    : _slot_mark(0), _active_slot_count(active_slot_count),
+    _release_delegation(release_delegation) {
     // Zero-out all slots
     ::memset(_all_slots, 0, sizeof(CArraySlot) * ALL_SLOT_COUNT);
     typedef CArraySlot* CArraySlotPtr;
@@ -134,7 +138,7 @@ CArraySlot* ConsolidationArray::join_slot(int32_t size, carray_status_t &old_cou
 }
 
 void ConsolidationArray::join_expose(CArraySlot* info) {
-    if (CARRAY_RELEASE_DELEGATION) {
+    if (_release_delegation) {
         info->me2._status.individual._delegated = 0;
         info->pred2 = _expose_lock.__unsafe_begin_acquire(&info->me2);
     }
@@ -147,7 +151,7 @@ CArraySlot* ConsolidationArray::grab_delegated_expose(CArraySlot* info) {
     // 3. Spinning (can't delegate)
     // 4. Busy
     w_assert1(SLOT_FINISHED == info->vthis()->count);
-    if (CARRAY_RELEASE_DELEGATION) {
+    if (_release_delegation) {
         lintel::atomic_thread_fence(lintel::memory_order_release);
         // did next (predecessor in terms of logging) delegate to us?
         mcs_lock::qnode *next = info->me2.vthis()->_next;
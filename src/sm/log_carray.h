@@ -197,8 +197,14 @@ struct CArraySlot {
  */
 class ConsolidationArray {
 public:
-    /** @param[in] active_slot_count Max number of slots that can be active at the same time */
-    ConsolidationArray(int active_slot_count);
+    /**
+     * @param[in] active_slot_count Max number of slots that can be active at the same time
+     * @param[in] release_delegation Whether to enable \e Delegated-Buffer-Release.
+     * Private log buffers need it because a slot holding a reserved chunk is released
+     * only when the chunk is closed, which no successor may spin on.
+     */
+    ConsolidationArray(int active_slot_count,
+                       bool release_delegation = CARRAY_RELEASE_DELEGATION);
     ~ConsolidationArray();
 
     /** Constant numbers. */
@@ -297,6 +303,9 @@ public:
      */
     void                replace_active_slot(CArraySlot* slot);
 
+    /** Whether \e Delegated-Buffer-Release is enabled. */
+    bool                release_delegation() const { return _release_delegation; }
+
 private:
     int                 _indexof(const CArraySlot* slot) const;
 
@@ -308,6 +317,8 @@ private:
     int32_t             _slot_mark;
     /** Max number of slots that can be active at the same time. */
     const int32_t       _active_slot_count;
+    /** Whether \e Delegated-Buffer-Release is enabled. */
+    const bool          _release_delegation;
     /** All slots, including available, currently used, or retired slots. */
     CArraySlot          _all_slots[ALL_SLOT_COUNT];
     /** Active slots that are (probably) up for grab or join. */
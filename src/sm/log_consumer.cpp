@@ -91,7 +91,7 @@ bool ArchiverControl::waitForActivation()
 ReaderThread::ReaderThread(AsyncRingBuffer* readbuf, lsn_t startLSN)
     :
       log_worker_thread_t(-1 /* interval_ms */),
-      buf(readbuf), currentFd(-1), pos(0), localEndLSN(0)
+      buf(readbuf), pos(0), localEndLSN(0)
 {
     // position initialized to startLSN
     pos = startLSN.lo();
@@ -100,25 +100,21 @@ ReaderThread::ReaderThread(AsyncRingBuffer* readbuf, lsn_t startLSN)
 
 rc_t ReaderThread::openPartition()
 {
-    if (currentFd != -1) {
-        auto ret = ::close(currentFd);
-        CHECK_ERRNO(ret);
+    log_storage* storage = smlevel_0::log->get_storage();
+    if (!currentFds.empty()) {
+        storage->close_striped(currentFds);
     }
-    currentFd = -1;
 
     // open file for read -- copied from partition_t::peek()
-    int fd;
-    string fname = smlevel_0::log->make_log_name(nextPartition);
-
+    std::vector<int> fds;
     int flags = O_RDONLY;
-    fd = ::open(fname.c_str(), flags, 0744 /*mode*/);
-    CHECK_ERRNO(fd);
+    storage->open_striped(nextPartition, flags, fds);
 
-    struct stat stat;
-    auto ret = ::fstat(fd, &stat);
-    CHECK_ERRNO(ret);
-    if (stat.st_size == 0) { return RC(eEOF); }
-    off_t partSize = stat.st_size;
+    off_t partSize = storage->get_striped_size(fds);
+    if (partSize == 0) {
+        storage->close_striped(fds);
+        return RC(eEOF);
+    }
 
     /*
      * The size of the file must be at least the offset of endLSN, otherwise
@@ -132,9 +128,9 @@ rc_t ReaderThread::openPartition()
         w_assert1(partSize > 0);
     }
 
-    DBGTHRD(<< "Opened log partition for read " << fname);
+    DBGTHRD(<< "Opened log partition for read " << nextPartition);
 
-    currentFd = fd;
+    currentFds.swap(fds);
     nextPartition++;
     return RCOK;
 }
@@ -160,7 +156,7 @@ void ReaderThread::do_work()
 
     while(true) {
         unsigned currPartition =
-            currentFd == -1 ? nextPartition : nextPartition - 1;
+            currentFds.empty() ? nextPartition : nextPartition - 1;
         if (localEndLSN.hi() == currPartition && pos >= localEndLSN.lo())
         {
             /*
@@ -190,14 +186,14 @@ void ReaderThread::do_work()
         }
 
 
-        if (currentFd == -1) {
+        if (currentFds.empty()) {
             W_COERCE(openPartition());
         }
 
         // Read only the portion which was ignored on the last round
         size_t blockPos = pos % blockSize;
-        int bytesRead = ::pread(currentFd, dest + blockPos, blockSize - blockPos, pos);
-        CHECK_ERRNO(bytesRead);
+        int bytesRead = smlevel_0::log->get_storage()->read_striped(
+                currentFds, dest + blockPos, blockSize - blockPos, pos);
 
         if (bytesRead == 0) {
             // Reached EOF -- open new file and try again
@@ -205,8 +201,8 @@ void ReaderThread::do_work()
             W_COERCE(openPartition());
             pos = 0;
             blockPos = 0;
-            bytesRead = ::pread(currentFd, dest, blockSize, pos);
-            CHECK_ERRNO(bytesRead);
+            bytesRead = smlevel_0::log->get_storage()->read_striped(
+                    currentFds, dest, blockSize, pos);
             if (bytesRead == 0) {
                 W_FATAL_MSG(fcINTERNAL,
                         << "Error reading from partition "
@@ -159,7 +159,7 @@ protected:
     rc_t openPartition();
 
     AsyncRingBuffer* buf;
-    int currentFd;
+    std::vector<int> currentFds;
     off_t pos;
     lsn_t localEndLSN;
 
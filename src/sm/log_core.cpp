@@ -79,6 +79,7 @@ Rome Research Laboratory Contract No. F30602-97-2-0247.
 // files and stuff
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/uio.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -194,6 +195,87 @@ public:
     virtual void run() { _log->flush_daemon(); }
 };
 
+struct log_core::private_buffer_t
+{
+    /** Set in #used when the chunk is being closed or has been closed. */
+    static const long CLOSED = 1L << 62;
+
+    /** C-Array slot through which the chunk was reserved. */
+    CArraySlot* info;
+    /** Offset of the chunk within the log space reserved by the slot. */
+    long pos;
+    /** Size of the chunk in bytes. */
+    long size;
+    /** LSN of the first byte of the chunk. Read by the flush daemon. */
+    std::atomic<lsndata_t> lsn;
+    /**
+     * Bytes claimed by the owner so far, ORed with CLOSED once anyone starts
+     * closing the chunk. The owner claims space with a CAS, so it can never
+     * claim any after the closer has set CLOSED.
+     */
+    std::atomic<long> used;
+    /** Bytes the owner finished copying; the closer waits for it to reach used. */
+    std::atomic<long> copied;
+    /** Whether the chunk has been handed to the flush daemon. */
+    std::atomic<bool> released;
+    /** Size to reserve for the next chunk, adapted to what the last one used. */
+    long next_size;
+    /** Comment log record used to pad the unused tail of the chunk. */
+    logrec_t filler;
+
+    private_buffer_t(long max_size)
+        : info(NULL), pos(0), size(0), lsn(lsndata_null), used(CLOSED),
+        copied(0), released(true), next_size(max_size)
+    {}
+};
+
+namespace {
+    /**
+     * Smallest piece of a chunk that can be padded: a comment log record
+     * without any data.
+     */
+    const long PRIVATE_BUFFER_MIN_FILL = logrec_t::hdr_non_ssx_sz + sizeof(lsn_t);
+    /** Smallest chunk reserved unless a single log record needs less. */
+    const long PRIVATE_BUFFER_MIN_SIZE = 1024;
+
+    /** Identifies each log_core so that stale thread-local buffers are ignored. */
+    std::atomic<uint64_t> private_buffers_generation(0);
+    /** Generation of the log_core that currently exists; 0 if none. */
+    std::atomic<uint64_t> private_buffers_live(0);
+
+    /** Private buffer of a thread, which is recycled when the thread exits. */
+    struct private_buffer_tls_t {
+        log_core* log;
+        log_core::private_buffer_t* pb;
+        uint64_t id;
+
+        private_buffer_tls_t() : log(NULL), pb(NULL), id(0) {}
+        ~private_buffer_tls_t()
+        {
+            if (pb && id == private_buffers_live) {
+                log->recycle_private_buffer(pb);
+            }
+        }
+    };
+    thread_local private_buffer_tls_t tls_private_buffer;
+
+    /**
+     * A log record must be placed after the LSN of the last update of each
+     * page it updates and after the previous log record of its transaction.
+     */
+    lsn_t private_min_lsn(const logrec_t& r)
+    {
+        lsn_t min_lsn = lsn_t::null;
+        if (r.is_redo()) {
+            min_lsn = std::max(r.page_prev_lsn(), r.page2_prev_lsn());
+        }
+        if (!r.is_single_sys_xct()) {
+            min_lsn = std::max(min_lsn, r.xid_prev());
+        }
+        return min_lsn;
+    }
+}
+
 void log_core::start_flush_daemon()
 {
     _flush_daemon_running = true;
@@ -348,6 +430,8 @@ log_core::fetch(lsn_t& ll, void* buf, lsn_t* nxt, const bool forward)
 
 bool log_core::fetch_direct(lsn_t lsn, logrec_t*& lr, lsn_t& prev_lsn)
 {
+    INC_TSTAT(log_fetches);
+
     auto p = _storage->get_partition(lsn.hi());
     if(!p) { return false; }
     W_COERCE(p->open_for_read());
@@ -366,6 +450,24 @@ bool log_core::fetch_direct(lsn_t lsn, logrec_t*& lr, lsn_t& prev_lsn)
     return true;
 }
 
+#ifdef USE_MMAP
+rc_t log_core::fetch_pinned(lsn_t lsn, logrec_t*& lr, shared_ptr<partition_t>& p)
+{
+    INC_TSTAT(log_fetches);
+
+    if (lsn >= durable_lsn()) { return RC(eEOF); }
+    p = _storage->get_partition(lsn.hi());
+    if (!p) { return RC(eEOF); }
+    W_DO(p->open_for_read());
+
+    W_DO(p->read(lr, lsn, NULL));
+    p->release_read();
+    w_assert1(lr->valid_header(lsn));
+
+    return RCOK;
+}
+#endif
+
 void log_core::shutdown()
 {
     // gnats 52:  RACE: We set _shutting_down and signal between the time
@@ -416,7 +518,18 @@ log_core::log_core(const sm_options& options)
 
     uint32_t carray_slots = options.get_int_option("sm_carray_slots",
                         ConsolidationArray::DEFAULT_ACTIVE_SLOT_COUNT);
-    _carray = new ConsolidationArray(carray_slots);
+    _private_buffer_size = options.get_int_option("sm_log_private_buffer_size", 0);
+    if (_private_buffer_size > 0) {
+        _private_buffer_size = std::max<long>(
+                alignon(_private_buffer_size, 8), PRIVATE_BUFFER_MIN_SIZE);
+    }
+    _private_flush_lsn = lsndata_null;
+    _private_age_mark = _private_age_timer.now();
+    _private_buffers_id = ++private_buffers_generation;
+    private_buffers_live = _private_buffers_id;
+    // a slot holding a private chunk may stay unreleased for a while
+    _carray = new ConsolidationArray(carray_slots,
+            CARRAY_RELEASE_DELEGATION || _private_buffer_size > 0);
 
     /* Create thread o flush the log */
     _flush_daemon = new flush_daemon_thread_t(this);
@@ -428,6 +541,7 @@ log_core::log_core(const sm_options& options)
     auto p = _storage->curr_partition();
     W_COERCE(p->open_for_read());
     _curr_lsn = _durable_lsn = _flush_lsn = lsn_t(p->num(), p->get_size(false));
+    _private_age_lsn = _curr_lsn;
 
     size_t prime_offset = 0;
     W_COERCE(p->prime_buffer(_buf, _durable_lsn, prime_offset));
@@ -464,6 +578,13 @@ log_core::log_core(const sm_options& options)
 
     _group_commit_size = options.get_int_option("sm_group_commit_size", 0);
     _group_commit_timeout = options.get_int_option("sm_group_commit_timeout", 0);
+    _group_commit_adaptive = options.get_bool_option("sm_group_commit_adaptive", false);
+    _flush_requests = 0;
+    _gc_served_requests = 0;
+    _gc_flush_us = 0;
+    _gc_arrivals_per_flush = 0;
+    _gc_hold_start = 0;
+    _gc_hold_us = 0;
 
     _page_img_compression = options.get_int_option("sm_page_img_compression", 0);
 
@@ -516,6 +637,9 @@ rc_t log_core::init()
 
 log_core::~log_core()
 {
+    // exiting threads must not recycle their buffers anymore
+    private_buffers_live = 0;
+
     if (_ticker) {
         _ticker->shutdown();
         _ticker->join();
@@ -532,6 +656,11 @@ log_core::~log_core()
 
     delete _carray;
 
+    for (size_t i = 0; i < _private_buffers.size(); ++i) {
+        w_assert1(_private_buffers[i]->released);
+        delete _private_buffers[i];
+    }
+
     DO_PTHREAD(pthread_mutex_destroy(&_wait_flush_lock));
     DO_PTHREAD(pthread_cond_destroy(&_wait_cond));
     DO_PTHREAD(pthread_cond_destroy(&_flush_cond));
@@ -583,6 +712,10 @@ void log_core::_acquire_buffer_space(CArraySlot* info, long recsize)
             end_byte() - start_byte() + recsize > segsize() - 2* log_storage::BLOCK_SIZE)
     {
         _insert_lock.release(&info->me);
+        if (_private_buffer_size > 0) {
+            // open chunks may be what keeps the daemon from making space
+            _request_private_flush(_curr_lsn);
+        }
         {
             CRITICAL_SECTION(cs, _wait_flush_lock);
             while(end_byte() - start_byte() + recsize > segsize() - 2* log_storage::BLOCK_SIZE)
@@ -741,6 +874,11 @@ void log_core::_acquire_buffer_space(CArraySlot* info, long recsize)
  */
 rc_t log_core::truncate()
 {
+    if (_private_buffer_size > 0) {
+        // chunks must not straddle the partition switch below
+        _close_private_buffers(true);
+    }
+
     // We want exclusive access to the log, so no CArray
     mcs_lock::qnode me;
     _insert_lock.acquire(&me);
@@ -785,7 +923,7 @@ bool log_core::_update_epochs(CArraySlot* info) {
     // Even though the end pointer we're checking wraps regularly, we
     // already have to limit each address in the buffer to one active
     // writer or data corruption will result.
-    if (CARRAY_RELEASE_DELEGATION) {
+    if (_carray->release_delegation()) {
         if(_carray->wait_for_expose(info)) {
             return true; // we delegated!
         }
@@ -913,6 +1051,10 @@ rc_t log_core::insert(logrec_t &rec, lsn_t* rlsn)
     w_assert1(rec.length() <= sizeof(logrec_t));
     int32_t size = rec.length();
 
+    if (_private_buffer_size > 0 && smthread_t::xct()) {
+        return _insert_private(rec, rlsn);
+    }
+
     CArraySlot* info = NULL;
     long pos = 0;
     W_DO(_join_carray(info, pos, size));
@@ -971,6 +1113,224 @@ void log_core::_copy_raw(CArraySlot* info, long& pos, const char* data,
     }
 }
 
+log_core::private_buffer_t* log_core::_get_private_buffer(bool create)
+{
+    if (tls_private_buffer.id == _private_buffers_id) {
+        return tls_private_buffer.pb;
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    private_buffer_t* pb = NULL;
+    {
+        CRITICAL_SECTION(cs, _private_buffers_lock);
+        if (!_free_private_buffers.empty()) {
+            pb = _free_private_buffers.back();
+            _free_private_buffers.pop_back();
+        }
+        else {
+            pb = new private_buffer_t(_private_buffer_size);
+            _private_buffers.push_back(pb);
+            INC_TSTAT(log_private_buffers);
+        }
+    }
+    tls_private_buffer.log = this;
+    tls_private_buffer.pb = pb;
+    tls_private_buffer.id = _private_buffers_id;
+    return pb;
+}
+
+void log_core::recycle_private_buffer(private_buffer_t* pb)
+{
+    // also waits if the flush daemon is closing it right now
+    _close_private_buffer(pb);
+    pb->next_size = _private_buffer_size;
+
+    CRITICAL_SECTION(cs, _private_buffers_lock);
+    _free_private_buffers.push_back(pb);
+}
+
+rc_t log_core::_open_private_buffer(private_buffer_t* pb, long recsize)
+{
+    w_assert1(pb->used & private_buffer_t::CLOSED);
+    w_assert1(pb->released);
+
+    long size = std::max(pb->next_size, recsize);
+    if (size - recsize < PRIVATE_BUFFER_MIN_FILL) {
+        // the tail after the record could not be padded
+        size = recsize;
+    }
+
+    CArraySlot* info = NULL;
+    long pos = 0;
+    W_DO(_join_carray(info, pos, size));
+    w_assert1(info);
+    if (info->error) {
+        return _leave_carray(info, size);
+    }
+
+    pb->info = info;
+    pb->pos = pos;
+    pb->size = size;
+    pb->lsn = (info->lsn + pos).data();
+    pb->copied = 0;
+    pb->released = false;
+    // publishes the chunk to the flush daemon
+    pb->used.store(0, std::memory_order_release);
+
+    INC_TSTAT(log_private_chunks);
+    return RCOK;
+}
+
+void log_core::_fill_private_buffer(private_buffer_t* pb, long used)
+{
+    long rest = pb->size - used;
+    if (rest == 0) {
+        return;
+    }
+    w_assert1(rest >= PRIVATE_BUFFER_MIN_FILL);
+    w_assert1(rest % 8 == 0);
+
+    logrec_t* filler = &pb->filler;
+    while (rest > 0) {
+        long len = std::min<long>(rest, sizeof(logrec_t));
+        if (rest > len && rest - len < PRIVATE_BUFFER_MIN_FILL) {
+            len = rest - PRIVATE_BUFFER_MIN_FILL;
+        }
+
+        // an empty comment, ignored by restart, checkpoints and the archiver
+        filler->init_header(logrec_t::t_comment);
+        filler->init_xct_info();
+        long data_len = len - PRIVATE_BUFFER_MIN_FILL;
+        ::memset(filler->data(), 0, data_len);
+        filler->set_size(data_len);
+        w_assert1(filler->length() == len);
+
+        filler->set_lsn_ck(lsn_t(pb->lsn) + used);
+        long pos = pb->pos + used;
+        _copy_raw(pb->info, pos, (const char*) filler, len);
+
+        used += len;
+        rest -= len;
+    }
+}
+
+void log_core::_close_private_buffer(private_buffer_t* pb)
+{
+    long used = pb->used.fetch_or(private_buffer_t::CLOSED);
+    if (used & private_buffer_t::CLOSED) {
+        // somebody else is closing it; wait until it is out of our hands
+        while (!pb->released.load(std::memory_order_acquire)) {
+            lintel::atomic_thread_fence(lintel::memory_order_consume);
+        }
+        return;
+    }
+
+    // the owner might still be copying its last record
+    while (pb->copied.load(std::memory_order_acquire) != used) {
+        lintel::atomic_thread_fence(lintel::memory_order_consume);
+    }
+
+    ADD_TSTAT(log_private_fill_bytes, pb->size - used);
+    _fill_private_buffer(pb, used);
+
+    // next time reserve what this chunk needed, or twice as much if it was full
+    if (pb->size - used < PRIVATE_BUFFER_MIN_FILL) {
+        pb->next_size = std::min(2 * pb->size, _private_buffer_size);
+    }
+    else {
+        pb->next_size = alignon(used + used / 4, 8);
+    }
+    pb->next_size = std::max(std::min(pb->next_size, _private_buffer_size),
+            PRIVATE_BUFFER_MIN_SIZE);
+
+    // errors were reported when the chunk was opened
+    W_IGNORE(_leave_carray(pb->info, pb->size));
+    pb->released.store(true, std::memory_order_release);
+}
+
+rc_t log_core::_insert_private(logrec_t &rec, lsn_t* rlsn)
+{
+    private_buffer_t* pb = _get_private_buffer(true);
+    long size = rec.length();
+    lsn_t min_lsn = private_min_lsn(rec);
+
+    long used;
+    while (true) {
+        used = pb->used.load(std::memory_order_acquire);
+        if (!(used & private_buffer_t::CLOSED)) {
+            long rest = pb->size - used - size;
+            bool fits = rest == 0 || rest >= PRIVATE_BUFFER_MIN_FILL;
+            bool ordered = lsn_t(pb->lsn) + used > min_lsn;
+            if (fits && ordered) {
+                // fails only if the flush daemon is closing the chunk
+                if (pb->used.compare_exchange_strong(used, used + size)) {
+                    break;
+                }
+                continue;
+            }
+            if (!ordered) {
+                // a newer chunk of another thread updated the page first
+                INC_TSTAT(log_private_reordered);
+            }
+        }
+
+        _close_private_buffer(pb);
+        W_DO(_open_private_buffer(pb, size));
+    }
+
+    lsn_t rec_lsn = lsn_t(pb->lsn) + used;
+    rec.set_lsn_ck(rec_lsn);
+    long pos = pb->pos + used;
+    _copy_raw(pb->info, pos, (const char*) &rec, size);
+    pb->copied.store(used + size, std::memory_order_release);
+
+    if(rlsn) {
+        *rlsn = rec_lsn;
+    }
+    DBGOUT3(<< " private insert @ lsn: " << rec_lsn << " type " << rec.type()
+            << " length " << rec.length() );
+
+    INC_TSTAT(log_inserts);
+    ADD_TSTAT(log_bytes_generated,size);
+    return RCOK;
+}
+
+void log_core::_request_private_flush(const lsn_t& lsn)
+{
+    // close our own chunk right away instead of waiting for the daemon
+    private_buffer_t* pb = _get_private_buffer(false);
+    if (pb && !(pb->used & private_buffer_t::CLOSED) && lsn_t(pb->lsn) <= lsn) {
+        _close_private_buffer(pb);
+    }
+
+    lsndata_t old = _private_flush_lsn;
+    while (old < lsn.data()
+            && !_private_flush_lsn.compare_exchange_weak(old, lsn.data())) {}
+}
+
+void log_core::_close_private_buffers(bool all)
+{
+    lsn_t limit = all ? lsn_t::max : lsn_t(_private_flush_lsn);
+
+    long long now = _private_age_timer.now();
+    if (!all && now - _private_age_mark >= PRIVATE_BUFFER_MAX_AGE_MS * 1000) {
+        // whatever was open last time has been open long enough
+        limit = std::max(limit, _private_age_lsn);
+        _private_age_lsn = _curr_lsn;
+        _private_age_mark = now;
+    }
+
+    CRITICAL_SECTION(cs, _private_buffers_lock);
+    for (size_t i = 0; i < _private_buffers.size(); ++i) {
+        private_buffer_t* pb = _private_buffers[i];
+        if (!(pb->used & private_buffer_t::CLOSED) && lsn_t(pb->lsn) <= limit) {
+            _close_private_buffer(pb);
+        }
+    }
+}
+
 /*
  * Inserts an arbitrary block of memory (a bulk of log records from plog) into
  * the log buffer, returning the LSN of the first byte in rlsn. This is used
@@ -1011,6 +1371,11 @@ rc_t log_core::flush(const lsn_t &to_lsn, bool block, bool signal, bool *ret_flu
 
     // already durable?
     if(lsn >= *&_durable_lsn) {
+        // the group commit controller measures the rate of these
+        _flush_requests.fetch_add(1, std::memory_order_relaxed);
+        if (_private_buffer_size > 0) {
+            _request_private_flush(lsn);
+        }
         if (!block) {
             *&_waiting_for_flush = true;
             if (signal) {
@@ -1035,6 +1400,50 @@ rc_t log_core::flush(const lsn_t &to_lsn, bool block, bool signal, bool *ret_flu
     return RCOK;
 }
 
+void log_core::on_durable(const lsn_t& to_lsn, durability_callback_t callback)
+{
+    // same end-of-log clamp as flush(), so that we never wait forever
+    lsn_t lsn = std::min(to_lsn, (*&_curr_lsn)+ -1);
+    bool durable = true;
+    {
+        // checked under the lock so that the daemon cannot miss us
+        CRITICAL_SECTION(cs, _durability_callbacks_lock);
+        if (lsn >= *&_durable_lsn) {
+            _durability_callbacks.emplace(lsn, std::move(callback));
+            durable = false;
+        }
+    }
+    if (durable) {
+        INC_TSTAT(log_durable_callbacks);
+        callback(lsn);
+        return;
+    }
+    W_COERCE(flush(lsn, false, true));
+}
+
+void log_core::_dispatch_durability_callbacks()
+{
+    std::vector<std::pair<lsn_t, durability_callback_t>> durable;
+    {
+        CRITICAL_SECTION(cs, _durability_callbacks_lock);
+        auto end = _durability_callbacks.lower_bound(*&_durable_lsn);
+        for (auto it = _durability_callbacks.begin(); it != end; ++it) {
+            durable.emplace_back(it->first, std::move(it->second));
+        }
+        _durability_callbacks.erase(_durability_callbacks.begin(), end);
+    }
+    if (durable.empty()) {
+        return;
+    }
+
+    // called outside the lock, so callbacks may register new ones
+    INC_TSTAT(log_durable_dispatches);
+    ADD_TSTAT(log_durable_callbacks, durable.size());
+    for (auto& d : durable) {
+        d.second(d.first);
+    }
+}
+
 /**\brief Log-flush daemon driver.
  * \details
  * This method handles the wait/block of the daemon thread,
@@ -1075,13 +1484,42 @@ void log_core::flush_daemon()
 
             // sleep. We don't care if we get a spurious wakeup
             //if(!success && !*&_waiting_for_space && !*&_waiting_for_flush) {
-            if(!success && !*&_waiting_for_flush) {
+            if(!success && _gc_hold_us > 0) {
+                // holding a flush for more commits to join; any new flush
+                // request wakes us up to reconsider
+                long long hold_us = _gc_hold_us;
+                if (_private_buffer_size > 0) {
+                    hold_us = std::min<long long>(hold_us, PRIVATE_BUFFER_MAX_AGE_MS * 1000);
+                }
+                // microsecond deadline, since the hold is at most one flush
+                // latency, which is well below a millisecond on fast devices
+                struct timespec ts;
+                ::clock_gettime(CLOCK_REALTIME, &ts);
+                long long nsec = ts.tv_nsec + hold_us * 1000;
+                ts.tv_sec += nsec / 1000000000;
+                ts.tv_nsec = nsec % 1000000000;
+                int ret = pthread_cond_timedwait(&_flush_cond, &_wait_flush_lock, &ts);
+                w_assert1(ret == 0 || ret == ETIMEDOUT);
+            }
+            else if(!success && !*&_waiting_for_flush) {
                 // Use signal since the only thread that should be waiting
                 // on the _flush_cond is the log flush daemon.
-                DO_PTHREAD(pthread_cond_wait(&_flush_cond, &_wait_flush_lock));
+                if (_private_buffer_size > 0) {
+                    // wake up in time to age out open chunks
+                    struct timespec ts;
+                    smthread_t::timeout_to_timespec(PRIVATE_BUFFER_MAX_AGE_MS, ts);
+                    int ret = pthread_cond_timedwait(&_flush_cond, &_wait_flush_lock, &ts);
+                    w_assert1(ret == 0 || ret == ETIMEDOUT);
+                } else {
+                    DO_PTHREAD(pthread_cond_wait(&_flush_cond, &_wait_flush_lock));
+                }
             }
         }
 
+        if (_private_buffer_size > 0) {
+            _close_private_buffers();
+        }
+
         // flush all records later than last_completed_flush_lsn
         // and return the resulting last durable lsn
         lsn_t lsn = flush_daemon_work(last_completed_flush_lsn);
@@ -1089,17 +1527,32 @@ void log_core::flush_daemon()
         // success=true if we wrote anything
         success = (lsn != last_completed_flush_lsn);
         last_completed_flush_lsn = lsn;
+
+        if (success) {
+            _dispatch_durability_callbacks();
+        }
     }
 
     // make sure the buffer is completely empty before leaving...
+    if (_private_buffer_size > 0) {
+        _close_private_buffers(true);
+    }
+    // ...even if nobody waits for it
+    _group_commit_adaptive = false;
     for(lsn_t lsn;
         (lsn=flush_daemon_work(last_completed_flush_lsn)) !=
                 last_completed_flush_lsn;
         last_completed_flush_lsn=lsn) ;
+    _dispatch_durability_callbacks();
+    w_assert1(_durability_callbacks.empty());
 }
 
 bool log_core::_should_group_commit(long write_size)
 {
+    if (_group_commit_adaptive) {
+        return _should_group_commit_adaptive(write_size);
+    }
+
     // Do not flush if write size is less than group commit size
     if (write_size < _group_commit_size) {
         // Only supress flush if timeout hasn't expired
@@ -1113,6 +1566,70 @@ bool log_core::_should_group_commit(long write_size)
     return true;
 }
 
+bool log_core::_should_group_commit_adaptive(long write_size)
+{
+    long long now = _gc_clock.now();
+    uint64_t requests = _flush_requests.load(std::memory_order_relaxed);
+
+    long max_batch = GC_MAX_BATCH;
+    if (_group_commit_size > 0) { max_batch = _group_commit_size; }
+    max_batch = std::min(max_batch, segsize() / 4);
+
+    _gc_hold_us = 0;
+    if (write_size < max_batch) {
+        if (requests == _gc_served_requests) {
+            // nobody waits for this flush, except maybe for log buffer space
+            return *&_waiting_for_flush;
+        }
+
+        // Under light load, no other commit is expected before this flush
+        // is over, so flush right away. Otherwise, wait for more commits to
+        // join, for at most one flush latency.
+        if (_gc_arrivals_per_flush >= 1.0) {
+            long long max_hold = std::min<long long>(_gc_flush_us, GC_MAX_HOLD_US);
+            if (_group_commit_timeout > 0) {
+                max_hold = std::min<long long>(max_hold, _group_commit_timeout * 1000);
+            }
+            if (_gc_hold_start == 0) {
+                _gc_hold_start = now;
+                INC_TSTAT(log_gc_holds);
+            }
+            if (now - _gc_hold_start < max_hold) {
+                _gc_hold_us = max_hold - (now - _gc_hold_start);
+                return false;
+            }
+        }
+    }
+
+    if (_gc_hold_start > 0) {
+        ADD_TSTAT(log_gc_hold_us, now - _gc_hold_start);
+        _gc_hold_start = 0;
+    }
+    return true;
+}
+
+void log_core::_group_commit_flushed(long long start_us, uint64_t requests)
+{
+    long long latency = _gc_clock.now() - start_us;
+    _gc_flush_us = _gc_flush_us == 0 ? latency : (_gc_flush_us * 7 + latency) / 8;
+    ADD_TSTAT(log_gc_flush_us, latency);
+
+    // Requests that arrived before the flush started. Some of them may have
+    // been served by the previous flush already, so this is an upper bound.
+    uint64_t batch = requests - _gc_served_requests;
+    _gc_served_requests = requests;
+
+    // commits that arrived while the flush was written could have joined it
+    uint64_t arrived = _flush_requests.load(std::memory_order_relaxed) - requests;
+    _gc_arrivals_per_flush = (_gc_arrivals_per_flush * 7 + arrived) / 8;
+
+    if (batch == 0) { INC_TSTAT(log_gc_batch_0); }
+    else if (batch == 1) { INC_TSTAT(log_gc_batch_1); }
+    else if (batch < 8) { INC_TSTAT(log_gc_batch_2_7); }
+    else if (batch < 32) { INC_TSTAT(log_gc_batch_8_31); }
+    else { INC_TSTAT(log_gc_batch_32_up); }
+}
+
 /**\brief Flush unflushed-portion of log buffer.
  * @param[in] old_mark Durable lsn from last flush. Flush records later than this.
  * \details
@@ -1226,7 +1743,10 @@ lsn_t log_core::flush_daemon_work(lsn_t old_mark)
             start2, end2);
 
     // Flush the log buffer
+    uint64_t flush_requests = _flush_requests.load(std::memory_order_relaxed);
+    long long flush_start = _gc_clock.now();
     W_COERCE(p->flush(start_lsn, _buf, start1, end1, start2, end2));
+    _group_commit_flushed(flush_start, flush_requests);
     write_size = (end2 - start2) + (end1 - start1);
     p->set_size(start_lsn.lo() + write_size);
 
@@ -1313,35 +1833,45 @@ rc_t log_core::load_fetch_buffers()
     _fetch_buffers.resize(_fetch_buf_last - _fetch_buf_first + 1, NULL);
 
     for (size_t p = _fetch_buf_last; p >= _fetch_buf_first; p--) {
-        int fd;
-
-        string fname = _storage->make_log_name(p);
-        int flags = O_RDONLY;
-        if (directIO) { flags |= O_DIRECT; }
+        std::vector<int> fds;
 
-        // get file size and whether it exists
-        struct stat file_info;
-        int status = stat(fname.c_str(), &file_info);
-        if (status < 0) {
+        // whether it exists
+        if (!fs::exists(_storage->make_log_path(p))) {
             continue;
         }
 
-        // Allocate buffer space and open file
-        char* buf = new char[file_info.st_size];
+#ifdef USE_MMAP
+        // Map the partition instead of copying it into the heap. The mapping
+        // outlives the files, and fetches can use it right away while the
+        // kernel reads it ahead into the page cache.
+        _storage->open_striped(p, O_RDONLY, fds);
+        size_t map_size = _storage->get_partition_size();
+        char* buf = _storage->map_striped(fds, map_size);
+        _storage->close_striped(fds);
+        ::madvise(buf, map_size, MADV_WILLNEED); // only a hint
+        _fetch_buffers[p - _fetch_buf_first] = buf;
+
+        _fetch_buf_begin = lsn_t(p, 0);
+        lintel::atomic_thread_fence(lintel::memory_order_release);
+#else
+        int flags = O_RDONLY;
+        if (directIO) { flags |= O_DIRECT; }
+        _storage->open_striped(p, flags, fds);
+
+        // Allocate buffer space
+        off_t file_size = _storage->get_striped_size(fds);
+        char* buf = new char[file_size];
         _fetch_buffers[p - _fetch_buf_first] = buf;
-        fd = ::open(fname.c_str(), flags, 0744);
-        CHECK_ERRNO(fd);
 
         // Main loop that loads chunks of 32MB in reverse sequential order
         size_t chunk = 32 * 1024 * 1024;
-        long offset = file_info.st_size - chunk;
+        long offset = file_size - chunk;
         while (true) {
             size_t read_size = offset >= 0 ? chunk : chunk + offset;
             if (offset < 0) { offset = 0; }
 
-            auto bytesRead = ::pread(fd, buf + offset, read_size, offset);
-            CHECK_ERRNO(bytesRead);
-            if (bytesRead != (int) read_size) { return RC(stSHORTIO); }
+            auto bytesRead = _storage->read_striped(fds, buf + offset, read_size, offset);
+            if (bytesRead != read_size) { return RC(stSHORTIO); }
 
             // CS TODO: use std::atomic
             _fetch_buf_begin = lsn_t(p, offset);
@@ -1351,8 +1881,8 @@ rc_t log_core::load_fetch_buffers()
             offset -= read_size;
         }
 
-        auto ret = ::close(fd);
-        CHECK_ERRNO(ret);
+        _storage->close_striped(fds);
+#endif
 
         // size_t pos = 0;
         // while (pos < file_info.st_size) {
@@ -1379,7 +1909,12 @@ void log_core::discard_fetch_buffers(partition_number_t recycled_until)
     for (size_t p = _fetch_buf_first; p > 0 && p <= _fetch_buf_last; p++) {
         size_t i = p - _fetch_buf_first;
         if (_fetch_buffers[i]) {
+#ifdef USE_MMAP
+            auto ret = ::munmap(_fetch_buffers[i], _storage->get_partition_size());
+            CHECK_ERRNO(ret);
+#else
             delete[] _fetch_buffers[i];
+#endif
         }
     }
 
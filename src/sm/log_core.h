@@ -64,6 +64,8 @@ Rome Research Laboratory Contract No. F30602-97-2-0247.
 #include <AtomicCounter.hpp>
 #include <vector> // only for _collect_single_page_recovery_logs()
 #include <limits>
+#include <atomic>
+#include <map>
 
 // in sm_base for the purpose of log callback function argument type
 class      partition_t ; // forward
@@ -100,6 +102,15 @@ public:
     rc_t            compensate(const lsn_t &orig_lsn, const lsn_t& undo_lsn);
     rc_t            fetch(lsn_t &lsn, void* buf, lsn_t* nxt, const bool forward);
     bool fetch_direct(lsn_t lsn, logrec_t*& lr, lsn_t& prev_lsn);
+#ifdef USE_MMAP
+    /**
+     * Points lr to the durable log record at lsn in the mapping of its
+     * partition, which is returned in p: the record stays valid as long as p
+     * is held, which also keeps the partition from being recycled. Returns
+     * eEOF if the record is not durable or not in the log anymore.
+     */
+    rc_t fetch_pinned(lsn_t lsn, logrec_t*& lr, shared_ptr<partition_t>& p);
+#endif
 
     void            shutdown();
     rc_t            truncate();
@@ -108,6 +119,15 @@ public:
 
     lsn_t durable_lsn() const { return _durable_lsn; }
 
+    /**
+     * Calls the given function once the log record at the given LSN is
+     * durable, without blocking the caller. If it already is, the function is
+     * called right away by the caller; otherwise a flush is requested and the
+     * flush daemon calls it, together with all others that became durable with
+     * the same flush. It must therefore be short and must not wait for the log.
+     */
+    void on_durable(const lsn_t& lsn, durability_callback_t callback);
+
     void start_flush_daemon();
 
     long                 segsize() const { return _segsize; }
@@ -142,6 +162,35 @@ public:
 
     unsigned get_page_img_compression() { return _page_img_compression; }
 
+    /** Whether transaction threads log into private log buffers. */
+    bool uses_private_buffers() const { return _private_buffer_size > 0; }
+
+    /**
+     * \brief A chunk of the log buffer reserved by one thread.
+     * \details
+     * With private log buffers (sm_log_private_buffer_size > 0), each thread
+     * that runs a transaction reserves a contiguous chunk of the log with a
+     * single C-Array join and then copies its log records into the chunk
+     * without touching the C-Array or the insert lock again. LSNs are assigned
+     * from the chunk as the records are copied, so page LSNs are known when
+     * the page is updated, exactly as with log_core::insert.
+     *
+     * The chunk is closed -- its unused tail padded with comment log records
+     * and the whole chunk released to the flush daemon -- when it is full,
+     * when a record must follow a page or transaction LSN beyond the chunk
+     * (page LSNs must grow in the order the page is updated), when the owner
+     * waits for a flush past the chunk, e.g. at commit or rollback, or when
+     * the flush daemon needs to flush past it.
+     *
+     * When the thread exits, its buffer is closed and handed to the next
+     * thread that needs one, so there are never more buffers than threads
+     * logging at the same time.
+     */
+    struct private_buffer_t;
+
+    /** Closes the private buffer of an exiting thread and makes it reusable. */
+    void recycle_private_buffer(private_buffer_t* pb);
+
 protected:
 
     char*                _buf; // log buffer: _segsize buffer into which
@@ -149,7 +198,9 @@ protected:
 
     /** Buffers for fetch operation -- used during log analysis and
      * single-page redo. One buffer is used for each partition.
-     * The number of partitions is specified by sm_log_fetch_buf_partitions */
+     * The number of partitions is specified by sm_log_fetch_buf_partitions.
+     * With USE_MMAP, each buffer is a read-only mapping of its partition,
+     * so it takes page cache rather than heap memory. */
     vector<char*> _fetch_buffers;
     uint32_t _fetch_buf_first;
     uint32_t _fetch_buf_last;
@@ -201,6 +252,54 @@ protected:
     void _copy_raw(CArraySlot* info, long& pos, const char* data, size_t size);
     /** @}*/
 
+    /**
+     * \ingroup CARRAY
+     * Private log buffers; see log_core::private_buffer_t.
+     *  @{
+     */
+    rc_t _insert_private(logrec_t &r, lsn_t* l);
+    private_buffer_t* _get_private_buffer(bool create);
+    rc_t _open_private_buffer(private_buffer_t* pb, long recsize);
+    void _close_private_buffer(private_buffer_t* pb);
+    void _fill_private_buffer(private_buffer_t* pb, long used);
+    /** Makes sure chunks starting at or before the given LSN get closed. */
+    void _request_private_flush(const lsn_t& lsn);
+    /**
+     * Closes the chunks the flush daemon must flush past, or all of them.
+     * Called by the flush daemon, except with all=true.
+     */
+    void _close_private_buffers(bool all = false);
+
+    /** Max size of a chunk; 0 disables private log buffers. */
+    long _private_buffer_size;
+    /** All private buffers, one per thread that logs (or did and exited). */
+    std::vector<private_buffer_t*> _private_buffers;
+    /** Buffers of exited threads, to be handed to new threads. */
+    std::vector<private_buffer_t*> _free_private_buffers;
+    /** Protects the two vectors above. */
+    tatas_lock _private_buffers_lock;
+    /** Highest LSN some thread waits to become durable. */
+    std::atomic<lsndata_t> _private_flush_lsn;
+    /**
+     * End of the log when the flush daemon last aged the open chunks out;
+     * chunks starting before it have been open for at least
+     * PRIVATE_BUFFER_MAX_AGE_MS and are closed. Used by the daemon only.
+     */
+    lsn_t _private_age_lsn;
+    long long _private_age_mark;
+    stopwatch_t _private_age_timer;
+    /** Tells this log_core's private buffers apart from a previous one's. */
+    uint64_t _private_buffers_id;
+
+    enum {
+        /**
+         * Longest time in ms a chunk may keep the flush daemon from flushing
+         * past it when nobody waits for that flush.
+         */
+        PRIVATE_BUFFER_MAX_AGE_MS = 10
+    };
+    /** @}*/
+
     log_storage*    _storage;
     PoorMansOldestLsnTracker* _oldest_lsn_tracker;
 
@@ -317,6 +416,65 @@ protected:
      */
     bool _should_group_commit(long write_size);
 
+    /**
+     * \brief Adaptive group commit (sm_group_commit_adaptive).
+     * \details
+     * Instead of the static window above, the flush daemon holds back a flush
+     * only while more commits are expected to join it, i.e., while recent
+     * flushes saw at least one new commit arrive while they were being
+     * written. A single committer never arrives during its own flush, so
+     * its flushes are never held. A held flush waits no longer
+     * than the recent flush latency (or sm_group_commit_timeout, if lower),
+     * and it is never held once GC_MAX_BATCH bytes (or sm_group_commit_size,
+     * if set) are pending. Flushes nobody waits for are held until somebody
+     * does or the batch is full. Flush latency and arrivals per flush are
+     * tracked as moving averages by the flush daemon.
+     *  @{
+     */
+    bool _should_group_commit_adaptive(long write_size);
+    /**
+     * Records latency and batch size of the flush that just finished, given
+     * when it started and the value of _flush_requests at that time.
+     */
+    void _group_commit_flushed(long long start_us, uint64_t requests);
+
+    bool _group_commit_adaptive;
+    /** Flush requests, e.g., commits, that found their LSN not yet durable. */
+    std::atomic<uint64_t> _flush_requests;
+    /** Value of _flush_requests when the last flush started. */
+    uint64_t _gc_served_requests;
+    /**
+     * Moving averages of flush latency and of the flush requests that
+     * arrived while a flush was being written.
+     */
+    double _gc_flush_us;
+    double _gc_arrivals_per_flush;
+    /** When the daemon started holding the pending flush; 0 if it is not. */
+    long long _gc_hold_start;
+    /** How much longer the daemon holds the pending flush; 0 = until kicked. */
+    long long _gc_hold_us;
+    stopwatch_t _gc_clock;
+
+    enum {
+        /** Pending bytes that are flushed without waiting for more commits. */
+        GC_MAX_BATCH = 1024 * 1024,
+        /** Longest a flush is held, unless sm_group_commit_timeout is set. */
+        GC_MAX_HOLD_US = 5000
+    };
+    /** @}*/
+
+    /**
+     * \brief Callbacks registered with on_durable(), keyed by their LSN.
+     * \details
+     * The flush daemon hands all callbacks whose LSN became durable to
+     * _dispatch_durability_callbacks() after each flush.
+     *  @{
+     */
+    void _dispatch_durability_callbacks();
+    std::multimap<lsn_t, durability_callback_t> _durability_callbacks;
+    tatas_lock _durability_callbacks_lock;
+    /** @}*/
+
     /**
      * Enables page-image compression in the log. For every N bytes of log
      * generated for a page, a page_img_format log record is generated rather
@@ -6,10 +6,15 @@
 #include <cstdio>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
 #include <atomic>
 #include <thread>
 #include <chrono>
 #include <algorithm>
+#include <limits>
 
 #include "w_defines.h"
 #include "sm_base.h"
@@ -25,6 +30,12 @@ const string log_storage::log_regex = "log\\.[1-9][0-9]*";
 const string log_storage::chkpt_prefix = "chkpt_";
 const string log_storage::chkpt_regex = "chkpt_[1-9][0-9]*\\.[0-9][0-9]*";
 
+// TODO proper exception mechanism
+#define CHECK_ERRNO(n) \
+    if (n == -1) { \
+        W_FATAL_MSG(fcOS, << "Kernel errno code: " << errno); \
+    }
+
 class partition_recycler_t : public thread_wrapper_t
 {
 public:
@@ -59,6 +70,86 @@ public:
     std::mutex _recycler_mutex;
 };
 
+/**
+ * Writes and fsyncs the part of each flush that goes to one log stream, so
+ * that all streams of a striped log sync in parallel.
+ */
+class log_stream_writer_t : public thread_wrapper_t
+{
+public:
+    log_stream_writer_t()
+        : fd(-1), offset(0), pending(false), retire(false)
+    {}
+
+    virtual ~log_stream_writer_t() {}
+
+    void run()
+    {
+        unique_lock<mutex> lck(_writer_mutex);
+        while (true) {
+            _writer_condvar.wait(lck, [this] { return pending || retire; });
+            if (!pending) { break; }
+            write(fd, iov, offset);
+            pending = false;
+            _writer_condvar.notify_all();
+        }
+    }
+
+    void submit(int fd, std::vector<iovec>& iov, off_t offset)
+    {
+        unique_lock<mutex> lck(_writer_mutex);
+        w_assert1(!pending);
+        this->fd = fd;
+        this->iov.swap(iov);
+        this->offset = offset;
+        pending = true;
+        _writer_condvar.notify_all();
+    }
+
+    void wait()
+    {
+        unique_lock<mutex> lck(_writer_mutex);
+        _writer_condvar.wait(lck, [this] { return !pending; });
+    }
+
+    void shutdown()
+    {
+        {
+            unique_lock<mutex> lck(_writer_mutex);
+            retire = true;
+            _writer_condvar.notify_all();
+        }
+        join();
+    }
+
+    static void write(int fd, const std::vector<iovec>& iov, off_t offset)
+    {
+        for (size_t i = 0; i < iov.size(); i += IOV_MAX) {
+            int count = std::min<size_t>(iov.size() - i, IOV_MAX);
+            ssize_t expected = 0;
+            for (int j = 0; j < count; j++) {
+                expected += iov[i + j].iov_len;
+            }
+            auto ret = ::pwritev(fd, &iov[i], count, offset);
+            CHECK_ERRNO(ret);
+            w_assert0(ret == expected);
+            offset += ret;
+        }
+
+        INC_TSTAT(log_fsync_cnt);
+        auto ret = ::fsync(fd);
+        CHECK_ERRNO(ret);
+    }
+
+    int fd;
+    std::vector<iovec> iov;
+    off_t offset;
+    bool pending;
+    bool retire;
+    std::condition_variable _writer_condvar;
+    std::mutex _writer_mutex;
+};
+
 /*
  * Opens log files in logdir and initializes partitions as well as the
  * given LSN's. The buffer given in prime_buf is primed with the contents
@@ -102,6 +193,54 @@ log_storage::log_storage(const sm_options& options)
 
     _delete_old_partitions = options.get_bool_option("sm_log_delete_old_partitions", true);
 
+    // emulates a slower log device
+    partition_t::set_artificial_flush_delay(
+            options.get_int_option("sm_log_fake_flush_delay", 0));
+
+    // additional log streams, separated by ':'
+    _streampaths.push_back(_logpath);
+    std::string streamdirs = options.get_string_option("sm_log_stream_dirs", "");
+    stringstream dirs(streamdirs);
+    for (string dir; std::getline(dirs, dir, ':');) {
+        if (dir.empty()) { continue; }
+        fs::path spath = dir;
+        if (!fs::exists(spath)) {
+            if (reformat) {
+                fs::create_directories(spath);
+            } else {
+                cerr << "Error: could not open the log stream directory "
+                    << dir << endl;
+                W_COERCE(RC(eOS));
+            }
+        }
+        if (reformat) {
+            fs::directory_iterator sit(spath), seod;
+            std::regex slog_rx(log_regex, std::regex::basic);
+            for (; sit != seod; sit++) {
+                if (std::regex_match(sit->path().filename().string(), slog_rx)) {
+                    fs::remove(sit->path());
+                }
+            }
+        }
+        _streampaths.push_back(spath);
+    }
+
+    // option given in KB -> convert to B
+    _stripe_size = off_t(options.get_int_option("sm_log_stripe_size", 1024)) * 1024;
+    if (_stripe_size <= 0 || _stripe_size % BLOCK_SIZE != 0
+            || _stripe_size % sysconf(_SC_PAGESIZE) != 0
+            || _partition_size % _stripe_size != 0)
+    {
+        cerr << "ERROR: sm_log_stripe_size must be a multiple of the log block"
+            << " and memory page sizes that divides the partition size" << endl;
+        W_FATAL(eCRASH);
+    }
+
+    for (size_t i = 1; i < _streampaths.size(); i++) {
+        _stream_writers.emplace_back(new log_stream_writer_t);
+        _stream_writers.back()->fork();
+    }
+
     partition_number_t  last_partition = 1;
 
     fs::directory_iterator it(_logpath), eod;
@@ -118,6 +257,13 @@ log_storage::log_storage(const sm_options& options)
             }
 
             long pnum = std::stoi(fname.substr(log_prefix.length()));
+            for (unsigned i = 1; i < get_stream_count(); i++) {
+                if (!fs::exists(make_log_path(pnum, i))) {
+                    cerr << "Error: log partition " << pnum << " is missing in"
+                        << " log stream directory " << _streampaths[i] << endl;
+                    W_FATAL(eCRASH);
+                }
+            }
             _partitions[pnum] = make_shared<partition_t>(this, pnum);
 
             if (pnum >= last_partition) {
@@ -174,6 +320,11 @@ log_storage::~log_storage()
         _recycler_thread = nullptr;
     }
 
+    for (auto& w : _stream_writers) {
+        w->shutdown();
+    }
+    _stream_writers.clear();
+
     spinlock_write_critical_section cs(&_partition_map_latch);
 
     partition_map_t::iterator it = _partitions.begin();
@@ -479,14 +630,161 @@ void log_storage::list_partitions(std::vector<partition_number_t>& vec) const
     std::sort(vec.begin(), vec.end());
 }
 
-string log_storage::make_log_name(partition_number_t pnum) const
+string log_storage::make_log_name(partition_number_t pnum, unsigned stream) const
+{
+    return make_log_path(pnum, stream).string();
+}
+
+fs::path log_storage::make_log_path(partition_number_t pnum, unsigned stream) const
+{
+    return _streampaths[stream] / fs::path(log_prefix + to_string(pnum));
+}
+
+void log_storage::open_striped(partition_number_t pnum, int flags,
+        std::vector<int>& fds) const
+{
+    w_assert1(fds.empty());
+    for (unsigned i = 0; i < get_stream_count(); i++) {
+        int fd = ::open(make_log_name(pnum, i).c_str(), flags, 0744 /*mode*/);
+        CHECK_ERRNO(fd);
+        fds.push_back(fd);
+    }
+}
+
+void log_storage::close_striped(std::vector<int>& fds) const
+{
+    for (int fd : fds) {
+        auto ret = ::close(fd);
+        CHECK_ERRNO(ret);
+    }
+    fds.clear();
+}
+
+void log_storage::remove_striped(partition_number_t pnum) const
+{
+    for (unsigned i = 0; i < get_stream_count(); i++) {
+        fs::remove(make_log_path(pnum, i));
+    }
+}
+
+off_t log_storage::get_striped_size(const std::vector<int>& fds) const
+{
+    off_t size = std::numeric_limits<off_t>::max();
+    for (unsigned i = 0; i < fds.size(); i++) {
+        struct stat stat;
+        auto ret = ::fstat(fds[i], &stat);
+        CHECK_ERRNO(ret);
+
+        // logical offset of the first byte missing from this stream
+        off_t end = stat.st_size;
+        off_t unit = (end / _stripe_size) * fds.size() + i;
+        size = std::min(size, unit * _stripe_size + end % _stripe_size);
+    }
+    return size;
+}
+
+size_t log_storage::read_striped(const std::vector<int>& fds, void* buf,
+        size_t count, off_t offset) const
 {
-    return make_log_path(pnum).string();
+    w_assert1(fds.size() == get_stream_count());
+    size_t total = 0;
+    while (count > 0) {
+        unsigned stream;
+        off_t soffset = get_stream_offset(offset, stream);
+        size_t len = std::min<size_t>(count, _stripe_size - offset % _stripe_size);
+
+        auto bytesRead = ::pread(fds[stream], (char*) buf + total, len, soffset);
+        CHECK_ERRNO(bytesRead);
+        total += bytesRead;
+        if ((size_t) bytesRead < len) { break; }
+
+        offset += len;
+        count -= len;
+    }
+    return total;
 }
 
-fs::path log_storage::make_log_path(partition_number_t pnum) const
+void log_storage::write_striped(const std::vector<int>& fds, const iovec* iov,
+        int iovcnt, off_t offset)
 {
-    return _logpath / fs::path(log_prefix + to_string(pnum));
+    w_assert1(fds.size() == get_stream_count());
+
+    // Cut the buffers at stripe boundaries. Consecutive units of a stream are
+    // also consecutive in its file, so each stream gets a single vector write.
+    std::vector<std::vector<iovec>> siov(fds.size());
+    std::vector<off_t> soffset(fds.size(), -1);
+    for (int i = 0; i < iovcnt; i++) {
+        char* base = (char*) iov[i].iov_base;
+        size_t rest = iov[i].iov_len;
+        while (rest > 0) {
+            unsigned stream;
+            off_t pos = get_stream_offset(offset, stream);
+            size_t len = std::min<size_t>(rest, _stripe_size - offset % _stripe_size);
+            if (soffset[stream] < 0) { soffset[stream] = pos; }
+            siov[stream].push_back({ base, len });
+
+            base += len;
+            rest -= len;
+            offset += len;
+        }
+    }
+
+    for (unsigned i = 1; i < fds.size(); i++) {
+        if (soffset[i] >= 0) {
+            _stream_writers[i - 1]->submit(fds[i], siov[i], soffset[i]);
+        }
+    }
+    if (soffset[0] >= 0) {
+        log_stream_writer_t::write(fds[0], siov[0], soffset[0]);
+    }
+    for (unsigned i = 1; i < fds.size(); i++) {
+        if (soffset[i] >= 0) {
+            _stream_writers[i - 1]->wait();
+        }
+    }
+}
+
+char* log_storage::map_striped(const std::vector<int>& fds, size_t length) const
+{
+    if (fds.size() == 1) {
+        void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fds[0], 0);
+        CHECK_ERRNO((long) addr);
+        return reinterpret_cast<char*>(addr);
+    }
+
+    // reserve the address range, then map each stripe unit into it
+    void* addr = mmap(nullptr, length, PROT_NONE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    CHECK_ERRNO((long) addr);
+    char* base = reinterpret_cast<char*>(addr);
+    for (size_t offset = 0; offset < length; offset += _stripe_size) {
+        unsigned stream;
+        off_t soffset = get_stream_offset(offset, stream);
+        void* unit = mmap(base + offset, _stripe_size, PROT_READ,
+                MAP_SHARED | MAP_FIXED, fds[stream], soffset);
+        CHECK_ERRNO((long) unit);
+    }
+    return base;
+}
+
+std::vector<std::pair<fs::path, off_t>> log_storage::get_striped_extents(
+        partition_number_t pnum, off_t size) const
+{
+    std::vector<std::pair<fs::path, off_t>> extents;
+    for (unsigned i = 0; i < get_stream_count(); i++) {
+        extents.emplace_back(make_log_path(pnum, i), 0);
+    }
+    // each stream ends within or after the last full unit it holds
+    off_t units = size / _stripe_size;
+    for (unsigned i = 0; i < get_stream_count(); i++) {
+        off_t full = units / get_stream_count()
+            + (i < units % get_stream_count() ? 1 : 0);
+        extents[i].second = full * _stripe_size;
+    }
+    unsigned stream;
+    off_t end = get_stream_offset(size, stream);
+    extents[stream].second = end;
+    return extents;
 }
 
 fs::path log_storage::make_chkpt_path(lsn_t lsn) const
@@ -65,6 +65,7 @@ Rome Research Laboratory Contract No. F30602-97-2-0247.
 #include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <sys/uio.h>
 
 #include "logdef_gen.h"
 
@@ -76,12 +77,26 @@ typedef std::map<partition_number_t, shared_ptr<partition_t>> partition_map_t;
 namespace fs = boost::filesystem;
 
 class partition_recycler_t;
-
+class log_stream_writer_t;
+
+/**
+ * \brief Owns the log partition files.
+ * \details
+ * With sm_log_stream_dirs, each partition is striped across several log
+ * \e streams -- the sm_logdir directory being stream 0, followed by each of
+ * the given directories -- in units of sm_log_stripe_size bytes, so that
+ * every flush is written and fsync'ed by all devices in parallel, one writer
+ * thread per stream. The LSN space is not affected: an LSN still is an offset
+ * into a (logical) partition, so LSNs keep their global order and restart,
+ * the archiver and everything else that reads the log see a single stream.
+ * Log files must only be accessed through the *_striped methods below.
+ */
 class log_storage {
 
     // use friend mechanism until better interface is implemented
     friend class partition_t;
     friend class partition_recycler_t;
+    friend class log_stream_writer_t;
 
 public:
     log_storage(const sm_options&);
@@ -102,8 +117,8 @@ public:
 
     size_t get_byte_distance(lsn_t a, lsn_t b) const;
 
-    string make_log_name(partition_number_t pnum) const;
-    fs::path make_log_path(partition_number_t pnum) const;
+    string make_log_name(partition_number_t pnum, unsigned stream = 0) const;
+    fs::path make_log_path(partition_number_t pnum, unsigned stream = 0) const;
     fs::path make_chkpt_path(lsn_t lsn) const;
 
     void add_checkpoint(lsn_t lsn);
@@ -111,12 +126,56 @@ public:
     void wakeup_recycler(bool chkpt_only = false);
     unsigned delete_old_partitions(bool chkpt_only = false, partition_number_t older_than = 0);
 
+    /** Number of streams each partition is striped across. */
+    unsigned get_stream_count() const { return _streampaths.size(); }
+
+    /** Opens the files of all streams of a partition. */
+    void open_striped(partition_number_t pnum, int flags,
+            std::vector<int>& fds) const;
+    void close_striped(std::vector<int>& fds) const;
+    void remove_striped(partition_number_t pnum) const;
+    /**
+     * Logical size of a partition, i.e., the first byte missing from any
+     * stream. A crash during a flush may leave a stream short while later
+     * streams already hold the tail, which is then ignored.
+     */
+    off_t get_striped_size(const std::vector<int>& fds) const;
+    /** Like pread, reading short only at the end of a stream. */
+    size_t read_striped(const std::vector<int>& fds, void* buf, size_t count,
+            off_t offset) const;
+    /**
+     * Writes the given buffers at the given logical offset and fsyncs every
+     * stream written to, in parallel. Used by the flush daemon only.
+     */
+    void write_striped(const std::vector<int>& fds, const iovec* iov,
+            int iovcnt, off_t offset);
+    /** Maps a whole partition into one contiguous, read-only region. */
+    char* map_striped(const std::vector<int>& fds, size_t length) const;
+    /** File of each stream and its size when the partition ends at size. */
+    std::vector<std::pair<fs::path, off_t>> get_striped_extents(
+            partition_number_t pnum, off_t size) const;
+
 private:
     shared_ptr<partition_t> create_partition(partition_number_t pnum);
 
     fs::path _logpath;
     off_t _partition_size;
 
+    /** Directory of each stream; _logpath is stream 0. */
+    std::vector<fs::path> _streampaths;
+    off_t _stripe_size;
+    /** Writer threads of streams 1..n; stream 0 is written by the caller. */
+    std::vector<unique_ptr<log_stream_writer_t>> _stream_writers;
+
+    /** Stream and offset within its file of the given logical offset. */
+    off_t get_stream_offset(off_t offset, unsigned& stream) const
+    {
+        off_t unit = offset / _stripe_size;
+        stream = unit % _streampaths.size();
+        return (unit / _streampaths.size()) * _stripe_size
+            + offset % _stripe_size;
+    }
+
     partition_map_t _partitions;
     shared_ptr<partition_t> _curr_partition;
 
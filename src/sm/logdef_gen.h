@@ -253,6 +253,12 @@ Rome Research Laboratory Contract No. F30602-97-2-0247.
     template <class Ptr> void redo(Ptr);
     };
 
+    struct btree_foster_deadopt_log : public logrec_t {
+        static constexpr kind_t TYPE = logrec_t::t_btree_foster_deadopt;
+    template <class PagePtr> void construct (const PagePtr page, const PagePtr page2, PageID deadopted_pid, lsn_t deadopted_emlsn, const w_keystr_t& low_key, const w_keystr_t& high_key);
+    template <class Ptr> void redo(Ptr);
+    };
+
     struct btree_split_log : public logrec_t {
         static constexpr kind_t TYPE = logrec_t::t_btree_split;
     template <class PagePtr> void construct (const PagePtr page, const PagePtr page2, uint16_t move_count, const w_keystr_t& new_high_fence, const w_keystr_t& new_chain);
@@ -174,6 +174,8 @@ logrec_t::get_type_str(kind_t type)
 		return "btree_ghost_reserve";
 	case t_btree_foster_adopt :
 		return "btree_foster_adopt";
+	case t_btree_foster_deadopt :
+		return "btree_foster_deadopt";
 	case t_btree_split :
 		return "btree_split";
 	case t_btree_compress_page :
@@ -370,6 +372,9 @@ void logrec_t::redo(PagePtr page)
 	case t_btree_foster_adopt :
 		((btree_foster_adopt_log *) this)->redo(page);
 		break;
+	case t_btree_foster_deadopt :
+		((btree_foster_deadopt_log *) this)->redo(page);
+		break;
 	case t_btree_split :
 		((btree_split_log *) this)->redo(page);
 		break;
@@ -545,6 +550,9 @@ void logrec_t::undo(PagePtr page)
 	case t_btree_foster_adopt :
 		W_FATAL(eINTERNAL);
 		break;
+	case t_btree_foster_deadopt :
+		W_FATAL(eINTERNAL);
+		break;
 	case t_btree_split :
 		W_FATAL(eINTERNAL);
 		break;
@@ -192,7 +192,7 @@ public:
 	// t_btree_foster_merge = 39,
 	// t_btree_foster_rebalance = 40,
 	// t_btree_foster_rebalance_norec = 41,
-	// t_btree_foster_deadopt = 42,
+	t_btree_foster_deadopt = 42,
 	t_btree_split = 43,
 	t_btree_compress_page = 44,
 	t_tick_sec = 45,
@@ -710,6 +710,7 @@ constexpr u_char logrec_t::get_logrec_cat(kind_t type)
 	case t_btree_ghost_reclaim : return t_redo|t_single_sys_xct;
 	case t_btree_ghost_reserve : return t_redo|t_single_sys_xct;
 	case t_btree_foster_adopt : return t_redo|t_multi|t_single_sys_xct;
+	case t_btree_foster_deadopt : return t_redo|t_multi|t_single_sys_xct;
 	case t_btree_split : return t_redo|t_multi|t_single_sys_xct;
 	case t_btree_compress_page : return t_redo|t_single_sys_xct;
 
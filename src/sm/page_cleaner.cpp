@@ -31,7 +31,11 @@ page_cleaner_base::~page_cleaner_base()
 
 void page_cleaner_base::write_pages(size_t from, size_t to)
 {
-    W_COERCE(smlevel_0::vol->write_many_pages(
+    // Asynchronous if io_uring is enabled -- callers must wait_aio() before
+    // reusing the workspace
+    smlevel_0::vol->register_aio_buffers(_workspace.data(),
+            _workspace.size() * sizeof(generic_page));
+    W_COERCE(smlevel_0::vol->submit_write(
                 _workspace[from].pid, &(_workspace[from]), to - from));
     ADD_TSTAT(cleaned_pages, to - from);
 }
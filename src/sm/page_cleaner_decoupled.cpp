@@ -105,6 +105,9 @@ void page_cleaner_decoupled::flush_segments()
 {
     if (segments.empty()) { return; }
 
+    smlevel_0::vol->register_aio_buffers(_workspace.data(),
+            _workspace.size() * sizeof(generic_page));
+
     size_t w_index = 0;
     size_t adjacent = 0;
     for (size_t i = 0; i < segments.size(); i++) {
@@ -115,7 +118,7 @@ void page_cleaner_decoupled::flush_segments()
        }
        else {
            size_t flush_size = (adjacent+1) * _segment_size;
-           W_COERCE(smlevel_0::vol->write_many_pages(segments[i-adjacent],
+           W_COERCE(smlevel_0::vol->submit_write(segments[i-adjacent],
                        &_workspace[w_index], flush_size));
            ADD_TSTAT(cleaned_pages, flush_size);
            w_index += flush_size;
@@ -123,6 +126,7 @@ void page_cleaner_decoupled::flush_segments()
        }
     }
 
+    smlevel_0::vol->wait_aio();
     if (!_write_elision) {
         smlevel_0::vol->sync();
         // mark clean
@@ -8,12 +8,18 @@
 // Template definitions
 #include "bf_hashtable.cpp"
 
-page_evictioner_base::page_evictioner_base(bf_tree_m* bufferpool, const sm_options& options)
+page_evictioner_base::page_evictioner_base(bf_tree_m* bufferpool, const sm_options& options,
+        bf_idx first_frame, bf_idx end_frame)
     :
     worker_thread_t(options.get_int_option("sm_eviction_interval", 100)),
     _bufferpool(bufferpool),
-    _rnd_distr(1, _bufferpool->get_block_cnt() - 1)
+    _first_frame(first_frame),
+    _end_frame(end_frame > 0 ? end_frame : bufferpool->get_block_cnt()),
+    _rnd_distr(_first_frame, _end_frame - 1)
 {
+    w_assert0(_first_frame > 0 && _first_frame < _end_frame);
+    w_assert0(_end_frame <= _bufferpool->get_block_cnt());
+
     _swizzling_enabled = options.get_bool_option("sm_bufferpool_swizzle", false);
     _maintain_emlsn = options.get_bool_option("sm_bf_maintain_emlsn", false);
     _random_pick = options.get_bool_option("sm_evict_random", false);
@@ -29,18 +35,40 @@ page_evictioner_base::page_evictioner_base(bf_tree_m* bufferpool, const sm_optio
         _clean_only_attempts = 1;
     }
 
-    if (_use_clock) { _clock_ref_bits.resize(_bufferpool->get_block_cnt(), false); }
+    _batch_size = options.get_int_option("sm_evict_batch_size", 1);
+    if (_batch_size < 1) { _batch_size = 1; }
+
+    if (_use_clock) { _clock_ref_bits.resize(frame_count(), false); }
 
-    _current_frame = 0;
+    _current_frame = _first_frame;
 
     constexpr unsigned max_rounds = 1000;
-    _max_attempts = max_rounds * _bufferpool->get_block_cnt();
+    _max_attempts = max_rounds * frame_count();
+    _attempt_limit = 0;
 }
 
 page_evictioner_base::~page_evictioner_base()
 {
 }
 
+std::shared_ptr<page_evictioner_base> page_evictioner_base::create(
+        bf_tree_m* bufferpool, const sm_options& options,
+        bf_idx first_frame, bf_idx end_frame)
+{
+    string pstr = options.get_string_option("sm_evict_policy", "clock");
+    switch (make_evict_policy(pstr)) {
+        case evict_policy::lruk:
+            return std::make_shared<page_evictioner_lruk>(bufferpool, options,
+                    first_frame, end_frame);
+        case evict_policy::twoq:
+            return std::make_shared<page_evictioner_2q>(bufferpool, options,
+                    first_frame, end_frame);
+        case evict_policy::clock: default:
+            return std::make_shared<page_evictioner_base>(bufferpool, options,
+                    first_frame, end_frame);
+    }
+}
+
 void page_evictioner_base::do_work()
 {
     /**
@@ -51,21 +79,58 @@ void page_evictioner_base::do_work()
 
     uint32_t preferred_count = EVICT_BATCH_RATIO * _bufferpool->_block_cnt + 1;
 
-    // In principle, _freelist_len requires a fence, but here it should be OK
+    std::vector<bf_idx> victims;
+    std::vector<bf_idx> freed;
+    // Victims that could not be evicted in a row. If there is no progress,
+    // the parents of the victims are most likely latched by the threads
+    // waiting for us, so the round ends and they evict a frame themselves
+    // (see bf_tree_m::_grab_free_block).
+    size_t failed = 0;
+    victims.reserve(_batch_size);
+    freed.reserve(_batch_size);
+
+    // In principle, the free count requires a fence, but here it should be OK
     // because we don't need to read a consistent value every time.
-    while(_bufferpool->_freelist_len < preferred_count)
+    // With multiple evictioner threads, each of them evicts from its own
+    // shard until the global target is reached.
+    while(_bufferpool->_get_free_count() < preferred_count)
     {
-        bf_idx victim = pick_victim();
-
-        if (evict_one(victim)) {
-            _bufferpool->_add_free_block(victim);
+        if (_batch_size == 1) {
+            bf_idx victim = pick_victim();
+            if (victim == 0) { break; }
+
+            if (evict_one(victim)) {
+                _bufferpool->_add_free_block(victim);
+                failed = 0;
+            }
+            else if (++failed > frame_count()) { break; }
+
+            /* Rather than waiting for all the pages to be evicted, we notify
+             * waiting threads every time a page is evicted. One of them is going to
+             * be able to re-use the freed slot, the others will go back to waiting.
+             */
+            notify_one();
+        }
+        else {
+            victims.clear();
+            freed.clear();
+            while (victims.size() < _batch_size) {
+                // Only the first victim is worth waiting for; the rest of the
+                // batch is filled with what one sweep over the shard yields
+                _attempt_limit = victims.empty() ? 0 : frame_count();
+                bf_idx victim = pick_victim();
+                if (victim == 0) { break; }
+                victims.push_back(victim);
+            }
+            _attempt_limit = 0;
+            if (victims.empty()) { break; }
+
+            evict_batch(victims, freed);
+            if (freed.empty()) { break; }
+            _bufferpool->_add_free_blocks(freed);
+            INC_TSTAT(bf_evict_batches);
+            notify_all();
         }
-
-        /* Rather than waiting for all the pages to be evicted, we notify
-         * waiting threads every time a page is evicted. One of them is going to
-         * be able to re-use the freed slot, the others will go back to waiting.
-         */
-        notify_one();
 
         if (should_exit()) { break; }
     }
@@ -83,12 +148,86 @@ bool page_evictioner_base::evict_one(bf_idx victim)
          * proceed with this victim. We just jump to the next iteration and
          * hope for better luck next time. */
         cb.latch().latch_release();
+        evict_failed(victim, cb._pid);
         return false;
     }
 
+    return evict_latched(victim);
+}
+
+void page_evictioner_base::evict_batch(std::vector<bf_idx>& victims,
+        std::vector<bf_idx>& freed)
+{
+    if (!_maintain_emlsn && !_swizzling_enabled) {
+        for (bf_idx victim : victims) {
+            if (evict_latched(victim)) { freed.push_back(victim); }
+        }
+        return;
+    }
+
+    // Group victims by parent, so that each parent is latched only once
+    std::vector<std::pair<bf_idx, bf_idx>> by_parent;
+    by_parent.reserve(victims.size());
+    for (bf_idx victim : victims) {
+        by_parent.emplace_back(lookup_parent_idx(victim), victim);
+    }
+    std::sort(by_parent.begin(), by_parent.end());
+    std::sort(victims.begin(), victims.end());
+
+    size_t i = 0;
+    while (i < by_parent.size()) {
+        bf_idx parent_idx = by_parent[i].first;
+        size_t end = i;
+        while (end < by_parent.size() && by_parent[end].first == parent_idx) { end++; }
+
+        bool parent_latched = false;
+        if (parent_idx != 0
+                // parent is itself a victim of this batch (latched by us or
+                // already evicted) -- its children must wait for another round
+                && !std::binary_search(victims.begin(), victims.end(), parent_idx))
+        {
+            bf_tree_cb_t& parent_cb = _bufferpool->get_cb(parent_idx);
+            rc_t r = parent_cb.latch().latch_acquire(LATCH_EX, timeout_t::WAIT_IMMEDIATE);
+            parent_latched = !r.is_error();
+        }
+
+        // whether each victim can be evicted after updating the parent
+        std::vector<bool> updated(end - i, parent_latched);
+        if (parent_latched) {
+            for (size_t j = i; j < end; j++) {
+                updated[j - i] = update_parent_latched(parent_idx, by_parent[j].second);
+            }
+            ADD_TSTAT(bf_evict_shared_parent_latch, end - i - 1);
+            _bufferpool->get_cb(parent_idx).latch().latch_release();
+        }
+
+        for (size_t j = i; j < end; j++) {
+            bf_idx victim = by_parent[j].second;
+            bf_tree_cb_t& cb = _bufferpool->get_cb(victim);
+            bool ok = updated[j - i] ||
+                (parent_idx == 0 && !_bufferpool->_write_elision && !cb._swizzled);
+            if (!ok) {
+                cb.latch().latch_release();
+                evict_failed(victim, cb._pid);
+            }
+            else if (evict_latched(victim)) {
+                freed.push_back(victim);
+            }
+        }
+
+        i = end;
+    }
+}
+
+bool page_evictioner_base::evict_latched(bf_idx victim)
+{
+    bf_tree_cb_t& cb = _bufferpool->get_cb(victim);
+    w_assert1(cb.latch().is_mine());
+
     // Try to atomically set pin from 0 to -1; give up if it fails
     if (!cb.prepare_for_eviction()) {
         cb.latch().latch_release();
+        evict_failed(victim, cb._pid);
         return false;
     }
 
@@ -119,6 +258,8 @@ bool page_evictioner_base::evict_one(bf_idx victim)
         Logger::log_sys<evict_page_log>(cb._pid, was_dirty, page_lsn);
     }
 
+    if (cb._prefetched) { INC_TSTAT(bf_prefetch_waste); }
+
     // remove it from hashtable.
     w_assert1(cb._pin_cnt < 0);
     w_assert1(!cb._used);
@@ -128,6 +269,7 @@ bool page_evictioner_base::evict_one(bf_idx victim)
     DBG2(<< "EVICTED " << victim << " pid " << cb._pid
             << " log-tail " << smlevel_0::log->curr_lsn());
 
+    evict_succeeded(victim, cb._pid);
     cb.latch().latch_release();
 
 //     if (_bufferpool->is_no_db_mode()) {
@@ -163,114 +305,149 @@ void page_evictioner_base::flush_dirty_page(const bf_tree_cb_t& cb)
 
 void page_evictioner_base::ref(bf_idx idx)
 {
-    if (_use_clock && !_clock_ref_bits[idx]) { _clock_ref_bits[idx] = true; }
+    if (_use_clock && !_clock_ref_bits[frame_slot(idx)]) {
+        _clock_ref_bits[frame_slot(idx)] = true;
+    }
 }
 
-bf_idx page_evictioner_base::pick_victim()
+bf_idx page_evictioner_base::next_sweep_idx()
 {
-    bool ignore_dirty = _write_elision || _no_db_mode;
+    if (_current_frame > _end_frame) {
+        // race condition here, but it's not a big deal
+        _current_frame = _first_frame;
+    }
+    bf_idx idx = _random_pick ? get_random_idx() : _current_frame++;
+    if (idx >= _end_frame || idx < _first_frame) { idx = _first_frame; }
+    return idx;
+}
 
-     auto next_idx = [this]
-     {
-         if (_current_frame > _bufferpool->_block_cnt) {
-             // race condition here, but it's not a big deal
-             _current_frame = 1;
-         }
-         return _random_pick ? get_random_idx() : _current_frame++;
-     };
+bool page_evictioner_base::count_attempt(unsigned& attempts, bool& ignore_dirty)
+{
+    if (should_exit()) { return false; }
 
-     unsigned attempts = 0;
-     while(true) {
+    attempts++;
+    if (_attempt_limit > 0 && attempts > _attempt_limit) {
+        return false;
+    }
+    if (attempts >= _max_attempts) {
+        W_FATAL_MSG(fcINTERNAL, << "Eviction got stuck!");
+    }
+    else if (_wakeup_cleaner_attempts > 0 && attempts % _wakeup_cleaner_attempts == 0)
+    {
+        _bufferpool->wakeup_cleaner();
+    }
+    else if (_clean_only_attempts > 0 && attempts >= _clean_only_attempts)
+    {
+        ignore_dirty = true;
+    }
+    return true;
+}
 
-        if (should_exit()) return 0; // in bf_tree.h, 0 is never used, means null
+bool page_evictioner_base::latch_candidate(bf_idx idx)
+{
+    auto& cb = _bufferpool->get_cb(idx);
 
-        bf_idx idx = next_idx();
-        if (idx >= _bufferpool->_block_cnt || idx == 0) { idx = 1; }
+    if (!cb._used) {
+        return false;
+    }
 
-        attempts++;
-        if (attempts >= _max_attempts) {
-            W_FATAL_MSG(fcINTERNAL, << "Eviction got stuck!");
-        }
-        else if (_wakeup_cleaner_attempts > 0 && attempts % _wakeup_cleaner_attempts == 0)
-        {
-            _bufferpool->wakeup_cleaner();
-        }
-        else if (_clean_only_attempts > 0 && attempts >= _clean_only_attempts)
-        {
-            ignore_dirty = true;
-        }
+    // If I already hold the latch on this page (e.g., with latch
+    // coupling), then the latch acquisition below will succeed, but the
+    // page is obvisouly not available for eviction. This would not happen
+    // if every fix would also pin the page, which I didn't wan't to do
+    // because it seems like a waste.  Note that this is only a problem
+    // with threads perform their own eviction (i.e., with the option
+    // _async_eviction set to false in bf_tree_m), because otherwise the
+    // evictioner thread never holds any latches other than when trying to
+    // evict a page.  This bug cost me 2 days of work. Anyway, it should
+    // work with the check below for now.
+    if (cb.latch().held_by_me()) {
+        // I (this thread) currently have the latch on this frame, so
+        // obviously I should not evict it
+        return false;
+    }
 
-        auto& cb = _bufferpool->get_cb(idx);
+    // latch page in EX mode
+    rc_t latch_rc;
+    latch_rc = cb.latch().latch_acquire(LATCH_EX, timeout_t::WAIT_IMMEDIATE);
+    if (latch_rc.is_error()) {
+        DBG3(<< "Eviction failed on latch for " << idx);
+        return false;
+    }
+    w_assert1(cb.latch().is_mine());
+    return true;
+}
 
-        if (!cb._used) {
-            continue;
-        }
+bool page_evictioner_base::is_evictable_latched(bf_idx idx, bool ignore_dirty)
+{
+    auto& cb = _bufferpool->get_cb(idx);
+    w_assert1(cb.latch().is_mine());
 
-        // If I already hold the latch on this page (e.g., with latch
-        // coupling), then the latch acquisition below will succeed, but the
-        // page is obvisouly not available for eviction. This would not happen
-        // if every fix would also pin the page, which I didn't wan't to do
-        // because it seems like a waste.  Note that this is only a problem
-        // with threads perform their own eviction (i.e., with the option
-        // _async_eviction set to false in bf_tree_m), because otherwise the
-        // evictioner thread never holds any latches other than when trying to
-        // evict a page.  This bug cost me 2 days of work. Anyway, it should
-        // work with the check below for now.
-        if (cb.latch().held_by_me()) {
-            // I (this thread) currently have the latch on this frame, so
-            // obviously I should not evict it
-            continue;
-        }
+    // now we hold an EX latch -- check if page qualifies for eviction
+    btree_page_h p;
+    p.fix_nonbufferpool_page(_bufferpool->_buffer + idx);
+    // We do not consider for eviction...
+    if (
+            // ... the stnode page
+            p.tag() == t_stnode_p
+            // ... B-tree inner (non-leaf) pages
+            // (requires unswizzling, which is not supported)
+            // || (p.tag() == t_btree_p && !p.is_leaf())
+            // ... B-tree root pages
+            // (note, single-node B-tree is both root and leaf)
+            || (p.tag() == t_btree_p && p.pid() == p.root())
+            // ... B-tree inner pages with swizzled pointers, whose children
+            // could not be evicted anymore without their parent frame
+            || (_swizzling_enabled && p.tag() == t_btree_p && !p.is_leaf()
+                    && _bufferpool->has_swizzled_child(idx))
+            // ... B-tree pages that have a foster child
+            // (requires unswizzling, which is not supported)
+            // || (p.tag() == t_btree_p && p.get_foster() != 0)
+            // ... dirty pages, unless we're told to ignore them
+            || (!ignore_dirty && cb.is_dirty())
+            // ... unused frames, which don't hold a valid page
+            || !cb._used
+            // ... pinned frames, i.e., someone required it not be evicted
+            || cb._pin_cnt != 0
+            // ... frames prefetched by restore but not yet restored
+            || cb.is_pinned_for_restore()
+    )
+    {
+        cb.latch().latch_release();
+        DBG5(<< "Eviction failed on flags for " << idx);
+        return false;
+    }
 
-        // Step 1: latch page in EX mode and check if eligible for eviction
-        rc_t latch_rc;
-        latch_rc = cb.latch().latch_acquire(LATCH_EX, timeout_t::WAIT_IMMEDIATE);
-        if (latch_rc.is_error()) {
-            DBG3(<< "Eviction failed on latch for " << idx);
-            continue;
-        }
-        w_assert1(cb.latch().is_mine());
+    w_assert1(_bufferpool->_is_active_idx(idx));
+    return true;
+}
+
+bf_idx page_evictioner_base::pick_victim()
+{
+    bool ignore_dirty = _write_elision || _no_db_mode;
+
+    unsigned attempts = 0;
+    while(true) {
+
+        // in bf_tree.h, 0 is never used, means null
+        if (!count_attempt(attempts, ignore_dirty)) { return 0; }
+
+        bf_idx idx = next_sweep_idx();
+
+        // Step 1: latch page in EX mode
+        if (!latch_candidate(idx)) { continue; }
 
         // Only evict if clock refbit is not set
-        if (_use_clock && _clock_ref_bits[idx]) {
-            _clock_ref_bits[idx] = false;
-            cb.latch().latch_release();
+        if (_use_clock && _clock_ref_bits[frame_slot(idx)]) {
+            _clock_ref_bits[frame_slot(idx)] = false;
+            _bufferpool->get_cb(idx).latch().latch_release();
             continue;
         }
 
-        // now we hold an EX latch -- check if page qualifies for eviction
-        btree_page_h p;
-        p.fix_nonbufferpool_page(_bufferpool->_buffer + idx);
-        // We do not consider for eviction...
-        if (
-                // ... the stnode page
-                p.tag() == t_stnode_p
-                // ... B-tree inner (non-leaf) pages
-                // (requires unswizzling, which is not supported)
-                // || (p.tag() == t_btree_p && !p.is_leaf())
-                // ... B-tree root pages
-                // (note, single-node B-tree is both root and leaf)
-                || (p.tag() == t_btree_p && p.pid() == p.root())
-                // ... B-tree pages that have a foster child
-                // (requires unswizzling, which is not supported)
-                // || (p.tag() == t_btree_p && p.get_foster() != 0)
-                // ... dirty pages, unless we're told to ignore them
-                || (!ignore_dirty && cb.is_dirty())
-                // ... unused frames, which don't hold a valid page
-                || !cb._used
-                // ... pinned frames, i.e., someone required it not be evicted
-                || cb._pin_cnt != 0
-                // ... frames prefetched by restore but not yet restored
-                || cb.is_pinned_for_restore()
-        )
-        {
-            cb.latch().latch_release();
-            DBG5(<< "Eviction failed on flags for " << idx);
-            continue;
-        }
+        // Step 2: check if page is eligible for eviction
+        if (!is_evictable_latched(idx, ignore_dirty)) { continue; }
 
         // If we got here, we passed all tests and have a victim!
-        w_assert1(_bufferpool->_is_active_idx(idx));
         w_assert0(idx != 0);
         ADD_TSTAT(bf_eviction_attempts, attempts);
         return idx;
@@ -287,13 +464,7 @@ bool page_evictioner_base::unswizzle_and_update_emlsn(bf_idx idx)
     //==========================================================================
     // STEP 1: Look for parent.
     //==========================================================================
-    PageID pid = _bufferpool->_buffer[idx].pid;
-    bf_idx_pair idx_pair;
-    bool found = _bufferpool->_hashtable->lookup(pid, idx_pair);
-    w_assert1(found);
-
-    bf_idx parent_idx = idx_pair.second;
-    w_assert1(!found || idx == idx_pair.first);
+    bf_idx parent_idx = lookup_parent_idx(idx);
 
     // If there is no parent, but write elision is off and the frame is not swizzled,
     // then it's OK to evict
@@ -308,25 +479,56 @@ bool page_evictioner_base::unswizzle_and_update_emlsn(bf_idx idx)
          * because other threads are also waiting on the eviction mutex. */
         return false;
     }
+
+    bool ok = update_parent_latched(parent_idx, idx);
+
+    parent_cb.latch().latch_release();
+    return ok;
+}
+
+bf_idx page_evictioner_base::lookup_parent_idx(bf_idx idx)
+{
+    w_assert1(_bufferpool->get_cb(idx).latch().is_mine());
+
+    PageID pid = _bufferpool->_buffer[idx].pid;
+    bf_idx_pair idx_pair;
+    bool found = _bufferpool->_hashtable->lookup(pid, idx_pair);
+    w_assert1(found);
+    w_assert1(!found || idx == idx_pair.first);
+
+    return found ? idx_pair.second : 0;
+}
+
+bool page_evictioner_base::update_parent_latched(bf_idx parent_idx, bf_idx idx)
+{
+    bf_tree_cb_t& cb = _bufferpool->get_cb(idx);
+    bf_tree_cb_t& parent_cb = _bufferpool->get_cb(parent_idx);
+    w_assert1(cb.latch().is_mine());
     w_assert1(parent_cb.latch().is_mine());
+    PageID pid = _bufferpool->_buffer[idx].pid;
 
-    /* Look for emlsn slot on parent (must be found because parent pointer is
-     * kept consistent at all times). */
-    w_assert1(_bufferpool->_is_active_idx(parent_idx));
+    /* Look for emlsn slot on parent. The parent frame recorded in the hash
+     * table is only updated when the page is fixed through its parent, so the
+     * page may have been moved to another parent (by a split or an adoption)
+     * in the meantime, and the frame may have been evicted or reused. */
     generic_page *parent = &_bufferpool->_buffer[parent_idx];
     btree_page_h parent_h;
     parent_h.fix_nonbufferpool_page(parent);
 
-    general_recordid_t child_slotid;
-    if (_swizzling_enabled && cb._swizzled) {
+    bool is_parent = _bufferpool->_is_active_idx(parent_idx) && parent->tag == t_btree_p;
+    general_recordid_t child_slotid = GeneralRecordIds::INVALID;
+    if (is_parent && _swizzling_enabled && cb._swizzled) {
         // Search for swizzled address
         PageID swizzled_pid = idx | SWIZZLED_PID_BIT;
         child_slotid = _bufferpool->find_page_id_slot(parent, swizzled_pid);
     }
-    else {
+    else if (is_parent) {
         child_slotid = _bufferpool->find_page_id_slot(parent, pid);
     }
-    w_assert1 (child_slotid != GeneralRecordIds::INVALID);
+    if (child_slotid == GeneralRecordIds::INVALID) {
+        // Same as if there was no parent
+        return !_bufferpool->_write_elision && !cb._swizzled;
+    }
 
     //==========================================================================
     // STEP 2: Unswizzle pointer on parent before evicting.
@@ -357,8 +559,251 @@ bool page_evictioner_base::unswizzle_and_update_emlsn(bf_idx idx)
         w_assert1(parent_h.get_emlsn_general(child_slotid)
                     == _bufferpool->_buffer[idx].lsn);
     }
-
-    parent_cb.latch().latch_release();
     return true;
 }
 
+
+page_evictioner_lruk::page_evictioner_lruk(bf_tree_m* bufferpool,
+        const sm_options& options, bf_idx first_frame, bf_idx end_frame)
+    : page_evictioner_base(bufferpool, options, first_frame, end_frame)
+{
+    _k = options.get_int_option("sm_evict_lruk_k", 2);
+    if (_k < 1) { _k = 1; }
+    if (_k > MAX_K) { _k = MAX_K; }
+    _sample_size = options.get_int_option("sm_evict_lruk_sample", 32);
+    if (_sample_size < 1) { _sample_size = 1; }
+
+    // CLOCK bits are not used by this policy
+    _use_clock = false;
+    _clock_ref_bits.clear();
+
+    // 0 means "no reference"
+    _history.reset(new std::atomic<uint64_t>[frame_count() * _k]);
+    for (size_t i = 0; i < frame_count() * _k; i++) { _history[i] = 0; }
+    _clock = 1;
+}
+
+void page_evictioner_lruk::miss_ref(bf_idx idx, PageID)
+{
+    // frame is EX-latched while being loaded, so nobody else references it
+    std::atomic<uint64_t>* h = &_history[frame_slot(idx) * _k];
+    for (unsigned i = 0; i < _k; i++) { h[i].store(0, std::memory_order_relaxed); }
+    _clock.fetch_add(1, std::memory_order_relaxed);
+}
+
+void page_evictioner_lruk::ref(bf_idx idx)
+{
+    uint64_t now = _clock.load(std::memory_order_relaxed);
+    std::atomic<uint64_t>* h = &_history[frame_slot(idx) * _k];
+    uint64_t last = h[0].load(std::memory_order_relaxed);
+    // Correlated reference: do not count again within the same tick
+    if (last == now) { return; }
+    // Only the thread that moves h[0] forward shifts the older references
+    if (!h[0].compare_exchange_strong(last, now, std::memory_order_relaxed)) { return; }
+    for (unsigned i = _k - 1; i > 1; i--) {
+        h[i].store(h[i-1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    if (_k > 1) { h[1].store(last, std::memory_order_relaxed); }
+}
+
+bf_idx page_evictioner_lruk::pick_victim()
+{
+    bool ignore_dirty = _write_elision || _no_db_mode;
+
+    struct candidate {
+        uint64_t kth;
+        uint64_t last;
+        bf_idx idx;
+        bool operator<(const candidate& o) const {
+            return kth < o.kth || (kth == o.kth && last < o.last);
+        }
+    };
+    std::vector<candidate> sample;
+    sample.reserve(_sample_size);
+
+    unsigned attempts = 0;
+    while (true) {
+        // Collect a sample of used frames and order them by backward K-distance
+        sample.clear();
+        for (unsigned i = 0; i < _sample_size; i++) {
+            bf_idx idx = next_sweep_idx();
+            if (!_bufferpool->get_cb(idx)._used) { continue; }
+            const std::atomic<uint64_t>* h = &_history[frame_slot(idx) * _k];
+            sample.push_back(candidate {h[_k - 1].load(std::memory_order_relaxed),
+                    h[0].load(std::memory_order_relaxed), idx});
+        }
+        std::sort(sample.begin(), sample.end());
+
+        for (auto& c : sample) {
+            if (!count_attempt(attempts, ignore_dirty)) { return 0; }
+            if (!latch_candidate(c.idx)) { continue; }
+            if (!is_evictable_latched(c.idx, ignore_dirty)) { continue; }
+
+            if (c.kth == 0) { INC_TSTAT(bf_evict_cold_victim); }
+            else { INC_TSTAT(bf_evict_hot_victim); }
+            ADD_TSTAT(bf_eviction_attempts, attempts);
+            return c.idx;
+        }
+
+        // sample might have been empty
+        if (!count_attempt(attempts, ignore_dirty)) { return 0; }
+    }
+}
+
+page_evictioner_2q::page_evictioner_2q(bf_tree_m* bufferpool,
+        const sm_options& options, bf_idx first_frame, bf_idx end_frame)
+    : page_evictioner_base(bufferpool, options, first_frame, end_frame), _a1out_seq(0)
+{
+    size_t nframes = frame_count();
+    _a1in_max = nframes * options.get_int_option("sm_evict_2q_a1in_pct", 25) / 100;
+    _a1out_max = nframes * options.get_int_option("sm_evict_2q_a1out_pct", 50) / 100;
+    if (_a1in_max < 1) { _a1in_max = 1; }
+
+    // CLOCK bits are kept in _am_referenced for the Am queue only
+    _use_clock = false;
+    _clock_ref_bits.clear();
+    _queue.reset(new std::atomic<queue_t>[nframes]);
+    _am_referenced.reset(new std::atomic<bool>[nframes]);
+    for (size_t i = 0; i < nframes; i++) {
+        _queue[i] = QUEUE_A1IN;
+        _am_referenced[i] = false;
+    }
+}
+
+void page_evictioner_2q::miss_ref(bf_idx idx, PageID pid)
+{
+    std::unique_lock<std::mutex> lck(_mutex);
+    auto it = _a1out_map.find(pid);
+    if (it != _a1out_map.end()) {
+        // Page was evicted from A1in recently -- it is hot
+        _a1out_map.erase(it);
+        _am_referenced[frame_slot(idx)] = false;
+        _queue[frame_slot(idx)] = QUEUE_AM;
+        INC_TSTAT(bf_evict_ghost_hit);
+    }
+    else {
+        _queue[frame_slot(idx)] = QUEUE_A1IN;
+        _a1in.emplace_back(idx, pid);
+    }
+}
+
+void page_evictioner_2q::ref(bf_idx idx)
+{
+    // Hits on A1in pages are ignored on purpose (correlated references)
+    size_t slot = frame_slot(idx);
+    if (_queue[slot].load(std::memory_order_relaxed) == QUEUE_AM
+            && !_am_referenced[slot].load(std::memory_order_relaxed)) {
+        _am_referenced[slot].store(true, std::memory_order_relaxed);
+    }
+}
+
+bf_idx page_evictioner_2q::pop_a1in(PageID& pid)
+{
+    std::unique_lock<std::mutex> lck(_mutex);
+    while (!_a1in.empty()) {
+        auto e = _a1in.front();
+        _a1in.pop_front();
+        // Skip entries whose frame was evicted or reused in the meantime
+        auto& cb = _bufferpool->get_cb(e.first);
+        if (cb._used && cb._pid == e.second && _queue[frame_slot(e.first)] == QUEUE_A1IN) {
+            pid = e.second;
+            return e.first;
+        }
+    }
+    return 0;
+}
+
+void page_evictioner_2q::push_a1out(PageID pid)
+{
+    std::unique_lock<std::mutex> lck(_mutex);
+    if (_a1out_max == 0) { return; }
+    _a1out_seq++;
+    _a1out_map[pid] = _a1out_seq;
+    _a1out.emplace_back(pid, _a1out_seq);
+    while (_a1out.size() > _a1out_max) {
+        auto e = _a1out.front();
+        _a1out.pop_front();
+        auto it = _a1out_map.find(e.first);
+        if (it != _a1out_map.end() && it->second == e.second) {
+            _a1out_map.erase(it);
+        }
+    }
+}
+
+void page_evictioner_2q::evict_failed(bf_idx idx, PageID pid)
+{
+    // Put it back in A1in, otherwise the frame would never be considered again
+    if (_queue[frame_slot(idx)] == QUEUE_A1IN) {
+        std::unique_lock<std::mutex> lck(_mutex);
+        _a1in.emplace_back(idx, pid);
+    }
+}
+
+void page_evictioner_2q::evict_succeeded(bf_idx idx, PageID pid)
+{
+    // Only pages evicted from A1in are remembered; Am victims are simply dropped
+    if (_queue[frame_slot(idx)] == QUEUE_A1IN) {
+        push_a1out(pid);
+    }
+}
+
+bf_idx page_evictioner_2q::pick_victim()
+{
+    bool ignore_dirty = _write_elision || _no_db_mode;
+    bf_idx nframes = frame_count();
+
+    unsigned attempts = 0;
+    // Number of consecutive frames examined in Am without finding a victim
+    bf_idx am_misses = 0;
+    while (true) {
+        if (!count_attempt(attempts, ignore_dirty)) { return 0; }
+
+        size_t a1in_size;
+        {
+            std::unique_lock<std::mutex> lck(_mutex);
+            a1in_size = _a1in.size();
+        }
+
+        if (a1in_size > _a1in_max || (a1in_size > 0 && am_misses >= nframes)) {
+            PageID pid;
+            bf_idx idx = pop_a1in(pid);
+            if (idx == 0) { continue; }
+
+            if (!latch_candidate(idx)) {
+                evict_failed(idx, pid);
+                continue;
+            }
+            // re-check after latching, since frame may have been reused
+            if (_bufferpool->get_cb(idx)._pid != pid || _queue[frame_slot(idx)] != QUEUE_A1IN) {
+                _bufferpool->get_cb(idx).latch().latch_release();
+                continue;
+            }
+            if (!is_evictable_latched(idx, ignore_dirty)) {
+                evict_failed(idx, pid);
+                continue;
+            }
+
+            am_misses = 0;
+            INC_TSTAT(bf_evict_cold_victim);
+            ADD_TSTAT(bf_eviction_attempts, attempts);
+            return idx;
+        }
+
+        // CLOCK over frames in Am
+        bf_idx idx = next_sweep_idx();
+        am_misses++;
+        if (_queue[frame_slot(idx)] != QUEUE_AM) { continue; }
+        if (!latch_candidate(idx)) { continue; }
+        if (_am_referenced[frame_slot(idx)]) {
+            _am_referenced[frame_slot(idx)] = false;
+            _bufferpool->get_cb(idx).latch().latch_release();
+            continue;
+        }
+        if (!is_evictable_latched(idx, ignore_dirty)) { continue; }
+
+        am_misses = 0;
+        INC_TSTAT(bf_evict_hot_victim);
+        ADD_TSTAT(bf_eviction_attempts, attempts);
+        return idx;
+    }
+}
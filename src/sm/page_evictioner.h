@@ -11,34 +11,76 @@
 
 #include "worker_thread.h"
 
+#include <atomic>
+#include <memory>
 #include <random>
+#include <mutex>
+#include <deque>
+#include <unordered_map>
 
 class bf_tree_m;
 class generic_page;
 struct bf_tree_cb_t;
 
+/**
+ * Page replacement policies, selected with the option sm_evict_policy.
+ */
+enum class evict_policy {
+    /** Round-robin (or random) sweep with optional CLOCK bit (default) */
+    clock,
+    /** LRU-K, approximated by sampling (see page_evictioner_lruk) */
+    lruk,
+    /** Full 2Q with FIFO probation queue and ghost queue (see page_evictioner_2q) */
+    twoq
+};
+
 class page_evictioner_base : public worker_thread_t {
 public:
 
-    page_evictioner_base(bf_tree_m* bufferpool, const sm_options& options);
+    /**
+     * The evictioner is responsible for the frames in the range
+     * [first_frame, end_frame); end_frame = 0 means the whole buffer pool.
+     */
+    page_evictioner_base(bf_tree_m* bufferpool, const sm_options& options,
+            bf_idx first_frame = 1, bf_idx end_frame = 0);
     virtual ~page_evictioner_base();
 
     /**
      * Every time a page is fixed, this method is called. The policy then should
      * do whatever it wants.
      */
-    void            ref(bf_idx idx);
+    virtual void    ref(bf_idx idx);
 
+    /**
+     * Called when a page is loaded into a free frame, before ref() is called
+     * for the same fix. Policies may use it to reset per-frame metadata.
+     */
+    virtual void    miss_ref(bf_idx /*idx*/, PageID /*pid*/) {}
 
     /**
      * Pick victim must return the bf_idx. The corresponding CB must be latched
      * in EX mode. If for any reason it must exit without a victim, this method
      * must return bf_idx 0.
      */
-    bf_idx          pick_victim();
+    virtual bf_idx  pick_victim();
 
     bool evict_one(bf_idx);
 
+    /**
+     * Evicts a batch of victims returned by pick_victim(), all latched in EX
+     * mode. Victims that share a parent are unswizzled and have their EMLSN
+     * updated under a single latch acquisition on the parent. Frames that
+     * were evicted are appended to freed; all latches are released on return.
+     */
+    void evict_batch(std::vector<bf_idx>& victims, std::vector<bf_idx>& freed);
+
+    /** Creates the evictioner for the policy given in sm_evict_policy */
+    static std::shared_ptr<page_evictioner_base> create(bf_tree_m* bufferpool,
+            const sm_options& options, bf_idx first_frame = 1, bf_idx end_frame = 0);
+
+    bf_idx get_first_frame() const { return _first_frame; }
+    bf_idx get_end_frame() const { return _end_frame; }
+
 protected:
     /** the buffer pool this cleaner deals with. */
     bf_tree_m*                  _bufferpool;
@@ -50,6 +92,19 @@ protected:
     bool                        _random_pick;
     bool                        _use_clock;
 
+    /**
+     * Range of frames [_first_frame, _end_frame) owned by this evictioner.
+     * With sm_evict_threads > 1, each evictioner thread owns a disjoint shard
+     * of the buffer pool; per-frame policy metadata covers only that shard.
+     */
+    bf_idx                      _first_frame;
+    bf_idx                      _end_frame;
+    size_t frame_slot(bf_idx idx) const { return idx - _first_frame; }
+    size_t frame_count() const { return _end_frame - _first_frame; }
+
+    /** Number of victims selected before they are evicted together (sm_evict_batch_size) */
+    unsigned                    _batch_size;
+
     std::default_random_engine _rnd_gen;
     std::uniform_int_distribution<bf_idx> _rnd_distr;
     bf_idx get_random_idx() { return _rnd_distr(_rnd_gen); }
@@ -57,12 +112,57 @@ protected:
     // Maximum number of pick_victim attempts before throwing "eviction stuck" error
     unsigned _max_attempts;
 
+    // If non-zero, pick_victim gives up (returning 0) after this many attempts.
+    // Used to stop filling a batch once the shard has been swept without success.
+    unsigned _attempt_limit;
+
     // Cleaner is waken up every this many eviction attempts
     unsigned _wakeup_cleaner_attempts;
 
     // Dirty pages are flushed after this many eviction attempts
     unsigned _clean_only_attempts;
 
+    // Used by simple CLOCK policy
+    std::vector<bool> _clock_ref_bits;
+
+    /**
+     * Called by evict_one() when the victim returned by pick_victim() could
+     * not be evicted after all (e.g., because the parent could not be latched).
+     * The latch on the frame is already released.
+     */
+    virtual void evict_failed(bf_idx /*idx*/, PageID /*pid*/) {}
+
+    /**
+     * Called once the victim has been removed from the hash table, while its
+     * frame is still latched, i.e., before it can be reused.
+     */
+    virtual void evict_succeeded(bf_idx /*idx*/, PageID /*pid*/) {}
+
+    /**
+     * Counts one attempt of a pick_victim implementation. Throws the "eviction
+     * stuck" error, wakes up the cleaner and flips ignore_dirty according to
+     * the configured number of attempts. Returns false if the thread should exit
+     * or if _attempt_limit was reached.
+     */
+    bool count_attempt(unsigned& attempts, bool& ignore_dirty);
+
+    /**
+     * Tries to latch the given frame in EX mode without blocking.
+     * Returns false if the frame is unused, already latched by this thread or
+     * if the latch could not be acquired.
+     */
+    bool latch_candidate(bf_idx idx);
+
+    /**
+     * Checks whether the latched frame qualifies for eviction, i.e., it is not
+     * pinned, not a root or stnode page, not dirty (unless ignore_dirty), etc.
+     * If not, the latch is released and false is returned.
+     */
+    bool is_evictable_latched(bf_idx idx, bool ignore_dirty);
+
+    /** Returns the next frame from the round-robin (or random) sweep. */
+    bf_idx next_sweep_idx();
+
 private:
     /**
      * When eviction is triggered, _about_ this number of cb will be evicted at
@@ -76,9 +176,6 @@ private:
      */
     std::atomic<bf_idx>                      _current_frame;
 
-    // Used by simple CLOCK policy
-    std::vector<bool> _clock_ref_bits;
-
     /**
      * In case swizziling is enabled, it will unswizzle the parent point.
      * Additionally, it will update the parent emlsn.
@@ -87,9 +184,141 @@ private:
      */
     bool unswizzle_and_update_emlsn(bf_idx idx);
 
+    /** Returns the frame of the parent of the given latched frame, or 0 */
+    bf_idx lookup_parent_idx(bf_idx idx);
+
+    /**
+     * Unswizzles the pointer to idx and updates its EMLSN on the given parent,
+     * which must be latched in EX mode by the caller. Returns whether idx can
+     * be evicted, which is not the case if the parent no longer points to it
+     * and it is swizzled (see unswizzle_and_update_emlsn).
+     */
+    bool update_parent_latched(bf_idx parent_idx, bf_idx idx);
+
+    /**
+     * Second half of evict_one(), i.e., after the parent has been taken care
+     * of. The latch on the frame is released in any case.
+     */
+    bool evict_latched(bf_idx idx);
+
     void flush_dirty_page(const bf_tree_cb_t& cb);
 
     virtual void do_work ();
 };
 
+inline evict_policy make_evict_policy(std::string s)
+{
+    if (s == "clock") { return evict_policy::clock; }
+    if (s == "lruk") { return evict_policy::lruk; }
+    if (s == "2q") { return evict_policy::twoq; }
+    W_FATAL_MSG(fcINTERNAL, << "Invalid value for sm_evict_policy: " << s);
+    return evict_policy::clock;
+}
+
+/**
+ * \brief LRU-K replacement (O'Neil et al., SIGMOD 1993).
+ * \details
+ * Each frame keeps the timestamps of its last K references in an array
+ * outside of bf_tree_cb_t. The victim is the frame with the oldest K-th most
+ * recent reference, and frames with fewer than K references are preferred
+ * (infinite backward K-distance), which makes the policy scan-resistant.
+ *
+ * Time is advanced on every buffer miss rather than on every fix, so that
+ * the fix path stays free of shared writes and correlated references (e.g.,
+ * a cursor re-fixing the same leaf) are collapsed into a single one.
+ * Threads fixing the same frame concurrently race for its history with a
+ * CAS on the most recent reference; the loser's reference is correlated
+ * anyway and is dropped.
+ * Instead of keeping a priority queue, pick_victim() examines a sample of
+ * frames from the sweep and picks the best candidate among them.
+ *
+ * Options: sm_evict_lruk_k (default 2), sm_evict_lruk_sample (default 32).
+ */
+class page_evictioner_lruk : public page_evictioner_base {
+public:
+    page_evictioner_lruk(bf_tree_m* bufferpool, const sm_options& options,
+            bf_idx first_frame = 1, bf_idx end_frame = 0);
+    virtual ~page_evictioner_lruk() {}
+
+    virtual void    ref(bf_idx idx);
+    virtual void    miss_ref(bf_idx idx, PageID pid);
+    virtual bf_idx  pick_victim();
+
+protected:
+    static constexpr unsigned MAX_K = 8;
+
+    unsigned _k;
+    unsigned _sample_size;
+
+    /** _history[frame_slot(idx) * _k + i] is the (i+1)-th most recent reference of frame idx */
+    std::unique_ptr<std::atomic<uint64_t>[]> _history;
+
+    /** Logical clock, advanced on every miss */
+    std::atomic<uint64_t> _clock;
+};
+
+/**
+ * \brief 2Q replacement (Johnson and Shasha, VLDB 1994).
+ * \details
+ * Pages enter a FIFO probation queue (A1in) when first loaded; hits on them
+ * do not promote them, so a long scan only cycles through A1in. When a page
+ * is evicted from A1in, its ID is remembered in a ghost queue (A1out). A page
+ * that is fetched again while in A1out is considered hot and goes to the main
+ * queue (Am), which is managed with CLOCK as an approximation of LRU.
+ * Victims are taken from A1in as long as it is larger than its share of the
+ * buffer pool (or if no frame in Am can be evicted).
+ *
+ * Options: sm_evict_2q_a1in_pct (default 25), sm_evict_2q_a1out_pct (default 50),
+ * both relative to the number of frames. With sm_evict_threads > 1, each shard
+ * keeps its own queues, so a ghost hit is only detected if the page is loaded
+ * again into the shard that evicted it.
+ */
+class page_evictioner_2q : public page_evictioner_base {
+public:
+    page_evictioner_2q(bf_tree_m* bufferpool, const sm_options& options,
+            bf_idx first_frame = 1, bf_idx end_frame = 0);
+    virtual ~page_evictioner_2q() {}
+
+    virtual void    ref(bf_idx idx);
+    virtual void    miss_ref(bf_idx idx, PageID pid);
+    virtual bf_idx  pick_victim();
+
+protected:
+    virtual void evict_failed(bf_idx idx, PageID pid);
+    virtual void evict_succeeded(bf_idx idx, PageID pid);
+
+    enum queue_t : uint8_t { QUEUE_A1IN = 0, QUEUE_AM = 1 };
+
+    /**
+     * Queue of each frame. Kept outside bf_tree_cb_t. Written under _mutex,
+     * but read without it on every fix.
+     */
+    std::unique_ptr<std::atomic<queue_t>[]> _queue;
+
+    /**
+     * CLOCK bits of the frames in Am. Unlike the bit vector of the base
+     * class, neighboring frames can be referenced concurrently.
+     */
+    std::unique_ptr<std::atomic<bool>[]> _am_referenced;
+
+    /** FIFO of <frame, page> pairs; entries may be stale and are checked on pop */
+    std::deque<std::pair<bf_idx, PageID>> _a1in;
+    size_t _a1in_max;
+
+    /** Ghost queue of evicted page IDs with a sequence number to detect stale entries */
+    std::deque<std::pair<PageID, uint64_t>> _a1out;
+    std::unordered_map<PageID, uint64_t> _a1out_map;
+    size_t _a1out_max;
+    uint64_t _a1out_seq;
+
+    /** Protects the queues above */
+    std::mutex _mutex;
+
+    /** Pops the oldest entry of A1in that still matches its frame; 0 if none. */
+    bf_idx pop_a1in(PageID& pid);
+
+    /** Adds an evicted page to A1out, trimming it to its maximum size */
+    void push_a1out(PageID pid);
+};
+
 #endif
@@ -0,0 +1,47 @@
+#include "page_prefetcher.h"
+
+#include "bf_tree.h"
+#include "smthread.h"
+
+page_prefetcher::page_prefetcher(bf_tree_m* bufferpool, const sm_options& options)
+    :
+    // only runs when woken up by enqueue()
+    worker_thread_t(-1),
+    _bufferpool(bufferpool)
+{
+    _max_queued = options.get_int_option("sm_bf_readahead_max_queued", 1024);
+}
+
+page_prefetcher::~page_prefetcher()
+{
+}
+
+void page_prefetcher::enqueue(const std::vector<PageID>& pids)
+{
+    if (pids.empty()) { return; }
+    {
+        std::unique_lock<std::mutex> lck(_mutex);
+        if (_queue.size() + pids.size() > _max_queued) {
+            // Read-ahead is only a hint -- don't let it pile up
+            ADD_TSTAT(bf_prefetch_dropped, pids.size());
+            return;
+        }
+        _queue.insert(_queue.end(), pids.begin(), pids.end());
+    }
+    ADD_TSTAT(bf_prefetch_requested, pids.size());
+    wakeup();
+}
+
+void page_prefetcher::do_work()
+{
+    std::vector<PageID> pids;
+    while (!should_exit()) {
+        pids.clear();
+        {
+            std::unique_lock<std::mutex> lck(_mutex);
+            if (_queue.empty()) { break; }
+            std::swap(pids, _queue);
+        }
+        _bufferpool->prefetch_pages(pids);
+    }
+}
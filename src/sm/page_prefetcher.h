@@ -0,0 +1,48 @@
+#ifndef PAGE_PREFETCHER_H
+#define PAGE_PREFETCHER_H
+
+#include "basics.h"
+#include "sm_options.h"
+#include "worker_thread.h"
+
+#include <mutex>
+#include <vector>
+
+class bf_tree_m;
+
+/**
+ * \brief Read-ahead thread of the buffer pool.
+ * \details
+ * Threads that expect to need some pages soon (e.g., B-tree cursors, see
+ * bf_tree_m::readahead_siblings) queue their IDs with enqueue(), which returns
+ * immediately. The prefetcher then reads them into free frames with
+ * bf_tree_m::prefetch_pages(), using vector I/O for runs of consecutive pages.
+ * Pages that are already cached when a request is processed are skipped, so
+ * overlapping requests are cheap.
+ *
+ * Options: sm_bf_readahead_window (window of a cursor; 0 disables read-ahead
+ * and this thread), sm_bf_readahead_max_queued (requests beyond this number
+ * of queued pages are dropped).
+ */
+class page_prefetcher : public worker_thread_t {
+public:
+    page_prefetcher(bf_tree_m* bufferpool, const sm_options& options);
+    virtual ~page_prefetcher();
+
+    /** Queues the given pages for asynchronous read. */
+    void enqueue(const std::vector<PageID>& pids);
+
+protected:
+    virtual void do_work();
+
+private:
+    bf_tree_m* _bufferpool;
+
+    /** Pages requested but not yet processed; protected by _mutex */
+    std::vector<PageID> _queue;
+    std::mutex _mutex;
+
+    size_t _max_queued;
+};
+
+#endif
@@ -80,8 +80,7 @@ Rome Research Laboratory Contract No. F30602-97-2-0247.
     }
 
 partition_t::partition_t(log_storage *owner, partition_number_t num)
-    : _num(num), _owner(owner), _size(-1),
-      _fhdl_rd(invalid_fhdl), _fhdl_app(invalid_fhdl)
+    : _num(num), _owner(owner), _size(-1)
 {
     _max_partition_size = owner->get_partition_size();
 #ifndef USE_MMAP
@@ -105,11 +104,8 @@ rc_t partition_t::open_for_append()
 {
     w_assert3(!is_open_for_append());
 
-    int fd, flags = O_RDWR | O_CREAT;
-    string fname = _owner->make_log_name(_num);
-    fd = ::open(fname.c_str(), flags, 0744 /*mode*/);
-    CHECK_ERRNO(fd);
-    _fhdl_app = fd;
+    int flags = O_RDWR | O_CREAT;
+    _owner->open_striped(_num, flags, _fhdl_app);
 
     return RCOK;
 }
@@ -184,8 +180,10 @@ rc_t partition_t::flush(
            pread/pwrite (which doesn't change the file pointer).
          */
         off_t where = file_offset;
-        auto ret = lseek(_fhdl_app, where, SEEK_SET);
-        CHECK_ERRNO(ret);
+        if (_fhdl_app.size() == 1) {
+            auto ret = lseek(_fhdl_app[0], where, SEEK_SET);
+            CHECK_ERRNO(ret);
+        }
     } // end sync log
 
     { // Copy a skip record to the end of the buffer.
@@ -222,13 +220,21 @@ rc_t partition_t::flush(
             { block_of_zeros(),         grand_total-total},
         };
 
-        auto ret = ::writev(_fhdl_app, iov, 4);
-        CHECK_ERRNO(ret);
-
         ADD_TSTAT(log_bytes_written, grand_total);
+
+        if (_fhdl_app.size() > 1) {
+            // striped log: every stream writes and fsyncs its own part
+            _owner->write_striped(_fhdl_app, iov, 4,
+                    floor2(lsn.lo(), log_storage::BLOCK_SIZE));
+            flush_delay();
+            return RCOK;
+        }
+
+        auto ret = ::writev(_fhdl_app[0], iov, 4);
+        CHECK_ERRNO(ret);
     } // end copy skip record
 
-    fsync_delayed(_fhdl_app); // fsync
+    fsync_delayed(_fhdl_app[0]); // fsync
     return RCOK;
 }
 
@@ -308,8 +314,7 @@ rc_t partition_t::read(logrec_t *&rp, lsn_t &ll, lsn_t* prev_lsn)
 
         DBG5(<<"leftover=" << int(leftover) << " b=" << b);
 
-        auto bytesRead = ::pread(_fhdl_rd, (void *)(_readbuf + b), XFERSIZE, lower + b);
-        CHECK_ERRNO(bytesRead);
+        auto bytesRead = _owner->read_striped(_fhdl_rd, _readbuf + b, XFERSIZE, lower + b);
         if (bytesRead != XFERSIZE) { return RC(stSHORTIO); }
 
         b += XFERSIZE;
@@ -333,9 +338,8 @@ rc_t partition_t::read(logrec_t *&rp, lsn_t &ll, lsn_t* prev_lsn)
                         *prev_lsn = lsn_t::null;
                     }
                     else {
-                        bytesRead = pread(_fhdl_rd, (void*) prev_lsn, sizeof(lsn_t),
-                                    prev_offset);
-                        CHECK_ERRNO(bytesRead);
+                        bytesRead = _owner->read_striped(_fhdl_rd, prev_lsn,
+                                sizeof(lsn_t), prev_offset);
                         if (bytesRead != sizeof(lsn_t)) { return RC(stSHORTIO); }
                     }
                 }
@@ -355,10 +359,7 @@ rc_t partition_t::read(logrec_t *&rp, lsn_t &ll, lsn_t* prev_lsn)
 size_t partition_t::read_block(void* buf, size_t count, off_t offset)
 {
     w_assert0(is_open_for_read());
-    auto bytesRead = ::pread(_fhdl_rd, buf, count, offset);
-    CHECK_ERRNO(bytesRead);
-
-    return bytesRead;
+    return _owner->read_striped(_fhdl_rd, buf, count, offset);
 }
 
 void partition_t::release_read()
@@ -373,17 +374,14 @@ rc_t partition_t::open_for_read()
     // mmap code needs lock just to synchronize multiple open calls, reads don't need it
     lock_guard<mutex> lck(_read_mutex);
 
-    if(_fhdl_rd == invalid_fhdl) {
-        string fname = _owner->make_log_name(_num);
-        int fd, flags = O_RDONLY;
-        fd = ::open(fname.c_str(), flags, 0 /*mode*/);
-        CHECK_ERRNO(fd);
-        w_assert3(_fhdl_rd == invalid_fhdl);
-        _fhdl_rd = fd;
+    if(_fhdl_rd.empty()) {
+        int flags = O_RDONLY;
+        _owner->open_striped(_num, flags, _fhdl_rd);
 #ifdef USE_MMAP
-        _readbuf = reinterpret_cast<char*>(
-                mmap(nullptr, _max_partition_size, PROT_READ, MAP_SHARED, _fhdl_rd, 0));
-        CHECK_ERRNO((long) _readbuf);
+        _readbuf = _owner->map_striped(_fhdl_rd, _max_partition_size);
+        // Reads through the mapping mostly follow per-page or per-xct chains
+        // backwards, for which readahead would only load unneeded blocks
+        ::madvise(_readbuf, _max_partition_size, MADV_RANDOM); // only a hint
 #endif
     }
     w_assert3(is_open_for_read());
@@ -393,10 +391,17 @@ rc_t partition_t::open_for_read()
 
 // CS TODO: why is this definition here?
 int partition_t::_artificial_flush_delay = 0;
+int64_t partition_t::_attempt_flush_delay = 0;
+
+void partition_t::set_artificial_flush_delay(int us)
+{
+    w_assert1(us < 99999999/1000);
+    _artificial_flush_delay = us;
+    _attempt_flush_delay = 0;
+}
 
 void partition_t::fsync_delayed(int fd)
 {
-    static int64_t attempt_flush_delay = 0;
     // We only cound the fsyncs called as
     // a result of flush(), not from peek
     // or start-up
@@ -405,14 +410,18 @@ void partition_t::fsync_delayed(int fd)
     auto ret = ::fsync(fd);
     CHECK_ERRNO(ret);
 
+    flush_delay();
+}
+
+void partition_t::flush_delay()
+{
     if (_artificial_flush_delay > 0) {
-        if (attempt_flush_delay==0) {
-            w_assert1(_artificial_flush_delay < 99999999/1000);
-            attempt_flush_delay = _artificial_flush_delay * 1000;
+        if (_attempt_flush_delay==0) {
+            _attempt_flush_delay = _artificial_flush_delay * 1000;
         }
         struct timespec req, rem;
         req.tv_sec = 0;
-        req.tv_nsec = attempt_flush_delay;
+        req.tv_nsec = _attempt_flush_delay;
 
         struct timeval start;
         gettimeofday(&start,0);
@@ -428,32 +437,28 @@ void partition_t::fsync_delayed(int fd)
         diff -= start.tv_sec *       1000000 + start.tv_usec;
         //diff is in micros.
         diff *= 1000; // now it is nanos
-        attempt_flush_delay += ((_artificial_flush_delay * 1000) - diff)/8;
+        _attempt_flush_delay += ((_artificial_flush_delay * 1000) - diff)/8;
 
     }
 }
 
 rc_t partition_t::close_for_append()
 {
-    if (_fhdl_app != invalid_fhdl)  {
-        auto ret = close(_fhdl_app);
-        CHECK_ERRNO(ret);
-        _fhdl_app = invalid_fhdl;
+    if (!_fhdl_app.empty())  {
+        _owner->close_striped(_fhdl_app);
     }
     return RCOK;
 }
 
 rc_t partition_t::close_for_read()
 {
-    if (_fhdl_rd != invalid_fhdl)  {
+    if (!_fhdl_rd.empty())  {
 #ifdef USE_MMAP
         auto ret = munmap(_readbuf, _max_partition_size);
         CHECK_ERRNO(ret);
         _readbuf = nullptr;
 #endif
-        auto ret2 = close(_fhdl_rd);
-        CHECK_ERRNO(ret2);
-        _fhdl_rd = invalid_fhdl;
+        _owner->close_striped(_fhdl_rd);
     }
     return RCOK;
 }
@@ -474,10 +479,18 @@ rc_t partition_t::scan_for_size(bool must_be_skip)
     // is found; then check for must_be_skip
     W_DO(open_for_read());
 
-    struct stat stat;
-    auto ret = ::fstat(_fhdl_rd, &stat);
-    CHECK_ERRNO(ret);
-    off_t fsize = stat.st_size;
+    off_t fsize = _owner->get_striped_size(_fhdl_rd);
+
+    if (_fhdl_rd.size() > 1) {
+        // Drop what a crash during a flush left beyond the first gap, so
+        // that later flushes cannot make it look like valid log again.
+        // Only happens on startup, before anything is appended.
+        for (auto& extent : _owner->get_striped_extents(_num, fsize)) {
+            if (fs::file_size(extent.first) > (uintmax_t) extent.second) {
+                fs::resize_file(extent.first, extent.second);
+            }
+        }
+    }
 
     if (fsize == 0) {
         _size = 0;
@@ -489,8 +502,7 @@ rc_t partition_t::scan_for_size(bool must_be_skip)
     size_t bpos = fsize - XFERSIZE;
     int pos = 2*XFERSIZE - sizeof(lsn_t);
     // start reading just the last of 2 blocks, because the file may be just one block
-    auto bytesRead = ::pread(_fhdl_rd, buf + XFERSIZE, XFERSIZE, bpos);
-    CHECK_ERRNO(bytesRead);
+    auto bytesRead = _owner->read_striped(_fhdl_rd, buf + XFERSIZE, XFERSIZE, bpos);
     if (bytesRead != XFERSIZE) { return RC(stSHORTIO); }
 
     lsn_t lsn;
@@ -501,8 +513,7 @@ rc_t partition_t::scan_for_size(bool must_be_skip)
             // position -- good chance we've found the last logrec. Read
             // record header to check validity
             baseLogHeader h;
-            bytesRead = ::pread(_fhdl_rd, &h, sizeof(baseLogHeader), lsn.lo());
-            CHECK_ERRNO(bytesRead);
+            bytesRead = _owner->read_striped(_fhdl_rd, &h, sizeof(baseLogHeader), lsn.lo());
             if (bytesRead != sizeof(baseLogHeader)) { return RC(stSHORTIO); }
 
             if (h.is_valid()) {
@@ -520,8 +531,7 @@ rc_t partition_t::scan_for_size(bool must_be_skip)
             // We've scanned last block and didn't find it -- read second
             // last block
             bpos -= XFERSIZE;
-            bytesRead = ::pread(_fhdl_rd, buf, XFERSIZE, bpos);
-            CHECK_ERRNO(bytesRead);
+            bytesRead = _owner->read_striped(_fhdl_rd, buf, XFERSIZE, bpos);
             if (bytesRead != XFERSIZE) { return RC(stSHORTIO); }
         }
         pos--;
@@ -541,6 +551,5 @@ void partition_t::destroy()
     W_COERCE(close_for_read());
     W_COERCE(close_for_append());
 
-    fs::path f = _owner->make_log_name(_num);
-    fs::remove(f);
+    _owner->remove_striped(_num);
 }
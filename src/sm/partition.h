@@ -62,6 +62,7 @@ Rome Research Laboratory Contract No. F30602-97-2-0247.
 #include "sm_base.h" // for partition_number_t (CS TODO)
 #include "logrec.h"
 #include <mutex>
+#include <vector>
 
 class log_storage; // forward
 
@@ -70,7 +71,6 @@ public:
     typedef smlevel_0::partition_number_t partition_number_t;
 
     enum { XFERSIZE = 8192 };
-    enum { invalid_fhdl = -1 };
 
     partition_t(log_storage*, partition_number_t);
     virtual ~partition_t() { }
@@ -92,12 +92,12 @@ public:
 
     bool is_open_for_read() const
     {
-        return (_fhdl_rd != invalid_fhdl);
+        return !_fhdl_rd.empty();
     }
 
     bool is_open_for_append() const
     {
-        return (_fhdl_app != invalid_fhdl);
+        return !_fhdl_app.empty();
     }
 
     size_t get_size(bool must_be_skip = true);
@@ -108,19 +108,26 @@ public:
 
     void destroy();
 
+    /** Sets the artificial delay after each flush (sm_log_fake_flush_delay). */
+    static void set_artificial_flush_delay(int us);
+
 private:
     partition_number_t    _num;
     log_storage*          _owner;
     long                  _size;
-    int                   _fhdl_rd;
-    int                   _fhdl_app;
+    // one file per log stream (see log_storage)
+    std::vector<int>      _fhdl_rd;
+    std::vector<int>      _fhdl_app;
     static int            _artificial_flush_delay;  // in microseconds
+    static int64_t        _attempt_flush_delay;     // in nanoseconds
     char*                 _readbuf;
 
     size_t _max_partition_size;
     char* _mmap_buffer;
 
     void             fsync_delayed(int fd);
+    /** Artificial delay after each fsync (sm_log_fake_flush_delay). */
+    void             flush_delay();
     rc_t scan_for_size(bool must_be_skip);
 
     // Serialize (non-mmap) read calls, which use the same buffer
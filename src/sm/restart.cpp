@@ -499,8 +499,13 @@ SprIterator::SprIterator()
     : buffer_capacity{1 << 18 /* 256KB */}
     , archive_scan{smlevel_0::logArchiver ? smlevel_0::logArchiver->getIndex() : nullptr}
 {
+#ifdef USE_MMAP
+    // log records are read in place
+    buffer = nullptr;
+#else
     // Allocate initial buffer -- expand later if needed
     buffer = new char[buffer_capacity];
+#endif
 }
 
 SprIterator::~SprIterator()
@@ -512,8 +517,15 @@ void SprIterator::open(PageID pid, lsn_t firstLSN, lsn_t lastLSN, bool prioritiz
 {
     last_lsn = lsn_t::null,
     replayed_count = 0;
-    lr_offsets.clear();
+    lrs.clear();
+#ifdef USE_MMAP
+    pinned.clear();
+#endif
+#ifndef USE_MMAP
+    // buffer may grow, so remember offsets until it is filled
+    std::vector<uint32_t> lr_offsets;
     size_t pos = 0;
+#endif
 
     if (!lastLSN.is_null()) {
         // make sure log is durable until the lsn we're trying to fetch
@@ -534,6 +546,25 @@ void SprIterator::open(PageID pid, lsn_t firstLSN, lsn_t lastLSN, bool prioritiz
             break;
         }
 
+#ifdef USE_MMAP
+        // STEP 1: Fetch log record in place from the mapped partition,
+        // which we pin until the record is replayed
+        logrec_t* lr;
+        shared_ptr<partition_t> p;
+        rc_t rc = smlevel_0::log->fetch_pinned(nxt, lr, p);
+
+        if ((rc.is_error()) && (eEOF == rc.err_num())) {
+            // EOF -- scan finished
+            left_early = true;
+            break;
+        }
+        else { W_COERCE(rc); }
+
+        if (pinned.empty() || pinned.back() != p) {
+            pinned.push_back(p);
+        }
+        lrs.push_back(lr);
+#else
         // STEP 1: Fecth log record and copy it into buffer
         lsn_t lsn = nxt;
         logrec_t* lr = (logrec_t*) (buffer + pos);
@@ -553,6 +584,7 @@ void SprIterator::open(PageID pid, lsn_t firstLSN, lsn_t lastLSN, bool prioritiz
 
         lr_offsets.push_back(pos);
         pos += lr->length();
+#endif
 
         // STEP 2: Obtain LSN of previous log record on the same page (nxt)
 
@@ -591,7 +623,12 @@ void SprIterator::open(PageID pid, lsn_t firstLSN, lsn_t lastLSN, bool prioritiz
         archive_scan.open(pid, pid+1, firstLSN);
     }
 
-    lr_iter = lr_offsets.crbegin();
+#ifndef USE_MMAP
+    for (auto offset : lr_offsets) {
+        lrs.push_back(reinterpret_cast<logrec_t*>(buffer + offset));
+    }
+#endif
+    lr_iter = lrs.crbegin();
 }
 
 bool SprIterator::next(logrec_t*& lr)
@@ -603,8 +640,8 @@ bool SprIterator::next(logrec_t*& lr)
     }
 
     lsn_t curr_lsn = lsn_t::null;
-    while (curr_lsn <= last_lsn && lr_iter != lr_offsets.crend()) {
-        lr = reinterpret_cast<logrec_t*>(buffer + *lr_iter);
+    while (curr_lsn <= last_lsn && lr_iter != lrs.crend()) {
+        lr = *lr_iter;
         lr_iter++;
         curr_lsn = lr->lsn();
     }
@@ -614,6 +651,12 @@ bool SprIterator::next(logrec_t*& lr)
         return true;
     }
 
+#ifdef USE_MMAP
+    // all replayed: don't hold up recycling of the partitions
+    lrs.clear();
+    lr_iter = lrs.crbegin();
+    pinned.clear();
+#endif
     return false;
 }
 
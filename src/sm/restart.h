@@ -115,7 +115,8 @@ private:
  * A log-record iterator that encapsulates a log archive scan and a recovery
  * log scan. It reads from the former until it runs out, after which it reads
  * from the latter, which is collected by following the per-page chain in the
- * recovery log.
+ * recovery log. With USE_MMAP, records of the recovery log are not copied but
+ * replayed in place from the mapped log partitions.
  */
 class SprIterator
 {
@@ -135,8 +136,13 @@ private:
 
     char* buffer;
     size_t buffer_capacity;
-    std::vector<uint32_t> lr_offsets;
-    std::vector<uint32_t>::const_reverse_iterator lr_iter;
+    // collected recovery log records, pointing into buffer or the log mapping
+    std::vector<logrec_t*> lrs;
+    std::vector<logrec_t*>::const_reverse_iterator lr_iter;
+#ifdef USE_MMAP
+    // partitions lrs point into, kept from being unmapped until replayed
+    std::vector<shared_ptr<partition_t>> pinned;
+#endif
     ArchiveScan archive_scan;
 
     lsn_t last_lsn;
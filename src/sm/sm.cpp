@@ -59,6 +59,7 @@ Rome Research Laboratory Contract No. F30602-97-2-0247.
 #include "sm_base.h"
 #include "btree.h"
 #include "chkpt.h"
+#include "btree_maintainer.h"
 #include "sm.h"
 #include "vol.h"
 #include "bf_tree.h"
@@ -117,6 +118,8 @@ restart_thread_t* smlevel_0::recovery = 0;
 
 btree_m* smlevel_0::bt = 0;
 
+btree_maintainer* smlevel_0::bt_maint = 0;
+
 ss_m* smlevel_top::SSM = 0;
 
 /*
@@ -307,6 +310,16 @@ ss_m::_construct_once()
         if (logBasedRedo) { vol->build_caches(format, nullptr); }
     }
 
+    if (!format) {
+        ERROUT(<< "[" << timer.time_ms() << "] Loading buffer pool snapshot");
+        bf->load_snapshot();
+    }
+
+    // B-tree maintenance walks the stores of the metadata caches, so it can
+    // only start once recovery is done with them
+    bt_maint = new btree_maintainer(_options);
+    if (! bt_maint)  { W_FATAL(eOUTOFMEMORY); }
+
     ERROUT(<< "[" << timer.time_ms() << "] Finished SM initialization");
 }
 
@@ -341,7 +354,8 @@ ss_m::_destruct_once()
     shutting_down = true;
 
     lsn_t shutdown_lsn = log->durable_lsn();
-    fs::path current_log_path = log->get_storage()->make_log_path(shutdown_lsn.hi());
+    auto current_log_extents = log->get_storage()->get_striped_extents(
+            shutdown_lsn.hi(), shutdown_lsn.lo());
 
 
     // get rid of all non-prepared transactions
@@ -353,6 +367,9 @@ ss_m::_destruct_once()
     // retire chkpt thread (calling take() directly still possible)
     chkpt->stop();
 
+    // B-tree maintenance runs system transactions, so retire it before xcts
+    bt_maint->stop();
+
     ERROUT(<< "Terminating recovery manager");
 
     if (recovery) {
@@ -392,6 +409,8 @@ ss_m::_destruct_once()
 
     delete chkpt; chkpt = 0;
 
+    delete bt_maint; bt_maint = 0;
+
     if (recovery) {
         delete recovery;
         recovery = 0;
@@ -425,11 +444,13 @@ ss_m::_destruct_once()
 
      if (shutdown_filthy) {
          ERROUT(<< "Executing Shutdown Filthy");
-         auto offset = shutdown_lsn.lo();
-         resize_file(current_log_path, offset);
-         if ((offset % partition_t::XFERSIZE)> 0 )
-    	     offset = (offset/ partition_t::XFERSIZE + 1) * partition_t::XFERSIZE;
-         resize_file(current_log_path, offset);
+         for (auto& extent : current_log_extents) {
+             auto offset = extent.second;
+             resize_file(extent.first, offset);
+             if ((offset % partition_t::XFERSIZE)> 0 )
+                 offset = (offset/ partition_t::XFERSIZE + 1) * partition_t::XFERSIZE;
+             resize_file(extent.first, offset);
+         }
      }
 
      shutdown_filthy = false;
@@ -571,6 +592,20 @@ ss_m::commit_xct(bool lazy, lsn_t* plastlsn)
     return RCOK;
 }
 
+/*--------------------------------------------------------------*
+ *  ss_m::commit_xct_async()                                    *
+ *--------------------------------------------------------------*/
+rc_t
+ss_m::commit_xct_async(durability_callback_t callback, lsn_t* plastlsn)
+{
+    w_assert1(callback);
+    sm_stats_t*             _stats=0;
+    W_DO(_commit_xct(_stats, false, plastlsn, std::move(callback)));
+    delete _stats;
+
+    return RCOK;
+}
+
 /*--------------------------------------------------------------*
  *  ss_m::abort_xct()                                *
  *--------------------------------------------------------------*/
@@ -794,7 +829,7 @@ void ss_m::dump_page_lsn_chain(std::ostream &o, const PageID &pid, const lsn_t &
 rc_t ss_m::verify_volume(
     int hash_bits, verify_volume_result &result)
 {
-    W_DO(btree_m::verify_volume(hash_bits, result));
+    W_DO(btree_m::verify_volume(hash_bits, result, _verify_threads()));
     return RCOK;
 }
 
@@ -921,7 +956,7 @@ xct_t* ss_m::_new_xct(
  *--------------------------------------------------------------*/
 rc_t
 ss_m::_commit_xct(sm_stats_t*& _stats, bool lazy,
-                  lsn_t* plastlsn)
+                  lsn_t* plastlsn, durability_callback_t callback)
 {
     w_assert3(xct() != 0);
     xct_t* xp = xct();
@@ -936,13 +971,21 @@ ss_m::_commit_xct(sm_stats_t*& _stats, bool lazy,
         } else {
             x.set_piggy_backed_single_log_sys_xct(false);
         }
+        if (callback) {
+            callback(lsn_t::null); // nothing to wait for
+        }
         return RCOK;
     }
 
     w_assert3(x.state()==xct_active);
     w_assert1(x.ssx_chain_len() == 0);
 
-    W_DO( x.commit(lazy,plastlsn) );
+    if (callback) {
+        W_DO( x.commit_async(std::move(callback), plastlsn) );
+    }
+    else {
+        W_DO( x.commit(lazy,plastlsn) );
+    }
 
     if(x.is_instrumented()) {
         _stats = x.steal_stats();
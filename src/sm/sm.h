@@ -406,6 +406,8 @@ class sm_stats_cache_t;
 class prologue_rc_t;
 class w_keystr_t;
 class verify_volume_result;
+struct btree_stats_t;
+class bulk_load_iterator;
 class lil_global_table;
 struct okvl_mode;
 
@@ -752,6 +754,34 @@ public:
                                     bool              lazy = false,
                                     lsn_t*            plastlsn=NULL);
 
+    /**\brief Commit a transaction without waiting for the log flush.
+     *\ingroup SSMXCT
+     * @param[in] callback   Invoked once the commit is durable.
+     * @param[out] plastlsn   If non-null, this is a pointer to a
+     *                    log sequence number into which the storage
+     *                    manager writes the that of the last log record
+     *                    inserted for this transaction.
+     * \details
+     *
+     * Commit the attached transaction and detach it, destroy it.
+     * Unlike a lazy commit, the commit record is still made durable: the
+     * log flush is requested, but this function returns as soon as the
+     * commit record is inserted and the locks are released. The callback
+     * then receives the LSN of the commit record once it is durable. It is
+     * usually called by the log flush daemon, batched with all other commits
+     * made durable by the same flush, so it must be short and must not wait
+     * for the log itself. If the commit is already durable (or the
+     * transaction logged nothing and everything it read is durable), it is
+     * called before this function returns. It is not called if an error is
+     * returned.
+     *
+     * Until the callback is invoked, the results of the transaction must
+     * not be reported to anyone who expects them to survive a crash.
+     */
+    static rc_t            commit_xct_async(
+                                    durability_callback_t callback,
+                                    lsn_t*            plastlsn=NULL);
+
     /**
      * \brief Commit a system transaction, which doesn't cause log sync.
      * \ingroup SSMXCT
@@ -1130,6 +1160,7 @@ public:
      * \brief Verifies consistency of all BTree indexes in the volume.
      * \ingroup SSMVOL
      * @copydetails btree_impl::_ux_verify_volume()
+     * The volume is scanned by sm_btree_verify_threads threads.
      * @see verify_index()
      */
     static rc_t            verify_volume(
@@ -1192,11 +1223,21 @@ public:
 
     /**\brief Create a B+-Tree index.
      * \ingroup SSMBTREE
-     * @param[in] vid   Volume on which to create the index.
      * @param[out] stid New store ID will be returned here.
+     * @param[in] poor_key_width Number of leading key bytes (after the
+     * common prefix of each page) kept in the slot array to avoid full key
+     * comparisons during searches: 2, 4, or 8. Wider ones suit keys whose
+     * first bytes (e.g., a composite key's first columns) are often equal.
+     * @param[in] compress_values Whether to store the elements of leaf
+     * records compressed, which saves space for values with runs of equal
+     * bytes (e.g., padded strings or small integers) at some CPU cost when
+     * reading and writing them.  Option sm_btree_compress_values turns it
+     * on for all new indexes.
      */
     static rc_t            create_index(
-                StoreID&               stid
+                StoreID&               stid,
+                int                    poor_key_width = 2,
+                bool                   compress_values = false
     );
 
 
@@ -1222,6 +1263,31 @@ public:
      */
     static rc_t            touch_index(StoreID stid, uint64_t &page_count);
 
+    /**
+     * \brief Fills an empty B+-Tree index with the given entries.
+     * \ingroup SSMBTREE
+     * \details
+     * Much faster than creating the entries one by one with create_assoc():
+     * leaf and interior pages are built bottom-up, packed full, and each is
+     * logged as a single page image.  No locks are taken other than an X
+     * lock on the index.  Must be called inside a transaction, but the
+     * pages are installed by system transactions, so aborting it does not
+     * undo the load.
+     *
+     * @param[in] stid  ID of the index, which must be empty (else eNDXNOTEMPTY).
+     * @param[in] iter  Entries to be loaded.
+     * @param[in] sorted  Whether iter returns the entries in strictly
+     * ascending key order.  If false, they are sorted first with an external
+     * sort which uses sm_bulkload_sort_memory MB of memory.
+     * @param[out] count  Number of entries loaded, if not NULL.
+     */
+    static rc_t            bulk_load(
+        StoreID                   stid,
+        bulk_load_iterator&       iter,
+        bool                      sorted = true,
+        uint64_t*                 count = NULL
+    );
+
     /**
      * \brief Create an entry in a B+-Tree index.
      * \ingroup SSMBTREE
@@ -1247,6 +1313,29 @@ public:
         const vec_t&             el
     );
 
+    /**
+     * \brief Create many entries in a B+-Tree index.
+     * \ingroup SSMBTREE
+     * \details
+     * Same as calling create_assoc() for each entry, but the entries are
+     * inserted in key order and entries which go to the same leaf page
+     * share one traversal of the index.  Each entry succeeds or fails on
+     * its own, so an error of one entry does not undo the others.
+     *
+     * @param[in] stid  ID of the index.
+     * @param[in] count  Number of entries.
+     * @param[in] keys  Keys of the entries to be created.
+     * @param[in] els  Elements of the entries to be created.
+     * @param[out] results  Outcome for each entry, e.g., eDUPLICATE.
+     */
+    static rc_t            create_assoc_batch(
+        StoreID                   stid,
+        size_t                    count,
+        const w_keystr_t*         keys,
+        const cvec_t*             els,
+        rc_t*                     results
+    );
+
     /**
      * \brief Update record data of an entry in a B+-Tree index.
      * \ingroup SSMBTREE
@@ -1318,6 +1407,34 @@ public:
         bool&                   found
     );
 
+    /** \brief Find the entries associated with many keys in a B+-Tree index.
+     * \ingroup SSMBTREE
+     * \details
+     * Same as calling find_assoc() for each key, but the keys are looked up
+     * in key order and keys which fall into the same leaf page share one
+     * traversal of the index.  Meanwhile, the leaf pages of upcoming keys
+     * are prefetched.
+     *
+     * @param[in] stid  ID of the index.
+     * @param[in] count  Number of keys.
+     * @param[in] keys  Keys to be looked up.
+     * @param[out] els  For each key, buffer into which its element is copied.
+     * @param[in,out] elens  For each key, length of its buffer (in) and of
+     *                  the element (out).
+     * @param[out] found  For each key, true if an entry is found.
+     * @param[out] results  Outcome for each key, e.g., eRECWONTFIT if its
+     *                  buffer is too small.
+     */
+    static rc_t            find_assoc_batch(
+        StoreID                  stid,
+        size_t                   count,
+        const w_keystr_t*        keys,
+        void**                   els,
+        smsize_t*                elens,
+        bool*                    found,
+        rc_t*                    results
+    );
+
     /**
      * \brief Defrags the given page to remove holes and ghost records in the page.
      * \ingroup SSMBTREE
@@ -1330,9 +1447,23 @@ public:
      * \ingroup SSMBTREE
      * @copydetails btree_impl::_ux_verify_tree(const PageID&,int,bool&)
     * @param[in] stid  ID of the index.
+    * If sm_btree_verify_threads is more than 1, the tree is verified in parallel
+    * (see btree_impl::_ux_verify_tree_parallel()).
     */
     static rc_t           verify_index(StoreID  stid, int hash_bits, bool &consistent);
 
+    /**
+     * \brief Collects space statistics of a B-Tree index.
+     * \ingroup SSMBTREE
+     * \details The statistics are added to \e stats. The tree is walked by
+     * sm_btree_verify_threads threads, which also verify it, and pages that
+     * are not in the bufferpool are read without caching them.
+     * @param[in] stid  ID of the index.
+     * @param[in] audit whether to fail if the tree is inconsistent or
+     * some bytes are not accounted for.
+     */
+    static rc_t           get_du_statistics(StoreID stid, btree_stats_t &stats, bool audit = false);
+
     /**
      * Starts reading a given store and returns its root page ID.
      * If this is called in transaction with lock enabled,
@@ -1386,6 +1517,9 @@ private:
 
     void _set_option_logsize();
 
+    /** Threads used for verification and statistics (sm_btree_verify_threads). */
+    static int             _verify_threads();
+
     static rc_t            _set_store_property(
         StoreID                stid,
         store_property_t      property);
@@ -1404,7 +1538,8 @@ private:
     static rc_t            _commit_xct(
         sm_stats_t*&     stats,
         bool                  lazy,
-        lsn_t* plastlsn);
+        lsn_t* plastlsn,
+        durability_callback_t callback = durability_callback_t());
 
     static rc_t            _commit_xct_group(
         xct_t *               list[],
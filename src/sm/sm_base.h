@@ -81,6 +81,7 @@ Rome Research Laboratory Contract No. F30602-97-2-0247.
  */
 
 #include <climits>
+#include <functional>
 
 class ErrLog;
 class xct_t;
@@ -103,6 +104,7 @@ class sm_tls_allocator;
 template <typename T, size_t A> class memalign_allocator;
 
 class chkpt_m;
+class btree_maintainer;
 class restart_thread_t;
 class btree_m;
 class ss_m;
@@ -117,6 +119,13 @@ class ss_m;
 class w_rc_t;
 typedef   w_rc_t        rc_t;
 
+/**
+ * Called once the log is durable up to the LSN it was registered for, e.g.,
+ * the commit record of a transaction committed with ss_m::commit_xct_async().
+ * Receives that LSN.
+ */
+typedef std::function<void(const lsn_t&)> durability_callback_t;
+
 
 /**\cond skip
  * This structure collects the depth on construction
@@ -381,6 +390,9 @@ public:
 
     static btree_m* bt;
 
+    // Background B-tree maintenance
+    static btree_maintainer* bt_maint;
+
     static ss_m*    SSM;    // we will change to lower case later
 
     /**\brief Store property that controls logging of pages in the store.
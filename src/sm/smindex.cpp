@@ -7,21 +7,30 @@
 #include "sm.h"
 #include "xct.h"
 #include "btree.h"
+#include "btree_page.h"
+#include "btree_bulk_load.h"
 #include "vol.h"
 #include "lock.h"
 
+#include <thread>
+
 /*==============================================================*
  *  Physical ID version of all the index operations                *
  *==============================================================*/
 
-rc_t ss_m::create_index(StoreID &stid)
+rc_t ss_m::create_index(StoreID &stid, int poor_key_width, bool compress_values)
 {
     // W_DO(lm->intent_vol_lock(vid, okvl_mode::IX)); // take IX on volume
+    if (!btree_page_data::is_valid_poor_key_width(poor_key_width)) {
+        return RC(eBADARGUMENT);
+    }
 
     // CS TODO: page allocation should transfer ownership to stnode
     PageID root;
     W_DO(vol->create_store(root, stid));
-    W_DO(bt->create(stid, root));
+    compress_values = compress_values
+        || _options.get_bool_option("sm_btree_compress_values", false);
+    W_DO(bt->create(stid, root, poor_key_width, compress_values));
 
     W_DO(lm->intent_store_lock(stid, okvl_mode::X)); // take X on this new index
 
@@ -61,6 +70,39 @@ rc_t ss_m::create_assoc(StoreID stid, const w_keystr_t& key, const vec_t& el)
     return RCOK;
 }
 
+rc_t ss_m::create_assoc_batch(StoreID stid, size_t count, const w_keystr_t* keys,
+                              const cvec_t* els, rc_t* results)
+{
+    PageID root_pid;
+    W_DO(open_store (stid, root_pid, true));
+    W_DO( bt->insert_batch(stid, count, keys, els, results) );
+    return RCOK;
+}
+
+rc_t ss_m::bulk_load(StoreID stid, bulk_load_iterator& iter, bool sorted, uint64_t* count)
+{
+    // the load bypasses key locks, so nobody else may use the index meanwhile
+    if (g_xct_does_need_lock()) {
+        W_DO(lm->intent_store_lock(stid, okvl_mode::X));
+    }
+    PageID root_pid;
+    W_DO(open_store_nolock(stid, root_pid));
+
+    uint64_t loaded;
+    if (sorted) {
+        W_DO(bt->bulk_load(stid, iter, loaded));
+    } else {
+        size_t memory = _options.get_int_option("sm_bulkload_sort_memory", 64);
+        bulk_load_sorter sorter(memory << 20);
+        W_DO(sorter.add_all(iter));
+        W_DO(bt->bulk_load(stid, sorter, loaded));
+    }
+    if (count) {
+        *count = loaded;
+    }
+    return RCOK;
+}
+
 rc_t ss_m::update_assoc(StoreID stid, const w_keystr_t& key, const vec_t& el)
 {
     PageID root_pid;
@@ -104,14 +146,41 @@ rc_t ss_m::find_assoc(StoreID stid, const w_keystr_t& key,
     return RCOK;
 }
 
+rc_t ss_m::find_assoc_batch(StoreID stid, size_t count, const w_keystr_t* keys,
+                 void** els, smsize_t* elens, bool* found, rc_t* results)
+{
+    PageID root_pid;
+    bool for_update = g_xct_does_ex_lock_for_select();
+    W_DO(open_store (stid, root_pid, for_update));
+    W_DO( bt->lookup_batch(stid, count, keys, els, elens, found, results) );
+    return RCOK;
+}
+
 rc_t ss_m::verify_index(StoreID stid, int hash_bits, bool &consistent)
 {
     PageID root_pid;
     W_DO( open_store (stid, root_pid));
-    W_DO( bt->verify_tree(stid,  hash_bits, consistent) );
+    W_DO( bt->verify_tree(stid,  hash_bits, consistent, _verify_threads()) );
+    return RCOK;
+}
+
+rc_t ss_m::get_du_statistics(StoreID stid, btree_stats_t &stats, bool audit)
+{
+    PageID root_pid;
+    W_DO( open_store (stid, root_pid));
+    W_DO( bt->get_du_statistics(stid, stats, audit, _verify_threads()) );
     return RCOK;
 }
 
+int ss_m::_verify_threads()
+{
+    int threads = _options.get_int_option("sm_btree_verify_threads", 1);
+    if (threads < 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return threads;
+}
+
 rc_t ss_m::defrag_index_page(btree_page_h &page)
 {
     W_DO( bt->defrag_page(page));
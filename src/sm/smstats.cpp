@@ -135,6 +135,10 @@ const char* get_stat_name(sm_stat_id s)
         case sm_stat_id::log_fetches: return "log_fetches";
         case sm_stat_id::log_buffer_hit: return "log_buffer_hit";
         case sm_stat_id::log_inserts: return "log_inserts";
+        case sm_stat_id::log_private_chunks: return "log_private_chunks";
+        case sm_stat_id::log_private_fill_bytes: return "log_private_fill_bytes";
+        case sm_stat_id::log_private_reordered: return "log_private_reordered";
+        case sm_stat_id::log_private_buffers: return "log_private_buffers";
         case sm_stat_id::log_full: return "log_full";
         case sm_stat_id::log_full_old_xct: return "log_full_old_xct";
         case sm_stat_id::log_full_old_page: return "log_full_old_page";
@@ -150,6 +154,16 @@ const char* get_stat_name(sm_stat_id s)
         case sm_stat_id::log_flush_wait: return "log_flush_wait";
         case sm_stat_id::log_short_flush: return "log_short_flush";
         case sm_stat_id::log_long_flush: return "log_long_flush";
+        case sm_stat_id::log_gc_holds: return "log_gc_holds";
+        case sm_stat_id::log_gc_hold_us: return "log_gc_hold_us";
+        case sm_stat_id::log_gc_flush_us: return "log_gc_flush_us";
+        case sm_stat_id::log_gc_batch_0: return "log_gc_batch_0";
+        case sm_stat_id::log_gc_batch_1: return "log_gc_batch_1";
+        case sm_stat_id::log_gc_batch_2_7: return "log_gc_batch_2_7";
+        case sm_stat_id::log_gc_batch_8_31: return "log_gc_batch_8_31";
+        case sm_stat_id::log_gc_batch_32_up: return "log_gc_batch_32_up";
+        case sm_stat_id::log_durable_callbacks: return "log_durable_callbacks";
+        case sm_stat_id::log_durable_dispatches: return "log_durable_dispatches";
         case sm_stat_id::lock_deadlock_cnt: return "lock_deadlock_cnt";
         case sm_stat_id::lock_false_deadlock_cnt: return "lock_false_deadlock_cnt";
         case sm_stat_id::lock_dld_call_cnt: return "lock_dld_call_cnt";
@@ -171,9 +185,13 @@ const char* get_stat_name(sm_stat_id s)
         case sm_stat_id::bt_posc: return "bt_posc";
         case sm_stat_id::bt_scan_cnt: return "bt_scan_cnt";
         case sm_stat_id::bt_splits: return "bt_splits";
+        case sm_stat_id::bt_edge_splits: return "bt_edge_splits";
         case sm_stat_id::bt_cuts: return "bt_cuts";
         case sm_stat_id::bt_grows: return "bt_grows";
         case sm_stat_id::bt_shrinks: return "bt_shrinks";
+        case sm_stat_id::bt_bulkload_pages: return "bt_bulkload_pages";
+        case sm_stat_id::bt_value_bytes: return "bt_value_bytes";
+        case sm_stat_id::bt_value_bytes_stored: return "bt_value_bytes_stored";
         case sm_stat_id::bt_links: return "bt_links";
         case sm_stat_id::bt_upgrade_fail_retry: return "bt_upgrade_fail_retry";
         case sm_stat_id::bt_clr_smo_traverse: return "bt_clr_smo_traverse";
@@ -198,6 +216,7 @@ const char* get_stat_name(sm_stat_id s)
         case sm_stat_id::xct_log_flush: return "xct_log_flush";
         case sm_stat_id::begin_xct_cnt: return "begin_xct_cnt";
         case sm_stat_id::commit_xct_cnt: return "commit_xct_cnt";
+        case sm_stat_id::commit_xct_async_cnt: return "commit_xct_async_cnt";
         case sm_stat_id::abort_xct_cnt: return "abort_xct_cnt";
         case sm_stat_id::log_warn_abort_cnt: return "log_warn_abort_cnt";
         case sm_stat_id::prepare_xct_cnt: return "prepare_xct_cnt";
@@ -272,6 +291,42 @@ const char* get_stat_name(sm_stat_id s)
         case sm_stat_id::backup_eviction_stuck: return "backup_eviction_stuck";
         case sm_stat_id::la_wasted_read: return "la_wasted_read";
         case sm_stat_id::la_avoided_probes: return "la_avoided_probes";
+        case sm_stat_id::bf_evict_cold_victim: return "bf_evict_cold_victim";
+        case sm_stat_id::bf_evict_hot_victim: return "bf_evict_hot_victim";
+        case sm_stat_id::bf_evict_ghost_hit: return "bf_evict_ghost_hit";
+        case sm_stat_id::bf_evict_batches: return "bf_evict_batches";
+        case sm_stat_id::bf_evict_shared_parent_latch: return "bf_evict_shared_parent_latch";
+        case sm_stat_id::bf_freelist_contention: return "bf_freelist_contention";
+        case sm_stat_id::bf_freelist_refill: return "bf_freelist_refill";
+        case sm_stat_id::bf_freelist_steal: return "bf_freelist_steal";
+        case sm_stat_id::bf_freelist_spill: return "bf_freelist_spill";
+        case sm_stat_id::bf_prefetch_requested: return "bf_prefetch_requested";
+        case sm_stat_id::bf_prefetch_dropped: return "bf_prefetch_dropped";
+        case sm_stat_id::bf_prefetch_read: return "bf_prefetch_read";
+        case sm_stat_id::bf_prefetch_hit: return "bf_prefetch_hit";
+        case sm_stat_id::bf_prefetch_waste: return "bf_prefetch_waste";
+        case sm_stat_id::vol_aio_requests: return "vol_aio_requests";
+        case sm_stat_id::vol_aio_fixed_requests: return "vol_aio_fixed_requests";
+        case sm_stat_id::vol_aio_ring_full: return "vol_aio_ring_full";
+        case sm_stat_id::bf_snapshot_pages_saved: return "bf_snapshot_pages_saved";
+        case sm_stat_id::bf_snapshot_pages_loaded: return "bf_snapshot_pages_loaded";
+        case sm_stat_id::bf_snapshot_inner_fixed: return "bf_snapshot_inner_fixed";
+        case sm_stat_id::bt_optimistic_traverse_cnt: return "bt_optimistic_traverse_cnt";
+        case sm_stat_id::bt_optimistic_fallback_cnt: return "bt_optimistic_fallback_cnt";
+        case sm_stat_id::bt_optimistic_restart_cnt: return "bt_optimistic_restart_cnt";
+        case sm_stat_id::bt_full_key_compares: return "bt_full_key_compares";
+        case sm_stat_id::bt_batch_key_cnt: return "bt_batch_key_cnt";
+        case sm_stat_id::bt_batch_leaf_reuse_cnt: return "bt_batch_leaf_reuse_cnt";
+        case sm_stat_id::bt_batch_prefetch_cnt: return "bt_batch_prefetch_cnt";
+        case sm_stat_id::bt_cursor_batch_cnt: return "bt_cursor_batch_cnt";
+        case sm_stat_id::bt_cursor_foster_moves: return "bt_cursor_foster_moves";
+        case sm_stat_id::bt_maint_rounds: return "bt_maint_rounds";
+        case sm_stat_id::bt_maint_pages_visited: return "bt_maint_pages_visited";
+        case sm_stat_id::bt_maint_adopts: return "bt_maint_adopts";
+        case sm_stat_id::bt_maint_merges: return "bt_maint_merges";
+        case sm_stat_id::bt_maint_defrags: return "bt_maint_defrags";
+        case sm_stat_id::bt_maint_ghosts_reclaimed: return "bt_maint_ghosts_reclaimed";
+        case sm_stat_id::bt_maint_budget_exhausted: return "bt_maint_budget_exhausted";
     }
     return "UNKNOWN_STAT";
 }
@@ -370,6 +425,10 @@ const char* get_stat_expl(sm_stat_id s)
         case sm_stat_id::log_fetches: return "Log records fetched from log (read)";
         case sm_stat_id::log_buffer_hit: return "Log fetches that were served from in-memory fetch buffers";
         case sm_stat_id::log_inserts: return "Log records inserted into log (written)";
+        case sm_stat_id::log_private_chunks: return "Log chunks reserved for private log buffers";
+        case sm_stat_id::log_private_fill_bytes: return "Bytes of private log buffer chunks left unused and padded";
+        case sm_stat_id::log_private_reordered: return "Private log buffer chunks closed early to keep page or transaction LSNs increasing";
+        case sm_stat_id::log_private_buffers: return "Private log buffers allocated, i.e., not taken over from an exited thread";
         case sm_stat_id::log_full: return "A transaction encountered log full";
         case sm_stat_id::log_full_old_xct: return "An old transaction had to abort";
         case sm_stat_id::log_full_old_page: return "A transaction had to abort due to holding a dirty old page";
@@ -385,6 +444,16 @@ const char* get_stat_expl(sm_stat_id s)
         case sm_stat_id::log_flush_wait: return "Flushes awaited log flush daemon";
         case sm_stat_id::log_short_flush: return "Log flushes <= 1 block";
         case sm_stat_id::log_long_flush: return "Log flushes > 1 block";
+        case sm_stat_id::log_gc_holds: return "Log flushes held back by adaptive group commit to batch more commits";
+        case sm_stat_id::log_gc_hold_us: return "Total time in usec log flushes were held back by adaptive group commit";
+        case sm_stat_id::log_gc_flush_us: return "Total time in usec spent writing and syncing log flushes";
+        case sm_stat_id::log_gc_batch_0: return "Log flushes no commit was waiting for";
+        case sm_stat_id::log_gc_batch_1: return "Log flushes serving 1 commit";
+        case sm_stat_id::log_gc_batch_2_7: return "Log flushes serving 2 to 7 commits";
+        case sm_stat_id::log_gc_batch_8_31: return "Log flushes serving 8 to 31 commits";
+        case sm_stat_id::log_gc_batch_32_up: return "Log flushes serving 32 or more commits";
+        case sm_stat_id::log_durable_callbacks: return "Durability callbacks invoked, e.g., for asynchronous commits";
+        case sm_stat_id::log_durable_dispatches: return "Batches of durability callbacks dispatched by the log flush daemon";
         case sm_stat_id::lock_deadlock_cnt: return "Deadlocks detected";
         case sm_stat_id::lock_false_deadlock_cnt: return "False positive deadlocks";
         case sm_stat_id::lock_dld_call_cnt: return "Deadlock detector total calls";
@@ -406,9 +475,13 @@ const char* get_stat_expl(sm_stat_id s)
         case sm_stat_id::bt_posc: return "POSCs established";
         case sm_stat_id::bt_scan_cnt: return "Btree scans started";
         case sm_stat_id::bt_splits: return "Btree pages split (interior and leaf)";
+        case sm_stat_id::bt_edge_splits: return "Btree leaves split at the edge of sequential insertions instead of in the middle";
         case sm_stat_id::bt_cuts: return "Btree pages removed (interior and leaf)";
         case sm_stat_id::bt_grows: return "Btree grew a level";
         case sm_stat_id::bt_shrinks: return "Btree shrunk a level";
+        case sm_stat_id::bt_bulkload_pages: return "Btree pages built by bulk loads";
+        case sm_stat_id::bt_value_bytes: return "Bytes of elements written to Btree leaves with compressed values";
+        case sm_stat_id::bt_value_bytes_stored: return "Bytes of these elements after compression";
         case sm_stat_id::bt_links: return "Btree links followed";
         case sm_stat_id::bt_upgrade_fail_retry: return "Failure to upgrade a latch forced a retry";
         case sm_stat_id::bt_clr_smo_traverse: return "Cleared SMO bits on traverse";
@@ -433,6 +506,7 @@ const char* get_stat_expl(sm_stat_id s)
         case sm_stat_id::xct_log_flush: return "Log flushes by xct for commit/prepare";
         case sm_stat_id::begin_xct_cnt: return "Transactions started";
         case sm_stat_id::commit_xct_cnt: return "Transactions committed";
+        case sm_stat_id::commit_xct_async_cnt: return "Transactions committed without waiting for their commit to become durable";
         case sm_stat_id::abort_xct_cnt: return "Transactions aborted";
         case sm_stat_id::log_warn_abort_cnt: return "Transactions aborted due to log space warning";
         case sm_stat_id::prepare_xct_cnt: return "Transactions prepared";
@@ -507,6 +581,42 @@ const char* get_stat_expl(sm_stat_id s)
         case sm_stat_id::backup_eviction_stuck: return "Backup prefetcher could not find a segment to evict";
         case sm_stat_id::la_wasted_read: return "Wasted log archive reads, i.e., that didn't use any logrec";
         case sm_stat_id::la_avoided_probes: return "Log archive prbves that were avoided thanks to run filters";
+        case sm_stat_id::bf_evict_cold_victim: return "Victims selected by the eviction policy among pages referenced only once (LRU-K, 2Q A1in)";
+        case sm_stat_id::bf_evict_hot_victim: return "Victims selected by the eviction policy among frequently-referenced pages (LRU-K, 2Q Am)";
+        case sm_stat_id::bf_evict_ghost_hit: return "Buffer misses on pages still remembered in the 2Q ghost queue (A1out)";
+        case sm_stat_id::bf_evict_batches: return "Victim batches evicted by eviction threads";
+        case sm_stat_id::bf_evict_shared_parent_latch: return "Evictions that reused a parent latch acquired for another victim in the same batch";
+        case sm_stat_id::bf_freelist_contention: return "Free-frame list or cache locks that were not immediately available";
+        case sm_stat_id::bf_freelist_refill: return "Per-core free-frame caches refilled from the global freelist";
+        case sm_stat_id::bf_freelist_steal: return "Free frames taken from the cache of another core";
+        case sm_stat_id::bf_freelist_spill: return "Batches of free frames moved from a per-core cache to the global freelist";
+        case sm_stat_id::bf_prefetch_requested: return "Pages requested for asynchronous read-ahead";
+        case sm_stat_id::bf_prefetch_dropped: return "Read-ahead requests dropped because the queue was full";
+        case sm_stat_id::bf_prefetch_read: return "Pages read into the buffer pool by read-ahead";
+        case sm_stat_id::bf_prefetch_hit: return "Read-ahead pages fixed before being evicted";
+        case sm_stat_id::bf_prefetch_waste: return "Read-ahead pages evicted without being fixed";
+        case sm_stat_id::vol_aio_requests: return "Volume I/O requests submitted to io_uring";
+        case sm_stat_id::vol_aio_fixed_requests: return "io_uring requests on registered (fixed) buffers";
+        case sm_stat_id::vol_aio_ring_full: return "Times a submitter waited for a full io_uring";
+        case sm_stat_id::bf_snapshot_pages_saved: return "Pages written to the buffer pool snapshot on shutdown";
+        case sm_stat_id::bf_snapshot_pages_loaded: return "Pages read from the buffer pool snapshot on startup";
+        case sm_stat_id::bf_snapshot_inner_fixed: return "Inner nodes re-fixed (and swizzled) after loading the snapshot";
+        case sm_stat_id::bt_optimistic_traverse_cnt: return "B-tree traversals that reached the leaf without latching inner nodes";
+        case sm_stat_id::bt_optimistic_fallback_cnt: return "Optimistic B-tree traversals that fell back to latch coupling";
+        case sm_stat_id::bt_optimistic_restart_cnt: return "Optimistic B-tree traversals restarted from the root due to a conflicting writer";
+        case sm_stat_id::bt_full_key_compares: return "Key comparisons in B-tree page searches not decided by poor man's normalized keys";
+        case sm_stat_id::bt_batch_key_cnt: return "Keys looked up or inserted by batched B-tree operations";
+        case sm_stat_id::bt_batch_leaf_reuse_cnt: return "Keys of B-tree batches served from the leaf of the previous key without traversal";
+        case sm_stat_id::bt_batch_prefetch_cnt: return "Leaf pages prefetched for upcoming keys of B-tree batches";
+        case sm_stat_id::bt_cursor_batch_cnt: return "Batches of records returned by B-tree cursors (next_batch())";
+        case sm_stat_id::bt_cursor_foster_moves: return "B-tree cursor moves to a neighboring leaf along a foster relationship instead of a traversal";
+        case sm_stat_id::bt_maint_rounds: return "Rounds of the background B-tree maintenance";
+        case sm_stat_id::bt_maint_pages_visited: return "B-tree pages checked by the background maintenance";
+        case sm_stat_id::bt_maint_adopts: return "Foster children adopted (or root growths) by the background B-tree maintenance";
+        case sm_stat_id::bt_maint_merges: return "Underfull B-tree leaves merged into their left neighbor by the background maintenance";
+        case sm_stat_id::bt_maint_defrags: return "B-tree leaves defragmented by the background maintenance";
+        case sm_stat_id::bt_maint_ghosts_reclaimed: return "Ghost records reclaimed by the background B-tree maintenance";
+        case sm_stat_id::bt_maint_budget_exhausted: return "B-tree maintenance walks stopped because their I/O budget ran out";
     }
     return "UNKNOWN_STAT";
 }
@@ -221,6 +221,10 @@ enum class sm_stat_id : size_t
     log_chkpt_wake,
     log_fetches,
     log_inserts,
+    log_private_chunks,
+    log_private_fill_bytes,
+    log_private_reordered,
+    log_private_buffers,
     log_buffer_hit,
     log_full,
     log_full_old_xct,
@@ -237,6 +241,16 @@ enum class sm_stat_id : size_t
     log_flush_wait,
     log_short_flush,
     log_long_flush,
+    log_gc_holds,
+    log_gc_hold_us,
+    log_gc_flush_us,
+    log_gc_batch_0,
+    log_gc_batch_1,
+    log_gc_batch_2_7,
+    log_gc_batch_8_31,
+    log_gc_batch_32_up,
+    log_durable_callbacks,
+    log_durable_dispatches,
     lock_deadlock_cnt,
     lock_false_deadlock_cnt,
     lock_dld_call_cnt,
@@ -258,9 +272,13 @@ enum class sm_stat_id : size_t
     bt_posc,
     bt_scan_cnt,
     bt_splits,
+    bt_edge_splits,
     bt_cuts,
     bt_grows,
     bt_shrinks,
+    bt_bulkload_pages,
+    bt_value_bytes,
+    bt_value_bytes_stored,
     bt_links,
     bt_upgrade_fail_retry,
     bt_clr_smo_traverse,
@@ -285,6 +303,7 @@ enum class sm_stat_id : size_t
     xct_log_flush,
     begin_xct_cnt,
     commit_xct_cnt,
+    commit_xct_async_cnt,
     abort_xct_cnt,
     log_warn_abort_cnt,
     prepare_xct_cnt,
@@ -359,6 +378,42 @@ enum class sm_stat_id : size_t
     backup_eviction_stuck,
     la_wasted_read,
     la_avoided_probes,
+    bf_evict_cold_victim,
+    bf_evict_hot_victim,
+    bf_evict_ghost_hit,
+    bf_evict_batches,
+    bf_evict_shared_parent_latch,
+    bf_freelist_contention,
+    bf_freelist_refill,
+    bf_freelist_steal,
+    bf_freelist_spill,
+    bf_prefetch_requested,
+    bf_prefetch_dropped,
+    bf_prefetch_read,
+    bf_prefetch_hit,
+    bf_prefetch_waste,
+    vol_aio_requests,
+    vol_aio_fixed_requests,
+    vol_aio_ring_full,
+    bf_snapshot_pages_saved,
+    bf_snapshot_pages_loaded,
+    bf_snapshot_inner_fixed,
+    bt_optimistic_traverse_cnt,
+    bt_optimistic_fallback_cnt,
+    bt_optimistic_restart_cnt,
+    bt_full_key_compares,
+    bt_batch_key_cnt,
+    bt_batch_leaf_reuse_cnt,
+    bt_batch_prefetch_cnt,
+    bt_cursor_batch_cnt,
+    bt_cursor_foster_moves,
+    bt_maint_rounds,
+    bt_maint_pages_visited,
+    bt_maint_adopts,
+    bt_maint_merges,
+    bt_maint_defrags,
+    bt_maint_ghosts_reclaimed,
+    bt_maint_budget_exhausted,
     stat_max // Leave this one here to count the number of stats!
 };
 
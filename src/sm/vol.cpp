@@ -13,6 +13,7 @@
 #include "sm_base.h"
 #include "stnode_page.h"
 #include "vol.h"
+#include "vol_aio.h"
 #include "log_core.h"
 #include "sm_options.h"
 
@@ -27,6 +28,7 @@
 #include <sys/stat.h>
 #include <sys/uio.h>
 #include <fcntl.h>
+#include <atomic>
 
 #include "sm.h"
 
@@ -67,6 +69,12 @@ vol_t::vol_t(const sm_options& options)
     _prioritize_archive =
         options.get_bool_option("sm_recovery_prioritize_archive", false);
     _cluster_stores = options.get_bool_option("sm_vol_cluster_stores", true);
+    _use_io_uring = options.get_bool_option("sm_vol_io_uring", false);
+    _aio_depth = std::max<int64_t>(1,
+            options.get_int_option("sm_vol_aio_depth", 64));
+
+    static std::atomic<uint64_t> generation {0};
+    _aio_generation = ++generation;
 
     _no_db_mode = options.get_bool_option("sm_no_db", false);
     if (_no_db_mode) {
@@ -310,6 +318,77 @@ rc_t vol_t::read_page(PageID pnum, generic_page* const buf)
     return read_many_pages(pnum, buf, 1);
 }
 
+vol_aio_ring* vol_t::get_aio_ring()
+{
+    if (!_use_io_uring) { return nullptr; }
+
+    static thread_local std::unique_ptr<vol_aio_ring> ring;
+    static thread_local uint64_t ring_generation = 0;
+    if (ring_generation != _aio_generation) {
+        // Previous ring may have buffers of a destroyed instance registered
+        ring.reset(new vol_aio_ring(_aio_depth));
+        ring_generation = _aio_generation;
+        if (!ring->is_valid()) {
+            ERROUT(<< "io_uring not available -- using synchronous I/O");
+        }
+    }
+    return ring->is_valid() ? ring.get() : nullptr;
+}
+
+bool vol_t::register_aio_buffers(const void* base, size_t len)
+{
+    auto ring = get_aio_ring();
+    return ring && ring->register_buffers(base, len);
+}
+
+rc_t vol_t::submit_write(PageID first_page, const generic_page* buf, int cnt)
+{
+    auto ring = get_aio_ring();
+    if (!ring) { return write_many_pages(first_page, buf, cnt); }
+    if (_readonly) { return RCOK; }
+
+    w_assert1(cnt > 0);
+    size_t offset = size_t(first_page) * sizeof(generic_page);
+    ring->submit(_fd, true, const_cast<generic_page*>(buf),
+            sizeof(generic_page) * cnt, offset);
+
+    ADD_TSTAT(vol_blks_written, cnt);
+    INC_TSTAT(vol_writes);
+    return RCOK;
+}
+
+rc_t vol_t::submit_read(PageID first_page, generic_page* buf, int cnt)
+{
+    auto ring = get_aio_ring();
+    if (!ring) { return read_many_pages(first_page, buf, cnt); }
+
+    DBG(<< "Page read: from " << first_page << " to " << first_page + cnt);
+    ADD_TSTAT(vol_reads, cnt);
+
+    w_assert1(cnt > 0);
+    size_t offset = size_t(first_page) * sizeof(generic_page);
+    // Pages past the end of the file read as zeroes, as in read_many_pages
+    memset(buf, '\0', cnt * sizeof(generic_page));
+    ring->submit(_fd, false, buf, sizeof(generic_page) * cnt, offset);
+
+    if (_log_page_reads) {
+        Logger::log_sys<page_read_log>(first_page, cnt);
+    }
+
+    return RCOK;
+}
+
+void vol_t::wait_aio()
+{
+    auto ring = get_aio_ring();
+    if (!ring) { return; }
+
+    long start = 0;
+    if(_apply_fake_disk_latency) start = gethrtime();
+    ring->wait_all();
+    fake_disk_latency(start);
+}
+
 void vol_t::read_vector(PageID first_pid, unsigned count,
         std::vector<generic_page*>& frames, bool from_backup)
 {
@@ -319,14 +398,29 @@ void vol_t::read_vector(PageID first_pid, unsigned count,
 
     // Backup reads must guarantee that unallocated pages are zeroed out
     // (see comment in read_backup)
-    auto backup_pages = _backup_alloc_cache->get_end_pid();
-    if (from_backup && first_pid >= backup_pages) {
+    // (no backup alloc cache unless reading from a backup)
+    if (from_backup && first_pid >= _backup_alloc_cache->get_end_pid()) {
         for (size_t i = 0; i < count; i++) {
             memset(frames[i], 0, sizeof(generic_page));
         }
         return;
     }
 
+    size_t offset = size_t(first_pid) * sizeof(generic_page);
+    auto fd = from_backup ? _backup_fd : _fd;
+
+    // Frames are scattered in the buffer pool, but a ring still saves on
+    // system calls because all requests are submitted at once
+    auto ring = from_backup ? nullptr : get_aio_ring();
+    if (ring) {
+        for (unsigned i = 0; i < count; i++) {
+            ring->submit(fd, false, frames[i], sizeof(generic_page),
+                    offset + i * sizeof(generic_page));
+        }
+        ring->wait_all();
+        return;
+    }
+
     static thread_local std::vector<struct iovec> iov;
     iov.resize(count);
     for (unsigned i = 0; i < count; i++) {
@@ -334,8 +428,6 @@ void vol_t::read_vector(PageID first_pid, unsigned count,
         iov[i].iov_len = sizeof(generic_page);
     }
 
-    size_t offset = size_t(first_pid) * sizeof(generic_page);
-    auto fd = from_backup ? _backup_fd : _fd;
     int read_count = preadv(fd, &iov[0], count, offset);
     CHECK_ERRNO(read_count);
 
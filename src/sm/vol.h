@@ -16,6 +16,7 @@ class alloc_cache_t;
 class stnode_cache_t;
 class sm_options;
 class chkpt_t;
+class vol_aio_ring;
 
 class vol_t
 {
@@ -57,6 +58,26 @@ public:
         generic_page* const buf,        //caller must align this buffer
         int                 cnt);
 
+    /**
+     * Asynchronous variants of write_many_pages() and read_many_pages(). If
+     * io_uring is enabled (option sm_vol_io_uring), the request is queued on
+     * a ring owned by the calling thread and the buffer must not be touched
+     * until wait_aio() returns. Otherwise, the I/O is performed synchronously.
+     */
+    rc_t submit_write(PageID first_page, const generic_page* buf, int cnt);
+    rc_t submit_read(PageID first_page, generic_page* buf, int cnt);
+
+    /** Waits for all requests submitted by the calling thread. */
+    void wait_aio();
+
+    /**
+     * Registers a buffer that will be used for submit_write() and
+     * submit_read() by the calling thread, so that the kernel does not map its
+     * pages on each request. Returns whether requests on the buffer use
+     * fixed-buffer I/O, i.e., false if io_uring is disabled.
+     */
+    bool register_aio_buffers(const void* base, size_t len);
+
     void read_backup(PageID first, size_t count, void* buf);
     rc_t write_backup(PageID first, size_t count, void* buf);
 
@@ -174,6 +195,20 @@ private:
     /** Whether to cluster pages of the same store in extents */
     bool _cluster_stores;
 
+    /** Whether to use io_uring for submit_write() and submit_read() */
+    bool _use_io_uring;
+
+    /** Number of entries of the per-thread io_uring instances */
+    unsigned _aio_depth;
+
+    /** Identifies this volume instance, so that per-thread rings (and their
+     * registered buffers) are not reused across restarts */
+    uint64_t _aio_generation;
+
+    /** Returns the ring of the calling thread, or null if io_uring is
+     * disabled or not supported */
+    vol_aio_ring* get_aio_ring();
+
 };
 
 inline bool vol_t::is_valid_store(StoreID f) const
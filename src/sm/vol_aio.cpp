@@ -0,0 +1,341 @@
+#include "vol_aio.h"
+
+#include "w_base.h"
+#include "sm_base.h"
+#include "smthread.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#endif
+
+#define CHECK_ERRNO(n) \
+    if (n == -1) { \
+        W_FATAL_MSG(fcOS, << "Kernel errno code: " << errno); \
+    }
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+constexpr size_t vol_aio_ring::MAX_CHUNK;
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params* p)
+{
+    return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+        unsigned flags)
+{
+    return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+            flags, NULL, 0);
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, const void* arg,
+        unsigned nr_args)
+{
+    return (int) syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+vol_aio_ring::vol_aio_ring(unsigned depth)
+    : _ring_fd(-1), _depth(depth),
+    _sq_ptr(MAP_FAILED), _sq_size(0), _sqes(MAP_FAILED), _sqes_size(0),
+    _cq_ptr(MAP_FAILED), _cq_size(0), _unsubmitted(0)
+{
+    struct io_uring_params p;
+    ::memset(&p, 0, sizeof(p));
+    int fd = sys_io_uring_setup(depth, &p);
+    if (fd < 0) {
+        // Not supported by the kernel (or forbidden, e.g., by seccomp)
+        return;
+    }
+    _ring_fd = fd;
+    // Kernel rounds up to a power of two
+    _depth = p.sq_entries;
+
+    _sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    _cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        _sq_size = _cq_size = std::max(_sq_size, _cq_size);
+    }
+
+    _sq_ptr = ::mmap(NULL, _sq_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (_sq_ptr == MAP_FAILED) { teardown(); return; }
+
+    if (single_mmap) {
+        _cq_ptr = _sq_ptr;
+    }
+    else {
+        _cq_ptr = ::mmap(NULL, _cq_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (_cq_ptr == MAP_FAILED) { teardown(); return; }
+    }
+
+    _sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    _sqes = ::mmap(NULL, _sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (_sqes == MAP_FAILED) { teardown(); return; }
+
+    char* sq = reinterpret_cast<char*>(_sq_ptr);
+    _sq_head = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    _sq_mask = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    _sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+
+    char* cq = reinterpret_cast<char*>(_cq_ptr);
+    _cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    _cq_mask = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    _cqes = cq + p.cq_off.cqes;
+
+    _requests.resize(_depth);
+    _free_slots.reserve(_depth);
+    for (unsigned i = 0; i < _depth; i++) { _free_slots.push_back(_depth - 1 - i); }
+}
+
+vol_aio_ring::~vol_aio_ring()
+{
+    if (is_valid()) { wait_all(); }
+    teardown();
+}
+
+void vol_aio_ring::teardown()
+{
+    if (_sqes != MAP_FAILED) { ::munmap(_sqes, _sqes_size); }
+    if (_cq_ptr != MAP_FAILED && _cq_ptr != _sq_ptr) { ::munmap(_cq_ptr, _cq_size); }
+    if (_sq_ptr != MAP_FAILED) { ::munmap(_sq_ptr, _sq_size); }
+    _sqes = _cq_ptr = _sq_ptr = MAP_FAILED;
+    if (_ring_fd >= 0) {
+        // closing the ring also unregisters the buffers
+        ::close(_ring_fd);
+        _ring_fd = -1;
+    }
+}
+
+int vol_aio_ring::find_fixed_buffer(const char* buf, size_t len) const
+{
+    for (auto& r : _regions) {
+        if (!r.registered || buf < r.base || buf + len > r.base + r.len) { continue; }
+        size_t offset = buf - r.base;
+        // Request must not cross a chunk boundary
+        if (offset / MAX_CHUNK != (offset + len - 1) / MAX_CHUNK) { return -1; }
+        return r.first_index + offset / MAX_CHUNK;
+    }
+    return -1;
+}
+
+bool vol_aio_ring::register_buffers(const void* base, size_t len)
+{
+    if (!is_valid()) { return false; }
+    const char* b = reinterpret_cast<const char*>(base);
+    for (auto& r : _regions) {
+        if (r.base == b && r.len == len) { return r.registered; }
+    }
+
+    // Buffers can only be registered all at once, so the previous ones must
+    // be unregistered first, which requires no fixed-buffer I/O in flight
+    wait_all();
+    bool had_registered = false;
+    for (auto& r : _regions) { had_registered |= r.registered; }
+    if (had_registered) {
+        sys_io_uring_register(_ring_fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+    }
+
+    _regions.push_back(region {b, len, 0, true});
+
+    std::vector<struct iovec> iovs;
+    for (auto& r : _regions) {
+        if (!r.registered) { continue; }
+        r.first_index = iovs.size();
+        for (size_t off = 0; off < r.len; off += MAX_CHUNK) {
+            struct iovec iov;
+            iov.iov_base = const_cast<char*>(r.base) + off;
+            iov.iov_len = std::min(MAX_CHUNK, r.len - off);
+            iovs.push_back(iov);
+        }
+    }
+
+    int ret = sys_io_uring_register(_ring_fd, IORING_REGISTER_BUFFERS,
+            iovs.data(), iovs.size());
+    if (ret < 0) {
+        // Most likely RLIMIT_MEMLOCK -- use regular I/O on the new region and
+        // restore the registration of the previous ones
+        _regions.back().registered = false;
+        if (had_registered) {
+            iovs.clear();
+            for (auto& r : _regions) {
+                if (!r.registered) { continue; }
+                r.first_index = iovs.size();
+                for (size_t off = 0; off < r.len; off += MAX_CHUNK) {
+                    struct iovec iov;
+                    iov.iov_base = const_cast<char*>(r.base) + off;
+                    iov.iov_len = std::min(MAX_CHUNK, r.len - off);
+                    iovs.push_back(iov);
+                }
+            }
+            ret = sys_io_uring_register(_ring_fd, IORING_REGISTER_BUFFERS,
+                    iovs.data(), iovs.size());
+            if (ret < 0) {
+                for (auto& r : _regions) { r.registered = false; }
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+void vol_aio_ring::submit(int fd, bool write, void* buf, size_t len, off_t offset)
+{
+    w_assert1(is_valid());
+
+    if (_free_slots.empty()) {
+        INC_TSTAT(vol_aio_ring_full);
+        reap(1);
+    }
+    unsigned slot = _free_slots.back();
+    _free_slots.pop_back();
+
+    request& r = _requests[slot];
+    r.fd = fd;
+    r.write = write;
+    r.buf = reinterpret_cast<char*>(buf);
+    r.len = len;
+    r.offset = offset;
+    r.iov.iov_base = buf;
+    r.iov.iov_len = len;
+
+    // At most _depth requests are in flight, so there is always a free entry
+    unsigned tail = *_sq_tail;
+    unsigned index = tail & *_sq_mask;
+    struct io_uring_sqe* sqe = reinterpret_cast<struct io_uring_sqe*>(_sqes) + index;
+    ::memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->user_data = slot;
+
+    int buf_index = find_fixed_buffer(r.buf, len);
+    if (buf_index >= 0) {
+        sqe->opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe->addr = reinterpret_cast<uint64_t>(buf);
+        sqe->len = len;
+        sqe->buf_index = buf_index;
+        INC_TSTAT(vol_aio_fixed_requests);
+    }
+    else {
+        sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe->addr = reinterpret_cast<uint64_t>(&r.iov);
+        sqe->len = 1;
+    }
+
+    _sq_array[index] = index;
+    __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+    _unsubmitted++;
+    INC_TSTAT(vol_aio_requests);
+
+    // Hand over to the kernel once the ring is full
+    if (_free_slots.empty()) { enter(0); }
+}
+
+void vol_aio_ring::enter(unsigned min_complete)
+{
+    unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    while (_unsubmitted > 0 || min_complete > 0) {
+        int ret = sys_io_uring_enter(_ring_fd, _unsubmitted, min_complete, flags);
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) { continue; }
+            CHECK_ERRNO(ret);
+        }
+        w_assert1((unsigned) ret <= _unsubmitted);
+        _unsubmitted -= ret;
+        // GETEVENTS waited for completions even if not all entries were consumed
+        min_complete = 0;
+        flags = 0;
+    }
+}
+
+void vol_aio_ring::complete_sync(request& r, size_t done)
+{
+    while (done < r.len) {
+        ssize_t ret = r.write ?
+            ::pwrite(r.fd, r.buf + done, r.len - done, r.offset + done) :
+            ::pread(r.fd, r.buf + done, r.len - done, r.offset + done);
+        CHECK_ERRNO(ret);
+        // reading past the end of the file
+        if (ret == 0) { break; }
+        done += ret;
+    }
+}
+
+void vol_aio_ring::reap(unsigned min_complete)
+{
+    if (_unsubmitted > 0 || min_complete > 0) { enter(min_complete); }
+
+    unsigned head = *_cq_head;
+    unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        struct io_uring_cqe* cqe =
+            reinterpret_cast<struct io_uring_cqe*>(_cqes) + (head & *_cq_mask);
+        unsigned slot = cqe->user_data;
+        int res = cqe->res;
+        head++;
+
+        request& r = _requests[slot];
+        if (res < 0) {
+            if (res != -EAGAIN && res != -EINTR) {
+                errno = -res;
+                CHECK_ERRNO(-1);
+            }
+            complete_sync(r, 0);
+        }
+        else if ((size_t) res < r.len) {
+            complete_sync(r, res);
+        }
+        _free_slots.push_back(slot);
+    }
+    __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+}
+
+void vol_aio_ring::wait_all()
+{
+    while (in_flight() > 0) {
+        reap(1);
+    }
+}
+
+#else // !HAVE_LINUX_IO_URING_H
+
+vol_aio_ring::vol_aio_ring(unsigned depth)
+    : _ring_fd(-1), _depth(depth), _unsubmitted(0)
+{
+}
+
+vol_aio_ring::~vol_aio_ring()
+{
+}
+
+void vol_aio_ring::teardown() {}
+
+int vol_aio_ring::find_fixed_buffer(const char*, size_t) const { return -1; }
+
+bool vol_aio_ring::register_buffers(const void*, size_t) { return false; }
+
+void vol_aio_ring::submit(int, bool, void*, size_t, off_t)
+{
+    W_FATAL_MSG(fcINTERNAL, << "io_uring not supported");
+}
+
+void vol_aio_ring::enter(unsigned) {}
+
+void vol_aio_ring::complete_sync(request&, size_t) {}
+
+void vol_aio_ring::reap(unsigned) {}
+
+void vol_aio_ring::wait_all() {}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef VOL_AIO_H
+#define VOL_AIO_H
+
+#include "w_defines.h"
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <vector>
+
+/**
+ * \brief Asynchronous I/O on the volume file with Linux io_uring.
+ * \details
+ * A ring is owned by a single thread (see vol_t::submit_write()), so no
+ * synchronization is required. Requests are queued with submit(), which only
+ * blocks if all entries of the ring are in flight, and are handed to the
+ * kernel in batches, i.e., when the ring is full or when wait_all() is
+ * called. Memory regions registered with register_buffers() -- e.g., the
+ * workspace of a page cleaner or the frames of the buffer pool -- are accessed
+ * with fixed-buffer operations, which saves the kernel from mapping the user
+ * pages on every request.
+ *
+ * The ring is set up with raw system calls, so liburing is not required. If
+ * the kernel headers lack io_uring or the kernel refuses to set up a ring,
+ * is_valid() returns false and vol_t falls back to synchronous I/O.
+ */
+class vol_aio_ring {
+public:
+    vol_aio_ring(unsigned depth);
+    ~vol_aio_ring();
+
+    bool is_valid() const { return _ring_fd >= 0; }
+
+    /** Queues a read (or write) of len bytes at the given offset of fd. */
+    void submit(int fd, bool write, void* buf, size_t len, off_t offset);
+
+    /** Waits until all submitted requests are completed. */
+    void wait_all();
+
+    /**
+     * Registers a memory region for fixed-buffer I/O. Regions that are already
+     * registered are ignored. Returns false if the kernel refused (e.g., due
+     * to RLIMIT_MEMLOCK), in which case requests on it use regular I/O.
+     */
+    bool register_buffers(const void* base, size_t len);
+
+    size_t in_flight() const { return _depth - _free_slots.size(); }
+
+private:
+    struct request {
+        int fd;
+        bool write;
+        char* buf;
+        size_t len;
+        off_t offset;
+        struct iovec iov;
+    };
+
+    struct region {
+        const char* base;
+        size_t len;
+        /** index of first registered iovec; regions are split in chunks of MAX_CHUNK */
+        unsigned first_index;
+        bool registered;
+    };
+
+    /** Largest buffer accepted by IORING_REGISTER_BUFFERS */
+    static constexpr size_t MAX_CHUNK = 1UL << 30;
+
+    int _ring_fd;
+    unsigned _depth;
+
+    // Submission queue
+    void* _sq_ptr;
+    size_t _sq_size;
+    unsigned* _sq_head;
+    unsigned* _sq_tail;
+    unsigned* _sq_mask;
+    unsigned* _sq_array;
+    void* _sqes;
+    size_t _sqes_size;
+
+    // Completion queue
+    void* _cq_ptr;
+    size_t _cq_size;
+    unsigned* _cq_head;
+    unsigned* _cq_tail;
+    unsigned* _cq_mask;
+    void* _cqes;
+
+    /** Requests in flight, indexed by the user_data of their entries */
+    std::vector<request> _requests;
+    std::vector<unsigned> _free_slots;
+    unsigned _unsubmitted;
+
+    std::vector<region> _regions;
+
+    /** Enters the kernel to submit queued entries and wait for min_complete */
+    void enter(unsigned min_complete);
+
+    /** Reaps available completions; waits for at least min_complete */
+    void reap(unsigned min_complete);
+
+    /** Re-issues a failed or short request synchronously */
+    void complete_sync(request& r, size_t done);
+
+    /** Returns the registered buffer index for [buf, buf+len), or -1 */
+    int find_fixed_buffer(const char* buf, size_t len) const;
+
+    void teardown();
+};
+
+#endif
@@ -590,6 +590,13 @@ xct_t::commit(bool lazy,lsn_t* plastlsn)
     return _commit(t_normal | (lazy ? t_lazy : t_normal), plastlsn);
 }
 
+rc_t
+xct_t::commit_async(durability_callback_t callback, lsn_t* plastlsn)
+{
+    w_assert1(callback);
+    return _commit(t_normal | t_async, plastlsn, std::move(callback));
+}
+
 rc_t
 xct_t::commit_as_group_member()
 {
@@ -922,6 +929,8 @@ xct_t::_pre_commit(uint32_t flags)
  *  xct_t::commit(flags)
  *
  *  Commit the transaction. If flag t_lazy, log is not synced.
+ *  If flag t_async, log is not synced either, but the given callback
+ *  is invoked once the commit is durable.
  *  If flag t_chain, a new transaction is instantiated inside
  *  this one, and inherits all its locks.
  *
@@ -930,7 +939,8 @@ xct_t::_pre_commit(uint32_t flags)
  *
  *********************************************************************/
 rc_t
-xct_t::_commit(uint32_t flags, lsn_t* plastlsn /* default NULL*/)
+xct_t::_commit(uint32_t flags, lsn_t* plastlsn /* default NULL*/,
+        durability_callback_t callback)
 {
     // when chaining, we inherit the read_watermark from the previous xct
     // in case the next transaction are read-only.
@@ -940,10 +950,19 @@ xct_t::_commit(uint32_t flags, lsn_t* plastlsn /* default NULL*/)
     static thread_local unsigned long _accum_latency = 0;
     static thread_local unsigned int _latency_count = 0;
 
+    // asynchronous commits cannot be chained or grouped
+    w_assert1(!(flags & xct_t::t_async) || !(flags & (xct_t::t_chain | xct_t::t_group)));
+    // LSN an asynchronous commit has to wait for
+    lsn_t async_lsn = lsn_t::null;
+
     W_DO(_pre_commit(flags));
 
     if (_last_lsn.valid() || !smlevel_0::log)  {
-        if (!(flags & xct_t::t_lazy))  {
+        if (flags & xct_t::t_async)  {
+            // the caller learns from the callback when the commit is durable
+            async_lsn = _last_lsn;
+        }
+        else if (!(flags & xct_t::t_lazy))  {
             _sync_logbuf();
         }
         else { // IP: If lazy, wake up the flusher but do not block
@@ -967,6 +986,11 @@ xct_t::_commit(uint32_t flags, lsn_t* plastlsn /* default NULL*/)
         }
     }  else  {
         W_DO(_commit_read_only(flags, inherited_read_watermark));
+        if (flags & xct_t::t_async)  {
+            // nothing logged, but we may have read updates of other
+            // asynchronous commits which are not durable yet
+            async_lsn = log->curr_lsn();
+        }
     }
 
     INC_TSTAT(commit_xct_cnt);
@@ -1021,6 +1045,16 @@ xct_t::_commit(uint32_t flags, lsn_t* plastlsn /* default NULL*/)
         _latency_count = 0;
     }
 
+    if (flags & xct_t::t_async)  {
+        INC_TSTAT(commit_xct_async_cnt);
+        if (smlevel_0::log && async_lsn.valid())  {
+            smlevel_0::log->on_durable(async_lsn, std::move(callback));
+        }
+        else  {
+            callback(async_lsn);
+        }
+    }
+
     return RCOK;
 }
 
@@ -230,7 +230,7 @@ protected:
     xct_core* _core;
 
 protected:
-    enum commit_t { t_normal = 0, t_lazy = 1, t_chain = 2, t_group = 4 };
+    enum commit_t { t_normal = 0, t_lazy = 1, t_chain = 2, t_group = 4, t_async = 8 };
 
     enum loser_xct_state_t {
                  loser_false = 0x0,      // Not a loser transaction
@@ -299,6 +299,12 @@ public:
                                 }
     const sm_stats_t&      const_stats_ref() { return *__stats; }
     rc_t                        commit(bool lazy = false, lsn_t* plastlsn=NULL);
+    /**
+     * Commits without waiting for the commit log record to become durable;
+     * the callback is invoked once it is (see ss_m::commit_xct_async()).
+     */
+    rc_t                        commit_async(durability_callback_t callback,
+                                             lsn_t* plastlsn=NULL);
     rc_t                        commit_as_group_member();
     rc_t                        rollback(const lsn_t &save_pt);
     rc_t                        save_point(lsn_t& lsn);
@@ -503,7 +509,9 @@ private:
 protected:
     rc_t                _abort();
     rc_t                _commit(uint32_t flags,
-                                                 lsn_t* plastlsn=NULL);
+                                                 lsn_t* plastlsn=NULL,
+                                                 durability_callback_t callback
+                                                     = durability_callback_t());
     // CS: decoupled from _commit to allow reuse in plog_xct_t
     rc_t _commit_read_only(uint32_t flags, lsn_t& inherited_read_watermark);
     rc_t _pre_commit(uint32_t flags);
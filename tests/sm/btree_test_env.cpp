@@ -377,18 +377,10 @@ int btree_test_env::runBtreeTest (w_rc_t (*func)(ss_m*, test_volume_t*),
         testdriver_thread_t smtu(&functor, this, options);
 
         /* cause the thread's run() method to start */
-        w_rc_t e = smtu.fork();
-        if(e.is_error()) {
-            cerr << "Error forking thread: " << e <<endl;
-            return 1;
-        }
+        smtu.fork();
 
         /* wait for the thread's run() method to end */
-        e = smtu.join();
-        if(e.is_error()) {
-            cerr << "Error joining thread: " << e <<endl;
-            return 1;
-        }
+        smtu.join();
 
         rv = smtu.return_value();
     }
@@ -451,25 +443,14 @@ int btree_test_env::runRestartTest (restart_test_base *context, restart_test_opt
 
     DBGOUT2 ( << "Going to call pre_shutdown()...");
     int rv;
-    w_rc_t e;
         {
         if (restart_options->shutdown_mode == simulated_crash)
             {
             // Simulated crash
             restart_dirty_test_pre_functor functor(context);
             testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);  // User specified restart mode
-            e = smtu.fork();
-            if(e.is_error())
-                {
-                cerr << "Error forking thread while pre_shutdown: " << e <<endl;
-                return 1;
-                }
-            e = smtu.join();
-            if(e.is_error())
-                {
-                cerr << "Error joining thread while pre_shutdown: " << e <<endl;
-                return 1;
-                }
+            smtu.fork();
+            smtu.join();
 
             rv = smtu.return_value();
             if (rv != 0)
@@ -483,18 +464,8 @@ int btree_test_env::runRestartTest (restart_test_base *context, restart_test_opt
             // Clean shutdown
             restart_clean_test_pre_functor functor(context);
             testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);  // User specified restart mode
-            e = smtu.fork();
-            if(e.is_error())
-                {
-                cerr << "Error forking thread while pre_shutdown: " << e <<endl;
-                return 1;
-                }
-            e = smtu.join();
-            if(e.is_error())
-                {
-                cerr << "Error joining thread while pre_shutdown: " << e <<endl;
-                return 1;
-                }
+            smtu.fork();
+            smtu.join();
 
             rv = smtu.return_value();
             if (rv != 0)
@@ -510,19 +481,9 @@ int btree_test_env::runRestartTest (restart_test_base *context, restart_test_opt
         restart_test_post_functor functor(context);
         testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);   // User specified restart mode
 
-        w_rc_t e = smtu.fork();
-        if(e.is_error())
-            {
-            cerr << "Error forking thread while post_shutdown: " << e <<endl;
-            return 1;
-            }
+        smtu.fork();
 
-        e = smtu.join();
-        if(e.is_error())
-            {
-            cerr << "Error joining thread while post_shutdown: " << e <<endl;
-            return 1;
-            }
+        smtu.join();
 
         rv = smtu.return_value();
         }
@@ -585,17 +546,9 @@ int btree_test_env::runCrashTest (crash_test_base *context, bool use_locks, cons
         crash_test_pre_functor functor(context);
         testdriver_thread_t smtu(&functor, this,  options);  // Use serial restart mode
 
-        w_rc_t e = smtu.fork();
-        if(e.is_error()) {
-            cerr << "Error forking thread while pre_crash: " << e <<endl;
-            return 1;
-        }
+        smtu.fork();
 
-        e = smtu.join();
-        if(e.is_error()) {
-            cerr << "Error joining thread while pre_crash: " << e <<endl;
-            return 1;
-        }
+        smtu.join();
 
         rv = smtu.return_value();
         if (rv != 0) {
@@ -608,17 +561,9 @@ int btree_test_env::runCrashTest (crash_test_base *context, bool use_locks, cons
         crash_test_post_functor functor(context);
         testdriver_thread_t smtu(&functor, this, options);  // Use serial restart mode
 
-        w_rc_t e = smtu.fork();
-        if(e.is_error()) {
-            cerr << "Error forking thread while post_crash: " << e <<endl;
-            return 1;
-        }
+        smtu.fork();
 
-        e = smtu.join();
-        if(e.is_error()) {
-            cerr << "Error joining thread while post_crash: " << e <<endl;
-            return 1;
-        }
+        smtu.join();
 
         rv = smtu.return_value();
     }
@@ -707,25 +652,14 @@ int btree_test_env::runRestartPerfTest (
     //                            performance measurement on 1000 successful user transactions, clean shutdown
 
     int rv;
-    w_rc_t e;
     DBGOUT2 ( << "Going to call initial_shutdown()...");
     {
         // Start from a new database and populate it
         // Only clean shutdown from this phase
         restart_performance_initial_functor functor(context);
         testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);  // User specified restart mode
-        e = smtu.fork();
-        if (e.is_error())
-        {
-            std::cerr << "Error forking thread while initial_shutdown: " << e << std::endl;
-            return 1;
-        }
-        e = smtu.join();
-        if (e.is_error())
-        {
-            std::cerr << "Error joining thread while initial_shutdown: " << e << std::endl;
-            return 1;
-        }
+        smtu.fork();
+        smtu.join();
 
         rv = smtu.return_value();
         if (rv != 0)
@@ -743,18 +677,8 @@ int btree_test_env::runRestartPerfTest (
             // Simulated crash
             restart_performance_dirty_pre_functor functor(context);
             testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);  // User specified restart mode
-            e = smtu.fork();
-            if (e.is_error())
-            {
-                std::cerr << "Error forking thread while pre_shutdown: " << e << std::endl;
-                return 1;
-            }
-            e = smtu.join();
-            if (e.is_error())
-            {
-                std::cerr << "Error joining thread while pre_shutdown: " << e << std::endl;
-                return 1;
-            }
+            smtu.fork();
+            smtu.join();
 
             rv = smtu.return_value();
             if (rv != 0)
@@ -769,18 +693,8 @@ int btree_test_env::runRestartPerfTest (
             // Clean shutdown
             restart_performance_clean_pre_functor functor(context);
             testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);  // User specified restart mode
-            e = smtu.fork();
-            if (e.is_error())
-            {
-                std::cerr << "Error forking thread while pre_shutdown: " << e << std::endl;
-                return 1;
-            }
-            e = smtu.join();
-            if (e.is_error())
-            {
-                std::cerr << "Error joining thread while pre_shutdown: " << e << std::endl;
-                return 1;
-            }
+            smtu.fork();
+            smtu.join();
 
             rv = smtu.return_value();
             if (rv != 0)
@@ -936,19 +850,9 @@ int btree_test_env::runRestartPerfTest (
         restart_performance_post_functor functor(context);
         testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);   // User specified restart mode
 
-        w_rc_t e = smtu.fork();
-        if (e.is_error())
-        {
-            std::cerr << "Error forking thread while post_shutdown: " << e << std::endl;
-            return 1;
-        }
+        smtu.fork();
 
-        e = smtu.join();
-        if (e.is_error())
-        {
-            std::cerr << "Error joining thread while post_shutdown: " << e << std::endl;
-            return 1;
-        }
+        smtu.join();
 
         rv = smtu.return_value();
     }
@@ -1035,25 +939,14 @@ int btree_test_env::runRestartPerfTestBefore (
     //                           caller specifies either clean or crash (in-flight transactions) shutdown
 
     int rv;
-    w_rc_t e;
     DBGOUT2 ( << "Going to call initial_shutdown()...");
     {
         // Start from a new database and populate it
         // Only clean shutdown from this phase
         restart_performance_initial_functor functor(context);
         testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);  // User specified restart mode
-        e = smtu.fork();
-        if (e.is_error())
-        {
-            std::cerr << "Error forking thread while initial_shutdown: " << e << std::endl;
-            return 1;
-        }
-        e = smtu.join();
-        if (e.is_error())
-        {
-            std::cerr << "Error joining thread while initial_shutdown: " << e << std::endl;
-            return 1;
-        }
+        smtu.fork();
+        smtu.join();
 
         rv = smtu.return_value();
         if (rv != 0)
@@ -1071,18 +964,8 @@ int btree_test_env::runRestartPerfTestBefore (
             // Simulated crash
             restart_performance_dirty_pre_functor functor(context);
             testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);  // User specified restart mode
-            e = smtu.fork();
-            if (e.is_error())
-            {
-                std::cerr << "Error forking thread while pre_shutdown: " << e << std::endl;
-                return 1;
-            }
-            e = smtu.join();
-            if (e.is_error())
-            {
-                std::cerr << "Error joining thread while pre_shutdown: " << e << std::endl;
-                return 1;
-            }
+            smtu.fork();
+            smtu.join();
 
             rv = smtu.return_value();
             if (rv != 0)
@@ -1097,18 +980,8 @@ int btree_test_env::runRestartPerfTestBefore (
             // Clean shutdown
             restart_performance_clean_pre_functor functor(context);
             testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);  // User specified restart mode
-            e = smtu.fork();
-            if (e.is_error())
-            {
-                std::cerr << "Error forking thread while pre_shutdown: " << e << std::endl;
-                return 1;
-            }
-            e = smtu.join();
-            if (e.is_error())
-            {
-                std::cerr << "Error joining thread while pre_shutdown: " << e << std::endl;
-                return 1;
-            }
+            smtu.fork();
+            smtu.join();
 
             rv = smtu.return_value();
             if (rv != 0)
@@ -1199,7 +1072,6 @@ int btree_test_env::runRestartPerfTestAfter (
     //                            performance measurement on 1000 successful user transactions, clean shutdown
 
     int rv;
-    w_rc_t e;
 
     DBGOUT2 ( << "Going to call post_shutdown()...");
     {
@@ -1232,19 +1104,9 @@ int btree_test_env::runRestartPerfTestAfter (
         testdriver_thread_t smtu(&functor, this, options, restart_options->restart_mode);   // User specified restart mode
 
         // Start the recovery
-        w_rc_t e = smtu.fork();
-        if (e.is_error())
-        {
-            std::cerr << "Error forking thread while post_shutdown: " << e << std::endl;
-            return 1;
-        }
+        smtu.fork();
 
-        e = smtu.join();
-        if (e.is_error())
-        {
-            std::cerr << "Error joining thread while post_shutdown: " << e << std::endl;
-            return 1;
-        }
+        smtu.join();
 
         rv = smtu.return_value();
     }
@@ -1262,10 +1124,11 @@ void btree_test_env::set_xct_query_lock() {
     }
 }
 
-w_rc_t x_btree_create_index(ss_m* ssm, test_volume_t *test_volume, StoreID &stid, PageID &root_pid)
+w_rc_t x_btree_create_index(ss_m* ssm, test_volume_t *test_volume, StoreID &stid, PageID &root_pid,
+                            int poor_key_width)
 {
     W_DO(ssm->begin_xct());
-    W_DO(ssm->create_index(stid));
+    W_DO(ssm->create_index(stid, poor_key_width));
     W_DO(ssm->open_store(stid, root_pid));
     W_DO(ssm->commit_xct());
     return RCOK;
@@ -49,7 +49,8 @@ enum test_txn_state_t {
 w_rc_t x_begin_xct(ss_m* ssm, bool use_locks);
 w_rc_t x_commit_xct(ss_m* ssm);
 w_rc_t x_abort_xct(ss_m* ssm);
-w_rc_t x_btree_create_index(ss_m* ssm, test_volume_t *test_volume, StoreID &stid, PageID &root_pid);
+w_rc_t x_btree_create_index(ss_m* ssm, test_volume_t *test_volume, StoreID &stid, PageID &root_pid,
+                            int poor_key_width = 2);
 w_rc_t x_btree_get_root_pid(ss_m* ssm, const StoreID &stid, PageID &root_pid);
 w_rc_t x_btree_adopt_foster_all(ss_m* ssm, const StoreID &stid);
 w_rc_t x_btree_verify(ss_m* ssm, const StoreID &stid);
@@ -0,0 +1,144 @@
+#include "btree_test_env.h"
+#include "generic_page.h"
+#include "btree.h"
+#include "btree_page_h.h"
+#include "w_error.h"
+
+#include "bf_tree_cb.h"
+#include "bf_tree.h"
+#include "sm_base.h"
+
+/**
+ * Testcases for the control-block layout of the buffer pool. The layout is
+ * chosen at compile time (CMake option BF_SPLIT_CB); the split layout is
+ * tested by test_bf_cb_layout_split, which builds this test with
+ * -DBF_SPLIT_CB=ON in a separate build tree.
+ */
+
+btree_test_env *test_env;
+
+/** Frames whose addresses are checked */
+const bf_idx CHECKED_FRAMES = 64;
+
+uintptr_t addr(const void* p) {
+    return reinterpret_cast<uintptr_t>(p);
+}
+
+/** Offset of a field from the start of its control block */
+size_t field_offset(const bf_tree_cb_t& cb, const void* field) {
+    return addr(field) - addr(&cb);
+}
+
+w_rc_t test_cb_layout(ss_m*, test_volume_t*) {
+    bf_tree_m& bf = *smlevel_0::bf;
+    EXPECT_GT(bf.get_block_cnt(), CHECKED_FRAMES + 1);
+
+#ifdef BF_SPLIT_CB
+    // four control blocks per cache line
+    EXPECT_EQ(16U, sizeof(bf_tree_cb_t));
+    EXPECT_EQ(CACHELINE_SIZE, sizeof(bf_tree_cb_cold_t));
+    EXPECT_EQ(0U, addr(bf.get_cbp(0)) % CACHELINE_SIZE);
+#else
+    EXPECT_EQ(CACHELINE_SIZE, sizeof(bf_tree_cb_t));
+#endif
+
+    for (bf_idx idx = 0; idx < CHECKED_FRAMES; ++idx) {
+        bf_tree_cb_t& cb = bf.get_cb(idx);
+        bf_tree_cb_t& next = bf.get_cb(idx + 1);
+        EXPECT_EQ(idx, bf.get_idx(&cb));
+
+        // fields touched by every fix share the control block
+        EXPECT_LT(field_offset(cb, &cb._pid), sizeof(bf_tree_cb_t));
+        EXPECT_LT(field_offset(cb, &cb._pin_cnt), sizeof(bf_tree_cb_t));
+        EXPECT_LT(field_offset(cb, &cb._ref_count), sizeof(bf_tree_cb_t));
+        EXPECT_LT(field_offset(cb, &cb._used), sizeof(bf_tree_cb_t));
+        EXPECT_LT(field_offset(cb, &cb._swizzled), sizeof(bf_tree_cb_t));
+        EXPECT_LT(field_offset(cb, &cb._check_recovery), sizeof(bf_tree_cb_t));
+
+        // a control block and its latch are never in the same 128B sector
+        latch_t* latch = cb.latchp();
+        EXPECT_EQ(0U, addr(latch) % CACHELINE_SIZE);
+        EXPECT_NE(addr(&cb) / (2 * CACHELINE_SIZE), addr(latch) / (2 * CACHELINE_SIZE));
+
+#ifdef BF_SPLIT_CB
+        // one array each for control blocks, cold fields, and latches
+        EXPECT_EQ(sizeof(bf_tree_cb_t), addr(&next) - addr(&cb));
+        EXPECT_EQ(sizeof(bf_tree_cb_cold_t), addr(&next.cold()) - addr(&cb.cold()));
+        EXPECT_EQ(sizeof(latch_t), addr(next.latchp()) - addr(latch));
+        EXPECT_EQ(0U, addr(&cb.cold()) % CACHELINE_SIZE);
+        EXPECT_TRUE(addr(&cb.cold()) < addr(bf.get_cbp(0))
+                || addr(&cb.cold()) >= addr(bf.get_cbp(bf.get_block_cnt())));
+#else
+        // |CB0|L0|L1|CB1|CB2|L2|L3|CB3|...
+        EXPECT_EQ(addr(&cb.cold()), addr(&cb));
+        if (idx % 2) {
+            EXPECT_EQ(CACHELINE_SIZE, addr(&next) - addr(&cb));
+            EXPECT_EQ(addr(&cb) - CACHELINE_SIZE, addr(latch));
+        } else {
+            EXPECT_EQ(3 * CACHELINE_SIZE, addr(&next) - addr(&cb));
+            EXPECT_EQ(addr(&cb) + CACHELINE_SIZE, addr(latch));
+        }
+#endif
+    }
+    return RCOK;
+}
+
+TEST (ControlBlockLayoutTest, Layout) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(test_cb_layout), 0);
+}
+
+/**
+ * The cold fields of each frame follow its page, whichever array they are in.
+ */
+w_rc_t test_cb_cold_fields(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    const int recsize = SM_PAGESIZE / 6;
+    char datastr[recsize + 1];
+    ::memset (datastr, 'a', recsize);
+    datastr[recsize] = '\0';
+    char keystr[7];
+    for (int i = 0; i < 200; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "k%05d", i);
+        W_DO(x_btree_insert_and_commit(ssm, stid, keystr, datastr));
+    }
+
+    bf_tree_m& bf = *smlevel_0::bf;
+    size_t checked = 0;
+    for (bf_idx idx = 1; idx < bf.get_block_cnt(); ++idx) {
+        bf_tree_cb_t& cb = bf.get_cb(idx);
+        // extra pin allows refix_direct without a parent
+        if (!cb.pin()) { continue; }
+        if (cb._used) {
+            generic_page* page;
+            W_DO(bf.refix_direct(page, idx, LATCH_SH, false));
+            EXPECT_EQ(cb._pid, page->pid);
+            EXPECT_EQ(cb.get_page_lsn(), page->lsn);
+            EXPECT_GE(cb.get_page_lsn(), cb.get_persisted_lsn());
+            bf.unfix(page);
+            checked++;
+        }
+        cb.unpin();
+    }
+    EXPECT_GT(checked, 20U);
+
+    W_DO(x_btree_verify(ssm, stid));
+    return RCOK;
+}
+
+TEST (ControlBlockLayoutTest, ColdFields) {
+    test_env->empty_logdata_dir();
+    sm_options options;
+    options.set_bool_option("sm_backgroundflush", false);
+    EXPECT_EQ(test_env->runBtreeTest(test_cb_cold_fields, false, options), 0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    test_env = new btree_test_env();
+    ::testing::AddGlobalTestEnvironment(test_env);
+    return RUN_ALL_TESTS();
+}
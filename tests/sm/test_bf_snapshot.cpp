@@ -0,0 +1,150 @@
+#include "btree_test_env.h"
+#include "gtest/gtest.h"
+#include "sm_vas.h"
+#include "btree.h"
+#include "bf_tree.h"
+#include "log_core.h"
+#include "smstats.h"
+#include "sm_base.h"
+
+#include <unistd.h>
+
+/**
+ * Testcases for the buffer pool snapshot (option sm_bf_snapshot_file), which
+ * is saved on clean shutdown and reloaded by the SnapshotWarmupThread on the
+ * next startup.
+ */
+
+btree_test_env *test_env;
+
+class test_bf_tree {
+public:
+    static void save_snapshot() {
+        smlevel_0::bf->save_snapshot();
+    }
+};
+
+const int snapshot_records = 2000;
+/** Key updated after the snapshot was taken in restart_bf_snapshot_redo */
+const char* updated_key = "key001000";
+
+std::string snapshot_path() {
+    return std::string(test_env->vol_dir) + "/bf_snapshot";
+}
+
+long snapshot_pages_loaded() {
+    sm_stats_t stats;
+    W_COERCE(ss_m::gather_stats(stats));
+    return stats[enum_to_base(sm_stat_id::bf_snapshot_pages_loaded)];
+}
+
+/** Creates an index with inner nodes and returns its root */
+w_rc_t create_snapshot_index(ss_m* ssm, test_volume_t* volume, StoreID& stid,
+        PageID& root_pid)
+{
+    W_DO(x_btree_create_index(ssm, volume, stid, root_pid));
+    // large records, so that the tree has inner nodes
+    std::string data(SM_PAGESIZE / 8, 'd');
+    char key[16];
+    W_DO(test_env->begin_xct());
+    for (int i = 0; i < snapshot_records; ++i) {
+        ::snprintf(key, sizeof(key), "key%06d", i);
+        W_DO(test_env->btree_insert(stid, key, data.c_str()));
+    }
+    W_DO(test_env->commit_xct());
+    return RCOK;
+}
+
+w_rc_t check_snapshot_index(StoreID stid) {
+    x_btree_scan_result s;
+    W_DO(test_env->btree_scan(stid, s));
+    EXPECT_EQ (snapshot_records, s.rownum);
+    EXPECT_EQ (std::string("key000000"), s.minkey);
+    EXPECT_EQ (std::string("key001999"), s.maxkey);
+    return RCOK;
+}
+
+// Snapshot saved on clean shutdown and loaded on restart
+class restart_bf_snapshot : public restart_test_base
+{
+public:
+    w_rc_t pre_shutdown(ss_m *ssm) {
+        _stid_list = new StoreID[1];
+        W_DO(create_snapshot_index(ssm, &_volume, _stid_list[0], _root_pid));
+        // the test driver shuts down without flushing otherwise
+        ssm->set_shutdown_flag(true);
+        return RCOK;
+    }
+
+    w_rc_t post_shutdown(ss_m *) {
+        // Snapshot is consumed by the load
+        EXPECT_NE(0, ::access(snapshot_path().c_str(), F_OK));
+        EXPECT_GT(snapshot_pages_loaded(), 0);
+        // Root was loaded before the first access
+        EXPECT_NE(0u, smlevel_0::bf->lookup(_root_pid));
+
+        W_DO(check_snapshot_index(_stid_list[0]));
+        return RCOK;
+    }
+};
+
+TEST (BufferpoolSnapshotTest, SaveAndLoad) {
+    test_env->empty_logdata_dir();
+    restart_bf_snapshot context;
+    restart_test_options options;
+    options.shutdown_mode = normal_shutdown;
+    sm_options sm_opts;
+    sm_opts.set_string_option("sm_bf_snapshot_file", snapshot_path());
+    EXPECT_EQ(test_env->runRestartTest(&context, &options, false, sm_opts), 0);
+}
+
+// A page updated after the snapshot was taken is loaded from the snapshot
+// while instant restart has yet to redo it
+class restart_bf_snapshot_redo : public restart_test_base
+{
+public:
+    w_rc_t pre_shutdown(ss_m *ssm) {
+        _stid_list = new StoreID[1];
+        W_DO(create_snapshot_index(ssm, &_volume, _stid_list[0], _root_pid));
+        // the snapshot is only valid for pages that are clean on disk
+        W_DO(smlevel_0::log->flush_all());
+        smlevel_0::bf->wakeup_cleaner(true, 1);
+        test_bf_tree::save_snapshot();
+
+        std::string data(SM_PAGESIZE / 8, 'u');
+        W_DO(test_env->btree_update_and_commit(_stid_list[0], updated_key,
+                    data.c_str()));
+        W_DO(smlevel_0::log->flush_all());
+        return RCOK;
+    }
+
+    w_rc_t post_shutdown(ss_m *) {
+        EXPECT_NE(0, ::access(snapshot_path().c_str(), F_OK));
+        EXPECT_GT(snapshot_pages_loaded(), 0);
+
+        std::string data;
+        W_DO(test_env->btree_lookup_and_commit(_stid_list[0], updated_key, data));
+        EXPECT_EQ(std::string(SM_PAGESIZE / 8, 'u'), data);
+
+        W_DO(check_snapshot_index(_stid_list[0]));
+        return RCOK;
+    }
+};
+
+TEST (BufferpoolSnapshotTest, RedoAfterSnapshot) {
+    test_env->empty_logdata_dir();
+    restart_bf_snapshot_redo context;
+    restart_test_options options;
+    options.shutdown_mode = simulated_crash;
+    sm_options sm_opts;
+    sm_opts.set_string_option("sm_bf_snapshot_file", snapshot_path());
+    sm_opts.set_bool_option("sm_restart_instant", true);
+    EXPECT_EQ(test_env->runRestartTest(&context, &options, false, sm_opts), 0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    test_env = new btree_test_env();
+    ::testing::AddGlobalTestEnvironment(test_env);
+    return RUN_ALL_TESTS();
+}
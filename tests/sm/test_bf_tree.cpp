@@ -8,10 +8,16 @@
 
 #include "bf_tree_cb.h"
 #include "bf_tree.h"
+#include "bf_memory.h"
 #include "sm_base.h"
 
 #include <vector>
 #include <set>
+#include <fstream>
+#include <string>
+
+// Template definitions
+#include "bf_hashtable.cpp"
 
 btree_test_env *test_env;
 /**
@@ -41,6 +47,29 @@ public:
             *p.page_pointer_address(-1) = child;
         }
     }
+
+    /** per-core free-frame caches */
+    static uint32_t free_cache_count(bf_tree_m *bf) { return bf->_free_cache_count; }
+    static uint32_t free_cache_batch(bf_tree_m *bf) { return bf->_free_cache_batch; }
+    static bf_free_cache& my_free_cache(bf_tree_m *bf) { return bf->_my_free_cache(); }
+    static bf_free_cache& free_cache(bf_tree_m *bf, uint32_t i) { return bf->_free_caches[i]; }
+    static uint32_t global_free_count(bf_tree_m *bf) { return bf->_freelist_len; }
+    static bool grab_free_block(bf_tree_m *bf, bf_idx& idx) {
+        return bf->_grab_cached_free_block(idx);
+    }
+    static void add_free_block(bf_tree_m *bf, bf_idx idx) { bf->_add_free_block(idx); }
+    /** puts a free block into the given cache, as if it was freed by another core */
+    static void add_free_block_to(bf_tree_m *bf, bf_free_cache& cache, bf_idx idx) {
+        cache.lock.acquire();
+        bf->_freelist[idx] = cache.head;
+        cache.head = idx;
+        ++cache.len;
+        cache.lock.release();
+    }
+
+    static const bf_memory_region& buffer_memory(bf_tree_m *bf) { return bf->_buffer_memory; }
+    static const bf_memory_region& cb_memory(bf_tree_m *bf) { return bf->_cb_memory; }
+    static generic_page* buffer(bf_tree_m *bf) { return bf->_buffer; }
 };
 
 
@@ -48,8 +77,8 @@ enum test_size_t {
     SMALL, NORMAL, LARGE
 };
 
-void run_bf_test(w_rc_t (*func)(ss_m*, test_volume_t*),
-    test_size_t size, bool initially_enable_cleaners, bool enable_swizzling)
+sm_options make_bf_options(test_size_t size, bool initially_enable_cleaners,
+    bool enable_swizzling)
 {
     size_t npages = (size == LARGE ? 10000 : (size == NORMAL ? 1024 : 256));
     // (some of) tests in this file needs REALLY big log.
@@ -77,7 +106,15 @@ void run_bf_test(w_rc_t (*func)(ss_m*, test_volume_t*),
         (size == LARGE ? 50 : (size == NORMAL ? 20 : 10)));
     options.set_int_option("sm_rawlock_gc_max_segment_count",
         (size == LARGE ? 200 : (size == NORMAL ? 100 : 50)));
+    return options;
+}
 
+void run_bf_test(w_rc_t (*func)(ss_m*, test_volume_t*),
+    test_size_t size, bool initially_enable_cleaners, bool enable_swizzling,
+    bool optimistic_hashtable = false)
+{
+    sm_options options = make_bf_options(size, initially_enable_cleaners, enable_swizzling);
+    options.set_bool_option("sm_bf_hashtable_optimistic", optimistic_hashtable);
     EXPECT_EQ(test_env->runBtreeTest(func, false, options), 0);
 }
 
@@ -95,6 +132,48 @@ w_rc_t test_bf_init(ss_m* /*ssm*/, test_volume_t */*test_volume*/) {
 TEST (TreeBufferpoolTest, Init) {
     run_bf_test(test_bf_init, SMALL, true, true);
 }
+
+void test_bf_hashtable(bool optimistic) {
+    // very few buckets to exercise chaining and the overflow area
+    bf_hashtable<bf_idx_pair> table(3, optimistic);
+    EXPECT_EQ(optimistic, table.is_optimistic());
+    const PageID count = 500;
+    for (PageID pid = 1; pid <= count; ++pid) {
+        EXPECT_TRUE(table.insert_if_not_exists(pid, bf_idx_pair(pid + 1, pid + 2)));
+    }
+    for (PageID pid = 1; pid <= count; ++pid) {
+        EXPECT_FALSE(table.insert_if_not_exists(pid, bf_idx_pair(0, 0)));
+    }
+    bf_idx_pair p;
+    for (PageID pid = 1; pid <= count; ++pid) {
+        ASSERT_TRUE(table.lookup(pid, p));
+        EXPECT_EQ(pid + 1, p.first);
+        EXPECT_EQ(pid + 2, p.second);
+    }
+    EXPECT_FALSE(table.lookup(count + 1, p));
+    for (PageID pid = 1; pid <= count; pid += 2) {
+        EXPECT_TRUE(table.update(pid, bf_idx_pair(pid, 0)));
+        EXPECT_TRUE(table.remove(pid + 1));
+    }
+    EXPECT_FALSE(table.update(count + 1, bf_idx_pair(0, 0)));
+    EXPECT_FALSE(table.remove(count + 1));
+    for (PageID pid = 1; pid <= count; ++pid) {
+        if (pid % 2 == 1) {
+            ASSERT_TRUE(table.lookup(pid, p));
+            EXPECT_EQ(pid, p.first);
+            EXPECT_EQ(0U, p.second);
+        }
+        else {
+            EXPECT_FALSE(table.lookup(pid, p));
+        }
+    }
+}
+TEST (TreeBufferpoolTest, Hashtable) {
+    test_bf_hashtable(false);
+}
+TEST (TreeBufferpoolTest, HashtableOptimistic) {
+    test_bf_hashtable(true);
+}
 w_rc_t test_bf_fix_virgin_root(ss_m* /*ssm*/, test_volume_t *test_volume) {
     lsn_t thelsn = smlevel_0::log->curr_lsn();
     bf_tree_m &pool(*smlevel_0::bf);
@@ -296,6 +375,379 @@ TEST (TreeBufferpoolTest, EvictNoSwizzle) {
 TEST (TreeBufferpoolTest, EvictSwizzle) {
     run_bf_test(test_bf_evict, NORMAL, false, true);
 }
+TEST (TreeBufferpoolTest, EvictOptimisticHashtable) {
+    run_bf_test(test_bf_evict, NORMAL, false, true, true);
+}
+
+long stat_of(const sm_stats_t& stats, sm_stat_id id) {
+    return stats[enum_to_base(id)];
+}
+
+/** Difference of the stats of the last test_bf_evict_policy from before to after */
+sm_stats_t evict_stats;
+/** Misses while reading the hot set again after the scan of test_bf_evict_policy */
+long hot_set_misses;
+
+const int evict_policy_count = 6500;
+/** Keys k00000 to k00039, about 8 leaves */
+const int hot_keys = 40;
+/** Records per leaf (SM_PAGESIZE / 6 each) */
+const int recs_per_leaf = 5;
+/** Rounds over the hot set before the scan */
+const int hot_rounds = 3;
+/**
+ * Other leaves read between two rounds over the hot set. LRU-K only keeps
+ * pages referenced again while still cached, but the 2Q A1in queue holds all
+ * frames until Am fills up, so the hot set must be evicted from A1in (and
+ * remembered in A1out) before it is read again.
+ */
+int leaves_per_round = 100;
+
+w_rc_t lookup_key(ss_m* ssm, StoreID stid, int i, const char* datastr) {
+    char keystr[7];
+    std::string data;
+    ::snprintf(keystr, sizeof(keystr), "k%05d", i);
+    W_DO(x_btree_lookup_and_commit(ssm, stid, keystr, data));
+    EXPECT_EQ(std::string(datastr), data) << keystr;
+    return RCOK;
+}
+
+long nonroot_misses() {
+    sm_stats_t stats;
+    W_COERCE(ss_m::gather_stats(stats));
+    return stat_of(stats, sm_stat_id::bf_fix_nonroot_miss_count);
+}
+
+// insert much more data than fits in the (SMALL) bufferpool, then scan it
+// sequentially while a small hot set is being read
+w_rc_t test_bf_evict_policy(ss_m* ssm, test_volume_t *test_volume) {
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    const int recsize = SM_PAGESIZE / 6;
+    char datastr[recsize + 1];
+    ::memset (datastr, 'a', recsize);
+    datastr[recsize] = '\0';
+    char keystr[7];
+    for (int i = 0; i < evict_policy_count; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "k%05d", i);
+        W_DO(x_btree_insert_and_commit(ssm, stid, keystr, datastr));
+    }
+    W_DO(x_btree_verify(ssm, stid));
+
+    // the hot set is read again and again, each time after other leaves
+    // were read once (see leaves_per_round)
+    int key = hot_keys;
+    for (int round = 0; round < hot_rounds; ++round) {
+        // twice, since LRU-K does not count correlated references, i.e.,
+        // those without a miss in between
+        for (int i = 0; i < 2 * hot_keys; ++i) {
+            W_DO(lookup_key(ssm, stid, i % hot_keys, datastr));
+        }
+        for (int j = 0; j < leaves_per_round; ++j, key += recs_per_leaf) {
+            W_DO(lookup_key(ssm, stid, key, datastr));
+        }
+    }
+
+    // a scan over all keys not read so far, more than the bufferpool holds
+    for (; key < evict_policy_count; ++key) {
+        W_DO(lookup_key(ssm, stid, key, datastr));
+    }
+    long misses = nonroot_misses();
+    for (int i = 0; i < hot_keys; ++i) {
+        W_DO(lookup_key(ssm, stid, i, datastr));
+    }
+    hot_set_misses = nonroot_misses() - misses;
+
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    for (size_t i = 0; i < after.size(); ++i) {
+        evict_stats[i] = after[i] - before[i];
+    }
+    return RCOK;
+}
+void run_bf_evict_policy_test(const std::string& policy, bool enable_swizzling,
+        int evict_threads = 0, int evict_batch_size = 1)
+{
+    sm_options options = make_bf_options(SMALL, true, enable_swizzling);
+    options.set_string_option("sm_evict_policy", policy);
+    // evictioner writes dirty victims itself, so the test doesn't depend on the cleaner
+    options.set_bool_option("sm_evict_dirty_pages", true);
+    if (evict_threads > 0) {
+        options.set_bool_option("sm_async_eviction", true);
+        options.set_int_option("sm_evict_threads", evict_threads);
+        options.set_int_option("sm_evict_batch_size", evict_batch_size);
+    }
+    evict_stats.fill(0);
+    hot_set_misses = -1;
+    leaves_per_round = (policy == "2q" ? 320 : 100);
+    EXPECT_EQ(test_env->runBtreeTest(test_bf_evict_policy, false, options), 0);
+
+    long evicted = stat_of(evict_stats, sm_stat_id::bf_evict);
+    long cold_victims = stat_of(evict_stats, sm_stat_id::bf_evict_cold_victim);
+    long hot_victims = stat_of(evict_stats, sm_stat_id::bf_evict_hot_victim);
+    long ghost_hits = stat_of(evict_stats, sm_stat_id::bf_evict_ghost_hit);
+    cout << policy << ": evicted=" << evicted << ", cold victims=" << cold_victims
+        << ", hot victims=" << hot_victims << ", ghost hits=" << ghost_hits
+        << ", hot set misses after scan=" << hot_set_misses << endl;
+    EXPECT_GT(evicted, evict_policy_count / recs_per_leaf - 256);
+    if (policy == "clock") {
+        EXPECT_EQ(0, cold_victims + hot_victims + ghost_hits);
+        return;
+    }
+
+    // every victim is counted as either cold or hot (some could not be evicted after all)
+    EXPECT_GE(cold_victims + hot_victims, evicted);
+    // the scanned leaves are evicted before the hot set
+    EXPECT_GT(cold_victims, hot_victims);
+    EXPECT_LT(hot_set_misses, hot_keys / recs_per_leaf / 2);
+    if (policy == "2q") {
+        // the hot set came back while still in A1out and went to Am
+        EXPECT_GE(ghost_hits, hot_keys / recs_per_leaf);
+    } else {
+        EXPECT_EQ(0, ghost_hits);
+        // pages referenced at least K times during the inserts
+        EXPECT_GT(hot_victims, 0);
+    }
+}
+TEST (TreeBufferpoolTest, EvictPolicyClock) {
+    run_bf_evict_policy_test("clock", true);
+}
+TEST (TreeBufferpoolTest, EvictPolicyLRUK) {
+    run_bf_evict_policy_test("lruk", true);
+}
+TEST (TreeBufferpoolTest, EvictPolicy2Q) {
+    run_bf_evict_policy_test("2q", true);
+}
+TEST (TreeBufferpoolTest, EvictPolicy2QNoSwizzle) {
+    run_bf_evict_policy_test("2q", false);
+}
+
+void run_bf_evict_batch_test(const std::string& policy, bool enable_swizzling,
+        int evict_threads, int evict_batch_size)
+{
+    run_bf_evict_policy_test(policy, enable_swizzling, evict_threads, evict_batch_size);
+    long batches = stat_of(evict_stats, sm_stat_id::bf_evict_batches);
+    long shared_latches = stat_of(evict_stats, sm_stat_id::bf_evict_shared_parent_latch);
+    cout << "batches=" << batches << ", shared parent latches=" << shared_latches << endl;
+    EXPECT_GT(batches, 0);
+    // batches are filled up: fewer of them than evicted pages
+    EXPECT_LT(batches, stat_of(evict_stats, sm_stat_id::bf_evict));
+    if (enable_swizzling) {
+        // leaves of the same parent are unswizzled under one parent latch
+        EXPECT_GT(shared_latches, 0);
+    } else {
+        // nothing to update in the parent
+        EXPECT_EQ(0, shared_latches);
+    }
+}
+TEST (TreeBufferpoolTest, EvictShardedBatch) {
+    run_bf_evict_batch_test("clock", true, 4, 8);
+}
+TEST (TreeBufferpoolTest, EvictShardedBatchNoSwizzle) {
+    run_bf_evict_batch_test("clock", false, 4, 8);
+}
+TEST (TreeBufferpoolTest, EvictShardedBatchLRUK) {
+    run_bf_evict_batch_test("lruk", true, 2, 4);
+}
+
+/**
+ * Exercises each path of the per-core free-frame caches directly: refill
+ * from the global freelist, spill back to it, and stealing from the cache
+ * of another core. Then runs the eviction workload on top of them.
+ */
+w_rc_t test_bf_freelist_caches(ss_m* ssm, test_volume_t *test_volume) {
+    bf_tree_m* bf = smlevel_0::bf;
+    uint32_t caches = test_bf_tree::free_cache_count(bf);
+    uint32_t batch = test_bf_tree::free_cache_batch(bf);
+    EXPECT_GT(caches, 0U);
+    EXPECT_EQ(8U, batch);
+    bf_free_cache& mine = test_bf_tree::my_free_cache(bf);
+    std::vector<bf_idx> grabbed;
+    bf_idx idx;
+
+    // empty this core's cache, then take one more: refilled with a batch
+    while (mine.len > 0) {
+        EXPECT_TRUE(test_bf_tree::grab_free_block(bf, idx));
+        grabbed.push_back(idx);
+    }
+    EXPECT_GT(test_bf_tree::global_free_count(bf), 3 * batch);
+    sm_stats_t before, after;
+    W_DO(ss_m::gather_stats(before));
+    EXPECT_TRUE(test_bf_tree::grab_free_block(bf, idx));
+    grabbed.push_back(idx);
+    W_DO(ss_m::gather_stats(after));
+    EXPECT_EQ(1, stat_of(after, sm_stat_id::bf_freelist_refill)
+            - stat_of(before, sm_stat_id::bf_freelist_refill));
+    EXPECT_EQ(batch - 1, mine.len);
+
+    // freeing more than two batches spills one batch back
+    while (grabbed.size() < 3 * batch) {
+        EXPECT_TRUE(test_bf_tree::grab_free_block(bf, idx));
+        grabbed.push_back(idx);
+    }
+    uint32_t global_before = test_bf_tree::global_free_count(bf);
+    W_DO(ss_m::gather_stats(before));
+    for (bf_idx i : grabbed) {
+        test_bf_tree::add_free_block(bf, i);
+    }
+    grabbed.clear();
+    W_DO(ss_m::gather_stats(after));
+    long spills = stat_of(after, sm_stat_id::bf_freelist_spill)
+        - stat_of(before, sm_stat_id::bf_freelist_spill);
+    EXPECT_GT(spills, 0);
+    EXPECT_EQ(global_before + spills * batch, test_bf_tree::global_free_count(bf));
+    EXPECT_LE(mine.len, 2 * batch);
+
+    if (caches > 1) {
+        // with the global freelist and this core's cache empty, half of the
+        // frames cached by another core are taken
+        while (test_bf_tree::global_free_count(bf) > 0 || mine.len > 0) {
+            EXPECT_TRUE(test_bf_tree::grab_free_block(bf, idx));
+            grabbed.push_back(idx);
+        }
+        bf_free_cache& other = test_bf_tree::free_cache(bf,
+                (&mine - &test_bf_tree::free_cache(bf, 0) + 1) % caches);
+        uint32_t other_before = other.len;
+        for (int i = 0; i < 4; ++i) {
+            test_bf_tree::add_free_block_to(bf, other, grabbed.back());
+            grabbed.pop_back();
+        }
+        W_DO(ss_m::gather_stats(before));
+        EXPECT_TRUE(test_bf_tree::grab_free_block(bf, idx));
+        grabbed.push_back(idx);
+        W_DO(ss_m::gather_stats(after));
+        EXPECT_GE(stat_of(after, sm_stat_id::bf_freelist_steal)
+                - stat_of(before, sm_stat_id::bf_freelist_steal), 1);
+        EXPECT_LT(other.len, other_before + 4);
+        for (bf_idx i : grabbed) {
+            test_bf_tree::add_free_block(bf, i);
+        }
+        grabbed.clear();
+    }
+
+    return test_bf_evict_policy(ssm, test_volume);
+}
+void run_bf_freelist_caches_test(int caches, bool async_eviction) {
+    sm_options options = make_bf_options(SMALL, true, true);
+    options.set_bool_option("sm_evict_dirty_pages", true);
+    options.set_bool_option("sm_async_eviction", async_eviction);
+    options.set_int_option("sm_bf_freelist_caches", caches);
+    options.set_int_option("sm_bf_freelist_batch", 8);
+    EXPECT_EQ(test_env->runBtreeTest(test_bf_freelist_caches, false, options), 0);
+}
+TEST (TreeBufferpoolTest, FreelistCaches) {
+    run_bf_freelist_caches_test(4, false);
+}
+TEST (TreeBufferpoolTest, FreelistCachesAsyncEviction) {
+    run_bf_freelist_caches_test(4, true);
+}
+TEST (TreeBufferpoolTest, FreelistCachesPerCore) {
+    run_bf_freelist_caches_test(-1, true);
+}
+
+/** Configuration of the last run_bf_memory_test */
+bf_memory_region::huge_page_mode memory_huge_pages;
+bf_memory_region::numa_policy memory_numa;
+
+/** Number of huge pages of the given size reserved in the hugetlbfs pool */
+long reserved_huge_pages(size_t page_size) {
+    std::ifstream in("/sys/kernel/mm/hugepages/hugepages-"
+            + std::to_string(page_size >> 10) + "kB/free_hugepages");
+    long count = 0;
+    in >> count;
+    return count;
+}
+
+void check_memory_region(const bf_memory_region& region, size_t size, size_t alignment) {
+    region.print_layout(cout);
+    EXPECT_EQ(size, region.size());
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(region.base()) % alignment);
+    if (region.is_mapped()) {
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(region.base()) % region.page_size());
+    }
+
+    switch (memory_huge_pages) {
+    case bf_memory_region::HUGE_PAGES_NONE:
+        EXPECT_EQ(bf_memory_region::HUGE_PAGES_NONE, region.huge_pages());
+        EXPECT_EQ(4096U, region.page_size());
+        // posix_memalign unless needed for a NUMA policy
+        EXPECT_EQ(memory_numa != bf_memory_region::NUMA_NONE, region.is_mapped());
+        break;
+    case bf_memory_region::HUGE_PAGES_2M:
+        EXPECT_TRUE(region.is_mapped());
+        if (reserved_huge_pages(size_t(1) << 21) * (size_t(1) << 21) >= 2 * size) {
+            EXPECT_EQ(bf_memory_region::HUGE_PAGES_2M, region.huge_pages());
+        } else {
+            // fell back to transparent huge pages, or to none if those are disabled
+            EXPECT_NE(bf_memory_region::HUGE_PAGES_2M, region.huge_pages());
+        }
+        break;
+    default:
+        EXPECT_TRUE(region.is_mapped());
+        EXPECT_NE(bf_memory_region::HUGE_PAGES_2M, region.huge_pages());
+        EXPECT_NE(bf_memory_region::HUGE_PAGES_1G, region.huge_pages());
+        break;
+    }
+    if (region.huge_pages() != bf_memory_region::HUGE_PAGES_NONE) {
+        EXPECT_EQ(size_t(1) << 21, region.page_size());
+    }
+
+    // a policy is either applied on all online nodes or not at all
+    if (memory_numa == bf_memory_region::NUMA_NONE || region.nodes().empty()) {
+        EXPECT_EQ(-1, region.node_of(0));
+    } else {
+        EXPECT_EQ(bf_memory_region::online_numa_nodes(), region.nodes());
+        if (memory_numa == bf_memory_region::NUMA_PARTITION) {
+            EXPECT_EQ(region.nodes().front(), region.node_of(0));
+            EXPECT_EQ(region.nodes().back(), region.node_of(size - 1));
+        } else {
+            EXPECT_EQ(-1, region.node_of(0));
+        }
+    }
+}
+
+w_rc_t test_bf_memory(ss_m* ssm, test_volume_t *test_volume) {
+    bf_tree_m* bf = smlevel_0::bf;
+    const bf_memory_region& frames = test_bf_tree::buffer_memory(bf);
+    EXPECT_EQ(static_cast<void*>(test_bf_tree::buffer(bf)), frames.base());
+    check_memory_region(frames, SM_PAGESIZE * bf->get_block_cnt(), SM_PAGESIZE);
+#ifndef BF_SPLIT_CB
+    // control blocks and latches, plus one pair for alignment
+    const size_t cb_pair = sizeof(bf_tree_cb_t) + sizeof(latch_t);
+    check_memory_region(test_bf_tree::cb_memory(bf),
+            cb_pair * (bf->get_block_cnt() + 1), cb_pair);
+#endif
+    return test_bf_evict_policy(ssm, test_volume);
+}
+// 2M/1G fall back to transparent huge pages if none are reserved, and NUMA
+// placement falls back to the default if mbind is not permitted
+void run_bf_memory_test(const std::string& huge_pages, const std::string& numa) {
+    sm_options options = make_bf_options(SMALL, true, true);
+    options.set_bool_option("sm_evict_dirty_pages", true);
+    options.set_string_option("sm_bf_huge_pages", huge_pages);
+    options.set_string_option("sm_bf_numa_policy", numa);
+    options.set_int_option("sm_bf_prefault_threads", 4);
+    memory_huge_pages = bf_memory_region::parse_huge_pages(huge_pages);
+    memory_numa = bf_memory_region::parse_numa_policy(numa);
+    EXPECT_EQ(test_env->runBtreeTest(test_bf_memory, false, options), 0);
+}
+TEST (TreeBufferpoolTest, MemoryDefault) {
+    run_bf_memory_test("none", "none");
+}
+TEST (TreeBufferpoolTest, MemoryTransparentHugePages) {
+    run_bf_memory_test("transparent", "none");
+}
+TEST (TreeBufferpoolTest, MemoryHugePagesInterleave) {
+    run_bf_memory_test("2M", "interleave");
+}
+TEST (TreeBufferpoolTest, MemoryNumaPartition) {
+    run_bf_memory_test("none", "partition");
+}
 
 w_rc_t _test_bf_swizzle(ss_m* /*ssm*/, test_volume_t *test_volume, bool enable_swizzle) {
     bf_tree_m &pool(*smlevel_0::bf);
@@ -438,6 +890,9 @@ TEST (TreeBufferpoolTest, Swizzle) {
 TEST (TreeBufferpoolTest, NoSwizzle) {
     run_bf_test(test_bf_noswizzle, LARGE, false, false);
 }
+TEST (TreeBufferpoolTest, NoSwizzleOptimisticHashtable) {
+    run_bf_test(test_bf_noswizzle, LARGE, false, false, true);
+}
 
 #ifdef BP_MAINTAIN_PARENT_PTR
 // w_rc_t test_bf_switch_parent(ss_m* /*ssm*/, test_volume_t *test_volume) {
@@ -3,6 +3,13 @@
 #include "sm_vas.h"
 #include "btree.h"
 #include "btcursor.h"
+#include "btree_maintainer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
 
 btree_test_env *test_env;
 
@@ -389,6 +396,696 @@ TEST (BtreeBasicTest, InsertManyLock) {
     EXPECT_EQ(test_env->runBtreeTest(insert_many, true), 0);
 }
 
+w_rc_t lookup_optimistic(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    // few records per leaf, so that the root is an inner node
+    const int recsize = SM_PAGESIZE / 6;
+    char datastr[recsize + 1];
+    ::memset (datastr, 'a', recsize);
+    datastr[recsize] = '\0';
+    char keystr[7];
+    for (int i = 0; i < 1000; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "k%05d", i * 2);
+        W_DO(x_btree_insert_and_commit(ssm, stid, keystr, datastr));
+    }
+
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+
+    std::string data;
+    for (int i = 0; i < 1000; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "k%05d", i * 2);
+        W_DO(x_btree_lookup_and_commit(ssm, stid, keystr, data));
+        EXPECT_EQ(std::string(datastr), data);
+        // keys between existing ones take the same path
+        ::snprintf(keystr, sizeof(keystr), "k%05d", i * 2 + 1);
+        W_DO(x_btree_lookup_and_commit(ssm, stid, keystr, data));
+        EXPECT_EQ(std::string(""), data);
+    }
+
+    // writers fix the leaf in EX mode and split it
+    for (int i = 0; i < 1000; i += 10) {
+        ::snprintf(keystr, sizeof(keystr), "k%05d", i * 2 + 1);
+        W_DO(x_btree_insert_and_commit(ssm, stid, keystr, datastr));
+        ::snprintf(keystr, sizeof(keystr), "k%05d", i * 2);
+        W_DO(x_btree_remove_and_commit(ssm, stid, keystr));
+    }
+
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    size_t optimistic = enum_to_base(sm_stat_id::bt_optimistic_traverse_cnt);
+    EXPECT_GT(after[optimistic] - before[optimistic], 2000);
+
+    x_btree_scan_result s;
+    W_DO(x_btree_scan(ssm, stid, s, test_env->get_use_locks()));
+    EXPECT_EQ (1000, s.rownum);
+    EXPECT_EQ (std::string("k00001"), s.minkey);
+    W_DO(x_btree_verify(ssm, stid));
+    return RCOK;
+}
+
+TEST (BtreeBasicTest, LookupOptimistic) {
+    test_env->empty_logdata_dir();
+    sm_options options;
+    options.set_bool_option("sm_bf_optimistic_inner", true);
+    EXPECT_EQ(test_env->runBtreeTest(lookup_optimistic, options), 0);
+}
+
+TEST (BtreeBasicTest, LookupOptimisticSwizzle) {
+    test_env->empty_logdata_dir();
+    sm_options options;
+    options.set_bool_option("sm_bf_optimistic_inner", true);
+    options.set_bool_option("sm_bufferpool_swizzle", true);
+    EXPECT_EQ(test_env->runBtreeTest(lookup_optimistic, options), 0);
+}
+
+/** Returns keys k000000, k000001, ... in the order of a given permutation. */
+class test_bulk_load_iterator : public bulk_load_iterator {
+public:
+    test_bulk_load_iterator(const std::vector<int>& order) : _order(order), _pos(0) {}
+    virtual rc_t next(w_keystr_t& key, std::string& elem, bool& eof) {
+        eof = (_pos == _order.size());
+        if (!eof) {
+            char keystr[8];
+            ::snprintf(keystr, sizeof(keystr), "k%06d", _order[_pos++]);
+            key.construct_regularkey(keystr, 7);
+            elem.assign(100, 'd');
+            elem.replace(0, 7, keystr);
+        }
+        return RCOK;
+    }
+private:
+    std::vector<int> _order;
+    size_t           _pos;
+};
+
+w_rc_t bulk_load_check(ss_m* ssm, test_volume_t *test_volume, bool sorted) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    const int count = 30000;
+    std::vector<int> order;
+    for (int i = 0; i < count; ++i) {
+        order.push_back(i);
+    }
+    if (!sorted) {
+        std::mt19937 rng(1234);
+        std::shuffle(order.begin(), order.end(), rng);
+    }
+
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+    W_DO(ssm->begin_xct());
+    test_bulk_load_iterator iter(order);
+    uint64_t loaded = 0;
+    W_DO(ssm->bulk_load(stid, iter, sorted, &loaded));
+    W_DO(ssm->commit_xct());
+    EXPECT_EQ((uint64_t) count, loaded);
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    size_t pages = enum_to_base(sm_stat_id::bt_bulkload_pages);
+    // packed leaves of 30000 * ~110 bytes, plus nodes
+    EXPECT_LT(after[pages] - before[pages], 500);
+
+    x_btree_scan_result s;
+    W_DO(x_btree_scan(ssm, stid, s, test_env->get_use_locks()));
+    EXPECT_EQ (count, s.rownum);
+    EXPECT_EQ (std::string("k000000"), s.minkey);
+    EXPECT_EQ (std::string("k029999"), s.maxkey);
+    W_DO(x_btree_verify(ssm, stid));
+
+    std::string data;
+    char keystr[8];
+    for (int i = 0; i < count; i += 997) {
+        ::snprintf(keystr, sizeof(keystr), "k%06d", i);
+        W_DO(x_btree_lookup_and_commit(ssm, stid, keystr, data));
+        EXPECT_EQ(100U, data.size());
+        EXPECT_EQ(std::string(keystr), data.substr(0, 7));
+    }
+
+    // the tree is an ordinary one afterwards, but cannot be bulk loaded again
+    W_DO(x_btree_insert_and_commit(ssm, stid, "k0100000", "new"));
+    W_DO(x_btree_remove_and_commit(ssm, stid, "k000001"));
+    W_DO(x_btree_verify(ssm, stid));
+    W_DO(ssm->begin_xct());
+    test_bulk_load_iterator again(order);
+    rc_t rc = ssm->bulk_load(stid, again, sorted);
+    EXPECT_EQ(eNDXNOTEMPTY, rc.err_num());
+    W_DO(ssm->abort_xct());
+    return RCOK;
+}
+
+w_rc_t bulk_load_sorted(ss_m* ssm, test_volume_t *test_volume) {
+    return bulk_load_check(ssm, test_volume, true);
+}
+
+w_rc_t bulk_load_unsorted(ss_m* ssm, test_volume_t *test_volume) {
+    return bulk_load_check(ssm, test_volume, false);
+}
+
+w_rc_t bulk_load_unordered_fail(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    std::vector<int> order;
+    order.push_back(1);
+    order.push_back(2);
+    order.push_back(2);
+    W_DO(ssm->begin_xct());
+    test_bulk_load_iterator dup(order);
+    rc_t rc = ssm->bulk_load(stid, dup);
+    EXPECT_EQ(eDUPLICATE, rc.err_num());
+    W_DO(ssm->abort_xct());
+
+    // failing after some pages were written out deallocates them again
+    order.clear();
+    for (int i = 0; i < 10000; ++i) {
+        order.push_back(i);
+    }
+    order.push_back(5000);
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+    W_DO(ssm->begin_xct());
+    test_bulk_load_iterator late_dup(order);
+    rc = ssm->bulk_load(stid, late_dup);
+    EXPECT_EQ(eBADARGUMENT, rc.err_num());
+    W_DO(ssm->abort_xct());
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    size_t pages = enum_to_base(sm_stat_id::bt_bulkload_pages);
+    size_t deallocs = enum_to_base(sm_stat_id::page_dealloc_cnt);
+    EXPECT_GT(after[pages] - before[pages], 10);
+    EXPECT_EQ(after[pages] - before[pages], after[deallocs] - before[deallocs]);
+
+    // the index is still empty and can be loaded
+    order.pop_back();
+    W_DO(ssm->begin_xct());
+    test_bulk_load_iterator retry(order);
+    uint64_t loaded = 0;
+    W_DO(ssm->bulk_load(stid, retry, true, &loaded));
+    W_DO(ssm->commit_xct());
+    EXPECT_EQ(10000U, loaded);
+    x_btree_scan_result s;
+    W_DO(x_btree_scan(ssm, stid, s, test_env->get_use_locks()));
+    EXPECT_EQ (10000, s.rownum);
+    W_DO(x_btree_verify(ssm, stid));
+    return RCOK;
+}
+
+TEST (BtreeBasicTest, BulkLoad) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(bulk_load_sorted), 0);
+}
+
+TEST (BtreeBasicTest, BulkLoadLock) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(bulk_load_sorted, true), 0);
+}
+
+TEST (BtreeBasicTest, BulkLoadUnsorted) {
+    test_env->empty_logdata_dir();
+    sm_options options;
+    // 30000 entries of ~110 bytes, so the external sort spills runs
+    options.set_int_option("sm_bulkload_sort_memory", 1);
+    EXPECT_EQ(test_env->runBtreeTest(bulk_load_unsorted, options), 0);
+}
+
+TEST (BtreeBasicTest, BulkLoadUnorderedFail) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(bulk_load_unordered_fail), 0);
+}
+
+w_rc_t batch_insert_lookup(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+    W_DO(x_btree_insert_and_commit(ssm, stid, "k000010", "old"));
+
+    // even keys in random order, plus a duplicate within the batch
+    const int count = 2000;
+    std::vector<int> numbers;
+    for (int i = 0; i < count; ++i) {
+        numbers.push_back(i * 2);
+    }
+    std::mt19937 rng(1234);
+    std::shuffle(numbers.begin(), numbers.end(), rng);
+    numbers.push_back(20);
+
+    std::vector<w_keystr_t> keys(numbers.size());
+    std::vector<std::string> datas(numbers.size());
+    std::vector<cvec_t> elems(numbers.size());
+    char keystr[8];
+    for (size_t i = 0; i < numbers.size(); ++i) {
+        ::snprintf(keystr, sizeof(keystr), "k%06d", numbers[i]);
+        keys[i].construct_regularkey(keystr, ::strlen(keystr));
+        datas[i] = std::string(keystr) + std::string(100, 'a');
+        elems[i].put(datas[i].data(), datas[i].size());
+    }
+
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+    std::vector<rc_t> results(numbers.size());
+    W_DO(ssm->begin_xct());
+    W_DO(ssm->create_assoc_batch(stid, keys.size(), &keys[0], &elems[0], &results[0]));
+    W_DO(ssm->commit_xct());
+    for (size_t i = 0; i < numbers.size(); ++i) {
+        if (numbers[i] == 10 || i == numbers.size() - 1) {
+            EXPECT_EQ(eDUPLICATE, results[i].err_num()) << numbers[i];
+        } else {
+            EXPECT_FALSE(results[i].is_error()) << numbers[i];
+        }
+    }
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    size_t reuse = enum_to_base(sm_stat_id::bt_batch_leaf_reuse_cnt);
+    EXPECT_GT(after[reuse] - before[reuse], count / 2);
+
+    x_btree_scan_result s;
+    W_DO(x_btree_scan(ssm, stid, s, test_env->get_use_locks()));
+    EXPECT_EQ (count, s.rownum);
+    W_DO(x_btree_verify(ssm, stid));
+
+    // look up all keys, every other of which does not exist
+    const int lookups = count * 2;
+    std::vector<w_keystr_t> lookup_keys(lookups);
+    std::vector<std::vector<char> > bufs(lookups, std::vector<char>(200));
+    std::vector<void*> els(lookups);
+    std::vector<smsize_t> elens(lookups, 200);
+    bool* found = new bool[lookups];
+    std::vector<rc_t> lookup_results(lookups);
+    for (int i = 0; i < lookups; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "k%06d", lookups - 1 - i);
+        lookup_keys[i].construct_regularkey(keystr, ::strlen(keystr));
+        els[i] = &bufs[i][0];
+    }
+    elens[1] = 10; // too small for k003998
+    W_DO(ssm->begin_xct());
+    W_DO(ssm->find_assoc_batch(stid, lookups, &lookup_keys[0], &els[0], &elens[0],
+                               found, &lookup_results[0]));
+    W_DO(ssm->commit_xct());
+    for (int i = 0; i < lookups; ++i) {
+        int number = lookups - 1 - i;
+        ::snprintf(keystr, sizeof(keystr), "k%06d", number);
+        if (i == 1) {
+            EXPECT_EQ(eRECWONTFIT, lookup_results[i].err_num());
+            EXPECT_EQ((smsize_t) 107, elens[i]);
+            continue;
+        }
+        EXPECT_FALSE(lookup_results[i].is_error()) << keystr;
+        EXPECT_EQ(number % 2 == 0, found[i]) << keystr;
+        if (found[i]) {
+            std::string data(&bufs[i][0], elens[i]);
+            EXPECT_EQ(number == 10 ? std::string("old") : std::string(keystr) + std::string(100, 'a'),
+                      data);
+        }
+    }
+    delete[] found;
+    return RCOK;
+}
+
+TEST (BtreeBasicTest, BatchInsertLookup) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(batch_insert_lookup), 0);
+}
+
+TEST (BtreeBasicTest, BatchInsertLookupLock) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(batch_insert_lookup, true), 0);
+}
+
+/** Leaves 1 of 20 records in each leaf, then runs a maintenance round. */
+w_rc_t maintenance_prepare(ss_m* ssm, StoreID stid, int count) {
+    char keystr[20];
+    std::string data(100, 'd');
+    vec_t el(data.data(), data.size());
+    W_DO(ssm->begin_xct());
+    test_env->set_xct_query_lock();
+    for (int i = 0; i < count; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "k%06d", i);
+        w_keystr_t key;
+        key.construct_regularkey(keystr, ::strlen(keystr));
+        W_DO(ssm->create_assoc(stid, key, el));
+    }
+    W_DO(ssm->commit_xct());
+
+    W_DO(ssm->begin_xct());
+    test_env->set_xct_query_lock();
+    for (int i = 0; i < count; ++i) {
+        if (i % 20 == 0) { continue; }
+        ::snprintf(keystr, sizeof(keystr), "k%06d", i);
+        w_keystr_t key;
+        key.construct_regularkey(keystr, ::strlen(keystr));
+        W_DO(ssm->destroy_assoc(stid, key));
+    }
+    W_DO(ssm->commit_xct());
+
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+    smlevel_0::bt_maint->wakeup(true, 1);
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    size_t rounds = enum_to_base(sm_stat_id::bt_maint_rounds);
+    size_t merges = enum_to_base(sm_stat_id::bt_maint_merges);
+    size_t defrags = enum_to_base(sm_stat_id::bt_maint_defrags);
+    size_t ghosts = enum_to_base(sm_stat_id::bt_maint_ghosts_reclaimed);
+    EXPECT_GT(after[rounds] - before[rounds], 0U);
+    EXPECT_GT(after[merges] - before[merges], 0U);
+    EXPECT_GT(after[defrags] - before[defrags], 0U);
+    EXPECT_GT(after[ghosts] - before[ghosts], 0U);
+    return RCOK;
+}
+
+w_rc_t maintenance_check(ss_m* ssm, StoreID stid, int count) {
+    W_DO(x_btree_verify(ssm, stid));
+    x_btree_scan_result s;
+    W_DO(x_btree_scan(ssm, stid, s, test_env->get_use_locks()));
+    EXPECT_EQ (count / 20, s.rownum);
+    EXPECT_EQ (std::string("k000000"), s.minkey);
+    EXPECT_EQ (std::string("k001980"), s.maxkey);
+
+    char keystr[20];
+    std::string data(100, 'd');
+    W_DO(ssm->begin_xct());
+    for (int i = 0; i < count; i += 20) {
+        ::snprintf(keystr, sizeof(keystr), "k%06d", i);
+        std::string found;
+        W_DO(test_env->btree_lookup(stid, keystr, found));
+        EXPECT_EQ(data, found) << keystr;
+    }
+    W_DO(ssm->commit_xct());
+    return RCOK;
+}
+
+w_rc_t background_maintenance(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+    W_DO(maintenance_prepare(ssm, stid, 2000));
+    W_DO(maintenance_check(ssm, stid, 2000));
+    return RCOK;
+}
+
+TEST (BtreeBasicTest, BackgroundMaintenance) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(background_maintenance), 0);
+}
+
+TEST (BtreeBasicTest, BackgroundMaintenanceLock) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(background_maintenance, true), 0);
+}
+
+/** The merges must be redone from the log after a crash. */
+class background_maintenance_crash : public restart_test_base {
+public:
+    w_rc_t pre_shutdown(ss_m *ssm) {
+        _stid_list = new StoreID[1];
+        W_DO(x_btree_create_index(ssm, &_volume, _stid_list[0], _root_pid));
+        W_DO(maintenance_prepare(ssm, _stid_list[0], 2000));
+        return RCOK;
+    }
+
+    w_rc_t post_shutdown(ss_m *ssm) {
+        return maintenance_check(ssm, _stid_list[0], 2000);
+    }
+};
+
+TEST (BtreeBasicTest, BackgroundMaintenanceCrash) {
+    test_env->empty_logdata_dir();
+    background_maintenance_crash context;
+    restart_test_options options;
+    options.shutdown_mode = simulated_crash;
+    EXPECT_EQ(test_env->runRestartTest(&context, &options), 0);
+}
+
+w_rc_t create_compressed_index(ss_m* ssm, StoreID &stid, PageID &root_pid) {
+    W_DO(ssm->begin_xct());
+    W_DO(ssm->create_index(stid, 2, true));
+    W_DO(ssm->open_store(stid, root_pid));
+    W_DO(ssm->commit_xct());
+    return RCOK;
+}
+
+/** A row with a few small integers, blank-padded strings and zeroed filler. */
+std::string make_row(int id, int version) {
+    std::string row(192, ' ');
+    int32_t ints[3] = {id, id % 10, version * 100 + id % 50};
+    ::memcpy(&row[0], ints, sizeof(ints));
+    ::snprintf(&row[12], 17, "name%d", id);
+    ::snprintf(&row[28], 101, "street %d", id % 300);
+    std::replace(row.begin() + 12, row.begin() + 132, '\0', ' ');
+    std::fill(row.begin() + 132, row.end(), '\0');
+    return row;
+}
+
+typedef std::map<std::string, std::string> row_map_t;
+
+/** Inserts rows in random order, then updates, overwrites and removes some. */
+w_rc_t compressed_values_load(ss_m* ssm, StoreID stid, int count, row_map_t &rows) {
+    std::vector<int> ids(count);
+    for (int i = 0; i < count; ++i) { ids[i] = i; }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(1234));
+
+    char keystr[20];
+    W_DO(ssm->begin_xct());
+    test_env->set_xct_query_lock();
+    for (int i : ids) {
+        ::snprintf(keystr, sizeof(keystr), "k%06d", i);
+        w_keystr_t key;
+        key.construct_regularkey(keystr, ::strlen(keystr));
+        std::string row = make_row(i, 0);
+        W_DO(ssm->create_assoc(stid, key, vec_t(row.data(), row.size())));
+        rows[keystr] = row;
+    }
+    W_DO(ssm->commit_xct());
+
+    W_DO(ssm->begin_xct());
+    test_env->set_xct_query_lock();
+    for (int i = 0; i < count; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "k%06d", i);
+        w_keystr_t key;
+        key.construct_regularkey(keystr, ::strlen(keystr));
+        if (i % 13 == 0) {
+            W_DO(ssm->destroy_assoc(stid, key));
+            rows.erase(keystr);
+        } else if (i % 11 == 0) {
+            // breaks a run of zeros, so the stored element grows in place
+            const char patch[] = "ZZZZ";
+            smsize_t len = 4;
+            W_DO(ssm->overwrite_assoc(stid, key, patch, 140, len));
+            rows[keystr].replace(140, 4, patch, 4);
+        } else if (i % 7 == 0) {
+            std::string row = make_row(i, 1);
+            W_DO(ssm->update_assoc(stid, key, vec_t(row.data(), row.size())));
+            rows[keystr] = row;
+        }
+    }
+    W_DO(ssm->commit_xct());
+    return RCOK;
+}
+
+w_rc_t compressed_values_check(ss_m* ssm, StoreID stid, const row_map_t &rows) {
+    W_DO(x_btree_verify(ssm, stid));
+    x_btree_scan_result s;
+    W_DO(x_btree_scan(ssm, stid, s, test_env->get_use_locks()));
+    EXPECT_EQ ((int) rows.size(), s.rownum);
+    EXPECT_EQ (rows.begin()->first, s.minkey);
+    EXPECT_EQ (rows.rbegin()->first, s.maxkey);
+
+    W_DO(ssm->begin_xct());
+    for (row_map_t::const_iterator it = rows.begin(); it != rows.end(); ++it) {
+        std::string found;
+        W_DO(x_btree_lookup(ssm, stid, it->first.c_str(), found));
+        EXPECT_EQ(it->second, found) << it->first;
+    }
+    W_DO(ssm->commit_xct());
+    return RCOK;
+}
+
+w_rc_t time_lookups(ss_m* ssm, StoreID stid, const row_map_t &rows, double &usec) {
+    std::chrono::high_resolution_clock::time_point start
+        = std::chrono::high_resolution_clock::now();
+    W_DO(ssm->begin_xct());
+    for (row_map_t::const_iterator it = rows.begin(); it != rows.end(); ++it) {
+        std::string found;
+        W_DO(x_btree_lookup(ssm, stid, it->first.c_str(), found));
+    }
+    W_DO(ssm->commit_xct());
+    std::chrono::duration<double, std::micro> elapsed
+        = std::chrono::high_resolution_clock::now() - start;
+    usec = elapsed.count() / rows.size();
+    return RCOK;
+}
+
+w_rc_t compressed_values(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID plain_stid, stid;
+    PageID plain_root, root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, plain_stid, plain_root));
+    W_DO(create_compressed_index(ssm, stid, root_pid));
+
+    const int count = 3000;
+    row_map_t plain_rows, rows;
+    W_DO(compressed_values_load(ssm, plain_stid, count, plain_rows));
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+    W_DO(compressed_values_load(ssm, stid, count, rows));
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    W_DO(compressed_values_check(ssm, plain_stid, plain_rows));
+    W_DO(compressed_values_check(ssm, stid, rows));
+
+    size_t raw_id = enum_to_base(sm_stat_id::bt_value_bytes);
+    size_t stored_id = enum_to_base(sm_stat_id::bt_value_bytes_stored);
+    long raw = after[raw_id] - before[raw_id];
+    long stored = after[stored_id] - before[stored_id];
+    EXPECT_GT(raw, 0);
+    EXPECT_LT(stored * 2, raw);
+
+    uint64_t plain_pages, pages;
+    W_DO(ssm->touch_index(plain_stid, plain_pages));
+    W_DO(ssm->touch_index(stid, pages));
+    EXPECT_LT(pages * 2, plain_pages);
+
+    double plain_usec, usec;
+    W_DO(time_lookups(ssm, plain_stid, plain_rows, plain_usec));
+    W_DO(time_lookups(ssm, stid, rows, usec));
+    cout << "Compressed values: " << stored << " of " << raw << " bytes stored, "
+        << pages << " pages instead of " << plain_pages << ", lookup "
+        << usec << "us instead of " << plain_usec << "us" << endl;
+    return RCOK;
+}
+
+TEST (BtreeBasicTest, CompressedValues) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(compressed_values), 0);
+}
+
+TEST (BtreeBasicTest, CompressedValuesLock) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(compressed_values, true), 0);
+}
+
+/**
+ * Key of row i: a letter for every 60 rows and two digits, so that the keys of
+ * a leaf have no common prefix that would leave space when it is truncated.
+ */
+void padded_row_key(int i, char* keystr, size_t len) {
+    ::snprintf(keystr, len, "%c%02d", 'A' + i / 60, i % 60);
+}
+
+/** Returns the keys of padded_row_key() with rows padded with zeros. */
+class padded_rows_iterator : public bulk_load_iterator {
+public:
+    padded_rows_iterator(int count, size_t row_size)
+        : _count(count), _row_size(row_size), _next(0) {}
+    virtual rc_t next(w_keystr_t& key, std::string& elem, bool& eof) {
+        eof = (_next == _count);
+        if (!eof) {
+            char keystr[20];
+            padded_row_key(_next, keystr, sizeof(keystr));
+            key.construct_regularkey(keystr, ::strlen(keystr));
+            elem = make_row(_next++, 0);
+            elem.resize(_row_size, '\0');
+        }
+        return RCOK;
+    }
+private:
+    int    _count;
+    size_t _row_size;
+    int    _next;
+};
+
+/**
+ * Updates and overwrites that compress as well as the old value replace it in
+ * place, even on pages without space for the uncompressed value, instead of
+ * removing and inserting the record.
+ */
+w_rc_t compressed_values_in_place(ss_m* ssm, test_volume_t *) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(create_compressed_index(ssm, stid, root_pid));
+
+    // the bulk load fills each leaf until an uncompressed row does not fit
+    const int count = 3000;
+    const size_t row_size = 1000;
+    padded_rows_iterator iter(count, row_size);
+    W_DO(ssm->begin_xct());
+    W_DO(ssm->bulk_load(stid, iter));
+    W_DO(ssm->commit_xct());
+
+    row_map_t rows;
+    char keystr[20];
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+    W_DO(ssm->begin_xct());
+    test_env->set_xct_query_lock();
+    for (int i = 0; i < count; ++i) {
+        padded_row_key(i, keystr, sizeof(keystr));
+        w_keystr_t key;
+        key.construct_regularkey(keystr, ::strlen(keystr));
+        std::string row = make_row(i, i % 2);
+        row.resize(row_size, '\0');
+        if (i % 2) {
+            W_DO(ssm->update_assoc(stid, key, vec_t(row.data(), row.size())));
+        } else {
+            const char patch[] = "NAME";
+            smsize_t len = 4;
+            W_DO(ssm->overwrite_assoc(stid, key, patch, 12, len));
+            row.replace(12, 4, patch, 4);
+        }
+        rows[keystr] = row;
+    }
+    W_DO(ssm->commit_xct());
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+
+    size_t remove_id = enum_to_base(sm_stat_id::bt_remove_cnt);
+    long removed = after[remove_id] - before[remove_id];
+    EXPECT_EQ(0, removed);
+    W_DO(compressed_values_check(ssm, stid, rows));
+    return RCOK;
+}
+
+TEST (BtreeBasicTest, CompressedValuesInPlace) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(compressed_values_in_place), 0);
+}
+
+TEST (BtreeBasicTest, CompressedValuesInPlaceLock) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(compressed_values_in_place, true), 0);
+}
+
+/** Inserts into compressed pages are redone from the logged, uncompressed values. */
+class compressed_values_crash : public restart_test_base {
+public:
+    w_rc_t pre_shutdown(ss_m *ssm) {
+        _stid_list = new StoreID[1];
+        W_DO(create_compressed_index(ssm, _stid_list[0], _root_pid));
+        W_DO(compressed_values_load(ssm, _stid_list[0], 2000, _rows));
+        return RCOK;
+    }
+
+    w_rc_t post_shutdown(ss_m *ssm) {
+        return compressed_values_check(ssm, _stid_list[0], _rows);
+    }
+
+    row_map_t _rows;
+};
+
+TEST (BtreeBasicTest, CompressedValuesCrash) {
+    test_env->empty_logdata_dir();
+    compressed_values_crash context;
+    restart_test_options options;
+    options.shutdown_mode = simulated_crash;
+    EXPECT_EQ(test_env->runRestartTest(&context, &options), 0);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     test_env = new btree_test_env();
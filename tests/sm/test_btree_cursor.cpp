@@ -3,6 +3,11 @@
 #include "sm_vas.h"
 #include "btree.h"
 #include "btcursor.h"
+#include "btree_impl.h"
+#include "btree_page_h.h"
+
+#include <chrono>
+#include <vector>
 
 btree_test_env *test_env;
 
@@ -385,6 +390,251 @@ TEST (BtreeCursorTest, SpanPagesLock) {
     EXPECT_EQ(test_env->runBtreeTest(span_pages, true), 0);
 }
 
+sm_options make_readahead_options(int window) {
+    sm_options options;
+    options.set_int_option("sm_bf_readahead_window", window);
+    return options;
+}
+TEST (BtreeCursorTest, SpanPagesReadAhead) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(span_pages, false, make_readahead_options(4)), 0);
+}
+TEST (BtreeCursorTest, SpanPagesReadAheadLock) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(span_pages, true, make_readahead_options(1)), 0);
+}
+
+const int BATCH_RECORDS = 5000;
+
+std::string keystr_of (const w_keystr_t &key) {
+    return std::string((const char*) key.buffer_as_keystr(), key.get_length_as_keystr());
+}
+
+w_rc_t prep_batch_test(ss_m* ssm, test_volume_t *test_volume, StoreID &stid) {
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+    char keystr[7];
+    char datastr[101];
+    ::memset (datastr, 'a', 100);
+    datastr[100] = '\0';
+    W_DO(test_env->begin_xct());
+    for (int i = 0; i < BATCH_RECORDS; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "k%05d", i);
+        ::memcpy(datastr, keystr, 6);
+        W_DO(test_env->btree_insert(stid, keystr, datastr));
+    }
+    W_DO(test_env->commit_xct());
+    return RCOK;
+}
+
+// reads the whole range with next() and with next_batch(), which must agree
+rc_t check_batch_result (StoreID stid, const w_keystr_t &lower, bool lower_inclusive,
+                         const w_keystr_t &upper, bool upper_inclusive, bool forward,
+                         size_t batch) {
+    std::vector<std::string> expected;
+    {
+        bt_cursor_t cursor (stid, lower, lower_inclusive, upper, upper_inclusive, forward);
+        while (true) {
+            W_DO(cursor.next());
+            if (cursor.eof()) {
+                break;
+            }
+            expected.push_back(keystr_of(cursor.key()) + get_dat(cursor));
+        }
+    }
+
+    std::vector<char> buffer(SM_PAGESIZE);
+    std::vector<bt_cursor_rec_t> recs(batch);
+    std::vector<std::string> actual;
+    bt_cursor_t cursor (stid, lower, lower_inclusive, upper, upper_inclusive, forward);
+    while (true) {
+        size_t count;
+        W_DO(cursor.next_batch(batch, &buffer[0], buffer.size(), &recs[0], count));
+        if (count == 0) {
+            EXPECT_TRUE(cursor.eof());
+            break;
+        }
+        EXPECT_LE(count, batch);
+        for (size_t i = 0; i < count; ++i) {
+            w_keystr_t key;
+            key.construct_from_keystr(recs[i].key, recs[i].klen);
+            actual.push_back(keystr_of(key) + std::string(recs[i].elem, recs[i].elen));
+        }
+        w_keystr_t last;
+        last.construct_from_keystr(recs[count - 1].key, recs[count - 1].klen);
+        EXPECT_EQ(last, cursor.key());
+    }
+    EXPECT_EQ(expected.size(), actual.size());
+    EXPECT_TRUE(expected == actual);
+    return RCOK;
+}
+
+w_rc_t batch_scan(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    W_DO(prep_batch_test(ssm, test_volume, stid));
+
+    W_DO(test_env->begin_xct());
+    for (int forward = 0; forward < 2; ++forward) {
+        SCOPED_TRACE(forward ? "forward" : "backward");
+        W_DO(check_batch_result(stid, neginf_key(), true, posinf_key(), true, forward, 64));
+        W_DO(check_batch_result(stid, neginf_key(), true, posinf_key(), true, forward, 1));
+        W_DO(check_batch_result(stid, reg_key("k01000"), true, reg_key("k03000"), true,
+                                forward, 50));
+        W_DO(check_batch_result(stid, reg_key("k01000"), false, reg_key("k03000"), false,
+                                forward, 1000));
+        W_DO(check_batch_result(stid, reg_key("k009995"), true, reg_key("k01005"), true,
+                                forward, 7));
+    }
+
+    // too small a buffer: the record is still returned like by next()
+    bt_cursor_t cursor (stid, true);
+    char small[20];
+    bt_cursor_rec_t rec;
+    size_t count;
+    rc_t rc = cursor.next_batch(1, small, sizeof(small), &rec, count);
+    EXPECT_EQ(eRECWONTFIT, rc.err_num());
+    EXPECT_EQ(0U, count);
+    EXPECT_EQ(reg_key("k00000"), cursor.key());
+    EXPECT_EQ(100, cursor.elen());
+    W_DO(test_env->commit_xct());
+    return RCOK;
+}
+
+TEST (BtreeCursorTest, BatchScan) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(batch_scan), 0);
+}
+TEST (BtreeCursorTest, BatchScanLock) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(batch_scan, true), 0);
+}
+
+// the cursor moves to a foster child without traversing from the root
+w_rc_t batch_scan_foster(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    W_DO(prep_batch_test(ssm, test_volume, stid));
+
+    W_DO(test_env->begin_xct());
+    bt_cursor_t cursor (stid, true);
+    W_DO(cursor.next());
+    EXPECT_EQ(reg_key("k00000"), cursor.key());
+
+    // split the first leaf while the cursor is on it
+    {
+        btree_page_h leaf;
+        W_DO(btree_impl::_ux_traverse(stid, reg_key("k00000"), btree_impl::t_fence_contain,
+                                      LATCH_EX, leaf));
+        PageID new_pid;
+        W_DO(btree_impl::_sx_split_foster(leaf, new_pid, reg_key("k00000")));
+        EXPECT_NE(0U, leaf.get_foster());
+    }
+
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+    std::vector<char> buffer(SM_PAGESIZE);
+    std::vector<bt_cursor_rec_t> recs(100);
+    int expected = 1;
+    char keystr[7];
+    while (true) {
+        size_t count;
+        W_DO(cursor.next_batch(recs.size(), &buffer[0], buffer.size(), &recs[0], count));
+        if (count == 0) {
+            break;
+        }
+        for (size_t i = 0; i < count; ++i, ++expected) {
+            ::snprintf(keystr, sizeof(keystr), "k%05d", expected);
+            w_keystr_t key;
+            key.construct_from_keystr(recs[i].key, recs[i].klen);
+            EXPECT_EQ(reg_key(keystr), key);
+        }
+    }
+    EXPECT_EQ(BATCH_RECORDS, expected);
+    W_DO(check_batch_result(stid, neginf_key(), true, posinf_key(), true, false, 64));
+    W_DO(test_env->commit_xct());
+
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    size_t moves = enum_to_base(sm_stat_id::bt_cursor_foster_moves);
+    EXPECT_GE(after[moves] - before[moves], 1);
+    W_DO(x_btree_verify(ssm, stid));
+    return RCOK;
+}
+
+TEST (BtreeCursorTest, BatchScanFoster) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(batch_scan_foster), 0);
+}
+TEST (BtreeCursorTest, BatchScanFosterLock) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(batch_scan_foster, true), 0);
+}
+
+typedef std::chrono::high_resolution_clock bench_clock;
+
+double elapsed_usec(bench_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            bench_clock::now() - start).count() / 1000.0;
+}
+
+/** Compares full scans with next() and next_batch() in both directions. */
+w_rc_t batch_scan_bench(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    W_DO(prep_batch_test(ssm, test_volume, stid));
+
+    const int ROUNDS = 20;
+    std::vector<char> buffer(SM_PAGESIZE);
+    std::vector<bt_cursor_rec_t> recs(256);
+    W_DO(test_env->begin_xct());
+    for (int forward = 1; forward >= 0; --forward) {
+        size_t rows = 0;
+        auto start = bench_clock::now();
+        for (int r = 0; r < ROUNDS; ++r) {
+            bt_cursor_t cursor (stid, forward);
+            while (true) {
+                W_DO(cursor.next());
+                if (cursor.eof()) {
+                    break;
+                }
+                ++rows;
+            }
+        }
+        double next_usec = elapsed_usec(start);
+        EXPECT_EQ((size_t) ROUNDS * BATCH_RECORDS, rows);
+
+        rows = 0;
+        start = bench_clock::now();
+        for (int r = 0; r < ROUNDS; ++r) {
+            bt_cursor_t cursor (stid, forward);
+            while (true) {
+                size_t count;
+                W_DO(cursor.next_batch(recs.size(), &buffer[0], buffer.size(),
+                                       &recs[0], count));
+                if (count == 0) {
+                    break;
+                }
+                rows += count;
+            }
+        }
+        double batch_usec = elapsed_usec(start);
+        EXPECT_EQ((size_t) ROUNDS * BATCH_RECORDS, rows);
+
+        std::cout << (forward ? "forward" : "backward") << " scan of " << rows << " records: "
+            << "next() " << next_usec * 1000 / rows << " nsec/record, "
+            << "next_batch() " << batch_usec * 1000 / rows << " nsec/record" << std::endl;
+    }
+    W_DO(test_env->commit_xct());
+    return RCOK;
+}
+
+TEST (BtreeCursorTest, BatchScanBench) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(batch_scan_bench), 0);
+}
+TEST (BtreeCursorTest, BatchScanBenchLock) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(batch_scan_bench, true), 0);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     test_env = new btree_test_env();
@@ -5,6 +5,10 @@
 #include "btree.h"
 #include "btcursor.h"
 #include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
 
 btree_test_env *test_env;
 
@@ -92,6 +96,97 @@ TEST (BtreeBasicTest2, DoSomeLock) {
     EXPECT_EQ(test_env->runBtreeTest(dosome, true, make_options()), 0);
 }
 
+/* Hypothesis: Splitting at the edge of sequential insertions (instead of in
+ *  the middle) leaves full pages behind, so that ascending or descending keys
+ *  need fewer pages than random keys rather than twice as many.
+ *
+ * Measure: pages of the tree, throughput
+ */
+enum insert_order_t { ascending, descending, random_order };
+
+size_t ordered_pages[3];
+
+w_rc_t insert_ordered(ss_m* ssm, test_volume_t *test_volume, insert_order_t order) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    const int records = 100000;
+    std::vector<int> keys(records);
+    for (int i = 0; i < records; ++i) {
+        keys[i] = order == descending ? records - 1 - i : i;
+    }
+    if (order == random_order) {
+        std::mt19937 rng(12345);
+        std::shuffle(keys.begin(), keys.end(), rng);
+    }
+
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    char keystr[16];
+    const char datastr[] = "data-data-data-data";
+    vec_t data(datastr, sizeof(datastr));
+    w_keystr_t key;
+    W_DO(ssm->begin_xct());
+    test_env->set_xct_query_lock();
+    for (int i = 0; i < records; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "k%08d", keys[i]);
+        key.construct_regularkey(keystr, ::strlen(keystr));
+        W_DO(ssm->create_assoc(stid, key, data));
+        if (i % 500 == 499) {
+            W_DO(ssm->commit_xct());
+            W_DO(ssm->begin_xct());
+            test_env->set_xct_query_lock();
+        }
+    }
+    W_DO(ssm->commit_xct());
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    size_t edge_splits = enum_to_base(sm_stat_id::bt_edge_splits);
+
+    uint64_t page_count;
+    W_DO(ssm->touch_index(stid, page_count));
+    ordered_pages[order] = page_count;
+    cout << "order " << order << ": " << page_count << " pages, "
+        << (after[edge_splits] - before[edge_splits]) << " edge splits, "
+        << (records / seconds) << " inserts/sec" << endl;
+    if (order != random_order) {
+        EXPECT_GT(after[edge_splits] - before[edge_splits], 0U);
+    }
+
+    x_btree_scan_result s;
+    W_DO(x_btree_scan(ssm, stid, s, test_env->get_use_locks()));
+    EXPECT_EQ (records, s.rownum);
+    W_DO(x_btree_verify(ssm, stid));
+    return RCOK;
+}
+
+w_rc_t insert_ascending(ss_m* ssm, test_volume_t *test_volume) {
+    return insert_ordered(ssm, test_volume, ascending);
+}
+w_rc_t insert_descending(ss_m* ssm, test_volume_t *test_volume) {
+    return insert_ordered(ssm, test_volume, descending);
+}
+w_rc_t insert_random(ss_m* ssm, test_volume_t *test_volume) {
+    return insert_ordered(ssm, test_volume, random_order);
+}
+
+TEST (BtreeBasicTest2, SequentialFillFactor) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(insert_random, false, make_options()), 0);
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(insert_ascending, false, make_options()), 0);
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(insert_descending, false, make_options()), 0);
+    // random insertions fill pages about 70%, edge splits almost 100%
+    // (but pages split off at the right edge can't truncate a prefix as
+    // long as their high fence is infinity)
+    EXPECT_LT(ordered_pages[ascending], ordered_pages[random_order]);
+    EXPECT_LT(ordered_pages[descending], ordered_pages[random_order]);
+}
 
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
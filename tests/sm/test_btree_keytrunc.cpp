@@ -4,6 +4,7 @@
 #include "btree.h"
 #include "btree_page_h.h"
 #include "btree_impl.h"
+#include "btree_bulk_load.h"
 #include "w_key.h"
 
 btree_test_env *test_env;
@@ -290,6 +291,157 @@ TEST (BtreeKeyTruncTest, Lock) {
     EXPECT_EQ(test_env->runBtreeTest(prefix_test, true), 0);
 }
 
+/** Shape of a B-tree, collected by walking all its pages. */
+struct tree_shape_t {
+    tree_shape_t() : height(0), nodes(0), node_entries(0), separator_bytes(0),
+        leaves(0), leaf_prefix_bytes(0), leaves_with_longest_prefix(0), leaves_with_fences(0) {}
+    int    height;
+    size_t nodes;
+    size_t node_entries;       // including pid0
+    size_t separator_bytes;    // of the separator keys in nodes, with prefix
+    size_t leaves;
+    size_t leaf_prefix_bytes;
+    size_t leaves_with_longest_prefix; // prefix as long as fences allow
+    size_t leaves_with_fences;         // with finite low and high fences
+};
+
+w_rc_t collect_tree_shape(btree_page_h &page, tree_shape_t &shape) {
+    if (page.is_leaf()) {
+        ++shape.leaves;
+        shape.leaf_prefix_bytes += page.get_prefix_length();
+        if (!page.is_fence_low_infimum() && !page.is_fence_high_supremum()) {
+            w_keystr_t low, high;
+            page.copy_fence_low_key(low);
+            page.copy_fence_high_key(high);
+            ++shape.leaves_with_fences;
+            w_keystr_len_t prefix_len = page.get_prefix_length();
+            if (prefix_len == low.common_leading_bytes(high)) {
+                ++shape.leaves_with_longest_prefix;
+            }
+        }
+    } else {
+        ++shape.nodes;
+        shape.node_entries += page.nrecs() + 1;
+        for (slotid_t slot = 0; slot < page.nrecs(); ++slot) {
+            w_keystr_t key;
+            page.get_key(slot, key);
+            shape.separator_bytes += key.get_length_as_nonkeystr();
+        }
+        for (slotid_t slot = -1; slot < page.nrecs(); ++slot) {
+            btree_page_h child;
+            W_DO(child.fix_nonroot(page, slot < 0 ? page.pid0_opaqueptr()
+                                   : page.child_opaqueptr(slot), LATCH_SH));
+            W_DO(collect_tree_shape(child, shape));
+        }
+    }
+    if (page.get_foster() != 0) {
+        btree_page_h foster;
+        W_DO(foster.fix_nonroot(page, page.get_foster_opaqueptr(), LATCH_SH));
+        W_DO(collect_tree_shape(foster, shape));
+    }
+    return RCOK;
+}
+
+// long string keys with a common head, e.g., "customer/name/.../00001234/..."
+const int fanout_keysize = 200;
+const int fanout_keys = 3000;
+void make_fanout_key(int i, w_keystr_t &key) {
+    char keystr[fanout_keysize];
+    ::memset(keystr, 'h', fanout_keysize);
+    ::memcpy(keystr, "customer/name/", 14);
+    char number[9];
+    ::snprintf(number, sizeof(number), "%08d", i);
+    ::memcpy(keystr + 40, number, 8);
+    ::memset(keystr + 48, 'a' + (i % 26), fanout_keysize - 48);
+    key.construct_regularkey(keystr, fanout_keysize);
+}
+
+class fanout_iterator : public bulk_load_iterator {
+public:
+    fanout_iterator() : _next(0) {}
+    virtual rc_t next(w_keystr_t& key, std::string& elem, bool& eof) {
+        eof = (_next == fanout_keys);
+        if (!eof) {
+            make_fanout_key(_next++, key);
+            elem = "dat";
+        }
+        return RCOK;
+    }
+private:
+    int _next;
+};
+
+w_rc_t check_fanout(ss_m* ssm, StoreID stid, const char* how) {
+    W_DO(x_btree_verify(ssm, stid));
+
+    tree_shape_t shape;
+    {
+        btree_page_h root_p;
+        W_DO (root_p.fix_root (stid, LATCH_SH));
+        shape.height = root_p.level();
+        W_DO(collect_tree_shape(root_p, shape));
+    }
+    EXPECT_GT(shape.nodes, 0U);
+    if (shape.nodes == 0) {
+        return RCOK;
+    }
+
+    // without truncation, every separator would be a whole key. Then a node
+    // could hold only this many of them:
+    const size_t full_key_fanout = SM_PAGESIZE / (fanout_keysize + sizeof(PageID) + sizeof(lsn_t));
+    size_t height_before = 1;
+    for (size_t pages = shape.leaves; pages > 1; pages = (pages + full_key_fanout - 1) / full_key_fanout) {
+        ++height_before;
+    }
+    double separator_length = (double) shape.separator_bytes / (shape.node_entries - shape.nodes);
+    double fanout = (double) shape.node_entries / shape.nodes;
+    cout << how << ": " << shape.leaves << " leaves, height before truncation="
+        << height_before << ", after=" << shape.height
+        << ". separator length before=" << fanout_keysize << ", after=" << separator_length
+        << ". fan-out (max) before=" << full_key_fanout << ", after (avg)=" << fanout
+        << ". leaf prefix length avg=" << (shape.leaf_prefix_bytes / shape.leaves)
+        << endl;
+
+    // 40 bytes of common head and a few more to distinguish the numbers
+    EXPECT_LT(separator_length, 50);
+    EXPECT_GT(fanout, full_key_fanout * 2);
+    EXPECT_LT((size_t) shape.height, height_before);
+    // every leaf truncates the prefix its fence keys share
+    EXPECT_EQ(shape.leaves_with_fences, shape.leaves_with_longest_prefix);
+    EXPECT_GE(shape.leaf_prefix_bytes / shape.leaves, 40U);
+    return RCOK;
+}
+
+w_rc_t fanout_test(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    // insert in scattered order, so that splits happen everywhere
+    W_DO(test_env->begin_xct());
+    w_keystr_t key;
+    for (int i = 0; i < fanout_keys; ++i) {
+        make_fanout_key((i * 7919) % fanout_keys, key);
+        W_DO(ssm->create_assoc(stid, key, vec_t("dat", 3)));
+    }
+    W_DO(test_env->commit_xct());
+    W_DO(check_fanout(ssm, stid, "inserted"));
+
+    StoreID stid2;
+    W_DO(x_btree_create_index(ssm, test_volume, stid2, root_pid));
+    W_DO(test_env->begin_xct());
+    fanout_iterator iter;
+    W_DO(ssm->bulk_load(stid2, iter));
+    W_DO(test_env->commit_xct());
+    W_DO(check_fanout(ssm, stid2, "bulk loaded"));
+    return RCOK;
+}
+
+TEST (BtreeKeyTruncTest, Fanout) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(fanout_test), 0);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     test_env = new btree_test_env();
@@ -5,6 +5,9 @@
 #include "btcursor.h"
 #include "btree_page_h.h"
 
+#include <chrono>
+#include <vector>
+
 btree_test_env *test_env;
 
 /**
@@ -231,6 +234,171 @@ TEST (BtreePTest, SearchLeafLong2) {
     EXPECT_EQ(test_env->runBtreeTest(test_search_leaf_long2), 0);
 }
 
+/**
+ * Microbenchmark of btree_page_h::search() with each instruction set usable
+ * for comparing poor man's keys, on a leaf and on an interior node. Also
+ * checks that all of them find the same slots.
+ */
+typedef std::chrono::high_resolution_clock bench_clock;
+
+const int SEARCH_ROUNDS = 200;
+
+void bench_page_search(const btree_page_h& page, const std::vector<w_keystr_t>& keys,
+                       const char* page_kind) {
+    const btree_page_data::poor_search_isa_t isas[] = {
+        btree_page_data::POOR_SEARCH_SCALAR,
+        btree_page_data::POOR_SEARCH_SSE2,
+        btree_page_data::POOR_SEARCH_AVX2
+    };
+    const char* isa_names[] = { "scalar", "sse2", "avx2" };
+    btree_page_data::poor_search_isa_t default_isa = btree_page_data::get_poor_search_isa();
+
+    std::vector<slotid_t> expected;
+    for (btree_page_data::poor_search_isa_t isa : isas) {
+        if (btree_page_data::set_poor_search_isa(isa) != isa) {
+            continue; // not supported by this CPU
+        }
+        std::vector<slotid_t> slots;
+        size_t found_cnt = 0;
+        auto start = bench_clock::now();
+        for (int r = 0; r < SEARCH_ROUNDS; r++) {
+            slots.clear();
+            for (const w_keystr_t& key : keys) {
+                bool found;
+                slotid_t slot;
+                page.search(key, found, slot);
+                found_cnt += found;
+                slots.push_back(slot);
+            }
+        }
+        double nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            bench_clock::now() - start).count();
+
+        if (expected.empty()) {
+            expected = slots;
+        }
+        EXPECT_TRUE(expected == slots) << isa_names[isa];
+        std::cout << page_kind << " search (" << page.nrecs() << " records), "
+            << isa_names[isa] << ": " << nsec / (SEARCH_ROUNDS * keys.size())
+            << " nsec/search, " << found_cnt / SEARCH_ROUNDS << " found" << std::endl;
+    }
+    btree_page_data::set_poor_search_isa(default_isa);
+}
+
+w_rc_t test_search_bench(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    // short keys with a common prefix, so that poor man's keys often tie
+    char keystr[9];
+    std::vector<w_keystr_t> keys;
+    for (int i = 0; i < 4000; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "key%05d", i);
+        w_keystr_t key;
+        key.construct_regularkey(keystr, 8);
+        keys.push_back(key);
+        if (i % 2 == 0) {
+            W_DO(x_btree_insert_and_commit(ssm, stid, keystr, "d"));
+        }
+    }
+
+    btree_page_h root;
+    W_DO(root.fix_root(stid, LATCH_SH));
+    EXPECT_FALSE(root.is_leaf());
+    bench_page_search(root, keys, "node");
+
+    // the leaf with most records
+    btree_page_h leaf;
+    for (slotid_t i = -1; i < root.nrecs(); ++i) {
+        btree_page_h child;
+        W_DO(child.fix_nonroot(root, i == -1 ? root.pid0_opaqueptr()
+                                             : root.child_opaqueptr(i), LATCH_SH));
+        if (child.is_leaf() && (!leaf.is_fixed() || child.nrecs() > leaf.nrecs())) {
+            leaf = child;
+        }
+    }
+    EXPECT_TRUE(leaf.is_fixed());
+
+    std::vector<w_keystr_t> leaf_keys;
+    for (const w_keystr_t& key : keys) {
+        if (leaf.fence_contains(key)) {
+            leaf_keys.push_back(key);
+        }
+    }
+    bench_page_search(leaf, leaf_keys, "leaf");
+    return RCOK;
+}
+
+TEST (BtreePTest, SearchBench) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(test_search_bench), 0);
+}
+
+/**
+ * Composite keys like TPC-C's order lines (warehouse, district, order, line
+ * number): the first bytes differ only across warehouses, so 2-byte poor
+ * man's keys rarely decide comparisons while 8-byte ones often do.
+ */
+w_rc_t test_poor_key_width(ss_m* ssm, test_volume_t *test_volume, int width,
+                           size_t& full_compares) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid, width));
+
+    char keystr[25];
+    for (int i = 0; i < 2000; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "%06d%06d%06d%06d", 1, i / 200, i / 10, i % 10);
+        W_DO(x_btree_insert_and_commit(ssm, stid, keystr, "data"));
+    }
+
+    btree_page_h root;
+    W_DO(root.fix_root(stid, LATCH_SH));
+    EXPECT_EQ(width, root.get_poor_key_width());
+    root.unfix();
+
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+    std::string data;
+    for (int i = 0; i < 2000; ++i) {
+        ::snprintf(keystr, sizeof(keystr), "%06d%06d%06d%06d", 1, i / 200, i / 10, i % 10);
+        W_DO(x_btree_lookup_and_commit(ssm, stid, keystr, data));
+        EXPECT_EQ(std::string("data"), data);
+    }
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    size_t compares = enum_to_base(sm_stat_id::bt_full_key_compares);
+    full_compares = after[compares] - before[compares];
+    std::cout << "poor man's key width " << width << ": " << full_compares
+        << " full key comparisons in 2000 lookups" << std::endl;
+
+    W_DO(x_btree_verify(ssm, stid));
+    return RCOK;
+}
+
+size_t full_compares_width2, full_compares_width8;
+
+w_rc_t test_poor_key_width2(ss_m* ssm, test_volume_t *test_volume) {
+    return test_poor_key_width(ssm, test_volume, 2, full_compares_width2);
+}
+w_rc_t test_poor_key_width4(ss_m* ssm, test_volume_t *test_volume) {
+    size_t full_compares;
+    return test_poor_key_width(ssm, test_volume, 4, full_compares);
+}
+w_rc_t test_poor_key_width8(ss_m* ssm, test_volume_t *test_volume) {
+    return test_poor_key_width(ssm, test_volume, 8, full_compares_width8);
+}
+
+TEST (BtreePTest, PoorKeyWidth) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(test_poor_key_width2), 0);
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(test_poor_key_width4), 0);
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(test_poor_key_width8), 0);
+    EXPECT_LT(full_compares_width8, full_compares_width2);
+}
+
 // TODO more and more testcases here
 
 int main(int argc, char **argv) {
@@ -1,6 +1,8 @@
 #include "btree_test_env.h"
 #include "btree.h"
 #include "btree_impl.h"
+#include "btree_page_h.h"
+#include "bf_tree.h"
 #include "xct.h"
 
 btree_test_env *test_env;
@@ -27,6 +29,24 @@ TEST (BtreeVerificationTest, ContextSimple) {
     EXPECT_FALSE (context.is_bitmap_clean());
 }
 
+TEST (BtreeVerificationTest, ContextMerge) {
+    // like two threads that verify different parts of a BTree
+    verification_context context1 (15), context2 (15);
+    context1.add_expectation(100, 2, true, 5, "abcde");
+    context1._pages_checked = 1;
+    context2.add_fact(100, 2, true, 5, "abcde");
+    context2.add_expectation(101, 1, false, 5, "vvvdd");
+    context2._pages_checked = 2;
+    EXPECT_FALSE (context1.is_bitmap_clean());
+    EXPECT_FALSE (context2.is_bitmap_clean());
+
+    context1.merge(context2);
+    EXPECT_FALSE (context1.is_bitmap_clean());
+    EXPECT_EQ (context1._pages_checked, 3);
+    context1.add_fact(101, 1, false, 5, "vvvdd");
+    EXPECT_TRUE (context1.is_bitmap_clean());
+}
+
 TEST (BtreeVerificationTest, ContextLevel) {
     verification_context context (15);
     EXPECT_TRUE (context.is_bitmap_clean());
@@ -552,6 +572,143 @@ TEST (BtreeVerificationTest, InQueryVerifyLock) {
     EXPECT_EQ(test_env->runBtreeTest(inquery_verify, true, default_locktable_size, 512, 64), 0);
 }
 
+const int verify_parallel_count = 4000;
+
+w_rc_t verify_parallel_load(ss_m* ssm, StoreID stid) {
+    // long keys, so that the tree has 3 levels
+    const int count = verify_parallel_count;
+    char keystr[201];
+    memset(keystr, 'k', 200);
+    keystr[200] = '\0';
+    char datastr[100];
+    memset(datastr, 'd', 100);
+    vec_t data(datastr, 100);
+    W_DO(ssm->begin_xct());
+    test_env->set_xct_query_lock();
+    for (int i = 0; i < count; ++i) {
+        ::snprintf(keystr + 190, 11, "%010d", (i * 7919) % count);
+        w_keystr_t key;
+        key.construct_regularkey(keystr, 200);
+        W_DO(ssm->create_assoc(stid, key, data));
+    }
+    W_DO(ssm->commit_xct());
+    // leave some ghosts
+    W_DO(ssm->begin_xct());
+    test_env->set_xct_query_lock();
+    for (int i = 0; i < count; i += 10) {
+        ::snprintf(keystr + 190, 11, "%010d", i);
+        w_keystr_t key;
+        key.construct_regularkey(keystr, 200);
+        W_DO(ssm->destroy_assoc(stid, key));
+    }
+    W_DO(ssm->commit_xct());
+    return RCOK;
+}
+
+/** Checks that the parallel verification and statistics agree with the serial ones. */
+w_rc_t verify_parallel_check(ss_m* ssm, StoreID stid, PageID root_pid) {
+    const int count = verify_parallel_count;
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+    btree_stats_t serial;
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        bool consistent = false;
+        btree_stats_t stats;
+        W_DO(btree_impl::_ux_verify_tree_parallel(stid, 19, threads, consistent, &stats));
+        EXPECT_TRUE(consistent) << threads << " threads";
+        EXPECT_EQ(stats.audit().err_num(), w_error_ok) << threads << " threads";
+        EXPECT_EQ(count - count / 10, (int) stats.leaf_pg.entry_cnt);
+        EXPECT_EQ(3, (int) stats.level_cnt);
+        if (threads == 1) {
+            serial = stats;
+        } else {
+            EXPECT_EQ(serial.leaf_pg_cnt, stats.leaf_pg_cnt);
+            EXPECT_EQ(serial.int_pg_cnt, stats.int_pg_cnt);
+            EXPECT_EQ(serial.leaf_pg.key_bs, stats.leaf_pg.key_bs);
+            EXPECT_EQ(serial.leaf_pg.unused_bs, stats.leaf_pg.unused_bs);
+            EXPECT_EQ(serial.int_pg.used_bs, stats.int_pg.used_bs);
+        }
+    }
+    cout << serial;
+    // pages that were not in the bufferpool were not loaded into it,
+    // unless restart still had to redo them
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+    size_t misses = enum_to_base(sm_stat_id::bf_fix_nonroot_miss_count);
+    EXPECT_LT((after[misses] - before[misses]) * 10, serial.alloc_pg_cnt());
+
+    uint64_t page_count;
+    W_DO(ssm->touch_index(stid, page_count));
+    EXPECT_EQ(page_count, (uint64_t) serial.alloc_pg_cnt());
+
+    btree_stats_t stats;
+    W_DO(ssm->get_du_statistics(stid, stats, true));
+    EXPECT_EQ(serial.leaf_pg_cnt, stats.leaf_pg_cnt);
+    bool consistent = false;
+    W_DO(ssm->verify_index(stid, 19, consistent));
+    EXPECT_TRUE(consistent);
+
+    verify_volume_result result;
+    W_DO(ssm->verify_volume(19, result));
+    verification_context *context = result.get_context(root_pid);
+    EXPECT_TRUE (context != NULL);
+    if (context != NULL) {
+        EXPECT_EQ ((int) page_count, context->_pages_checked);
+        EXPECT_EQ (0, context->_pages_inconsistent);
+        EXPECT_TRUE (context->is_bitmap_clean());
+    }
+    return RCOK;
+}
+
+w_rc_t verify_parallel(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+    W_DO(verify_parallel_load(ssm, stid));
+    return verify_parallel_check(ssm, stid, root_pid);
+}
+
+TEST (BtreeVerificationTest, VerifyParallel) {
+    test_env->empty_logdata_dir();
+    sm_options options;
+    options.set_int_option("sm_btree_verify_threads", 4);
+    EXPECT_EQ(test_env->runBtreeTest(verify_parallel, options), 0);
+}
+TEST (BtreeVerificationTest, VerifyParallelSwizzle) {
+    test_env->empty_logdata_dir();
+    sm_options options;
+    options.set_int_option("sm_btree_verify_threads", 4);
+    options.set_bool_option("sm_bufferpool_swizzle", true);
+    EXPECT_EQ(test_env->runBtreeTest(verify_parallel, options), 0);
+}
+
+/** After a restart, the pages of the tree are read without caching them. */
+class verify_parallel_restart : public restart_test_base {
+public:
+    w_rc_t pre_shutdown(ss_m *ssm) {
+        _stid_list = new StoreID[1];
+        W_DO(x_btree_create_index(ssm, &_volume, _stid_list[0], _root_pid));
+        W_DO(verify_parallel_load(ssm, _stid_list[0]));
+        // so that restart has nothing to redo
+        smlevel_0::bf->wakeup_cleaner(true, 1);
+        return ssm->checkpoint();
+    }
+
+    w_rc_t post_shutdown(ss_m *ssm) {
+        return verify_parallel_check(ssm, _stid_list[0], _root_pid);
+    }
+};
+
+TEST (BtreeVerificationTest, VerifyParallelRestart) {
+    test_env->empty_logdata_dir();
+    verify_parallel_restart context;
+    restart_test_options options;
+    options.shutdown_mode = normal_shutdown;
+    sm_options sm_opts;
+    sm_opts.set_int_option("sm_btree_verify_threads", 4);
+    EXPECT_EQ(test_env->runRestartTest(&context, &options, false, sm_opts), 0);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     test_env = new btree_test_env();
@@ -0,0 +1,152 @@
+#include "btree_test_env.h"
+#include "gtest/gtest.h"
+#include "sm_vas.h"
+#include "btree.h"
+#include "btree_page_h.h"
+#include "log_core.h"
+#include "restart.h"
+
+#include <vector>
+
+btree_test_env *test_env;
+
+/**
+ * Testcases for reading the recovery log in place from mapped partitions
+ * (USE_MMAP): pinned fetches, single-page redo through SprIterator, and
+ * restart with log fetch buffers (sm_log_fetch_buf_partitions).
+ */
+
+const int RECORDS = 2000;
+/** Few enough to stay on the root page */
+const int ROOT_RECORDS = 20;
+
+rc_t insert_records(StoreID stid, int count) {
+    char key[16];
+    for (int i = 0; i < count; ++i) {
+        ::sprintf(key, "key%06d", i);
+        W_DO(ss_m::begin_xct());
+        W_DO(test_env->btree_insert(stid, key, "data"));
+        W_DO(ss_m::commit_xct());
+    }
+    return RCOK;
+}
+
+long fetches() {
+    sm_stats_t stats;
+    W_COERCE(ss_m::gather_stats(stats));
+    return stats[enum_to_base(sm_stat_id::log_fetches)];
+}
+
+#ifdef USE_MMAP
+w_rc_t fetch_pinned(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    W_DO(ss_m::begin_xct());
+    W_DO(test_env->btree_insert(stid, "key1", "data1"));
+    lsn_t commit_lsn;
+    W_DO(ss_m::commit_xct(false, &commit_lsn));
+
+    long fetches_before = fetches();
+    logrec_t* lr;
+    shared_ptr<partition_t> p;
+    W_DO(smlevel_0::log->fetch_pinned(commit_lsn, lr, p));
+    // the record is read in place from the mapping of its partition
+    EXPECT_TRUE(p != nullptr);
+    EXPECT_EQ(commit_lsn.hi(), p->num());
+    EXPECT_EQ(commit_lsn, lr->lsn());
+
+    // what is not durable yet is treated as the end of the log
+    rc_t rc = smlevel_0::log->fetch_pinned(smlevel_0::log->durable_lsn(), lr, p);
+    EXPECT_EQ(eEOF, rc.err_num());
+    EXPECT_EQ(2, fetches() - fetches_before);
+    return RCOK;
+}
+
+TEST (LogFetchBuffersTest, FetchPinned) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(fetch_pinned), 0);
+}
+#endif
+
+w_rc_t spr_iterator(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+    W_DO(insert_records(stid, ROOT_RECORDS));
+
+    btree_page_h root_p;
+    W_DO(root_p.fix_root(stid, LATCH_SH));
+    EXPECT_TRUE(root_p.is_leaf());
+    lsn_t page_lsn = root_p.lsn();
+    root_p.unfix();
+
+    auto partition = smlevel_0::log->get_storage()->get_partition(page_lsn.hi());
+    long unpinned = partition.use_count();
+
+    SprIterator iter;
+    iter.open(root_pid, lsn_t::null, page_lsn);
+#ifdef USE_MMAP
+    // the partition the collected records point into cannot be recycled
+    EXPECT_GT(partition.use_count(), unpinned);
+#endif
+
+    // the per-page chain is replayed from the page image up to the page LSN
+    std::vector<lsn_t> lsns;
+    logrec_t* lr;
+    while (iter.next(lr)) {
+        EXPECT_TRUE(lr->pid() == root_pid || lr->pid2() == root_pid);
+        if (!lsns.empty()) { EXPECT_GT(lr->lsn(), lsns.back()); }
+        lsns.push_back(lr->lsn());
+    }
+    EXPECT_GE(lsns.size(), (size_t) ROOT_RECORDS);
+    EXPECT_EQ(page_lsn, lsns.back());
+    // once replayed, the partition is not held up anymore
+    EXPECT_EQ(unpinned, partition.use_count());
+    return RCOK;
+}
+
+TEST (LogFetchBuffersTest, SprIterator) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(spr_iterator), 0);
+}
+
+/**
+ * Restart with fetch buffers, which are mapped rather than copied with
+ * USE_MMAP, redoes every committed update.
+ */
+class fetch_buffer_crash : public restart_test_base {
+public:
+    w_rc_t pre_shutdown(ss_m *ssm) {
+        _stid_list = new StoreID[1];
+        W_DO(x_btree_create_index(ssm, &_volume, _stid_list[0], _root_pid));
+        W_DO(insert_records(_stid_list[0], RECORDS));
+        return RCOK;
+    }
+
+    w_rc_t post_shutdown(ss_m *) {
+        x_btree_scan_result s;
+        W_DO(test_env->btree_scan(_stid_list[0], s));
+        EXPECT_EQ(RECORDS, s.rownum);
+        EXPECT_EQ(std::string("key000000"), s.minkey);
+        return RCOK;
+    }
+};
+
+TEST (LogFetchBuffersTest, Crash) {
+    test_env->empty_logdata_dir();
+    fetch_buffer_crash context;
+    restart_test_options options;
+    options.shutdown_mode = simulated_crash;
+    sm_options fetch_options;
+    fetch_options.set_int_option("sm_log_fetch_buf_partitions", 2);
+    EXPECT_EQ(test_env->runRestartTest(&context, &options, false, fetch_options), 0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    test_env = new btree_test_env();
+    ::testing::AddGlobalTestEnvironment(test_env);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,134 @@
+#include "btree_test_env.h"
+#include "gtest/gtest.h"
+#include "sm_vas.h"
+#include "btree.h"
+#include "log_core.h"
+#include "thread_wrapper.h"
+
+btree_test_env *test_env;
+
+/**
+ * Testcases for adaptive group commit (sm_group_commit_adaptive).
+ * Light load: a single committer never has company, so its flushes must
+ * not be held. Heavy load: with a slow log device, many committers arrive
+ * during each flush, so flushes are held and serve larger batches.
+ */
+
+const int XCTS = 200;
+const int HEAVY_THREADS = 16;
+const int HEAVY_XCTS_PER_THREAD = 50;
+/** Flush latency emulated under heavy load (sm_log_fake_flush_delay) */
+const int HEAVY_FLUSH_DELAY_US = 5000;
+
+/** Group commit statistics gathered around a workload */
+struct gc_stats_t {
+    long holds;
+    long batch_0;
+    long batch_1;
+    long batch_2_up;
+
+    gc_stats_t(const sm_stats_t& before, const sm_stats_t& after) {
+        holds = delta(before, after, sm_stat_id::log_gc_holds);
+        batch_0 = delta(before, after, sm_stat_id::log_gc_batch_0);
+        batch_1 = delta(before, after, sm_stat_id::log_gc_batch_1);
+        batch_2_up = delta(before, after, sm_stat_id::log_gc_batch_2_7)
+            + delta(before, after, sm_stat_id::log_gc_batch_8_31)
+            + delta(before, after, sm_stat_id::log_gc_batch_32_up);
+    }
+
+    /** Flushes that served at least one commit */
+    long serving_flushes() const { return batch_1 + batch_2_up; }
+
+    static long delta(const sm_stats_t& before, const sm_stats_t& after, sm_stat_id id) {
+        return after[enum_to_base(id)] - before[enum_to_base(id)];
+    }
+};
+
+rc_t insert_and_commit(StoreID stid, int thread, int xcts) {
+    char key[16];
+    for (int x = 0; x < xcts; ++x) {
+        ::sprintf(key, "key%02d%05d", thread, x);
+        W_DO(ss_m::begin_xct());
+        W_DO(test_env->btree_insert(stid, key, "data"));
+        W_DO(ss_m::commit_xct());
+    }
+    return RCOK;
+}
+
+w_rc_t light_load(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    sm_stats_t before, after;
+    W_DO(ss_m::gather_stats(before));
+    W_DO(insert_and_commit(stid, 0, XCTS));
+    W_DO(ss_m::gather_stats(after));
+
+    gc_stats_t gc(before, after);
+    // nobody else commits during a flush, so each one is started right away
+    EXPECT_EQ(0, gc.holds);
+    EXPECT_GT(gc.batch_1, 0);
+    EXPECT_EQ(0, gc.batch_2_up);
+    return RCOK;
+}
+
+TEST (LogGroupCommitTest, LightLoadFlushesImmediately) {
+    test_env->empty_logdata_dir();
+    sm_options options;
+    options.set_bool_option("sm_group_commit_adaptive", true);
+    EXPECT_EQ(test_env->runBtreeTest(light_load, options), 0);
+}
+
+class committer_t : public thread_wrapper_t {
+public:
+    committer_t(StoreID stid, int thread) : _stid(stid), _thread(thread) {}
+    void run() { _rc = insert_and_commit(_stid, _thread, HEAVY_XCTS_PER_THREAD); }
+    StoreID _stid;
+    int _thread;
+    rc_t _rc;
+};
+
+w_rc_t heavy_load(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    sm_stats_t before, after;
+    W_DO(ss_m::gather_stats(before));
+    committer_t* threads[HEAVY_THREADS];
+    for (int t = 0; t < HEAVY_THREADS; ++t) {
+        threads[t] = new committer_t(stid, t);
+        threads[t]->fork();
+    }
+    for (int t = 0; t < HEAVY_THREADS; ++t) {
+        threads[t]->join();
+        EXPECT_FALSE(threads[t]->_rc.is_error()) << threads[t]->_rc;
+        delete threads[t];
+    }
+    W_DO(ss_m::gather_stats(after));
+
+    gc_stats_t gc(before, after);
+    const long commits = HEAVY_THREADS * HEAVY_XCTS_PER_THREAD;
+    EXPECT_GT(gc.holds, 0);
+    // most flushes serve several commits, so there are far fewer of them
+    EXPECT_GT(gc.batch_2_up, gc.batch_1);
+    EXPECT_GT(gc.serving_flushes(), 0);
+    EXPECT_LT(gc.serving_flushes() * 2, commits);
+    return RCOK;
+}
+
+TEST (LogGroupCommitTest, HeavyLoadHoldsAndBatches) {
+    test_env->empty_logdata_dir();
+    sm_options options;
+    options.set_bool_option("sm_group_commit_adaptive", true);
+    options.set_int_option("sm_log_fake_flush_delay", HEAVY_FLUSH_DELAY_US);
+    EXPECT_EQ(test_env->runBtreeTest(heavy_load, options), 0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    test_env = new btree_test_env();
+    ::testing::AddGlobalTestEnvironment(test_env);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,285 @@
+#include "btree_test_env.h"
+#include "gtest/gtest.h"
+#include "sm_vas.h"
+#include "btree.h"
+#include "btcursor.h"
+#include "log_core.h"
+#include "log_storage.h"
+#include "log_consumer.h"
+#include "thread_wrapper.h"
+
+#include <vector>
+
+btree_test_env *test_env;
+
+/**
+ * Testcases for private log buffers (sm_log_private_buffer_size).
+ */
+
+const int64_t PRIVATE_BUFFER_SIZE = 8192;
+const int THREADS = 4;
+const int XCTS_PER_THREAD = 60;
+const int KEYS_PER_XCT = 5;
+
+sm_options private_buffer_options() {
+    sm_options options;
+    options.set_int_option("sm_log_private_buffer_size", PRIVATE_BUFFER_SIZE);
+    return options;
+}
+
+void make_key(int thread, int xct, int i, char* buf) {
+    ::sprintf(buf, "key%02d%04d%02d", thread, xct, i);
+}
+
+/** Every third transaction rolls back, so half of its keys are undone from the log. */
+bool rolls_back(int xct) {
+    return xct % 3 == 2;
+}
+
+rc_t run_private_xcts(StoreID stid, int thread) {
+    char key[16];
+    char data[64];
+    for (int x = 0; x < XCTS_PER_THREAD; ++x) {
+        W_DO(ss_m::begin_xct());
+        for (int i = 0; i < KEYS_PER_XCT; ++i) {
+            make_key(thread, x, i, key);
+            ::memset(data, 'a' + i, sizeof(data));
+            W_DO(test_env->btree_insert(stid, key, std::string(data, 10 + x % 50).c_str()));
+        }
+        if (rolls_back(x)) {
+            W_DO(ss_m::abort_xct());
+        } else {
+            W_DO(ss_m::commit_xct());
+        }
+    }
+    return RCOK;
+}
+
+class private_xct_thread_t : public thread_wrapper_t {
+public:
+    private_xct_thread_t(StoreID stid, int thread)
+        : _stid(stid), _thread(thread) {}
+    void run() {
+        _rc = run_private_xcts(_stid, _thread);
+    }
+    StoreID _stid;
+    int _thread;
+    rc_t _rc;
+};
+
+rc_t check_private_xcts(StoreID stid, int threads) {
+    W_DO(ss_m::begin_xct());
+    char key[16];
+    for (int t = 0; t < threads; ++t) {
+        for (int x = 0; x < XCTS_PER_THREAD; ++x) {
+            for (int i = 0; i < KEYS_PER_XCT; ++i) {
+                make_key(t, x, i, key);
+                std::string data;
+                W_DO(test_env->btree_lookup(stid, key, data));
+                if (rolls_back(x)) {
+                    EXPECT_EQ(std::string(), data) << key;
+                } else {
+                    EXPECT_EQ(std::string(10 + x % 50, 'a' + i), data) << key;
+                }
+            }
+        }
+    }
+    W_DO(ss_m::commit_xct());
+
+    bool consistent;
+    W_DO(ss_m::verify_index(stid, 19, consistent));
+    EXPECT_TRUE(consistent);
+    return RCOK;
+}
+
+long stat_delta(const sm_stats_t& before, const sm_stats_t& after, sm_stat_id id) {
+    return after[enum_to_base(id)] - before[enum_to_base(id)];
+}
+
+/** Runs the transactions of the given number of threads concurrently. */
+void run_threads(StoreID stid, int threads) {
+    std::vector<private_xct_thread_t*> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(new private_xct_thread_t(stid, t));
+        workers.back()->fork();
+    }
+    for (private_xct_thread_t* w : workers) {
+        w->join();
+        EXPECT_FALSE(w->_rc.is_error()) << w->_rc;
+        delete w;
+    }
+}
+
+w_rc_t concurrent_xcts(ss_m* ssm, test_volume_t *test_volume) {
+    EXPECT_TRUE(smlevel_0::log->uses_private_buffers());
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    sm_stats_t before, after;
+    W_DO(ss_m::gather_stats(before));
+    // all threads insert into the same few pages, so chunks often get closed
+    // early to keep the page LSNs increasing
+    run_threads(stid, THREADS);
+    W_DO(ss_m::gather_stats(after));
+
+    // each chunk is reserved with one C-Array join, but holds many records
+    long chunks = stat_delta(before, after, sm_stat_id::log_private_chunks);
+    long inserts = stat_delta(before, after, sm_stat_id::log_inserts);
+    EXPECT_GT(chunks, 0);
+    EXPECT_LT(chunks, inserts);
+    // padding never exceeds the chunks it pads
+    long fill = stat_delta(before, after, sm_stat_id::log_private_fill_bytes);
+    EXPECT_LT(fill, chunks * PRIVATE_BUFFER_SIZE);
+
+    return check_private_xcts(stid, THREADS);
+}
+
+TEST (LogPrivateBufferTest, ConcurrentXcts) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(concurrent_xcts, private_buffer_options()), 0);
+}
+TEST (LogPrivateBufferTest, ConcurrentXctsLock) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(concurrent_xcts, true, private_buffer_options()), 0);
+}
+
+/**
+ * Threads that exit hand their buffers to the threads started after them,
+ * so several rounds of threads allocate only as many buffers as one round.
+ */
+w_rc_t recycled_buffers(ss_m* ssm, test_volume_t *test_volume) {
+    const int ROUNDS = 3;
+    // one index per round, since each round inserts the same keys
+    StoreID stids[ROUNDS];
+    PageID root_pid;
+    for (int r = 0; r < ROUNDS; ++r) {
+        W_DO(x_btree_create_index(ssm, test_volume, stids[r], root_pid));
+    }
+
+    sm_stats_t before, after;
+    W_DO(ss_m::gather_stats(before));
+    for (int r = 0; r < ROUNDS; ++r) {
+        run_threads(stids[r], THREADS);
+    }
+    W_DO(ss_m::gather_stats(after));
+
+    EXPECT_LE(stat_delta(before, after, sm_stat_id::log_private_buffers), THREADS);
+    for (int r = 0; r < ROUNDS; ++r) {
+        W_DO(check_private_xcts(stids[r], THREADS));
+    }
+    return RCOK;
+}
+
+TEST (LogPrivateBufferTest, RecycledBuffers) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(recycled_buffers, private_buffer_options()), 0);
+}
+
+/**
+ * The comment records padding the chunks chain up with the records around
+ * them, so the log can be scanned forward and backward with fetch_direct.
+ * The archiver's scanner (LogConsumer) skips them and returns every other
+ * record it does not ignore, also across block boundaries.
+ */
+w_rc_t scan_padded_log(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+    run_threads(stid, THREADS);
+    W_DO(smlevel_0::log->flush_all());
+
+    std::vector<partition_number_t> partitions;
+    smlevel_0::log->get_storage()->list_partitions(partitions);
+    EXPECT_FALSE(partitions.empty());
+    lsn_t begin(partitions.front(), 0);
+    lsn_t end = smlevel_0::log->durable_lsn();
+
+    // LSNs of all records, and of those the archiver does not ignore
+    std::vector<lsn_t> all, archived;
+    LogScanner ignored(log_storage::BLOCK_SIZE);
+    LogConsumer::initLogScanner(&ignored);
+
+    int comments = 0;
+    logrec_t* lr;
+    lsn_t prev;
+    lsn_t lsn = begin;
+    while (lsn < end) {
+        EXPECT_TRUE(smlevel_0::log->fetch_direct(lsn, lr, prev));
+        EXPECT_EQ(lsn, lr->lsn());
+        all.push_back(lsn);
+        if (lr->type() == logrec_t::t_skip) {
+            lsn = lsn_t(lsn.hi() + 1, 0);
+            continue;
+        }
+        if (lr->type() == logrec_t::t_comment) { comments++; }
+        if (!ignored.isIgnored(lr->type())) { archived.push_back(lsn); }
+        lsn += lr->length();
+    }
+    EXPECT_EQ(end, lsn);
+    EXPECT_GT(comments, 0);
+
+    // backward, following the LSN at the end of each record
+    lsn = all.back();
+    for (auto it = all.rbegin(); it != all.rend(); ++it) {
+        EXPECT_EQ(*it, lsn);
+        EXPECT_TRUE(smlevel_0::log->fetch_direct(lsn, lr, prev));
+        if (lsn == begin) { break; }
+        lsn = prev;
+    }
+    EXPECT_EQ(begin, lsn);
+
+    // small blocks, so that chunks and their padding span block boundaries
+    std::vector<lsn_t> consumed;
+    LogConsumer consumer(begin, log_storage::BLOCK_SIZE);
+    consumer.open(end);
+    while (consumer.next(lr)) {
+        EXPECT_NE(logrec_t::t_comment, lr->type());
+        consumed.push_back(lr->lsn());
+    }
+    consumer.shutdown();
+    EXPECT_EQ(end, consumer.getNextLSN());
+    EXPECT_EQ(archived.size(), consumed.size());
+    EXPECT_TRUE(archived == consumed);
+
+    return check_private_xcts(stid, THREADS);
+}
+
+TEST (LogPrivateBufferTest, ScanPaddedLog) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(scan_padded_log, private_buffer_options()), 0);
+}
+
+/**
+ * Log records written through private buffers, and the comment records
+ * padding their chunks, are replayed correctly by restart.
+ */
+class private_xcts_crash : public restart_test_base {
+public:
+    w_rc_t pre_shutdown(ss_m *ssm) {
+        _stid_list = new StoreID[1];
+        W_DO(x_btree_create_index(ssm, &_volume, _stid_list[0], _root_pid));
+        W_DO(run_private_xcts(_stid_list[0], 0));
+        return RCOK;
+    }
+
+    w_rc_t post_shutdown(ss_m *) {
+        W_DO(check_private_xcts(_stid_list[0], 1));
+        return RCOK;
+    }
+};
+
+TEST (LogPrivateBufferTest, Crash) {
+    test_env->empty_logdata_dir();
+    private_xcts_crash context;
+    restart_test_options options;
+    options.shutdown_mode = simulated_crash;
+    EXPECT_EQ(test_env->runRestartTest(&context, &options, false, private_buffer_options()), 0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    test_env = new btree_test_env();
+    ::testing::AddGlobalTestEnvironment(test_env);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,162 @@
+#include "btree_test_env.h"
+#include "gtest/gtest.h"
+#include "sm_vas.h"
+#include "btree.h"
+#include "vol.h"
+#include "vol_aio.h"
+#include "smstats.h"
+#include "sm_base.h"
+
+#include <stdlib.h>
+
+/**
+ * Testcases for volume I/O through io_uring (option sm_vol_io_uring). They
+ * pass trivially if the kernel does not allow setting up a ring.
+ */
+
+btree_test_env *test_env;
+
+/** Pages per batch; more than the ring has entries */
+const int aio_batch = 16;
+const int aio_depth = 4;
+
+long stat_of(const sm_stats_t& stats, sm_stat_id id) {
+    return stats[enum_to_base(id)];
+}
+
+bool io_uring_supported() {
+    vol_aio_ring probe(aio_depth);
+    if (!probe.is_valid()) {
+        std::cout << "io_uring not supported by the kernel; skipping" << std::endl;
+    }
+    return probe.is_valid();
+}
+
+sm_options aio_options() {
+    sm_options options;
+    options.set_bool_option("sm_vol_io_uring", true);
+    options.set_int_option("sm_vol_aio_depth", aio_depth);
+    return options;
+}
+
+// a batch of single-page writes, then reads of the same pages, both on
+// registered buffers
+w_rc_t test_vol_aio_batch(ss_m*, test_volume_t*) {
+    if (!io_uring_supported()) { return RCOK; }
+
+    vol_t* vol = smlevel_0::vol;
+    size_t len = sizeof(generic_page) * aio_batch;
+    void* out_mem = NULL;
+    void* in_mem = NULL;
+    EXPECT_EQ(0, ::posix_memalign(&out_mem, SM_PAGESIZE, len));
+    EXPECT_EQ(0, ::posix_memalign(&in_mem, SM_PAGESIZE, len));
+    generic_page* out = reinterpret_cast<generic_page*>(out_mem);
+    generic_page* in = reinterpret_cast<generic_page*>(in_mem);
+
+    EXPECT_TRUE(vol->register_aio_buffers(out, len));
+    EXPECT_TRUE(vol->register_aio_buffers(in, len));
+
+    // past the allocated pages, so that nothing in use is overwritten
+    PageID first = vol->get_last_allocated_pid() + 100;
+    for (int i = 0; i < aio_batch; ++i) {
+        ::memset(&out[i], 'a' + i, sizeof(generic_page));
+        out[i].pid = first + i;
+    }
+    ::memset(in, 0, len);
+
+    sm_stats_t before;
+    W_DO(ss_m::gather_stats(before));
+
+    for (int i = 0; i < aio_batch; ++i) {
+        W_DO(vol->submit_write(first + i, &out[i], 1));
+    }
+    vol->wait_aio();
+    for (int i = 0; i < aio_batch; ++i) {
+        W_DO(vol->submit_read(first + i, &in[i], 1));
+    }
+    vol->wait_aio();
+
+    sm_stats_t after;
+    W_DO(ss_m::gather_stats(after));
+
+    for (int i = 0; i < aio_batch; ++i) {
+        EXPECT_EQ(first + i, in[i].pid);
+        EXPECT_EQ(0, ::memcmp(&out[i], &in[i], sizeof(generic_page)));
+    }
+
+    EXPECT_EQ(2 * aio_batch, stat_of(after, sm_stat_id::vol_aio_requests)
+            - stat_of(before, sm_stat_id::vol_aio_requests));
+    EXPECT_EQ(2 * aio_batch, stat_of(after, sm_stat_id::vol_aio_fixed_requests)
+            - stat_of(before, sm_stat_id::vol_aio_fixed_requests));
+    // the ring was full while submitting
+    EXPECT_GT(stat_of(after, sm_stat_id::vol_aio_ring_full)
+            - stat_of(before, sm_stat_id::vol_aio_ring_full), 0);
+
+    ::free(out_mem);
+    ::free(in_mem);
+    return RCOK;
+}
+
+TEST (VolAioTest, BatchedWriteReadBack) {
+    test_env->empty_logdata_dir();
+    EXPECT_EQ(test_env->runBtreeTest(test_vol_aio_batch, aio_options()), 0);
+}
+
+// Pages missing in the buffer pool after a restart are read into the frames,
+// which are registered with the ring
+class restart_vol_aio : public restart_test_base
+{
+public:
+    w_rc_t pre_shutdown(ss_m *ssm) {
+        _stid_list = new StoreID[1];
+        W_DO(x_btree_create_index(ssm, &_volume, _stid_list[0], _root_pid));
+        std::string data(SM_PAGESIZE / 8, 'd');
+        char key[16];
+        W_DO(test_env->begin_xct());
+        for (int i = 0; i < 500; ++i) {
+            ::snprintf(key, sizeof(key), "key%06d", i);
+            W_DO(test_env->btree_insert(_stid_list[0], key, data.c_str()));
+        }
+        W_DO(test_env->commit_xct());
+        // the test driver shuts down without flushing otherwise
+        ssm->set_shutdown_flag(true);
+        return RCOK;
+    }
+
+    w_rc_t post_shutdown(ss_m *) {
+        sm_stats_t before;
+        W_DO(ss_m::gather_stats(before));
+
+        x_btree_scan_result s;
+        W_DO(test_env->btree_scan(_stid_list[0], s));
+        EXPECT_EQ (500, s.rownum);
+        EXPECT_EQ (std::string("key000000"), s.minkey);
+        EXPECT_EQ (std::string("key000499"), s.maxkey);
+
+        sm_stats_t after;
+        W_DO(ss_m::gather_stats(after));
+        if (io_uring_supported()) {
+            long reads = stat_of(after, sm_stat_id::vol_reads)
+                - stat_of(before, sm_stat_id::vol_reads);
+            EXPECT_GT(reads, 0);
+            EXPECT_EQ(reads, stat_of(after, sm_stat_id::vol_aio_fixed_requests)
+                    - stat_of(before, sm_stat_id::vol_aio_fixed_requests));
+        }
+        return RCOK;
+    }
+};
+
+TEST (VolAioTest, BufferpoolReads) {
+    test_env->empty_logdata_dir();
+    restart_vol_aio context;
+    restart_test_options options;
+    options.shutdown_mode = normal_shutdown;
+    EXPECT_EQ(test_env->runRestartTest(&context, &options, false, aio_options()), 0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    test_env = new btree_test_env();
+    ::testing::AddGlobalTestEnvironment(test_env);
+    return RUN_ALL_TESTS();
+}
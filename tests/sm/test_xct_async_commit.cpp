@@ -0,0 +1,155 @@
+#include "btree_test_env.h"
+#include "gtest/gtest.h"
+#include "sm_vas.h"
+#include "btree.h"
+#include "log_core.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+btree_test_env *test_env;
+
+/**
+ * Testcases for asynchronous commits (ss_m::commit_xct_async).
+ */
+
+const int XCTS = 200;
+/** Makes each flush take long enough to observe commits awaiting it */
+const int SLOW_FLUSH_DELAY_US = 50000;
+
+/**
+ * Records the LSNs the durability callbacks receive and checks that each
+ * of them really was durable.
+ */
+struct durable_recorder_t {
+    std::atomic<int> count;
+    std::atomic<int> not_durable;
+    std::mutex mutex;
+    std::vector<lsn_t> lsns;
+    durable_recorder_t() : count(0), not_durable(0) {}
+
+    durability_callback_t callback() {
+        return [this](const lsn_t& lsn) {
+            if (lsn >= smlevel_0::log->durable_lsn()) { ++not_durable; }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                lsns.push_back(lsn);
+            }
+            ++count;
+        };
+    }
+
+    void wait_for(int expected) {
+        while (count < expected) {
+            lsn_t lsn = smlevel_0::log->curr_lsn();
+            W_COERCE(ss_m::flush_until(lsn));
+            std::this_thread::yield();
+        }
+    }
+};
+
+rc_t insert_records(StoreID stid, durable_recorder_t& recorder,
+                    std::vector<lsn_t>* commit_lsns = NULL) {
+    char key[16];
+    for (int i = 0; i < XCTS; ++i) {
+        ::sprintf(key, "key%05d", i);
+        W_DO(ss_m::begin_xct());
+        W_DO(test_env->btree_insert(stid, key, "data"));
+        lsn_t commit_lsn;
+        W_DO(ss_m::commit_xct_async(recorder.callback(), &commit_lsn));
+        EXPECT_TRUE(commit_lsn.valid());
+        if (commit_lsns) { commit_lsns->push_back(commit_lsn); }
+    }
+    return RCOK;
+}
+
+rc_t check_records(StoreID stid) {
+    W_DO(ss_m::begin_xct());
+    char key[16];
+    for (int i = 0; i < XCTS; ++i) {
+        ::sprintf(key, "key%05d", i);
+        std::string data;
+        W_DO(test_env->btree_lookup(stid, key, data));
+        EXPECT_EQ(std::string("data"), data) << key;
+    }
+    W_DO(ss_m::commit_xct());
+    return RCOK;
+}
+
+w_rc_t async_commits(ss_m* ssm, test_volume_t *test_volume) {
+    StoreID stid;
+    PageID root_pid;
+    W_DO(x_btree_create_index(ssm, test_volume, stid, root_pid));
+
+    durable_recorder_t recorder;
+    std::vector<lsn_t> commit_lsns;
+    W_DO(insert_records(stid, recorder, &commit_lsns));
+    // each flush takes SLOW_FLUSH_DELAY_US, so the last commits cannot be
+    // durable yet: commit_xct_async() did not wait for them
+    EXPECT_LT(recorder.count, XCTS);
+
+    recorder.wait_for(XCTS);
+    EXPECT_EQ(0, recorder.not_durable);
+    // every commit is reported exactly once with its own LSN, and in the
+    // order the commits became durable
+    EXPECT_TRUE(std::is_sorted(recorder.lsns.begin(), recorder.lsns.end()));
+    EXPECT_EQ(commit_lsns, recorder.lsns);
+
+    // a read-only transaction is only notified once what it read is durable
+    durable_recorder_t read_recorder;
+    W_DO(ss_m::begin_xct());
+    std::string data;
+    W_DO(test_env->btree_lookup(stid, "key00000", data));
+    W_DO(ss_m::commit_xct_async(read_recorder.callback()));
+    read_recorder.wait_for(1);
+    EXPECT_EQ(0, read_recorder.not_durable);
+    EXPECT_GE(read_recorder.lsns[0], commit_lsns.back());
+
+    W_DO(check_records(stid));
+    return RCOK;
+}
+
+TEST (XctAsyncCommitTest, Commits) {
+    test_env->empty_logdata_dir();
+    sm_options options;
+    options.set_int_option("sm_log_fake_flush_delay", SLOW_FLUSH_DELAY_US);
+    EXPECT_EQ(test_env->runBtreeTest(async_commits, options), 0);
+}
+
+/**
+ * Whatever was reported durable survives a crash.
+ */
+class async_commit_crash : public restart_test_base {
+public:
+    w_rc_t pre_shutdown(ss_m *ssm) {
+        _stid_list = new StoreID[1];
+        W_DO(x_btree_create_index(ssm, &_volume, _stid_list[0], _root_pid));
+        durable_recorder_t recorder;
+        W_DO(insert_records(_stid_list[0], recorder));
+        recorder.wait_for(XCTS);
+        return RCOK;
+    }
+
+    w_rc_t post_shutdown(ss_m *) {
+        W_DO(check_records(_stid_list[0]));
+        return RCOK;
+    }
+};
+
+TEST (XctAsyncCommitTest, Crash) {
+    test_env->empty_logdata_dir();
+    async_commit_crash context;
+    restart_test_options options;
+    options.shutdown_mode = simulated_crash;
+    EXPECT_EQ(test_env->runRestartTest(&context, &options), 0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    test_env = new btree_test_env();
+    ::testing::AddGlobalTestEnvironment(test_env);
+    return RUN_ALL_TESTS();
+}